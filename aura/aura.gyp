@@ -75,6 +75,8 @@
         'env_observer.h',
         'focus_manager.cc',
         'focus_manager.h',
+        'input_latency_tracker.cc',
+        'input_latency_tracker.h',
         'layout_manager.cc',
         'layout_manager.h',
         'remote_root_window_host_win.cc',
@@ -160,6 +162,8 @@
         'test/test_windows.h',
         'test/test_window_delegate.cc',
         'test/test_window_delegate.h',
+        'test/touch_trace.cc',
+        'test/touch_trace.h',
         'test/window_test_api.cc',
         'test/window_test_api.h',
       ],
@@ -241,6 +245,52 @@
         'bench/bench_main.cc',
       ],
     },
+    {
+      'target_name': 'aura_perftests',
+      'type': 'executable',
+      'dependencies': [
+        '../../base/base.gyp:test_support_base',
+        '../../chrome/chrome_resources.gyp:packed_resources',
+        '../../skia/skia.gyp:skia',
+        '../../testing/gtest.gyp:gtest',
+        '../compositor/compositor.gyp:compositor_test_support',
+        '../compositor/compositor.gyp:compositor',
+        '../gl/gl.gyp:gl',
+        '../ui.gyp:ui',
+        '../ui.gyp:ui_resources',
+        '../ui.gyp:ui_test_support',
+        'aura_test_support',
+        'aura',
+      ],
+      'include_dirs': [
+        '..',
+      ],
+      'sources': [
+        'gestures/gesture_recognizer_perftest.cc',
+        'test/run_all_unittests.cc',
+        'test/test_suite.cc',
+        'test/test_suite.h',
+      ],
+      'conditions': [
+        # osmesa GL implementation is used on linux.
+        ['OS=="linux"', {
+          'dependencies': [
+            '<(DEPTH)/third_party/mesa/mesa.gyp:osmesa',
+          ],
+        }],
+        # compositor_test_support links tcmalloc in, which owns the global
+        # allocation functions.
+        ['os_posix == 1 and OS != "mac"', {
+          'conditions': [
+            ['linux_use_tcmalloc==1', {
+              'defines': [
+                'USE_TCMALLOC',
+              ],
+            }],
+          ],
+        }],
+      ],
+    },
     {
       'target_name': 'aura_unittests',
       'type': 'executable',
@@ -263,6 +313,7 @@
       ],
       'sources': [
         'gestures/gesture_recognizer_unittest.cc',
+        'input_latency_tracker_unittest.cc',
         'test/run_all_unittests.cc',
         'test/test_suite.cc',
         'test/test_suite.h',
@@ -0,0 +1,216 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <new>
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/format_macros.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/stringprintf.h"
+#include "base/time.h"
+#include "build/build_config.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/aura/root_window.h"
+#include "ui/aura/test/aura_test_base.h"
+#include "ui/aura/test/test_window_delegate.h"
+#include "ui/aura/test/test_windows.h"
+#include "ui/aura/test/touch_trace.h"
+#include "ui/base/events/event.h"
+#include "ui/gfx/point.h"
+#include "ui/gfx/rect.h"
+
+// Allocations are counted by replacing the global allocation functions. That
+// isn't done where tcmalloc is linked in, as it owns them, nor in Windows
+// component builds, where the override wouldn't see the allocations made
+// inside the DLLs. There allocations aren't counted.
+#if !defined(USE_TCMALLOC) && !(defined(OS_WIN) && defined(COMPONENT_BUILD))
+#define COUNT_ALLOCATIONS
+#endif
+
+#if defined(COUNT_ALLOCATIONS)
+namespace {
+
+// The number of calls to operator new made by this process. This isn't
+// thread-safe, but the replay happens on a single thread.
+int64 g_allocation_count = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+  ++g_allocation_count;
+  void* p = malloc(size ? size : 1);
+  CHECK(p);
+  return p;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* p) throw() {
+  free(p);
+}
+
+void operator delete[](void* p) throw() {
+  free(p);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) throw() {
+  ++g_allocation_count;
+  return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& nothrow) throw() {
+  return operator new(size, nothrow);
+}
+
+void operator delete(void* p, const std::nothrow_t&) throw() {
+  free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) throw() {
+  free(p);
+}
+#endif  // defined(COUNT_ALLOCATIONS)
+
+namespace aura {
+namespace test {
+
+namespace {
+
+// The number of times each trace is replayed.
+const int kReplayCount = 200;
+
+// Returns the number of allocations made so far, or 0 if they aren't counted.
+int64 GetAllocationCount() {
+#if defined(COUNT_ALLOCATIONS)
+  return g_allocation_count;
+#else
+  return 0;
+#endif
+}
+
+// Counts the gestures it receives.
+class GestureCountingDelegate : public TestWindowDelegate {
+ public:
+  GestureCountingDelegate()
+      : gesture_count_(0),
+        scroll_update_count_(0),
+        pinch_update_count_(0) {
+  }
+  virtual ~GestureCountingDelegate() {}
+
+  int gesture_count() const { return gesture_count_; }
+  int scroll_update_count() const { return scroll_update_count_; }
+  int pinch_update_count() const { return pinch_update_count_; }
+
+  // Overridden from TestWindowDelegate:
+  virtual void OnGestureEvent(ui::GestureEvent* gesture) OVERRIDE {
+    ++gesture_count_;
+    if (gesture->type() == ui::ET_GESTURE_SCROLL_UPDATE)
+      ++scroll_update_count_;
+    else if (gesture->type() == ui::ET_GESTURE_PINCH_UPDATE)
+      ++pinch_update_count_;
+    gesture->SetHandled();
+  }
+
+ private:
+  int gesture_count_;
+  int scroll_update_count_;
+  int pinch_update_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(GestureCountingDelegate);
+};
+
+}  // namespace
+
+// Replays synthetic touch traces through the RootWindow, and so through the
+// gesture recognizer and RootWindow::ProcessGestures, and reports the
+// throughput, the allocations made per touch event and the gestures generated.
+class GestureRecognizerPerfTest : public AuraTestBase {
+ public:
+  GestureRecognizerPerfTest() {}
+  virtual ~GestureRecognizerPerfTest() {}
+
+ protected:
+  void ReplayTrace(const char* name, const TouchTrace& trace) {
+    GestureCountingDelegate delegate;
+    scoped_ptr<Window> window(CreateTestWindowWithDelegate(
+        &delegate, 1, gfx::Rect(0, 0, 800, 600), root_window()));
+
+    // Each replay starts after the previous one, so that the recognizer
+    // sees a single stream of increasing time stamps.
+    base::TimeDelta offset;
+    const base::TimeDelta trace_duration =
+        trace.GetDuration() + base::TimeDelta::FromSeconds(1);
+    int64 allocations = GetAllocationCount();
+    base::TimeTicks start = base::TimeTicks::HighResNow();
+    for (int i = 0; i < kReplayCount; ++i) {
+      trace.Replay(root_window(), offset);
+      offset += trace_duration;
+    }
+    base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+    allocations = GetAllocationCount() - allocations;
+
+    size_t events = trace.events().size() * kReplayCount;
+    EXPECT_GT(delegate.gesture_count(), 0);
+#if defined(COUNT_ALLOCATIONS)
+    std::string allocations_per_event = base::StringPrintf(
+        "%.1f", static_cast<double>(allocations) / events);
+#else
+    std::string allocations_per_event = "n/a";
+#endif
+    printf("%s: %" PRIuS " touch events in %.1f ms (%.0f events/sec), "
+           "%s allocations/event, %d gestures (%d scroll updates, "
+           "%d pinch updates)\n",
+           name, events, elapsed.InMillisecondsF(),
+           events / std::max(elapsed.InSecondsF(), 1e-6),
+           allocations_per_event.c_str(),
+           delegate.gesture_count(),
+           delegate.scroll_update_count(),
+           delegate.pinch_update_count());
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(GestureRecognizerPerfTest);
+};
+
+TEST_F(GestureRecognizerPerfTest, Pinch) {
+  TouchTrace trace;
+  trace.AddPinch(gfx::Point(400, 300), 100);
+  ReplayTrace("Pinch", trace);
+}
+
+TEST_F(GestureRecognizerPerfTest, RailScroll) {
+  TouchTrace trace;
+  trace.AddRailScroll(gfx::Point(400, 20), 100);
+  ReplayTrace("RailScroll", trace);
+}
+
+TEST_F(GestureRecognizerPerfTest, Palm) {
+  TouchTrace trace;
+  trace.AddPalm(gfx::Point(400, 300), 100);
+  ReplayTrace("Palm", trace);
+}
+
+// Recorded traces go through the text format before being replayed.
+TEST_F(GestureRecognizerPerfTest, Mixed) {
+  TouchTrace recorded;
+  recorded.AddRailScroll(gfx::Point(100, 20), 50);
+  recorded.AddPinch(gfx::Point(400, 300), 50);
+  recorded.AddPalm(gfx::Point(400, 300), 50);
+
+  TouchTrace trace;
+  ASSERT_TRUE(trace.ParseFromString(recorded.ToString()));
+  ReplayTrace("Mixed", trace);
+}
+
+}  // namespace test
+}  // namespace aura
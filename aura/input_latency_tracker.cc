@@ -0,0 +1,207 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/aura/input_latency_tracker.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "base/debug/trace_event.h"
+#include "base/logging.h"
+#include "ui/base/events/event.h"
+
+namespace aura {
+
+namespace {
+
+// The number of most recent events of each type the percentiles cover.
+const size_t kMaxSamplesPerType = 256;
+
+// Events that scheduled a paint but never get a frame (e.g. because drawing is
+// stalled) are dropped, oldest first, beyond this many.
+const size_t kMaxPendingEvents = 64;
+
+// A native timestamp this much further behind the start of its dispatch than
+// the estimated clock offset allows is taken to mean the native clock has
+// jumped (e.g. the X server's time has wrapped), and the offset is estimated
+// afresh.
+const int64 kMaxNativeClockDriftSeconds = 60;
+
+base::TimeDelta GetPercentile(const std::vector<base::TimeDelta>& sorted,
+                              int percentile) {
+  return sorted[(sorted.size() - 1) * percentile / 100];
+}
+
+}  // namespace
+
+InputLatencyRecord::InputLatencyRecord()
+    : type(ui::ET_UNKNOWN) {
+}
+
+base::TimeDelta InputLatencyRecord::GetTotalLatency() const {
+  base::TimeTicks start = native_event_time.is_null() ?
+      dispatch_start_time : native_event_time;
+  base::TimeTicks end = swap_time.is_null() ? dispatch_end_time : swap_time;
+  return end - start;
+}
+
+InputLatencyTracker::Percentiles::Percentiles()
+    : sample_count(0) {
+}
+
+InputLatencyTracker::PendingEvent::PendingEvent()
+    : id(0),
+      frame(0) {
+}
+
+InputLatencyTracker::InputLatencyTracker()
+    : next_event_id_(1),
+      native_clock_offset_known_(false) {
+}
+
+InputLatencyTracker::~InputLatencyTracker() {
+  for (PendingEvents::const_iterator it = pending_events_.begin();
+       it != pending_events_.end(); ++it) {
+    DropEvent(*it);
+  }
+}
+
+void InputLatencyTracker::AddObserver(InputLatencyObserver* observer) {
+  observers_.AddObserver(observer);
+}
+
+void InputLatencyTracker::RemoveObserver(InputLatencyObserver* observer) {
+  observers_.RemoveObserver(observer);
+}
+
+bool InputLatencyTracker::GetPercentiles(ui::EventType type,
+                                         Percentiles* percentiles) const {
+  std::map<ui::EventType, Samples>::const_iterator found = samples_.find(type);
+  if (found == samples_.end() || found->second.empty())
+    return false;
+
+  std::vector<base::TimeDelta> sorted(found->second.begin(),
+                                      found->second.end());
+  std::sort(sorted.begin(), sorted.end());
+  percentiles->p50 = GetPercentile(sorted, 50);
+  percentiles->p90 = GetPercentile(sorted, 90);
+  percentiles->p99 = GetPercentile(sorted, 99);
+  percentiles->sample_count = sorted.size();
+  return true;
+}
+
+void InputLatencyTracker::OnDispatchStarted(const ui::Event& event) {
+  PendingEvent pending;
+  pending.id = next_event_id_++;
+  pending.record.type = event.type();
+  pending.record.dispatch_start_time = base::TimeTicks::Now();
+  if (event.time_stamp() != base::TimeDelta()) {
+    pending.record.native_event_time = MapNativeEventTime(
+        event.time_stamp(), pending.record.dispatch_start_time);
+  }
+
+  TRACE_EVENT_ASYNC_BEGIN1("ui", "InputLatency", pending.id,
+                           "type", static_cast<int>(event.type()));
+  dispatching_events_.push_back(pending);
+}
+
+void InputLatencyTracker::OnDispatchEnded() {
+  DCHECK(!dispatching_events_.empty());
+  PendingEvent pending = dispatching_events_.back();
+  dispatching_events_.pop_back();
+  pending.record.dispatch_end_time = base::TimeTicks::Now();
+
+  if (pending.record.paint_scheduled_time.is_null()) {
+    CompleteEvent(pending);
+    return;
+  }
+
+  TRACE_EVENT_ASYNC_STEP0("ui", "InputLatency", pending.id, "WaitingForFrame");
+  pending_events_.push_back(pending);
+  if (pending_events_.size() > kMaxPendingEvents) {
+    DropEvent(pending_events_.front());
+    pending_events_.pop_front();
+  }
+}
+
+void InputLatencyTracker::OnDrawScheduled() {
+  if (dispatching_events_.empty())
+    return;
+  InputLatencyRecord& record = dispatching_events_.back().record;
+  if (record.paint_scheduled_time.is_null())
+    record.paint_scheduled_time = base::TimeTicks::Now();
+}
+
+void InputLatencyTracker::OnDrawStarted(int frame) {
+  // Events get frames in the order they were dispatched, so the ones without a
+  // frame are at the back.
+  for (PendingEvents::reverse_iterator it = pending_events_.rbegin();
+       it != pending_events_.rend() && !it->frame; ++it) {
+    it->frame = frame;
+  }
+}
+
+void InputLatencyTracker::OnCompositingDidCommit() {
+  base::TimeTicks now = base::TimeTicks::Now();
+  for (PendingEvents::iterator it = pending_events_.begin();
+       it != pending_events_.end() && it->frame; ++it) {
+    if (it->record.commit_time.is_null())
+      it->record.commit_time = now;
+  }
+}
+
+void InputLatencyTracker::OnCompositingEnded(int last_ended_frame) {
+  base::TimeTicks now = base::TimeTicks::Now();
+  while (!pending_events_.empty() && pending_events_.front().frame &&
+         pending_events_.front().frame <= last_ended_frame) {
+    PendingEvent pending = pending_events_.front();
+    pending_events_.pop_front();
+    pending.record.swap_time = now;
+    if (pending.record.commit_time.is_null())
+      pending.record.commit_time = now;
+    CompleteEvent(pending);
+  }
+}
+
+void InputLatencyTracker::OnCompositingAborted() {
+  while (!pending_events_.empty() && pending_events_.front().frame) {
+    DropEvent(pending_events_.front());
+    pending_events_.pop_front();
+  }
+}
+
+base::TimeTicks InputLatencyTracker::MapNativeEventTime(
+    base::TimeDelta native_time,
+    base::TimeTicks dispatch_start_time) {
+  base::TimeDelta offset = dispatch_start_time - base::TimeTicks() -
+      native_time;
+  if (!native_clock_offset_known_ ||
+      offset < native_clock_offset_ ||
+      offset - native_clock_offset_ >
+          base::TimeDelta::FromSeconds(kMaxNativeClockDriftSeconds)) {
+    native_clock_offset_ = offset;
+    native_clock_offset_known_ = true;
+  }
+  return base::TimeTicks() + native_time + native_clock_offset_;
+}
+
+void InputLatencyTracker::CompleteEvent(const PendingEvent& event) {
+  base::TimeDelta latency = event.record.GetTotalLatency();
+  TRACE_EVENT_ASYNC_END1("ui", "InputLatency", event.id,
+                         "latency_us", latency.InMicroseconds());
+
+  Samples& samples = samples_[event.record.type];
+  samples.push_back(latency);
+  if (samples.size() > kMaxSamplesPerType)
+    samples.pop_front();
+
+  FOR_EACH_OBSERVER(InputLatencyObserver, observers_,
+                    OnInputLatencyRecorded(event.record));
+}
+
+void InputLatencyTracker::DropEvent(const PendingEvent& event) {
+  TRACE_EVENT_ASYNC_END0("ui", "InputLatency", event.id);
+}
+
+}  // namespace aura
@@ -0,0 +1,163 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_AURA_INPUT_LATENCY_TRACKER_H_
+#define UI_AURA_INPUT_LATENCY_TRACKER_H_
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/weak_ptr.h"
+#include "base/observer_list.h"
+#include "base/time.h"
+#include "ui/aura/aura_export.h"
+#include "ui/base/events/event_constants.h"
+
+namespace ui {
+class Event;
+}
+
+namespace aura {
+
+// The times at which an input event reached each stage between the native
+// event and the frame showing its effect.
+struct AURA_EXPORT InputLatencyRecord {
+  InputLatencyRecord();
+
+  // Returns the time from the native event (or, if its time is unknown, from
+  // the start of dispatch) to the swap of the frame showing its effect (or, if
+  // handling the event didn't schedule a paint, to the end of dispatch).
+  base::TimeDelta GetTotalLatency() const;
+
+  ui::EventType type;
+
+  // When the native event was generated, mapped onto the base::TimeTicks
+  // clock. Null if the event has no native timestamp.
+  base::TimeTicks native_event_time;
+
+  base::TimeTicks dispatch_start_time;
+  base::TimeTicks dispatch_end_time;
+
+  // These are null if handling the event didn't schedule a paint.
+  base::TimeTicks paint_scheduled_time;
+  base::TimeTicks commit_time;
+  base::TimeTicks swap_time;
+};
+
+class AURA_EXPORT InputLatencyObserver {
+ public:
+  // Called when |record| is complete: when the frame showing the event's effect
+  // has been swapped, or at the end of dispatch if handling the event didn't
+  // schedule a paint.
+  virtual void OnInputLatencyRecorded(const InputLatencyRecord& record) = 0;
+
+ protected:
+  virtual ~InputLatencyObserver() {}
+};
+
+// Follows the input events a RootWindow dispatches through to the compositor
+// frames that show their effect, and keeps rolling percentiles of the total
+// latency per event type. Each event is also traced as an asynchronous
+// "InputLatency" event in the "ui" category.
+//
+// An event is attributed to the first frame drawn after a paint is scheduled
+// while it is being dispatched. Paints scheduled asynchronously (e.g. from a
+// posted task) aren't attributed to the event.
+//
+// Native timestamps needn't be on the base::TimeTicks clock (on X11 they are
+// the X server's time), so they are mapped onto it with the smallest delay
+// seen between a native timestamp and the start of its dispatch. Latencies
+// are therefore measured from the fastest event's delivery, and understate
+// the true latency by that event's delivery time.
+class AURA_EXPORT InputLatencyTracker
+    : public base::SupportsWeakPtr<InputLatencyTracker> {
+ public:
+  struct AURA_EXPORT Percentiles {
+    Percentiles();
+
+    base::TimeDelta p50;
+    base::TimeDelta p90;
+    base::TimeDelta p99;
+    size_t sample_count;
+  };
+
+  InputLatencyTracker();
+  ~InputLatencyTracker();
+
+  void AddObserver(InputLatencyObserver* observer);
+  void RemoveObserver(InputLatencyObserver* observer);
+
+  // Gets the percentiles of the total latency of the most recent events of
+  // |type|. Returns false if no events of |type| have been recorded.
+  bool GetPercentiles(ui::EventType type, Percentiles* percentiles) const;
+
+  // Called by the RootWindow around the dispatch of an event from its host.
+  // An event dispatched from a nested message loop while another is being
+  // dispatched gets its own record.
+  void OnDispatchStarted(const ui::Event& event);
+  void OnDispatchEnded();
+
+  // Called by the RootWindow as it schedules, and then starts drawing, frame
+  // number |frame|.
+  void OnDrawScheduled();
+  void OnDrawStarted(int frame);
+
+  // Called by the RootWindow as the compositor commits, and then finishes or
+  // aborts, the frames it has started.
+  void OnCompositingDidCommit();
+  void OnCompositingEnded(int last_ended_frame);
+  void OnCompositingAborted();
+
+ private:
+  // An event whose record hasn't been completed yet.
+  struct PendingEvent {
+    PendingEvent();
+
+    int64 id;
+    InputLatencyRecord record;
+
+    // The frame showing the event's effect, or 0 if it hasn't started yet.
+    int frame;
+  };
+
+  typedef std::deque<PendingEvent> PendingEvents;
+  typedef std::deque<base::TimeDelta> Samples;
+
+  // Maps |native_time| onto the base::TimeTicks clock, updating the
+  // estimate of the offset between the two clocks with the delay to
+  // |dispatch_start_time|.
+  base::TimeTicks MapNativeEventTime(base::TimeDelta native_time,
+                                     base::TimeTicks dispatch_start_time);
+
+  void CompleteEvent(const PendingEvent& event);
+  void DropEvent(const PendingEvent& event);
+
+  ObserverList<InputLatencyObserver> observers_;
+
+  // The most recent total latencies of each event type, oldest first.
+  std::map<ui::EventType, Samples> samples_;
+
+  // The events being dispatched, outermost first.
+  std::vector<PendingEvent> dispatching_events_;
+
+  // Dispatched events that scheduled a paint and are waiting for its frame,
+  // oldest first.
+  PendingEvents pending_events_;
+
+  int64 next_event_id_;
+
+  // The smallest delay seen from a native timestamp to the start of its
+  // dispatch, which is taken as the offset between the native event clock
+  // and base::TimeTicks. Only valid if |native_clock_offset_known_|.
+  base::TimeDelta native_clock_offset_;
+  bool native_clock_offset_known_;
+
+  DISALLOW_COPY_AND_ASSIGN(InputLatencyTracker);
+};
+
+}  // namespace aura
+
+#endif  // UI_AURA_INPUT_LATENCY_TRACKER_H_
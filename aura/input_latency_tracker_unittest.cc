@@ -0,0 +1,226 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/aura/input_latency_tracker.h"
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/base/events/event.h"
+#include "ui/base/events/event_utils.h"
+#include "ui/base/keycodes/keyboard_codes.h"
+#include "ui/gfx/point.h"
+
+namespace aura {
+
+namespace {
+
+class TestInputLatencyObserver : public InputLatencyObserver {
+ public:
+  TestInputLatencyObserver() {}
+  virtual ~TestInputLatencyObserver() {}
+
+  const std::vector<InputLatencyRecord>& records() const { return records_; }
+
+  // InputLatencyObserver overrides:
+  virtual void OnInputLatencyRecorded(
+      const InputLatencyRecord& record) OVERRIDE {
+    records_.push_back(record);
+  }
+
+ private:
+  std::vector<InputLatencyRecord> records_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestInputLatencyObserver);
+};
+
+ui::MouseEvent CreateMouseMove() {
+  return ui::MouseEvent(ui::ET_MOUSE_MOVED, gfx::Point(1, 1),
+                        gfx::Point(1, 1), 0);
+}
+
+}  // namespace
+
+// An event that doesn't schedule a paint is complete once it's dispatched.
+TEST(InputLatencyTrackerTest, EventWithoutPaint) {
+  InputLatencyTracker tracker;
+  TestInputLatencyObserver observer;
+  tracker.AddObserver(&observer);
+
+  ui::KeyEvent key(ui::ET_KEY_PRESSED, ui::VKEY_A, 0, false);
+  tracker.OnDispatchStarted(key);
+  tracker.OnDispatchEnded();
+
+  ASSERT_EQ(1U, observer.records().size());
+  const InputLatencyRecord& record = observer.records()[0];
+  EXPECT_EQ(ui::ET_KEY_PRESSED, record.type);
+  EXPECT_FALSE(record.dispatch_start_time.is_null());
+  EXPECT_LE(record.dispatch_start_time, record.dispatch_end_time);
+  EXPECT_TRUE(record.paint_scheduled_time.is_null());
+  EXPECT_TRUE(record.swap_time.is_null());
+
+  InputLatencyTracker::Percentiles percentiles;
+  EXPECT_TRUE(tracker.GetPercentiles(ui::ET_KEY_PRESSED, &percentiles));
+  EXPECT_EQ(1U, percentiles.sample_count);
+  EXPECT_FALSE(tracker.GetPercentiles(ui::ET_MOUSE_MOVED, &percentiles));
+
+  tracker.RemoveObserver(&observer);
+}
+
+// An event that schedules a paint is complete once the next frame to start is
+// swapped, and not when a frame already in flight is.
+TEST(InputLatencyTrackerTest, EventWithPaint) {
+  InputLatencyTracker tracker;
+  TestInputLatencyObserver observer;
+  tracker.AddObserver(&observer);
+
+  // Frame 1 starts before the event is dispatched.
+  tracker.OnDrawStarted(1);
+
+  ui::MouseEvent mouse = CreateMouseMove();
+  tracker.OnDispatchStarted(mouse);
+  tracker.OnDrawScheduled();
+  tracker.OnDispatchEnded();
+  EXPECT_TRUE(observer.records().empty());
+
+  tracker.OnCompositingDidCommit();
+  tracker.OnCompositingEnded(1);
+  EXPECT_TRUE(observer.records().empty());
+
+  tracker.OnDrawStarted(2);
+  tracker.OnCompositingDidCommit();
+  EXPECT_TRUE(observer.records().empty());
+  tracker.OnCompositingEnded(2);
+
+  ASSERT_EQ(1U, observer.records().size());
+  const InputLatencyRecord& record = observer.records()[0];
+  EXPECT_EQ(ui::ET_MOUSE_MOVED, record.type);
+  EXPECT_LE(record.dispatch_start_time, record.paint_scheduled_time);
+  EXPECT_LE(record.paint_scheduled_time, record.dispatch_end_time);
+  EXPECT_LE(record.dispatch_end_time, record.commit_time);
+  EXPECT_LE(record.commit_time, record.swap_time);
+  ASSERT_FALSE(record.native_event_time.is_null());
+  EXPECT_LE(record.native_event_time, record.dispatch_start_time);
+  EXPECT_EQ(record.swap_time - record.native_event_time,
+            record.GetTotalLatency());
+
+  tracker.RemoveObserver(&observer);
+}
+
+// Events dispatched from a nested loop get their own records, and a paint is
+// attributed to the innermost event being dispatched.
+TEST(InputLatencyTrackerTest, NestedDispatch) {
+  InputLatencyTracker tracker;
+  TestInputLatencyObserver observer;
+  tracker.AddObserver(&observer);
+
+  ui::KeyEvent key(ui::ET_KEY_PRESSED, ui::VKEY_A, 0, false);
+  ui::MouseEvent mouse = CreateMouseMove();
+  tracker.OnDispatchStarted(key);
+  tracker.OnDispatchStarted(mouse);
+  tracker.OnDrawScheduled();
+  tracker.OnDispatchEnded();
+  tracker.OnDispatchEnded();
+
+  // The key event didn't schedule a paint, so only it is complete.
+  ASSERT_EQ(1U, observer.records().size());
+  EXPECT_EQ(ui::ET_KEY_PRESSED, observer.records()[0].type);
+
+  tracker.OnDrawStarted(1);
+  tracker.OnCompositingEnded(1);
+  ASSERT_EQ(2U, observer.records().size());
+  EXPECT_EQ(ui::ET_MOUSE_MOVED, observer.records()[1].type);
+
+  tracker.RemoveObserver(&observer);
+}
+
+// Events waiting on an aborted frame are dropped.
+TEST(InputLatencyTrackerTest, AbortedFrame) {
+  InputLatencyTracker tracker;
+  TestInputLatencyObserver observer;
+  tracker.AddObserver(&observer);
+
+  ui::MouseEvent mouse = CreateMouseMove();
+  tracker.OnDispatchStarted(mouse);
+  tracker.OnDrawScheduled();
+  tracker.OnDispatchEnded();
+  tracker.OnDrawStarted(1);
+  tracker.OnCompositingAborted();
+  tracker.OnCompositingEnded(1);
+  EXPECT_TRUE(observer.records().empty());
+
+  InputLatencyTracker::Percentiles percentiles;
+  EXPECT_FALSE(tracker.GetPercentiles(ui::ET_MOUSE_MOVED, &percentiles));
+
+  tracker.RemoveObserver(&observer);
+}
+
+TEST(InputLatencyTrackerTest, Percentiles) {
+  InputLatencyTracker tracker;
+  ui::MouseEvent mouse = CreateMouseMove();
+  for (int i = 0; i < 300; ++i) {
+    tracker.OnDispatchStarted(mouse);
+    tracker.OnDispatchEnded();
+  }
+
+  // Only the most recent events are kept.
+  InputLatencyTracker::Percentiles percentiles;
+  EXPECT_TRUE(tracker.GetPercentiles(ui::ET_MOUSE_MOVED, &percentiles));
+  EXPECT_EQ(256U, percentiles.sample_count);
+  EXPECT_LE(percentiles.p50, percentiles.p90);
+  EXPECT_LE(percentiles.p90, percentiles.p99);
+}
+
+// Native timestamps on another clock, such as the X server's, are mapped onto
+// base::TimeTicks with the smallest delay seen before dispatch, and the
+// mapping starts afresh if the native clock jumps.
+TEST(InputLatencyTrackerTest, NativeEventTimeOnOffsetClock) {
+  InputLatencyTracker tracker;
+  TestInputLatencyObserver observer;
+  tracker.AddObserver(&observer);
+
+  // The native clock started 30 seconds after base::TimeTicks.
+  const base::TimeDelta kClockOffset = base::TimeDelta::FromSeconds(30);
+  ui::MouseEvent mouse = CreateMouseMove();
+  ui::Event::TestApi test_api(&mouse);
+
+  // An event delivered quickly sets the offset.
+  test_api.set_time_stamp(ui::EventTimeForNow() - kClockOffset);
+  tracker.OnDispatchStarted(mouse);
+  tracker.OnDispatchEnded();
+
+  // An event delivered 10ms late shows that delay, and not the offset.
+  test_api.set_time_stamp(ui::EventTimeForNow() - kClockOffset -
+                          base::TimeDelta::FromMilliseconds(10));
+  tracker.OnDispatchStarted(mouse);
+  tracker.OnDispatchEnded();
+
+  // The native clock jumps forward, and then back.
+  test_api.set_time_stamp(ui::EventTimeForNow() +
+                          base::TimeDelta::FromDays(1));
+  tracker.OnDispatchStarted(mouse);
+  tracker.OnDispatchEnded();
+  test_api.set_time_stamp(ui::EventTimeForNow() - kClockOffset);
+  tracker.OnDispatchStarted(mouse);
+  tracker.OnDispatchEnded();
+
+  ASSERT_EQ(4U, observer.records().size());
+  for (size_t i = 0; i < observer.records().size(); ++i) {
+    const InputLatencyRecord& record = observer.records()[i];
+    ASSERT_FALSE(record.native_event_time.is_null());
+    base::TimeDelta delay =
+        record.dispatch_start_time - record.native_event_time;
+    EXPECT_GE(delay, base::TimeDelta());
+    EXPECT_LT(delay, base::TimeDelta::FromSeconds(1));
+  }
+  EXPECT_EQ(observer.records()[0].dispatch_start_time,
+            observer.records()[0].native_event_time);
+  EXPECT_GE(observer.records()[1].dispatch_start_time -
+                observer.records()[1].native_event_time,
+            base::TimeDelta::FromMilliseconds(5));
+
+  tracker.RemoveObserver(&observer);
+}
+
+}  // namespace aura
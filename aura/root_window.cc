@@ -89,6 +89,28 @@ RootWindowHost* CreateHost(RootWindow* root_window,
   return host;
 }
 
+// Reports the dispatch of an event from the host to an InputLatencyTracker.
+// The tracker is destroyed along with its RootWindow, which may happen during
+// dispatch.
+class ScopedInputLatencyDispatch {
+ public:
+  ScopedInputLatencyDispatch(InputLatencyTracker* tracker,
+                             const ui::Event& event)
+      : tracker_(tracker->AsWeakPtr()) {
+    tracker->OnDispatchStarted(event);
+  }
+
+  ~ScopedInputLatencyDispatch() {
+    if (tracker_)
+      tracker_->OnDispatchEnded();
+  }
+
+ private:
+  base::WeakPtr<InputLatencyTracker> tracker_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedInputLatencyDispatch);
+};
+
 }  // namespace
 
 RootWindow::CreateParams::CreateParams(const gfx::Rect& a_initial_bounds)
@@ -252,6 +274,7 @@ void RootWindow::Draw() {
 
   TRACE_EVENT_ASYNC_BEGIN0("ui", "RootWindow::Draw",
                            compositor_->last_started_frame() + 1);
+  input_latency_tracker_.OnDrawStarted(compositor_->last_started_frame() + 1);
 
   compositor_->Draw(false);
 }
@@ -463,6 +486,7 @@ ui::EventTarget* RootWindow::GetParentTarget() {
 // RootWindow, ui::CompositorDelegate implementation:
 
 void RootWindow::ScheduleDraw() {
+  input_latency_tracker_.OnDrawScheduled();
   if (!defer_draw_scheduling_) {
     defer_draw_scheduling_ = true;
     MessageLoop::current()->PostTask(
@@ -475,6 +499,7 @@ void RootWindow::ScheduleDraw() {
 // RootWindow, ui::CompositorObserver implementation:
 
 void RootWindow::OnCompositingDidCommit(ui::Compositor*) {
+  input_latency_tracker_.OnCompositingDidCommit();
 }
 
 void RootWindow::OnCompositingStarted(ui::Compositor*) {
@@ -483,6 +508,7 @@ void RootWindow::OnCompositingStarted(ui::Compositor*) {
 void RootWindow::OnCompositingEnded(ui::Compositor*) {
   TRACE_EVENT_ASYNC_END0("ui", "RootWindow::Draw",
                          compositor_->last_ended_frame());
+  input_latency_tracker_.OnCompositingEnded(compositor_->last_ended_frame());
   waiting_on_compositing_end_ = false;
   if (draw_on_compositing_end_) {
     draw_on_compositing_end_ = false;
@@ -495,6 +521,7 @@ void RootWindow::OnCompositingEnded(ui::Compositor*) {
 }
 
 void RootWindow::OnCompositingAborted(ui::Compositor*) {
+  input_latency_tracker_.OnCompositingAborted();
 }
 
 void RootWindow::OnCompositingLockStateChanged(ui::Compositor*) {
@@ -750,6 +777,7 @@ void RootWindow::OnLayerAnimationAborted(
 // RootWindow, RootWindowHostDelegate implementation:
 
 bool RootWindow::OnHostKeyEvent(ui::KeyEvent* event) {
+  ScopedInputLatencyDispatch latency_dispatch(&input_latency_tracker_, *event);
   DispatchHeldMouseMove();
   if (event->key_code() == ui::VKEY_UNKNOWN)
     return false;
@@ -764,6 +792,7 @@ bool RootWindow::OnHostKeyEvent(ui::KeyEvent* event) {
 }
 
 bool RootWindow::OnHostMouseEvent(ui::MouseEvent* event) {
+  ScopedInputLatencyDispatch latency_dispatch(&input_latency_tracker_, *event);
   if (event->type() == ui::ET_MOUSE_DRAGGED ||
       (event->flags() & ui::EF_IS_SYNTHESIZED)) {
     if (mouse_move_hold_count_) {
@@ -784,6 +813,7 @@ bool RootWindow::OnHostMouseEvent(ui::MouseEvent* event) {
 }
 
 bool RootWindow::OnHostScrollEvent(ui::ScrollEvent* event) {
+  ScopedInputLatencyDispatch latency_dispatch(&input_latency_tracker_, *event);
   DispatchHeldMouseMove();
 
   TransformEventForDeviceScaleFactor(event);
@@ -811,6 +841,7 @@ bool RootWindow::OnHostScrollEvent(ui::ScrollEvent* event) {
 }
 
 bool RootWindow::OnHostTouchEvent(ui::TouchEvent* event) {
+  ScopedInputLatencyDispatch latency_dispatch(&input_latency_tracker_, *event);
   DispatchHeldMouseMove();
   switch (event->type()) {
     case ui::ET_TOUCH_PRESSED:
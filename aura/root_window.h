@@ -14,6 +14,7 @@
 #include "base/message_loop.h"
 #include "ui/aura/aura_export.h"
 #include "ui/aura/client/capture_delegate.h"
+#include "ui/aura/input_latency_tracker.h"
 #include "ui/aura/root_window_host_delegate.h"
 #include "ui/aura/window.h"
 #include "ui/base/cursor/cursor.h"
@@ -81,6 +82,9 @@ class AURA_EXPORT RootWindow : public ui::CompositorDelegate,
   static RootWindow* GetForAcceleratedWidget(gfx::AcceleratedWidget widget);
 
   ui::Compositor* compositor() { return compositor_.get(); }
+  InputLatencyTracker* input_latency_tracker() {
+    return &input_latency_tracker_;
+  }
   gfx::NativeCursor last_cursor() const { return last_cursor_; }
   Window* mouse_pressed_handler() { return mouse_pressed_handler_; }
 
@@ -407,6 +411,9 @@ class AURA_EXPORT RootWindow : public ui::CompositorDelegate,
 
   scoped_ptr<ui::ViewProp> prop_;
 
+  // Records the latency of the events dispatched from |host_|.
+  InputLatencyTracker input_latency_tracker_;
+
   DISALLOW_COPY_AND_ASSIGN(RootWindow);
 };
 
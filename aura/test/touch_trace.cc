@@ -0,0 +1,250 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/aura/test/touch_trace.h"
+
+#include "base/basictypes.h"
+#include "base/format_macros.h"
+#include "base/logging.h"
+#include "base/string_number_conversions.h"
+#include "base/string_split.h"
+#include "base/stringprintf.h"
+#include "ui/aura/root_window.h"
+#include "ui/base/events/event.h"
+#include "ui/gfx/vector2d.h"
+
+namespace aura {
+namespace test {
+
+namespace {
+
+// Synthetic gestures report touches at 120Hz.
+const int kEventIntervalInUs = 8333;
+
+// The radius given to synthetic touches.
+const float kTouchRadius = 5.0f;
+
+// How far the fingers of a synthetic pinch start from its center, and how far
+// each moves per step.
+const int kPinchStartOffset = 20;
+const int kPinchStep = 3;
+
+const int kRailScrollStep = 5;
+
+// Where the fingers of a synthetic palm are relative to its center.
+const int kPalmOffsets[][2] = {
+  { -60, -20 }, { -30, -40 }, { 0, -45 }, { 30, -40 }, { 60, -20 },
+  { -60, 20 }, { -30, 40 }, { 0, 45 }, { 30, 40 }, { 60, 20 },
+};
+
+struct TypeName {
+  ui::EventType type;
+  const char* name;
+};
+
+const TypeName kTypeNames[] = {
+  { ui::ET_TOUCH_PRESSED, "press" },
+  { ui::ET_TOUCH_MOVED, "move" },
+  { ui::ET_TOUCH_RELEASED, "release" },
+  { ui::ET_TOUCH_CANCELLED, "cancel" },
+};
+
+const char* GetTypeName(ui::EventType type) {
+  for (size_t i = 0; i < arraysize(kTypeNames); ++i) {
+    if (kTypeNames[i].type == type)
+      return kTypeNames[i].name;
+  }
+  NOTREACHED();
+  return "";
+}
+
+bool ParseType(const std::string& name, ui::EventType* type) {
+  for (size_t i = 0; i < arraysize(kTypeNames); ++i) {
+    if (name == kTypeNames[i].name) {
+      *type = kTypeNames[i].type;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ParseEvent(const std::string& line, TouchTraceEvent* event) {
+  std::vector<std::string> fields;
+  base::SplitString(line, ' ', &fields);
+  if (fields.size() != 7)
+    return false;
+
+  int64 time_in_us;
+  int x, y;
+  double radius_x, radius_y;
+  if (!base::StringToInt64(fields[0], &time_in_us) ||
+      !ParseType(fields[1], &event->type) ||
+      !base::StringToInt(fields[2], &event->touch_id) ||
+      !base::StringToInt(fields[3], &x) ||
+      !base::StringToInt(fields[4], &y) ||
+      !base::StringToDouble(fields[5], &radius_x) ||
+      !base::StringToDouble(fields[6], &radius_y)) {
+    return false;
+  }
+  event->time_stamp = base::TimeDelta::FromMicroseconds(time_in_us);
+  event->location.SetPoint(x, y);
+  event->radius_x = static_cast<float>(radius_x);
+  event->radius_y = static_cast<float>(radius_y);
+  return true;
+}
+
+}  // namespace
+
+TouchTraceEvent::TouchTraceEvent()
+    : type(ui::ET_UNKNOWN),
+      touch_id(0),
+      radius_x(0),
+      radius_y(0) {
+}
+
+TouchTrace::TouchTrace() {
+}
+
+TouchTrace::~TouchTrace() {
+}
+
+base::TimeDelta TouchTrace::GetDuration() const {
+  return events_.empty() ? base::TimeDelta() : events_.back().time_stamp;
+}
+
+void TouchTrace::AddEvent(const TouchTraceEvent& event) {
+  events_.push_back(event);
+}
+
+void TouchTrace::AddPinch(const gfx::Point& center, int steps) {
+  const base::TimeDelta interval =
+      base::TimeDelta::FromMicroseconds(kEventIntervalInUs);
+  base::TimeDelta time = GetDuration() + interval;
+  int offset = kPinchStartOffset;
+  AddTouch(ui::ET_TOUCH_PRESSED, 0, center + gfx::Vector2d(-offset, 0),
+           time);
+  AddTouch(ui::ET_TOUCH_PRESSED, 1, center + gfx::Vector2d(offset, 0),
+           time);
+  for (int i = 0; i < steps; ++i) {
+    time += interval;
+    offset += kPinchStep;
+    AddTouch(ui::ET_TOUCH_MOVED, 0, center + gfx::Vector2d(-offset, 0),
+             time);
+    AddTouch(ui::ET_TOUCH_MOVED, 1, center + gfx::Vector2d(offset, 0),
+             time);
+  }
+  time += interval;
+  AddTouch(ui::ET_TOUCH_RELEASED, 0, center + gfx::Vector2d(-offset, 0),
+           time);
+  AddTouch(ui::ET_TOUCH_RELEASED, 1, center + gfx::Vector2d(offset, 0),
+           time);
+}
+
+void TouchTrace::AddRailScroll(const gfx::Point& start, int steps) {
+  const base::TimeDelta interval =
+      base::TimeDelta::FromMicroseconds(kEventIntervalInUs);
+  base::TimeDelta time = GetDuration() + interval;
+  gfx::Point location = start;
+  AddTouch(ui::ET_TOUCH_PRESSED, 0, location, time);
+  for (int i = 0; i < steps; ++i) {
+    time += interval;
+    location.Offset(0, kRailScrollStep);
+    AddTouch(ui::ET_TOUCH_MOVED, 0, location, time);
+  }
+  time += interval;
+  AddTouch(ui::ET_TOUCH_RELEASED, 0, location, time);
+}
+
+void TouchTrace::AddPalm(const gfx::Point& center, int steps) {
+  const base::TimeDelta interval =
+      base::TimeDelta::FromMicroseconds(kEventIntervalInUs);
+  const int kFingers = arraysize(kPalmOffsets);
+  gfx::Point fingers[kFingers];
+  for (int finger = 0; finger < kFingers; ++finger) {
+    fingers[finger] = center + gfx::Vector2d(kPalmOffsets[finger][0],
+                                             kPalmOffsets[finger][1]);
+  }
+
+  base::TimeDelta time = GetDuration() + interval;
+  for (int finger = 0; finger < kFingers; ++finger)
+    AddTouch(ui::ET_TOUCH_PRESSED, finger, fingers[finger], time);
+  for (int i = 0; i < steps; ++i) {
+    time += interval;
+    for (int finger = 0; finger < kFingers; ++finger) {
+      int jitter = (i + finger) % 3 - 1;
+      AddTouch(ui::ET_TOUCH_MOVED, finger,
+               fingers[finger] + gfx::Vector2d(jitter, -jitter), time);
+    }
+  }
+  time += interval;
+  for (int finger = 0; finger < kFingers; ++finger)
+    AddTouch(ui::ET_TOUCH_RELEASED, finger, fingers[finger], time);
+}
+
+bool TouchTrace::ParseFromString(const std::string& data) {
+  events_.clear();
+  std::vector<std::string> lines;
+  base::SplitString(data, '\n', &lines);
+  for (size_t i = 0; i < lines.size(); ++i) {
+    if (lines[i].empty() || lines[i][0] == '#')
+      continue;
+    TouchTraceEvent event;
+    if (!ParseEvent(lines[i], &event)) {
+      events_.clear();
+      return false;
+    }
+    events_.push_back(event);
+  }
+  return true;
+}
+
+std::string TouchTrace::ToString() const {
+  std::string data;
+  for (size_t i = 0; i < events_.size(); ++i) {
+    const TouchTraceEvent& event = events_[i];
+    base::StringAppendF(&data, "%" PRId64 " %s %d %d %d %g %g\n",
+                        event.time_stamp.InMicroseconds(),
+                        GetTypeName(event.type),
+                        event.touch_id,
+                        event.location.x(),
+                        event.location.y(),
+                        event.radius_x,
+                        event.radius_y);
+  }
+  return data;
+}
+
+void TouchTrace::Replay(RootWindow* root_window,
+                        base::TimeDelta time_offset) const {
+  for (size_t i = 0; i < events_.size(); ++i) {
+    const TouchTraceEvent& event = events_[i];
+    ui::TouchEvent touch(event.type,
+                         event.location,
+                         0,
+                         event.touch_id,
+                         event.time_stamp + time_offset,
+                         event.radius_x,
+                         event.radius_y,
+                         0.0f,
+                         0.0f);
+    root_window->AsRootWindowHostDelegate()->OnHostTouchEvent(&touch);
+  }
+}
+
+void TouchTrace::AddTouch(ui::EventType type,
+                          int touch_id,
+                          const gfx::Point& location,
+                          base::TimeDelta time_stamp) {
+  TouchTraceEvent event;
+  event.type = type;
+  event.touch_id = touch_id;
+  event.location = location;
+  event.radius_x = kTouchRadius;
+  event.radius_y = kTouchRadius;
+  event.time_stamp = time_stamp;
+  events_.push_back(event);
+}
+
+}  // namespace test
+}  // namespace aura
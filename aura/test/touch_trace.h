@@ -0,0 +1,82 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_AURA_TEST_TOUCH_TRACE_H_
+#define UI_AURA_TEST_TOUCH_TRACE_H_
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/time.h"
+#include "ui/base/events/event_constants.h"
+#include "ui/gfx/point.h"
+
+namespace aura {
+class RootWindow;
+
+namespace test {
+
+// A touch event in a TouchTrace.
+struct TouchTraceEvent {
+  TouchTraceEvent();
+
+  ui::EventType type;
+  int touch_id;
+  gfx::Point location;
+  float radius_x;
+  float radius_y;
+  base::TimeDelta time_stamp;
+};
+
+// A recorded stream of touch events, which can be saved as text, loaded back
+// and replayed through a RootWindow as if it came from the host. In text form
+// each event is a line of the form
+//   <time in us> <press|move|release|cancel> <touch id> <x> <y> <rx> <ry>
+// Blank lines and lines starting with '#' are ignored.
+class TouchTrace {
+ public:
+  TouchTrace();
+  ~TouchTrace();
+
+  const std::vector<TouchTraceEvent>& events() const { return events_; }
+
+  // Returns the time stamp of the last event, or zero if there are none.
+  base::TimeDelta GetDuration() const;
+
+  void AddEvent(const TouchTraceEvent& event);
+
+  // Append synthetic gestures, starting one event interval after the last
+  // event. Each gesture ends with all its touches released.
+  // Two fingers either side of |center| spreading apart over |steps| moves.
+  void AddPinch(const gfx::Point& center, int steps);
+  // One finger moving straight down from |start| over |steps| moves.
+  void AddRailScroll(const gfx::Point& start, int steps);
+  // Ten fingers pressed around |center| and jittering for |steps| moves.
+  void AddPalm(const gfx::Point& center, int steps);
+
+  // Replaces the events with those parsed from |data|. Returns false, leaving
+  // the trace empty, if |data| is malformed.
+  bool ParseFromString(const std::string& data);
+  std::string ToString() const;
+
+  // Sends each event to |root_window|, with |time_offset| added to its time
+  // stamp.
+  void Replay(RootWindow* root_window, base::TimeDelta time_offset) const;
+
+ private:
+  void AddTouch(ui::EventType type,
+                int touch_id,
+                const gfx::Point& location,
+                base::TimeDelta time_stamp);
+
+  std::vector<TouchTraceEvent> events_;
+
+  DISALLOW_COPY_AND_ASSIGN(TouchTrace);
+};
+
+}  // namespace test
+}  // namespace aura
+
+#endif  // UI_AURA_TEST_TOUCH_TRACE_H_
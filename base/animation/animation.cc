@@ -15,6 +15,19 @@
 
 namespace ui {
 
+namespace {
+
+// Creates the container of an animation that isn't given one. As it steps a
+// single animation nothing relies on the lockstep ticking of a shared
+// container, so it sleeps through the spans the animation holds its value.
+AnimationContainer* CreateDefaultContainer() {
+  AnimationContainer* container = new AnimationContainer();
+  container->set_idle_aware(true);
+  return container;
+}
+
+}  // namespace
+
 Animation::Animation(base::TimeDelta timer_interval)
     : timer_interval_(timer_interval),
       is_animating_(false),
@@ -33,7 +46,7 @@ void Animation::Start() {
     return;
 
   if (!container_.get())
-    container_ = new AnimationContainer();
+    container_ = CreateDefaultContainer();
 
   is_animating_ = true;
 
@@ -84,7 +97,7 @@ void Animation::SetContainer(AnimationContainer* container) {
   if (container)
     container_ = container;
   else
-    container_ = new AnimationContainer();
+    container_ = CreateDefaultContainer();
 
   if (is_animating_)
     container_->Start(this);
@@ -51,7 +51,7 @@ class UI_EXPORT Animation : public AnimationContainerElement {
   void set_delegate(AnimationDelegate* delegate) { delegate_ = delegate; }
 
   // Sets the container used to manage the timer. A value of NULL results in
-  // creating a new AnimationContainer.
+  // creating a new AnimationContainer, which uses idle-aware scheduling.
   void SetContainer(AnimationContainer* container);
 
   bool is_animating() const { return is_animating_; }
@@ -4,6 +4,8 @@
 
 #include "ui/base/animation/animation_container.h"
 
+#include <algorithm>
+
 #include "ui/base/animation/animation_container_element.h"
 #include "ui/base/animation/animation_container_observer.h"
 
@@ -12,9 +14,27 @@ using base::TimeTicks;
 
 namespace ui {
 
+namespace {
+
+// When driven by frames, the number of frame intervals (or timer intervals if
+// no vsync interval is known) without a frame after which the fallback timer
+// steps the elements.
+const int kMissedFramesBeforeFallback = 2;
+
+// With idle-aware scheduling, elements due within this much of a tick are
+// stepped by it rather than waking the timer again shortly after.
+const int kTickSlackMs = 1;
+
+}  // namespace
+
 AnimationContainer::AnimationContainer()
     : last_tick_time_(TimeTicks::Now()),
-      observer_(NULL) {
+      frame_driven_(false),
+      idle_aware_(false),
+      observer_(NULL),
+      counters_start_time_(TimeTicks::Now()),
+      tick_count_(0),
+      elements_stepped_count_(0) {
 }
 
 AnimationContainer::~AnimationContainer() {
@@ -27,15 +47,24 @@ void AnimationContainer::Start(AnimationContainerElement* element) {
   DCHECK(elements_.count(element) == 0);  // Start should only be invoked if the
                                           // element isn't running.
 
-  if (elements_.empty()) {
+  const bool was_empty = elements_.empty();
+  if (was_empty)
     last_tick_time_ = TimeTicks::Now();
+
+  // An idle-aware container may have been asleep since its last tick, which is
+  // then too old to start the element from. last_tick_time_ is left alone as
+  // the running elements were last stepped at it.
+  const TimeTicks start_time =
+      (idle_aware_ && !was_empty) ? TimeTicks::Now() : last_tick_time_;
+  element->SetStartTime(start_time);
+  elements_[element] = start_time + element->GetTimerInterval();
+
+  if (was_empty || element->GetTimerInterval() < min_timer_interval_) {
     SetMinTimerInterval(element->GetTimerInterval());
-  } else if (element->GetTimerInterval() < min_timer_interval_) {
-    SetMinTimerInterval(element->GetTimerInterval());
+  } else if (idle_aware_ && !frame_driven_ &&
+             elements_[element] < scheduled_run_time_) {
+    ScheduleTimer(start_time, element->GetTimerInterval());
   }
-
-  element->SetStartTime(last_tick_time_);
-  elements_.insert(element);
 }
 
 void AnimationContainer::Stop(AnimationContainerElement* element) {
@@ -45,6 +74,9 @@ void AnimationContainer::Stop(AnimationContainerElement* element) {
 
   if (elements_.empty()) {
     timer_.Stop();
+    // The frames that drove these elements may not keep arriving for the next
+    // ones, so they start out on the timer again.
+    frame_driven_ = false;
     if (observer_)
       observer_->AnimationContainerEmpty(this);
   } else {
@@ -54,27 +86,88 @@ void AnimationContainer::Stop(AnimationContainerElement* element) {
   }
 }
 
+void AnimationContainer::OnBeginFrame(TimeTicks frame_time) {
+  if (elements_.empty())
+    return;
+  frame_driven_ = true;
+  if (frame_time <= last_tick_time_)
+    return;
+
+  RunAtTime(frame_time);
+
+  // Push the fallback back so it only fires if the next frames don't arrive,
+  // or when the earliest sleeping element is due.
+  if (!elements_.empty())
+    ScheduleTimer(frame_time, GetFallbackDelay(frame_time));
+}
+
+void AnimationContainer::SetVSyncParameters(TimeTicks timebase,
+                                            TimeDelta interval) {
+  vsync_timebase_ = timebase;
+  vsync_interval_ = interval;
+}
+
+double AnimationContainer::GetTicksPerSecond() const {
+  double seconds = (TimeTicks::Now() - counters_start_time_).InSecondsF();
+  return seconds > 0 ? tick_count_ / seconds : 0;
+}
+
+double AnimationContainer::GetElementsSteppedPerTick() const {
+  return tick_count_ ?
+      static_cast<double>(elements_stepped_count_) / tick_count_ : 0;
+}
+
+void AnimationContainer::ResetCounters() {
+  counters_start_time_ = TimeTicks::Now();
+  tick_count_ = 0;
+  elements_stepped_count_ = 0;
+}
+
 void AnimationContainer::Run() {
+  RunAtTime(TimeTicks::Now());
+  if (!elements_.empty())
+    ScheduleTimer(last_tick_time_, GetDelayUntilNextRun(last_tick_time_));
+}
+
+void AnimationContainer::RunAtTime(TimeTicks current_time) {
   // We notify the observer after updating all the elements. If all the elements
   // are deleted as a result of updating then our ref count would go to zero and
   // we would be deleted before we notify our observer. We add a reference to
   // ourself here to make sure we're still valid after running all the elements.
   scoped_refptr<AnimationContainer> this_ref(this);
 
-  TimeTicks current_time = TimeTicks::Now();
-
   last_tick_time_ = current_time;
+  ++tick_count_;
+
+  // Gather the due elements first so that if any elements are added or removed
+  // as part of invoking Step there aren't any problems. The vector is taken
+  // from |due_elements_| to reuse its storage, and a nested run (e.g. from a
+  // nested message loop) simply starts with an empty one.
+  std::vector<AnimationContainerElement*> due;
+  due.swap(due_elements_);
+  const TimeTicks due_time =
+      current_time + TimeDelta::FromMilliseconds(kTickSlackMs);
+  for (Elements::const_iterator i = elements_.begin(); i != elements_.end();
+       ++i) {
+    if (!idle_aware_ || i->second <= due_time)
+      due.push_back(i->first);
+  }
 
-  // Make a copy of the elements to iterate over so that if any elements are
-  // removed as part of invoking Step there aren't any problems.
-  Elements elements = elements_;
-
-  for (Elements::const_iterator i = elements.begin();
-       i != elements.end(); ++i) {
+  for (size_t i = 0; i < due.size(); ++i) {
     // Make sure the element is still valid.
-    if (elements_.find(*i) != elements_.end())
-      (*i)->Step(current_time);
+    if (elements_.find(due[i]) == elements_.end())
+      continue;
+    due[i]->Step(current_time);
+    ++elements_stepped_count_;
+    if (idle_aware_) {
+      // Step may have stopped the element.
+      Elements::iterator found = elements_.find(due[i]);
+      if (found != elements_.end())
+        found->second = due[i]->GetNextTickTime(current_time);
+    }
   }
+  due.clear();
+  due_elements_.swap(due);
 
   if (observer_)
     observer_->AnimationContainerProgressed(this);
@@ -83,9 +176,48 @@ void AnimationContainer::Run() {
 void AnimationContainer::SetMinTimerInterval(base::TimeDelta delta) {
   // This doesn't take into account how far along the current element is, but
   // that shouldn't be a problem for uses of Animation/AnimationContainer.
-  timer_.Stop();
   min_timer_interval_ = delta;
-  timer_.Start(FROM_HERE, min_timer_interval_, this, &AnimationContainer::Run);
+  TimeTicks now = TimeTicks::Now();
+  // While frames are arriving they step the elements, so the timer is only
+  // restarted as a fallback.
+  ScheduleTimer(now, frame_driven_ ? GetFallbackDelay(now) :
+                                     GetDelayUntilNextRun(now));
+}
+
+void AnimationContainer::ScheduleTimer(TimeTicks now, TimeDelta delay) {
+  TimeTicks target = now + delay;
+  if (vsync_interval_ > TimeDelta()) {
+    // Round up to the next refresh so that the elements are stepped in phase
+    // with the display rather than beating against it.
+    int64 interval_us = vsync_interval_.InMicroseconds();
+    int64 offset_us = (target - vsync_timebase_).InMicroseconds() % interval_us;
+    if (offset_us < 0)
+      offset_us += interval_us;
+    if (offset_us)
+      target += TimeDelta::FromMicroseconds(interval_us - offset_us);
+  }
+  scheduled_run_time_ = target;
+  timer_.Stop();
+  timer_.Start(FROM_HERE, std::max(TimeDelta(), target - TimeTicks::Now()),
+               this, &AnimationContainer::Run);
+}
+
+TimeDelta AnimationContainer::GetDelayUntilNextRun(TimeTicks now) const {
+  if (!idle_aware_ || elements_.empty())
+    return min_timer_interval_;
+
+  Elements::const_iterator i = elements_.begin();
+  TimeTicks next_run_time = i->second;
+  for (++i; i != elements_.end(); ++i)
+    next_run_time = std::min(next_run_time, i->second);
+  return std::max(TimeDelta(), next_run_time - now);
+}
+
+TimeDelta AnimationContainer::GetFallbackDelay(TimeTicks now) const {
+  TimeDelta frame_interval = vsync_interval_ > TimeDelta() ?
+      vsync_interval_ : min_timer_interval_;
+  return std::max(frame_interval * kMissedFramesBeforeFallback,
+                  GetDelayUntilNextRun(now));
 }
 
 TimeDelta AnimationContainer::GetMinInterval() {
@@ -93,10 +225,10 @@ TimeDelta AnimationContainer::GetMinInterval() {
 
   TimeDelta min;
   Elements::const_iterator i = elements_.begin();
-  min = (*i)->GetTimerInterval();
+  min = i->first->GetTimerInterval();
   for (++i; i != elements_.end(); ++i) {
-    if ((*i)->GetTimerInterval() < min)
-      min = (*i)->GetTimerInterval();
+    if (i->first->GetTimerInterval() < min)
+      min = i->first->GetTimerInterval();
   }
   return min;
 }
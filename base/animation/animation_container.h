@@ -5,7 +5,8 @@
 #ifndef UI_BASE_ANIMATION_ANIMATION_CONTAINER_H_
 #define UI_BASE_ANIMATION_ANIMATION_CONTAINER_H_
 
-#include <set>
+#include <map>
+#include <vector>
 
 #include "base/memory/ref_counted.h"
 #include "base/time.h"
@@ -25,6 +26,17 @@ class AnimationContainerObserver;
 //
 // AnimationContainer is ref counted. Each Animation contained within the
 // AnimationContainer own it.
+//
+// By default the elements are stepped from a timer running at the smallest
+// interval of the elements. A container can instead be driven by display
+// frames: once OnBeginFrame() has been invoked the elements are stepped once
+// per frame with the frame's timestamp, and the timer only serves as a
+// fallback for when frames stop arriving. SetVSyncParameters() aligns the
+// fallback timer to the display refresh.
+//
+// With idle-aware scheduling (set_idle_aware()) each element is stepped only
+// once the time returned by its GetNextTickTime() is reached, and the timer
+// sleeps until the earliest of those times.
 class UI_EXPORT AnimationContainer
     : public base::RefCounted<AnimationContainer> {
  public:
@@ -41,6 +53,28 @@ class UI_EXPORT AnimationContainer
   // directly.
   void Stop(AnimationContainerElement* animation);
 
+  // Steps the running elements to |frame_time|, the time the display frame
+  // being produced starts at. Frames that do not advance past the last tick
+  // are ignored, so several sources may report the same frame.
+  void OnBeginFrame(base::TimeTicks frame_time);
+
+  // Sets the time of a display refresh and the interval between refreshes.
+  // The fallback timer is phase aligned to these. An empty |interval| disables
+  // the alignment.
+  void SetVSyncParameters(base::TimeTicks timebase, base::TimeDelta interval);
+
+  // Enables idle-aware scheduling, see the class comment. Should be set before
+  // any element is started.
+  void set_idle_aware(bool idle_aware) { idle_aware_ = idle_aware; }
+  bool idle_aware() const { return idle_aware_; }
+
+  // Number of ticks per second and average number of elements stepped per
+  // tick since construction or the last call to ResetCounters(). Exposed for
+  // profiling.
+  double GetTicksPerSecond() const;
+  double GetElementsSteppedPerTick() const;
+  void ResetCounters();
+
   void set_observer(AnimationContainerObserver* observer) {
     observer_ = observer;
   }
@@ -54,16 +88,32 @@ class UI_EXPORT AnimationContainer
  private:
   friend class base::RefCounted<AnimationContainer>;
 
-  typedef std::set<AnimationContainerElement*> Elements;
+  // Maps each element to the time it next needs to be stepped at. The time is
+  // only maintained with idle-aware scheduling.
+  typedef std::map<AnimationContainerElement*, base::TimeTicks> Elements;
 
   ~AnimationContainer();
 
   // Timer callback method.
   void Run();
 
+  // Steps the elements that are due to |time| and notifies the observer.
+  void RunAtTime(base::TimeTicks time);
+
+  // Returns the delay from |now| until the timer should next run.
+  base::TimeDelta GetDelayUntilNextRun(base::TimeTicks now) const;
+
+  // Returns the delay from |now| until the fallback timer of a frame driven
+  // container should run.
+  base::TimeDelta GetFallbackDelay(base::TimeTicks now) const;
+
   // Sets min_timer_interval_ and restarts the timer.
   void SetMinTimerInterval(base::TimeDelta delta);
 
+  // Starts the timer so that it fires |delay| from |now|, rounded up to the
+  // next vsync if the vsync parameters are known.
+  void ScheduleTimer(base::TimeTicks now, base::TimeDelta delay);
+
   // Returns the min timer interval of all the timers.
   base::TimeDelta GetMinInterval();
 
@@ -73,16 +123,40 @@ class UI_EXPORT AnimationContainer
   // . The time the last animation ran at (::Run was invoked).
   base::TimeTicks last_tick_time_;
 
-  // Set of elements (animations) being managed.
+  // Elements (animations) being managed.
   Elements elements_;
 
+  // Elements due to be stepped by RunAtTime(). A member so that its storage
+  // is reused across ticks.
+  std::vector<AnimationContainerElement*> due_elements_;
+
   // Minimum interval the timers run at.
   base::TimeDelta min_timer_interval_;
 
-  base::RepeatingTimer<AnimationContainer> timer_;
+  base::OneShotTimer<AnimationContainer> timer_;
+
+  // Time the timer is scheduled to run at.
+  base::TimeTicks scheduled_run_time_;
+
+  bool idle_aware_;
+
+  // True once OnBeginFrame() has been invoked while elements are running.
+  // Starting or stopping elements then only reschedules the timer as a
+  // fallback, rather than stepping them between frames. Reset when the last
+  // element stops.
+  bool frame_driven_;
+
+  // Time of a display refresh and the interval between refreshes.
+  base::TimeTicks vsync_timebase_;
+  base::TimeDelta vsync_interval_;
 
   AnimationContainerObserver* observer_;
 
+  // See GetTicksPerSecond() and GetElementsSteppedPerTick().
+  base::TimeTicks counters_start_time_;
+  int64 tick_count_;
+  int64 elements_stepped_count_;
+
   DISALLOW_COPY_AND_ASSIGN(AnimationContainer);
 };
 
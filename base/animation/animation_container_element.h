@@ -25,6 +25,16 @@ class UI_EXPORT AnimationContainerElement {
   // this it should first invoke Stop, then Start.
   virtual base::TimeDelta GetTimerInterval() const = 0;
 
+  // Returns the time the element next needs to be stepped at, given it was
+  // last stepped at |last_tick_time|. Only consulted by containers using
+  // idle-aware scheduling (see AnimationContainer::set_idle_aware()). Elements
+  // that hold a value for a while can return a later time so that the
+  // container sleeps rather than ticking at GetTimerInterval().
+  virtual base::TimeTicks GetNextTickTime(
+      base::TimeTicks last_tick_time) const {
+    return last_tick_time + GetTimerInterval();
+  }
+
  protected:
   virtual ~AnimationContainerElement() {}
 };
@@ -2,10 +2,13 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <vector>
+
 #include "base/memory/scoped_ptr.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "ui/base/animation/animation_container.h"
+#include "ui/base/animation/animation_container_element.h"
 #include "ui/base/animation/animation_container_observer.h"
 #include "ui/base/animation/linear_animation.h"
 #include "ui/base/animation/test_animation_delegate.h"
@@ -33,6 +36,8 @@ class TestAnimation : public LinearAnimation {
       : LinearAnimation(20, 20, delegate) {
   }
 
+  AnimationContainer* GetContainer() { return container(); }
+
   virtual void AnimateToState(double state) OVERRIDE {
   }
 
@@ -40,6 +45,42 @@ class TestAnimation : public LinearAnimation {
   DISALLOW_COPY_AND_ASSIGN(TestAnimation);
 };
 
+// Element that records the times it is stepped at.
+class RecordingElement : public AnimationContainerElement {
+ public:
+  RecordingElement() {}
+  virtual ~RecordingElement() {}
+
+  const std::vector<base::TimeTicks>& steps() const { return steps_; }
+
+  // If set, the element asks not to be stepped again for |delay| after each
+  // step.
+  void set_sleep_after_step(base::TimeDelta delay) {
+    sleep_after_step_ = delay;
+  }
+
+  // AnimationContainerElement overrides:
+  virtual void SetStartTime(base::TimeTicks start_time) OVERRIDE {}
+  virtual void Step(base::TimeTicks time_now) OVERRIDE {
+    steps_.push_back(time_now);
+  }
+  virtual base::TimeDelta GetTimerInterval() const OVERRIDE {
+    return base::TimeDelta::FromMilliseconds(10);
+  }
+  virtual base::TimeTicks GetNextTickTime(
+      base::TimeTicks last_tick_time) const OVERRIDE {
+    if (sleep_after_step_ == base::TimeDelta())
+      return AnimationContainerElement::GetNextTickTime(last_tick_time);
+    return last_tick_time + sleep_after_step_;
+  }
+
+ private:
+  std::vector<base::TimeTicks> steps_;
+  base::TimeDelta sleep_after_step_;
+
+  DISALLOW_COPY_AND_ASSIGN(RecordingElement);
+};
+
 }  // namespace
 
 class AnimationContainerTest: public testing::Test {
@@ -123,4 +164,91 @@ TEST_F(AnimationContainerTest, Observer) {
   container->set_observer(NULL);
 }
 
+// Makes sure frames step the elements once with the frame's timestamp.
+TEST_F(AnimationContainerTest, FrameDriven) {
+  scoped_refptr<AnimationContainer> container(new AnimationContainer());
+  RecordingElement element;
+  container->Start(&element);
+
+  base::TimeTicks frame_time =
+      container->last_tick_time() + base::TimeDelta::FromMilliseconds(16);
+  container->OnBeginFrame(frame_time);
+  ASSERT_EQ(1U, element.steps().size());
+  EXPECT_EQ(frame_time, element.steps()[0]);
+  EXPECT_EQ(frame_time, container->last_tick_time());
+
+  // A second source reporting the same frame doesn't step again.
+  container->OnBeginFrame(frame_time);
+  EXPECT_EQ(1U, element.steps().size());
+
+  container->OnBeginFrame(frame_time + base::TimeDelta::FromMilliseconds(16));
+  EXPECT_EQ(2U, element.steps().size());
+
+  container->Stop(&element);
+  EXPECT_FALSE(container->is_running());
+}
+
+// Makes sure idle-aware containers only step elements that are due.
+TEST_F(AnimationContainerTest, IdleAware) {
+  scoped_refptr<AnimationContainer> container(new AnimationContainer());
+  container->set_idle_aware(true);
+  RecordingElement sleepy;
+  sleepy.set_sleep_after_step(base::TimeDelta::FromSeconds(60));
+  RecordingElement busy;
+  container->Start(&sleepy);
+  container->Start(&busy);
+
+  // Both are due on the first frame.
+  base::TimeTicks frame_time =
+      container->last_tick_time() + base::TimeDelta::FromMilliseconds(16);
+  container->OnBeginFrame(frame_time);
+  EXPECT_EQ(1U, sleepy.steps().size());
+  EXPECT_EQ(1U, busy.steps().size());
+
+  // Only |busy| is due on the next one.
+  container->OnBeginFrame(frame_time + base::TimeDelta::FromMilliseconds(16));
+  EXPECT_EQ(1U, sleepy.steps().size());
+  EXPECT_EQ(2U, busy.steps().size());
+  EXPECT_DOUBLE_EQ(1.5, container->GetElementsSteppedPerTick());
+
+  container->ResetCounters();
+  EXPECT_DOUBLE_EQ(0, container->GetElementsSteppedPerTick());
+
+  container->Stop(&sleepy);
+  container->Stop(&busy);
+}
+
+// Makes sure starting an element in a running container doesn't move the time
+// the other elements were last stepped at.
+TEST_F(AnimationContainerTest, StartKeepsLastTickTime) {
+  scoped_refptr<AnimationContainer> container(new AnimationContainer());
+  container->set_idle_aware(true);
+  RecordingElement first;
+  container->Start(&first);
+
+  base::TimeTicks frame_time =
+      container->last_tick_time() + base::TimeDelta::FromMilliseconds(16);
+  container->OnBeginFrame(frame_time);
+
+  RecordingElement second;
+  container->Start(&second);
+  EXPECT_EQ(frame_time, container->last_tick_time());
+
+  container->Stop(&first);
+  container->Stop(&second);
+}
+
+// Makes sure animations that aren't given a container sleep while idle.
+TEST_F(AnimationContainerTest, DefaultContainerIsIdleAware) {
+  TestAnimationDelegate delegate;
+  TestAnimation animation(&delegate);
+  animation.Start();
+  ASSERT_TRUE(animation.GetContainer());
+  EXPECT_TRUE(animation.GetContainer()->idle_aware());
+  animation.Stop();
+
+  scoped_refptr<AnimationContainer> container(new AnimationContainer());
+  EXPECT_FALSE(container->idle_aware());
+}
+
 }  // namespace ui
@@ -4,6 +4,8 @@
 
 #include "ui/base/animation/multi_animation.h"
 
+#include <algorithm>
+
 #include "base/logging.h"
 #include "ui/base/animation/animation_delegate.h"
 
@@ -73,6 +75,30 @@ void MultiAnimation::SetStartTime(base::TimeTicks start_time) {
   current_part_index_ = 0;
 }
 
+base::TimeTicks MultiAnimation::GetNextTickTime(
+    base::TimeTicks last_tick_time) const {
+  int delta =
+      static_cast<int>((last_tick_time - start_time()).InMilliseconds());
+  if (delta < 0 || (delta >= cycle_time_ms_ && !continuous_))
+    return Animation::GetNextTickTime(last_tick_time);
+
+  delta %= cycle_time_ms_;
+  int part_end_ms = 0;
+  for (size_t i = 0; i < parts_.size(); ++i) {
+    part_end_ms += parts_[i].time_ms;
+    if (delta < part_end_ms) {
+      if (parts_[i].type != Tween::ZERO)
+        break;
+      // The value holds until the next part starts.
+      base::TimeTicks part_end_time = last_tick_time +
+          base::TimeDelta::FromMilliseconds(part_end_ms - delta);
+      return std::max(part_end_time,
+                      Animation::GetNextTickTime(last_tick_time));
+    }
+  }
+  return Animation::GetNextTickTime(last_tick_time);
+}
+
 const MultiAnimation::Part& MultiAnimation::GetPart(int* time_ms,
                                                     size_t* part_index) {
   DCHECK(*time_ms < cycle_time_ms_);
@@ -67,6 +67,11 @@ class UI_EXPORT MultiAnimation : public Animation {
   virtual void Step(base::TimeTicks time_now) OVERRIDE;
   virtual void SetStartTime(base::TimeTicks start_time) OVERRIDE;
 
+  // Overridden to sleep through parts whose value doesn't change
+  // (Tween::ZERO).
+  virtual base::TimeTicks GetNextTickTime(
+      base::TimeTicks last_tick_time) const OVERRIDE;
+
  private:
   // Returns the part containing the specified time. |time_ms| is reset to be
   // relative to the part containing the time and |part_index| the index of the
@@ -63,9 +63,7 @@ EventDispatcher::~EventDispatcher() {
 }
 
 void EventDispatcher::OnHandlerDestroyed(EventHandler* handler) {
-  handler_list_.erase(std::find(handler_list_.begin(),
-                                handler_list_.end(),
-                                handler));
+  *std::find(handler_list_->begin(), handler_list_->end(), handler) = NULL;
 }
 
 void EventDispatcher::ProcessEvent(EventTarget* target, Event* event) {
@@ -75,11 +73,8 @@ void EventDispatcher::ProcessEvent(EventTarget* target, Event* event) {
   ScopedDispatchHelper dispatch_helper(event);
   dispatch_helper.set_target(target);
 
-  handler_list_.clear();
-  target->GetPreTargetHandlers(&handler_list_);
-
   dispatch_helper.set_phase(EP_PRETARGET);
-  DispatchEventToEventHandlers(handler_list_, event);
+  DispatchEventToEventHandlers(target->GetPreTargetHandlers(), event);
   if (event->handled())
     return;
 
@@ -98,10 +93,8 @@ void EventDispatcher::ProcessEvent(EventTarget* target, Event* event) {
   if (!delegate_ || !delegate_->CanDispatchToTarget(target))
     return;
 
-  handler_list_.clear();
-  target->GetPostTargetHandlers(&handler_list_);
   dispatch_helper.set_phase(EP_POSTTARGET);
-  DispatchEventToEventHandlers(handler_list_, event);
+  DispatchEventToEventHandlers(target->GetPostTargetHandlers(), event);
 }
 
 void EventDispatcher::OnDispatcherDelegateDestroyed() {
@@ -111,26 +104,32 @@ void EventDispatcher::OnDispatcherDelegateDestroyed() {
 ////////////////////////////////////////////////////////////////////////////////
 // EventDispatcher, private:
 
-void EventDispatcher::DispatchEventToEventHandlers(EventHandlerList& list,
-                                                   Event* event) {
+void EventDispatcher::DispatchEventToEventHandlers(
+    const EventHandlerList& list,
+    Event* event) {
+  handler_list_->assign(list.begin(), list.end());
   for (EventHandlerList::const_iterator it = list.begin(),
            end = list.end(); it != end; ++it) {
     (*it)->dispatchers_.push(this);
   }
 
-  while (!list.empty()) {
-    EventHandler* handler = (*list.begin());
+  for (size_t i = 0; i < handler_list_->size(); ++i) {
+    EventHandler* handler = handler_list_[i];
+    if (!handler)
+      continue;  // Destroyed while an earlier handler had the event.
+
     if (delegate_ && !event->stopped_propagation())
       DispatchEvent(handler, event);
 
-    if (!list.empty() && *list.begin() == handler) {
+    if (handler_list_[i]) {
       // The handler has not been destroyed (because if it were, then it would
-      // have been removed from the list).
+      // have been cleared from the list).
       CHECK(handler->dispatchers_.top() == this);
       handler->dispatchers_.pop();
-      list.erase(list.begin());
+      handler_list_[i] = NULL;
     }
   }
+  handler_list_->clear();
 }
 
 void EventDispatcher::DispatchEvent(EventHandler* handler, Event* event) {
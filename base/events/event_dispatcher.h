@@ -6,6 +6,7 @@
 #define UI_BASE_EVENTS_EVENT_DISPATCHER_H_
 
 #include "base/auto_reset.h"
+#include "base/stack_container.h"
 #include "ui/base/events/event.h"
 #include "ui/base/events/event_constants.h"
 #include "ui/base/events/event_target.h"
@@ -58,7 +59,9 @@ class UI_EXPORT EventDispatcher {
   void OnDispatcherDelegateDestroyed();
 
  private:
-  void DispatchEventToEventHandlers(EventHandlerList& list,
+  // Dispatches |event| to each handler in |list|. |list| is copied first, so
+  // it may change while the event is being dispatched.
+  void DispatchEventToEventHandlers(const EventHandlerList& list,
                                     Event* event);
 
   // Dispatches an event, and makes sure it sets ER_CONSUMED on the
@@ -72,7 +75,11 @@ class UI_EXPORT EventDispatcher {
 
   Event* current_event_;
 
-  EventHandlerList handler_list_;
+  // The handlers still waiting for the event in the current phase. Handlers
+  // are set to NULL once they've received the event or have been destroyed.
+  // Handler chains are short, so this lives on the stack with the dispatcher
+  // rather than on the heap.
+  StackVector<EventHandler*, 32> handler_list_;
 
   DISALLOW_COPY_AND_ASSIGN(EventDispatcher);
 };
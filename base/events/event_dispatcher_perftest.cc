@@ -0,0 +1,107 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/base/events/event_dispatcher.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "base/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace ui {
+
+namespace {
+
+class TestTarget : public EventTarget {
+ public:
+  TestTarget() : parent_(NULL) {}
+  virtual ~TestTarget() {}
+
+  void set_parent(TestTarget* parent) { parent_ = parent; }
+
+ private:
+  // Overridden from EventTarget:
+  virtual bool CanAcceptEvent(const ui::Event& event) OVERRIDE {
+    return true;
+  }
+
+  virtual EventTarget* GetParentTarget() OVERRIDE {
+    return parent_;
+  }
+
+  TestTarget* parent_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestTarget);
+};
+
+// Counts the events it receives without recording anything else.
+class CountingEventHandler : public EventHandler {
+ public:
+  CountingEventHandler() : count_(0) {}
+  virtual ~CountingEventHandler() {}
+
+  int count() const { return count_; }
+
+ private:
+  // Overridden from EventHandler:
+  virtual void OnMouseEvent(MouseEvent* event) OVERRIDE {
+    ++count_;
+  }
+
+  int count_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingEventHandler);
+};
+
+class TestEventDispatcher : public EventDispatcherDelegate {
+ public:
+  TestEventDispatcher() {}
+  virtual ~TestEventDispatcher() {}
+
+  void ProcessEvent(EventTarget* target, Event* event) {
+    DispatchEvent(target, event);
+  }
+
+ private:
+  // Overridden from EventDispatcherDelegate:
+  virtual bool CanDispatchToTarget(EventTarget* target) OVERRIDE {
+    return true;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(TestEventDispatcher);
+};
+
+}  // namespace
+
+// Measures dispatch throughput through a 20-deep hierarchy with a pre- and
+// post-target handler at every level.
+TEST(EventDispatcherPerfTest, Dispatch) {
+  const int kDepth = 20;
+  const int kEvents = 200000;
+
+  TestEventDispatcher dispatcher;
+  TestTarget targets[kDepth];
+  CountingEventHandler handlers[kDepth];
+  for (int i = 0; i < kDepth; ++i) {
+    if (i > 0)
+      targets[i].set_parent(&targets[i - 1]);
+    targets[i].AddPreTargetHandler(&handlers[i]);
+    targets[i].AddPostTargetHandler(&handlers[i]);
+  }
+
+  MouseEvent mouse(ui::ET_MOUSE_MOVED, gfx::Point(3, 4), gfx::Point(3, 4), 0);
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (int i = 0; i < kEvents; ++i)
+    dispatcher.ProcessEvent(&targets[kDepth - 1], &mouse);
+  base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+
+  EXPECT_EQ(2 * kEvents, handlers[0].count());
+  printf("depth %d: %d events in %.1f ms (%.0f events/sec)\n",
+         kDepth, kEvents, elapsed.InMillisecondsF(),
+         kEvents / std::max(elapsed.InSecondsF(), 1e-6));
+}
+
+}  // namespace ui
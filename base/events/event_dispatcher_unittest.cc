@@ -472,4 +472,67 @@ TEST(EventDispatcherTest, EventHandlerAndDispatcherDestroyedDuringDispatch) {
   EXPECT_EQ(1, target.handler_list()[0]);
   EXPECT_EQ(2, target.handler_list()[1]);
 }
+
+// Tests that the cached handler chains pick up handlers added to and removed
+// from ancestors, and changes to the target's ancestors.
+TEST(EventDispatcherTest, HandlerChainsFollowHierarchyChanges) {
+  TestEventDispatcher dispatcher;
+  TestTarget grandparent, parent, other_parent, child;
+  TestEventHandler h1(1), h2(2), h3(3), h4(4);
+  h1.set_expect_pre_target(true);
+  h2.set_expect_pre_target(true);
+  h3.set_expect_pre_target(true);
+  h4.set_expect_post_target(true);
+
+  parent.set_parent(&grandparent);
+  child.set_parent(&parent);
+  child.AddPreTargetHandler(&h1);
+
+  MouseEvent mouse(ui::ET_MOUSE_MOVED, gfx::Point(3, 4), gfx::Point(3, 4), 0);
+  dispatcher.ProcessEvent(&child, &mouse);
+  EXPECT_EQ(std::vector<int>(1, 1), child.handler_list());
+
+  // A handler added to an ancestor after the chain was built.
+  child.Reset();
+  grandparent.AddPreTargetHandler(&h2);
+  grandparent.AddPostTargetHandler(&h4);
+  dispatcher.ProcessEvent(&child, &mouse);
+  {
+    int expected[] = { 2, 1, 4 };
+    EXPECT_EQ(std::vector<int>(expected, expected + arraysize(expected)),
+              child.handler_list());
+  }
+
+  // Reparenting the target drops the old ancestors' handlers.
+  child.Reset();
+  other_parent.AddPreTargetHandler(&h3);
+  child.set_parent(&other_parent);
+  dispatcher.ProcessEvent(&child, &mouse);
+  {
+    int expected[] = { 3, 1 };
+    EXPECT_EQ(std::vector<int>(expected, expected + arraysize(expected)),
+              child.handler_list());
+  }
+
+  // Reparenting an ancestor of the target.
+  child.Reset();
+  other_parent.set_parent(&grandparent);
+  dispatcher.ProcessEvent(&child, &mouse);
+  {
+    int expected[] = { 2, 3, 1, 4 };
+    EXPECT_EQ(std::vector<int>(expected, expected + arraysize(expected)),
+              child.handler_list());
+  }
+
+  child.Reset();
+  grandparent.RemovePreTargetHandler(&h2);
+  grandparent.RemovePostTargetHandler(&h4);
+  dispatcher.ProcessEvent(&child, &mouse);
+  {
+    int expected[] = { 3, 1 };
+    EXPECT_EQ(std::vector<int>(expected, expected + arraysize(expected)),
+              child.handler_list());
+  }
+}
+
 }  // namespace ui
@@ -50,8 +50,9 @@ class UI_EXPORT EventHandler {
   friend class EventDispatcher;
 
   // EventDispatcher pushes itself on the top of this stack while dispatching
-  // events to this then pops itself off when done.
-  std::stack<EventDispatcher*> dispatchers_;
+  // events to this then pops itself off when done. Backed by a vector so that
+  // the storage is kept, and reused, once the stack is empty.
+  std::stack<EventDispatcher*, std::vector<EventDispatcher*> > dispatchers_;
 
   DISALLOW_COPY_AND_ASSIGN(EventHandler);
 };
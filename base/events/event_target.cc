@@ -11,8 +11,19 @@
 
 namespace ui {
 
+namespace {
+
+int64 g_last_handlers_version = 0;
+
+int64 NextHandlersVersion() {
+  return ++g_last_handlers_version;
+}
+
+}  // namespace
+
 EventTarget::EventTarget()
-    : target_handler_(NULL) {
+    : target_handler_(NULL),
+      handlers_version_(NextHandlersVersion()) {
 }
 
 EventTarget::~EventTarget() {
@@ -20,6 +31,7 @@ EventTarget::~EventTarget() {
 
 void EventTarget::AddPreTargetHandler(EventHandler* handler) {
   pre_target_list_.push_back(handler);
+  handlers_version_ = NextHandlersVersion();
 }
 
 void EventTarget::RemovePreTargetHandler(EventHandler* handler) {
@@ -27,12 +39,15 @@ void EventTarget::RemovePreTargetHandler(EventHandler* handler) {
       std::find(pre_target_list_.begin(),
                 pre_target_list_.end(),
                 handler);
-  if (find != pre_target_list_.end())
+  if (find != pre_target_list_.end()) {
     pre_target_list_.erase(find);
+    handlers_version_ = NextHandlersVersion();
+  }
 }
 
 void EventTarget::AddPostTargetHandler(EventHandler* handler) {
   post_target_list_.push_back(handler);
+  handlers_version_ = NextHandlersVersion();
 }
 
 void EventTarget::RemovePostTargetHandler(EventHandler* handler) {
@@ -40,8 +55,10 @@ void EventTarget::RemovePostTargetHandler(EventHandler* handler) {
       std::find(post_target_list_.begin(),
                 post_target_list_.end(),
                 handler);
-  if (find != post_target_list_.end())
+  if (find != post_target_list_.end()) {
     post_target_list_.erase(find);
+    handlers_version_ = NextHandlersVersion();
+  }
 }
 
 void EventTarget::OnEvent(Event* event) {
@@ -82,29 +99,55 @@ void EventTarget::OnGestureEvent(GestureEvent* event) {
     target_handler_->OnGestureEvent(event);
 }
 
-void EventTarget::GetPreTargetHandlers(EventHandlerList* list) {
-  EventTarget* target = this;
-  while (target) {
-    EventHandlerList::reverse_iterator it, rend;
-    for (it = target->pre_target_list_.rbegin(),
-            rend = target->pre_target_list_.rend();
-        it != rend;
-        ++it) {
-      list->insert(list->begin(), *it);
-    }
-    target = target->GetParentTarget();
+const EventHandlerList& EventTarget::GetPreTargetHandlers() {
+  UpdateHandlerChains();
+  return pre_target_chain_;
+}
+
+const EventHandlerList& EventTarget::GetPostTargetHandlers() {
+  UpdateHandlerChains();
+  return post_target_chain_;
+}
+
+void EventTarget::UpdateHandlerChains() {
+  if (HandlerChainsAreValid())
+    return;
+
+  // The vectors keep their capacity, so rebuilding doesn't usually allocate.
+  chain_path_.clear();
+  pre_target_chain_.clear();
+  post_target_chain_.clear();
+  for (EventTarget* target = this; target; target = target->GetParentTarget()) {
+    ChainLink link = { target, target->handlers_version_ };
+    chain_path_.push_back(link);
+    post_target_chain_.insert(post_target_chain_.end(),
+                              target->post_target_list_.begin(),
+                              target->post_target_list_.end());
+  }
+  for (std::vector<ChainLink>::reverse_iterator it = chain_path_.rbegin();
+       it != chain_path_.rend(); ++it) {
+    const EventHandlerList& list = it->target->pre_target_list_;
+    pre_target_chain_.insert(pre_target_chain_.end(), list.begin(), list.end());
   }
 }
 
-void EventTarget::GetPostTargetHandlers(EventHandlerList* list) {
+bool EventTarget::HandlerChainsAreValid() {
+  if (chain_path_.empty())
+    return false;
+
+  // The targets in |chain_path_| may no longer exist, so they are only
+  // compared against, never dereferenced. A target allocated at the address of
+  // a destroyed one gets a new handlers version, so it won't match.
   EventTarget* target = this;
-  while (target) {
-    for (EventHandlerList::iterator it = target->post_target_list_.begin(),
-        end = target->post_target_list_.end(); it != end; ++it) {
-      list->push_back(*it);
+  for (std::vector<ChainLink>::const_iterator it = chain_path_.begin();
+       it != chain_path_.end(); ++it) {
+    if (target != it->target ||
+        target->handlers_version_ != it->handlers_version) {
+      return false;
     }
     target = target->GetParentTarget();
   }
+  return !target;
 }
 
 }  // namespace ui
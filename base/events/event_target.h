@@ -5,6 +5,8 @@
 #ifndef UI_BASE_EVENTS_EVENT_TARGET_H_
 #define UI_BASE_EVENTS_EVENT_TARGET_H_
 
+#include <vector>
+
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
 #include "ui/base/events/event_handler.h"
@@ -82,20 +84,46 @@ class UI_EXPORT EventTarget : public EventHandler {
  private:
   friend class EventDispatcher;
 
+  // A target on the path from |this| to the outermost target, and the version
+  // of its handler lists, at the time the handler chains were built.
+  struct ChainLink {
+    EventTarget* target;
+    int64 handlers_version;
+  };
+
   // Returns the list of handlers that should receive the event before the
   // target. The handlers from the outermost target are first in the list, and
-  // the handlers on |this| are the last in the list.
-  void GetPreTargetHandlers(EventHandlerList* list);
+  // the handlers on |this| are the last in the list. The list is owned by
+  // |this| and is only valid until the next call to either of these methods.
+  const EventHandlerList& GetPreTargetHandlers();
 
   // Returns the list of handlers that should receive the event after the
   // target. The handlers from the outermost target are last in the list, and
   // the handlers on |this| are the first in the list.
-  void GetPostTargetHandlers(EventHandlerList* list);
+  const EventHandlerList& GetPostTargetHandlers();
+
+  // Rebuilds the cached handler chains if any target on the path to the
+  // outermost target has changed its handlers, or the path itself has changed
+  // (e.g. because a target was reparented), since they were last built.
+  void UpdateHandlerChains();
+  bool HandlerChainsAreValid();
 
   EventHandlerList pre_target_list_;
   EventHandlerList post_target_list_;
   EventHandler* target_handler_;
 
+  // Changes whenever |pre_target_list_| or |post_target_list_| changes. Values
+  // are never reused, even by different targets.
+  int64 handlers_version_;
+
+  // The handler chains for events targeted at |this|, and the path they were
+  // built from. Validating the path is a walk up the hierarchy with no
+  // allocation, so dispatching repeatedly to the same target (e.g. for mouse
+  // moves) doesn't rebuild the chains.
+  std::vector<ChainLink> chain_path_;
+  EventHandlerList pre_target_chain_;
+  EventHandlerList post_target_chain_;
+
   DISALLOW_COPY_AND_ASSIGN(EventTarget);
 };
 
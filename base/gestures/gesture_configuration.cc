@@ -38,6 +38,8 @@ double
 int GestureConfiguration::points_buffered_for_velocity_ = 8;
 double GestureConfiguration::rail_break_proportion_ = 15;
 double GestureConfiguration::rail_start_proportion_ = 2;
+double GestureConfiguration::touch_resample_interval_in_seconds_ = 0;
+double GestureConfiguration::touch_resample_latency_in_seconds_ = 0.005;
 
 // Coefficients for a function that computes fling acceleration.
 // These are empirically determined defaults. Do not adjust without
@@ -167,6 +167,18 @@ class UI_EXPORT GestureConfiguration {
   static void set_rail_start_proportion(double val) {
     rail_start_proportion_ = val;
   }
+  static double touch_resample_interval_in_seconds() {
+    return touch_resample_interval_in_seconds_;
+  }
+  static void set_touch_resample_interval_in_seconds(double val) {
+    touch_resample_interval_in_seconds_ = val;
+  }
+  static double touch_resample_latency_in_seconds() {
+    return touch_resample_latency_in_seconds_;
+  }
+  static void set_touch_resample_latency_in_seconds(double val) {
+    touch_resample_latency_in_seconds_ = val;
+  }
   static void set_fling_acceleration_curve_coefficients(int i, float val) {
     fling_acceleration_curve_coefficients_[i] = val;
   }
@@ -227,6 +239,13 @@ class UI_EXPORT GestureConfiguration {
   static int points_buffered_for_velocity_;
   static double rail_break_proportion_;
   static double rail_start_proportion_;
+
+  // The frame interval touch moves are resampled to before gesture
+  // recognition, or 0 to disable resampling, and how long before each frame
+  // touches are resampled at.
+  static double touch_resample_interval_in_seconds_;
+  static double touch_resample_latency_in_seconds_;
+
   static float fling_acceleration_curve_coefficients_[NumAccelParams];
   static float fling_velocity_cap_;
 
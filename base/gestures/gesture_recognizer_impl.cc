@@ -230,7 +230,23 @@ GestureSequence::Gestures* GestureRecognizerImpl::ProcessTouchEventForGesture(
     GestureConsumer* target) {
   SetupTargets(event, target);
   GestureSequence* gesture_sequence = GetGestureSequenceForConsumer(target);
-  return gesture_sequence->ProcessTouchEventForGesture(event, result);
+
+  touch_resampler_.SetFrameTiming(
+      base::TimeDelta(),
+      base::TimeDelta::FromMicroseconds(static_cast<int64>(
+          GestureConfiguration::touch_resample_interval_in_seconds() *
+          base::Time::kMicrosecondsPerSecond)));
+  touch_resampler_.set_latency(base::TimeDelta::FromMicroseconds(
+      static_cast<int64>(
+          GestureConfiguration::touch_resample_latency_in_seconds() *
+          base::Time::kMicrosecondsPerSecond)));
+  scoped_ptr<TouchEvent> resampled;
+  const TouchEvent* resampled_event =
+      touch_resampler_.Resample(event, &resampled);
+  if (!resampled_event)
+    return NULL;
+  return gesture_sequence->ProcessTouchEventForGesture(*resampled_event,
+                                                       result);
 }
 
 void GestureRecognizerImpl::CleanupStateForConsumer(GestureConsumer* consumer) {
@@ -12,6 +12,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "ui/base/events/event_constants.h"
 #include "ui/base/gestures/gesture_recognizer.h"
+#include "ui/base/gestures/touch_resampler.h"
 #include "ui/base/ui_export.h"
 #include "ui/gfx/point.h"
 
@@ -69,6 +70,10 @@ class UI_EXPORT GestureRecognizerImpl : public GestureRecognizer {
   scoped_ptr<GestureConsumer> gesture_consumer_ignorer_;
   GestureEventHelper* helper_;
 
+  // Resamples touch moves to the frame rate configured in
+  // GestureConfiguration before they reach the gesture sequences.
+  TouchResampler touch_resampler_;
+
   DISALLOW_COPY_AND_ASSIGN(GestureRecognizerImpl);
 };
 
@@ -0,0 +1,144 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/base/gestures/touch_resampler.h"
+
+#include <algorithm>
+
+#include "ui/base/events/event.h"
+#include "ui/base/gestures/gesture_configuration.h"
+#include "ui/gfx/point_conversions.h"
+#include "ui/gfx/point_f.h"
+#include "ui/gfx/vector2d_f.h"
+
+namespace ui {
+
+namespace {
+
+// The default time before a frame is presented that touches are resampled to.
+const int kDefaultLatencyInMs = 5;
+
+// Touches are never extrapolated further than this past their last event.
+const int kMaxPredictionInMs = 8;
+
+}  // namespace
+
+TouchResampler::TouchState::TouchState()
+    : last_frame(0),
+      velocity_calculator(
+          GestureConfiguration::points_buffered_for_velocity()) {
+}
+
+TouchResampler::TouchResampler()
+    : latency_(base::TimeDelta::FromMilliseconds(kDefaultLatencyInMs)) {
+}
+
+TouchResampler::~TouchResampler() {
+}
+
+void TouchResampler::SetFrameTiming(base::TimeDelta frame_origin,
+                                    base::TimeDelta frame_interval) {
+  if (frame_origin == frame_origin_ && frame_interval == frame_interval_)
+    return;
+  frame_origin_ = frame_origin;
+  frame_interval_ = frame_interval;
+  touches_.clear();
+}
+
+const TouchEvent* TouchResampler::Resample(const TouchEvent& event,
+                                           scoped_ptr<TouchEvent>* resampled) {
+  if (!enabled())
+    return &event;
+
+  base::TimeDelta time = event.time_stamp();
+  switch (event.type()) {
+    case ET_TOUCH_PRESSED: {
+      linked_ptr<TouchState> touch(new TouchState);
+      touch->last_location = event.location();
+      touch->last_time = time;
+      // A move reported for the same frame as the press is still emitted.
+      touch->last_frame = GetUpcomingFrame(time) - 1;
+      touch->velocity_calculator.PointSeen(event.location().x(),
+                                           event.location().y(),
+                                           time.InMicroseconds());
+      touches_[event.touch_id()] = touch;
+      return &event;
+    }
+    case ET_TOUCH_MOVED:
+      break;
+    default:
+      touches_.erase(event.touch_id());
+      return &event;
+  }
+
+  std::map<int, linked_ptr<TouchState> >::iterator found =
+      touches_.find(event.touch_id());
+  if (found == touches_.end())
+    return &event;
+  TouchState* touch = found->second.get();
+
+  gfx::Point previous_location = touch->last_location;
+  base::TimeDelta previous_time = touch->last_time;
+  touch->last_location = event.location();
+  touch->last_time = time;
+  touch->velocity_calculator.PointSeen(event.location().x(),
+                                       event.location().y(),
+                                       time.InMicroseconds());
+
+  int64 frame = GetUpcomingFrame(time);
+  if (frame <= touch->last_frame)
+    return NULL;
+  touch->last_frame = frame;
+
+  base::TimeDelta sample_time =
+      frame_origin_ + frame_interval_ * frame - latency_;
+  gfx::PointF location(event.location().x(), event.location().y());
+  if (sample_time <= time) {
+    // The move is past the sample time: interpolate back to it from the
+    // previous event, if that was before it.
+    if (previous_time < sample_time) {
+      gfx::PointF previous(previous_location.x(), previous_location.y());
+      gfx::Vector2dF delta = location - previous;
+      delta.Scale(static_cast<float>(
+          (sample_time - previous_time).InSecondsF() /
+          (time - previous_time).InSecondsF()));
+      location = previous + delta;
+    } else {
+      sample_time = time;
+    }
+  } else {
+    // The sample time is still to come: extrapolate forward to it.
+    sample_time = std::min(
+        sample_time,
+        time + base::TimeDelta::FromMilliseconds(kMaxPredictionInMs));
+    float seconds = static_cast<float>((sample_time - time).InSecondsF());
+    location += gfx::Vector2dF(
+        touch->velocity_calculator.XVelocity() * seconds,
+        touch->velocity_calculator.YVelocity() * seconds);
+  }
+
+  resampled->reset(new TouchEvent(ET_TOUCH_MOVED,
+                                  gfx::ToRoundedPoint(location),
+                                  event.flags(),
+                                  event.touch_id(),
+                                  sample_time,
+                                  event.radius_x(),
+                                  event.radius_y(),
+                                  event.rotation_angle(),
+                                  event.force()));
+  return resampled->get();
+}
+
+int64 TouchResampler::GetUpcomingFrame(base::TimeDelta time) const {
+  int64 elapsed = (time - frame_origin_).InMicroseconds();
+  int64 interval = frame_interval_.InMicroseconds();
+  // Round towards negative infinity, so that times before the origin are
+  // handled the same as those after it.
+  int64 frame = elapsed / interval;
+  if (elapsed % interval < 0)
+    --frame;
+  return frame + 1;
+}
+
+}  // namespace ui
@@ -0,0 +1,82 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_BASE_GESTURES_TOUCH_RESAMPLER_H_
+#define UI_BASE_GESTURES_TOUCH_RESAMPLER_H_
+
+#include <map>
+
+#include "base/basictypes.h"
+#include "base/memory/linked_ptr.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/time.h"
+#include "ui/base/gestures/velocity_calculator.h"
+#include "ui/base/ui_export.h"
+#include "ui/gfx/point.h"
+
+namespace ui {
+
+class TouchEvent;
+
+// Resamples touch moves to the frame rate, so that gestures such as scrolls
+// update once per frame by an amount proportional to the finger's motion over
+// the frame, rather than beating against a touchscreen reporting at a
+// different rate or phase.
+//
+// For each touch, the first move reported for a frame is replaced by one
+// located where the touch is estimated to be |latency| before the frame is
+// presented: interpolated from the moves either side of that time when the
+// move arrives after it, and otherwise extrapolated from the move using the
+// touch's velocity. Further moves for the same frame are dropped. Everything
+// is computed from the event timestamps, so the output is deterministic.
+class UI_EXPORT TouchResampler {
+ public:
+  TouchResampler();
+  ~TouchResampler();
+
+  // Frames are presented at |frame_origin| + n * |frame_interval|, on the
+  // clock of the event timestamps. A zero |frame_interval| disables
+  // resampling.
+  void SetFrameTiming(base::TimeDelta frame_origin,
+                      base::TimeDelta frame_interval);
+
+  void set_latency(base::TimeDelta latency) { latency_ = latency; }
+
+  // Returns the event that should be processed in place of |event|: |event|
+  // itself, a resampled copy of it owned by |resampled|, or NULL if |event|
+  // should be dropped.
+  const TouchEvent* Resample(const TouchEvent& event,
+                             scoped_ptr<TouchEvent>* resampled);
+
+ private:
+  struct TouchState {
+    TouchState();
+
+    // The most recent event reported for the touch.
+    gfx::Point last_location;
+    base::TimeDelta last_time;
+
+    // The last frame a move has been emitted for.
+    int64 last_frame;
+
+    VelocityCalculator velocity_calculator;
+  };
+
+  // Returns the index of the first frame presented after |time|.
+  int64 GetUpcomingFrame(base::TimeDelta time) const;
+
+  bool enabled() const { return frame_interval_ > base::TimeDelta(); }
+
+  base::TimeDelta frame_origin_;
+  base::TimeDelta frame_interval_;
+  base::TimeDelta latency_;
+
+  std::map<int, linked_ptr<TouchState> > touches_;
+
+  DISALLOW_COPY_AND_ASSIGN(TouchResampler);
+};
+
+}  // namespace ui
+
+#endif  // UI_BASE_GESTURES_TOUCH_RESAMPLER_H_
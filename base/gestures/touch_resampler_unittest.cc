@@ -0,0 +1,131 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/base/events/event.h"
+#include "ui/base/gestures/touch_resampler.h"
+#include "ui/gfx/point.h"
+
+namespace ui {
+namespace test {
+
+namespace {
+
+const int kFrameIntervalInMs = 16;
+
+TouchEvent CreateTouch(EventType type, int x, int time_in_ms) {
+  return TouchEvent(type, gfx::Point(x, 0), 0,
+                    base::TimeDelta::FromMilliseconds(time_in_ms));
+}
+
+void EnableResampling(TouchResampler* resampler, int latency_in_ms) {
+  resampler->SetFrameTiming(
+      base::TimeDelta(),
+      base::TimeDelta::FromMilliseconds(kFrameIntervalInMs));
+  resampler->set_latency(base::TimeDelta::FromMilliseconds(latency_in_ms));
+}
+
+}  // namespace
+
+// Without frame timing, every event is passed through untouched.
+TEST(TouchResamplerTest, DisabledPassesEventsThrough) {
+  TouchResampler resampler;
+  scoped_ptr<TouchEvent> resampled;
+
+  TouchEvent press = CreateTouch(ET_TOUCH_PRESSED, 0, 0);
+  EXPECT_EQ(&press, resampler.Resample(press, &resampled));
+  for (int i = 1; i < 10; ++i) {
+    TouchEvent move = CreateTouch(ET_TOUCH_MOVED, i, i);
+    EXPECT_EQ(&move, resampler.Resample(move, &resampled));
+  }
+  EXPECT_FALSE(resampled.get());
+}
+
+// Presses and releases are never resampled, and a release ends the touch's
+// resampling.
+TEST(TouchResamplerTest, PressAndReleasePassThrough) {
+  TouchResampler resampler;
+  EnableResampling(&resampler, 5);
+  scoped_ptr<TouchEvent> resampled;
+
+  TouchEvent press = CreateTouch(ET_TOUCH_PRESSED, 0, 1);
+  EXPECT_EQ(&press, resampler.Resample(press, &resampled));
+  TouchEvent move = CreateTouch(ET_TOUCH_MOVED, 10, 9);
+  EXPECT_NE(&move, resampler.Resample(move, &resampled));
+  TouchEvent release = CreateTouch(ET_TOUCH_RELEASED, 10, 10);
+  EXPECT_EQ(&release, resampler.Resample(release, &resampled));
+
+  // Moves for a touch that isn't down are passed through.
+  TouchEvent stray_move = CreateTouch(ET_TOUCH_MOVED, 20, 11);
+  EXPECT_EQ(&stray_move, resampler.Resample(stray_move, &resampled));
+}
+
+// A move arriving after the sample time is interpolated back to it.
+TEST(TouchResamplerTest, Interpolates) {
+  TouchResampler resampler;
+  EnableResampling(&resampler, 12);
+  scoped_ptr<TouchEvent> resampled;
+
+  resampler.Resample(CreateTouch(ET_TOUCH_PRESSED, 0, 0), &resampled);
+  // Frame 1 is presented at 16ms, so touches are sampled at 4ms.
+  const TouchEvent* event =
+      resampler.Resample(CreateTouch(ET_TOUCH_MOVED, 80, 8), &resampled);
+  ASSERT_TRUE(event);
+  EXPECT_EQ(ET_TOUCH_MOVED, event->type());
+  EXPECT_EQ(40, event->location().x());
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(4), event->time_stamp());
+}
+
+// A move arriving before the sample time is extrapolated forward to it, but
+// no further than the prediction limit.
+TEST(TouchResamplerTest, Extrapolates) {
+  TouchResampler resampler;
+  EnableResampling(&resampler, 5);
+  scoped_ptr<TouchEvent> resampled;
+
+  // The touch moves at 1px per ms. Frame 1 is sampled at 11ms.
+  resampler.Resample(CreateTouch(ET_TOUCH_PRESSED, 1, 1), &resampled);
+  const TouchEvent* event =
+      resampler.Resample(CreateTouch(ET_TOUCH_MOVED, 9, 9), &resampled);
+  ASSERT_TRUE(event);
+  EXPECT_EQ(11, event->location().x());
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(11), event->time_stamp());
+
+  // Frame 2 is sampled at 27ms, more than 8ms after the move.
+  event = resampler.Resample(CreateTouch(ET_TOUCH_MOVED, 17, 17), &resampled);
+  ASSERT_TRUE(event);
+  EXPECT_EQ(25, event->location().x());
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(25), event->time_stamp());
+}
+
+// A touchscreen reporting at twice the frame rate produces one move per frame,
+// each by the same amount.
+TEST(TouchResamplerTest, OneMovePerFrame) {
+  TouchResampler resampler;
+  EnableResampling(&resampler, 5);
+  scoped_ptr<TouchEvent> resampled;
+
+  resampler.Resample(CreateTouch(ET_TOUCH_PRESSED, 3, 3), &resampled);
+  int emitted = 0;
+  int last_x = 0;
+  // 40 moves, 8ms apart, spanning frames 1 to 21.
+  for (int time = 11; time < 11 + 8 * 40; time += 8) {
+    const TouchEvent* event =
+        resampler.Resample(CreateTouch(ET_TOUCH_MOVED, time, time),
+                           &resampled);
+    if (!event)
+      continue;
+    if (emitted)
+      EXPECT_EQ(kFrameIntervalInMs, event->location().x() - last_x);
+    last_x = event->location().x();
+    ++emitted;
+  }
+  EXPECT_EQ(21, emitted);
+}
+
+}  // namespace test
+}  // namespace ui
@@ -0,0 +1,45 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/base/keycodes/keyboard_code_conversion_x.h"
+
+#include <stdio.h>
+
+#include "base/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace ui {
+
+namespace {
+
+// The number of key codes KeyboardCode can hold.
+const int kKeyboardCodeCount = 256;
+
+}  // namespace
+
+// Times converting every KeyboardCode to a keysym and back.
+TEST(KeyboardCodeConversionXPerfTest, RoundTrip) {
+  const int kIterations = 20000;
+
+  int checksum = 0;
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (int i = 0; i < kIterations; ++i) {
+    for (int j = 0; j < kKeyboardCodeCount; ++j) {
+      int keysym = XKeysymForWindowsKeyCode(static_cast<KeyboardCode>(j),
+                                            false);
+      if (keysym)
+        checksum += KeyboardCodeFromXKeysym(keysym);
+    }
+  }
+  base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+
+  int conversions = kIterations * kKeyboardCodeCount;
+  EXPECT_NE(0, checksum);
+  printf("%d keycode to keysym to keycode conversions in %.1f ms "
+         "(%.1f ns/conversion)\n",
+         conversions, elapsed.InMillisecondsF(),
+         elapsed.InMillisecondsF() * 1e6 / conversions);
+}
+
+}  // namespace ui
@@ -0,0 +1,46 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/base/keycodes/keyboard_code_conversion_x.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace ui {
+
+namespace {
+
+// The number of key codes KeyboardCode can hold.
+const int kKeyboardCodeCount = 256;
+
+}  // namespace
+
+// Every KeyboardCode that converts to a keysym converts back to itself.
+TEST(KeyboardCodeConversionXTest, KeysymRoundTrip) {
+  for (int shift = 0; shift < 2; ++shift) {
+    for (int i = 0; i < kKeyboardCodeCount; ++i) {
+      KeyboardCode keycode = static_cast<KeyboardCode>(i);
+      int keysym = XKeysymForWindowsKeyCode(keycode, shift != 0);
+      if (!keysym)
+        continue;
+      // Both single- and double-byte character switches are Zenkaku_Hankaku.
+      if (keycode == VKEY_DBE_SBCSCHAR)
+        keycode = VKEY_DBE_DBCSCHAR;
+      EXPECT_EQ(keycode, KeyboardCodeFromXKeysym(keysym))
+          << "keycode 0x" << std::hex << i << " keysym 0x" << keysym;
+    }
+  }
+}
+
+// Every hardware keycode with a default keysym converts to a KeyboardCode.
+TEST(KeyboardCodeConversionXTest, DefaultKeysymsAreKnown) {
+  for (unsigned int hardware_code = 0; hardware_code < 256; ++hardware_code) {
+    unsigned int keysym = DefaultXKeysymFromHardwareKeycode(hardware_code);
+    if (!keysym)
+      continue;
+    EXPECT_NE(VKEY_UNKNOWN, KeyboardCodeFromXKeysym(keysym))
+        << "hardware keycode 0x" << std::hex << hardware_code;
+  }
+}
+
+}  // namespace ui
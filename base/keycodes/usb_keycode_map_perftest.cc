@@ -0,0 +1,44 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdio.h>
+
+#include "base/basictypes.h"
+#include "base/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+#if defined(OS_WIN)
+#define USB_KEYMAP(usb, xkb, win, mac) {usb, win}
+#elif defined(OS_LINUX)
+#define USB_KEYMAP(usb, xkb, win, mac) {usb, xkb}
+#elif defined(OS_MACOSX)
+#define USB_KEYMAP(usb, xkb, win, mac) {usb, mac}
+#else
+#define USB_KEYMAP(usb, xkb, win, mac) {usb, 0}
+#endif
+#include "ui/base/keycodes/usb_keycode_map.h"
+#undef USB_KEYMAP
+
+// Times looking up every USB keycode in the table.
+TEST(UsbKeycodeMapPerfTest, Lookup) {
+  const int kIterations = 20000;
+
+  uint32_t checksum = 0;
+  base::TimeTicks start = base::TimeTicks::HighResNow();
+  for (int i = 0; i < kIterations; ++i) {
+    for (size_t j = 0; j < arraysize(usb_keycode_map); ++j)
+      checksum += UsbKeycodeToNativeKeycode(usb_keycode_map[j].usb_keycode);
+  }
+  base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+
+  int lookups = kIterations * arraysize(usb_keycode_map);
+  EXPECT_NE(0U, checksum);
+  printf("%d USB to native lookups in %.1f ms (%.1f ns/lookup)\n",
+         lookups, elapsed.InMillisecondsF(),
+         elapsed.InMillisecondsF() * 1e6 / lookups);
+}
+
+}  // namespace
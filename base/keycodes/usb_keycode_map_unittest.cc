@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <iomanip>
 #include <map>
 
 #include "base/basictypes.h"
@@ -39,6 +40,12 @@ TEST(UsbKeycodeMap, Basic) {
   std::map<uint32_t, uint16_t> usb_to_native;
   std::map<uint16_t, uint32_t> native_to_usb;
   for (size_t i = 0; i < arraysize(usb_keycode_map); ++i) {
+    // Verify that the table is sorted by USB code, which the lookup relies on.
+    if (i > 0) {
+      EXPECT_LT(usb_keycode_map[i - 1].usb_keycode,
+                usb_keycode_map[i].usb_keycode);
+    }
+
     // Don't test keys with no native keycode mapping on this platform.
     if (usb_keycode_map[i].native_keycode == kInvalidKeycode)
       continue;
@@ -46,6 +53,8 @@ TEST(UsbKeycodeMap, Basic) {
     // Verify UsbKeycodeToNativeKeycode works for this key.
     EXPECT_EQ(usb_keycode_map[i].native_keycode,
               UsbKeycodeToNativeKeycode(usb_keycode_map[i].usb_keycode));
+    EXPECT_EQ(usb_keycode_map[i].usb_keycode,
+              NativeKeycodeToUsbKeycode(usb_keycode_map[i].native_keycode));
 
     // Verify that the USB or native codes aren't duplicated.
     EXPECT_EQ(0U, usb_to_native.count(usb_keycode_map[i].usb_keycode))
@@ -79,6 +88,7 @@ TEST(UsbKeycodeMap, Basic) {
 TEST(UsbKeycodeMap, NonExistent) {
   // Verify that UsbKeycodeToNativeKeycode works for a non-existent USB keycode.
   EXPECT_EQ(kInvalidKeycode, UsbKeycodeToNativeKeycode(kUsbNonExistentKeycode));
+  EXPECT_EQ(kUsbInvalidKeycode, NativeKeycodeToUsbKeycode(kInvalidKeycode));
 }
 
 TEST(UsbKeycodeMap, UsBackslashIsNonUsHash) {
@@ -82,6 +82,42 @@ int TableModel::CompareValues(int row1, int row2, int column_id) {
   return 0;
 }
 
+bool TableModel::CanSortBySortKey(int column_id) {
+  return false;
+}
+
+size_t TableModel::AppendSortKey(int row,
+                                 int column_id,
+                                 std::vector<uint8>* key) {
+  DCHECK(row >= 0 && row < RowCount());
+  icu::Collator* collator = GetCollator();
+  if (!collator) {
+    NOTREACHED();
+    return 0;
+  }
+
+  const string16 value = GetText(row, column_id);
+  const UChar* chars = static_cast<const UChar*>(value.c_str());
+  const int32_t length = static_cast<int32_t>(value.length());
+  const size_t start = key->size();
+
+  // Guess the key size first; keys are rarely more than a few bytes per
+  // character. getSortKey() returns the size it needs, which includes a
+  // terminating zero byte.
+  size_t available = value.length() * 4 + 16;
+  key->resize(start + available);
+  size_t key_size = collator->getSortKey(chars, length, &(*key)[start],
+                                         static_cast<int32_t>(available));
+  if (key_size > available) {
+    available = key_size;
+    key->resize(start + available);
+    key_size = collator->getSortKey(chars, length, &(*key)[start],
+                                    static_cast<int32_t>(available));
+  }
+  key->resize(start + key_size);
+  return key_size;
+}
+
 void TableModel::ClearCollator() {
   delete collator;
   collator = NULL;
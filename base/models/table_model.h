@@ -7,6 +7,7 @@
 
 #include <vector>
 
+#include "base/basictypes.h"
 #include "base/string16.h"
 #include "third_party/icu/public/i18n/unicode/coll.h"
 #include "ui/base/ui_export.h"
@@ -80,6 +81,20 @@ class UI_EXPORT TableModel {
   // comparison.
   virtual int CompareValues(int row1, int row2, int column_id);
 
+  // Returns true if the values in the column with id |column_id| are ordered
+  // by the default CompareValues(), in which case views may sort the column by
+  // precomputed collation keys (see AppendSortKey()) instead of invoking
+  // CompareValues() for every comparison. As subclasses commonly override
+  // CompareValues() this returns false; models that use the default ordering
+  // for a column should override it to return true.
+  virtual bool CanSortBySortKey(int column_id);
+
+  // Appends the ICU collation sort key of the text in the column with id
+  // |column_id| of |row| to |key|. Comparing two keys byte-wise (shorter keys
+  // first on a common prefix) orders them the same as the default
+  // CompareValues() does. Returns the number of bytes appended.
+  size_t AppendSortKey(int row, int column_id, std::vector<uint8>* key);
+
   // Reset the collator.
   void ClearCollator();
 
@@ -6,11 +6,14 @@
 
 #include <errno.h>
 
+#include <string>
+
 #include "base/file_util.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted_memory.h"
 #include "base/metrics/histogram.h"
 #include "base/string_piece.h"
+#include "third_party/zlib/zlib.h"
 
 // For details of the file layout, see
 // http://dev.chromium.org/developers/design-documents/linuxresourcesandlocalizedstrings
@@ -18,6 +21,12 @@
 namespace {
 
 static const uint32 kFileFormatVersion = 4;
+// Version of packs written with DataPack::COMPRESS_ENTRIES, which follow the
+// index with a byte of flags per entry.
+static const uint32 kCompressedFileFormatVersion = 5;
+// Set in the flags of an entry stored as its uint32 uncompressed size followed
+// by its zlib compressed data.
+static const uint8 kEntryCompressed = 0x1;
 // Length of file header: version, entry count and text encoding type.
 static const size_t kHeaderLength = 2 * sizeof(uint32) + sizeof(uint8);
 
@@ -43,6 +52,14 @@ struct DataPackEntry {
 
 COMPILE_ASSERT(sizeof(DataPackEntry) == 6, size_of_entry_must_be_six);
 
+// Deflate can't compress better than this, so entries claiming to decompress
+// to more than this many times their compressed size are corrupt.
+const size_t kMaxCompressionRatio = 1032;
+
+// The lookup table is only built if it has at most this many slots per
+// resource, bounding its size to a small multiple of the file's own index.
+const size_t kMaxLookupTableSlotsPerResource = 4;
+
 // We're crashing when trying to load a pak file on Windows.  Add some error
 // codes for logging.
 // http://crbug.com/58056
@@ -62,8 +79,25 @@ enum LoadErrors {
 
 namespace ui {
 
+// static
+const size_t DataPack::kDefaultDecompressedCacheSize = 4 * 1024 * 1024;
+
+DataPack::CompressionStats::CompressionStats()
+    : compressed_count(0),
+      compressed_bytes(0),
+      uncompressed_bytes(0),
+      pinned_bytes(0),
+      cached_bytes(0),
+      decompress_count(0) {
+}
+
 DataPack::DataPack(ui::ScaleFactor scale_factor)
     : resource_count_(0),
+      first_resource_id_(0),
+      entry_flags_(NULL),
+      data_start_(0),
+      uncompressed_bytes_known_(true),
+      decompressed_cache_size_(kDefaultDecompressedCacheSize),
       text_encoding_type_(BINARY),
       scale_factor_(scale_factor) {
 }
@@ -109,9 +143,10 @@ bool DataPack::LoadImpl() {
   // First uint32: version; second: resource count;
   const uint32* ptr = reinterpret_cast<const uint32*>(mmap_->data());
   uint32 version = ptr[0];
-  if (version != kFileFormatVersion) {
+  if (version != kFileFormatVersion &&
+      version != kCompressedFileFormatVersion) {
     LOG(ERROR) << "Bad data pack version: got " << version << ", expected "
-               << kFileFormatVersion;
+               << kFileFormatVersion << " or " << kCompressedFileFormatVersion;
     UMA_HISTOGRAM_ENUMERATION("DataPack.Load", BAD_VERSION,
                               LOAD_ERRORS_COUNT);
     mmap_.reset();
@@ -157,13 +192,100 @@ bool DataPack::LoadImpl() {
       return false;
     }
   }
+  // 3) Check the entry flags of packs that have them fit.
+  data_start_ = kHeaderLength + (resource_count_ + 1) * sizeof(DataPackEntry);
+  entry_flags_ = NULL;
+  stats_ = CompressionStats();
+  if (version == kCompressedFileFormatVersion) {
+    if (data_start_ + resource_count_ > mmap_->length()) {
+      LOG(ERROR) << "Data pack file corruption: too short for the entry flags.";
+      UMA_HISTOGRAM_ENUMERATION("DataPack.Load", INDEX_TRUNCATED,
+                                LOAD_ERRORS_COUNT);
+      mmap_.reset();
+      return false;
+    }
+    entry_flags_ = mmap_->data() + data_start_;
+    data_start_ += resource_count_;
+    // Only the index is read here; the uncompressed sizes are at the start of
+    // each entry's data, so GetCompressionStats() reads them when asked
+    // rather than faulting in the whole pack on load.
+    for (size_t i = 0; i < resource_count_; ++i) {
+      if (!IsEntryCompressed(i))
+        continue;
+      ++stats_.compressed_count;
+      stats_.compressed_bytes += GetEntryData(i).size();
+    }
+  }
+  uncompressed_bytes_known_ = stats_.compressed_count == 0;
+
+  BuildLookupTable();
+  return true;
+}
+
+void DataPack::BuildLookupTable() {
+  lookup_table_.clear();
+  // Entry positions are stored plus one in a uint16.
+  if (resource_count_ == 0 || resource_count_ >= kuint16max)
+    return;
+
+  const DataPackEntry* entries =
+      reinterpret_cast<const DataPackEntry*>(mmap_->data() + kHeaderLength);
+  const uint16 first_id = entries[0].resource_id;
+  const uint16 last_id = entries[resource_count_ - 1].resource_id;
+  if (last_id < first_id)
+    return;  // Not sorted; stick to the binary search.
+  const size_t slot_count = static_cast<size_t>(last_id - first_id) + 1;
+  if (slot_count > resource_count_ * kMaxLookupTableSlotsPerResource)
+    return;
+
+  first_resource_id_ = first_id;
+  lookup_table_.assign(slot_count, 0);
+  for (size_t i = 0; i < resource_count_; ++i) {
+    size_t slot = entries[i].resource_id - first_id;
+    if (slot >= slot_count) {
+      lookup_table_.clear();
+      return;
+    }
+    // Keep the first of duplicate ids, as the binary search might not.
+    if (!lookup_table_[slot])
+      lookup_table_[slot] = static_cast<uint16>(i + 1);
+  }
+}
+
+bool DataPack::FindEntry(uint16 resource_id, size_t* index) const {
+  if (!lookup_table_.empty()) {
+    size_t slot = static_cast<size_t>(resource_id - first_resource_id_);
+    if (resource_id < first_resource_id_ || slot >= lookup_table_.size() ||
+        !lookup_table_[slot]) {
+      return false;
+    }
+    *index = lookup_table_[slot] - 1;
+    return true;
+  }
 
+  const DataPackEntry* entries =
+      reinterpret_cast<const DataPackEntry*>(mmap_->data() + kHeaderLength);
+  const DataPackEntry* target = reinterpret_cast<const DataPackEntry*>(
+      bsearch(&resource_id, entries, resource_count_, sizeof(DataPackEntry),
+              DataPackEntry::CompareById));
+  if (!target)
+    return false;
+  *index = target - entries;
   return true;
 }
 
+void DataPack::GetResourceIds(std::vector<uint16>* resource_ids) const {
+  if (!mmap_.get())
+    return;
+  const DataPackEntry* entries =
+      reinterpret_cast<const DataPackEntry*>(mmap_->data() + kHeaderLength);
+  for (size_t i = 0; i < resource_count_; ++i)
+    resource_ids->push_back(entries[i].resource_id);
+}
+
 bool DataPack::HasResource(uint16 resource_id) const {
-  return !!bsearch(&resource_id, mmap_->data() + kHeaderLength, resource_count_,
-                   sizeof(DataPackEntry), DataPackEntry::CompareById);
+  size_t index;
+  return FindEntry(resource_id, &index);
 }
 
 bool DataPack::GetStringPiece(uint16 resource_id,
@@ -179,17 +301,23 @@ bool DataPack::GetStringPiece(uint16 resource_id,
   #error DataPack assumes little endian
 #endif
 
-  const DataPackEntry* target = reinterpret_cast<const DataPackEntry*>(
-      bsearch(&resource_id, mmap_->data() + kHeaderLength, resource_count_,
-              sizeof(DataPackEntry), DataPackEntry::CompareById));
-  if (!target) {
+  size_t index;
+  if (!FindEntry(resource_id, &index))
     return false;
-  }
 
-  const DataPackEntry* next_entry = target + 1;
-  size_t length = next_entry->file_offset - target->file_offset;
+  if (!IsEntryCompressed(index)) {
+    *data = GetEntryData(index);
+    return true;
+  }
 
-  data->set(mmap_->data() + target->file_offset, length);
+  // The caller may hold on to |data|, so the decompressed data is kept for
+  // the lifetime of the pack. It is kept once per resource, which bounds the
+  // memory pinned to the uncompressed size of the compressed resources.
+  scoped_refptr<base::RefCountedString> entry =
+      GetDecompressedEntry(index, true);
+  if (!entry)
+    return false;
+  data->set(entry->data().data(), entry->data().size());
   return true;
 }
 
@@ -203,6 +331,147 @@ base::RefCountedStaticMemory* DataPack::GetStaticMemory(
       reinterpret_cast<const unsigned char*>(piece.data()), piece.length());
 }
 
+scoped_refptr<base::RefCountedMemory> DataPack::GetMemory(
+    uint16 resource_id) const {
+  size_t index;
+  if (!FindEntry(resource_id, &index))
+    return NULL;
+
+  if (!IsEntryCompressed(index)) {
+    base::StringPiece piece = GetEntryData(index);
+    return new base::RefCountedStaticMemory(
+        reinterpret_cast<const unsigned char*>(piece.data()), piece.length());
+  }
+  return GetDecompressedEntry(index, false);
+}
+
+DataPack::CompressionStats DataPack::GetCompressionStats() const {
+  base::AutoLock lock(decompressed_lock_);
+  if (!uncompressed_bytes_known_) {
+    for (size_t i = 0; i < resource_count_; ++i) {
+      uint32 uncompressed_size = 0;
+      if (IsEntryCompressed(i) && GetUncompressedSize(i, &uncompressed_size))
+        stats_.uncompressed_bytes += uncompressed_size;
+    }
+    uncompressed_bytes_known_ = true;
+  }
+  return stats_;
+}
+
+base::StringPiece DataPack::GetEntryData(size_t index) const {
+  const DataPackEntry* target = reinterpret_cast<const DataPackEntry*>(
+      mmap_->data() + kHeaderLength) + index;
+  const DataPackEntry* next_entry = target + 1;
+  size_t length = next_entry->file_offset - target->file_offset;
+  return base::StringPiece(
+      reinterpret_cast<const char*>(mmap_->data() + target->file_offset),
+      length);
+}
+
+bool DataPack::IsEntryCompressed(size_t index) const {
+  return entry_flags_ && (entry_flags_[index] & kEntryCompressed);
+}
+
+bool DataPack::GetUncompressedSize(size_t index, uint32* size) const {
+  base::StringPiece stored = GetEntryData(index);
+  if (stored.size() < sizeof(*size))
+    return false;
+  memcpy(size, stored.data(), sizeof(*size));
+  return *size <= (stored.size() - sizeof(*size)) * kMaxCompressionRatio;
+}
+
+scoped_refptr<base::RefCountedString> DataPack::GetDecompressedEntry(
+    size_t index,
+    bool pin) const {
+  {
+    base::AutoLock lock(decompressed_lock_);
+    scoped_refptr<base::RefCountedString> entry =
+        FindDecompressedEntry(index, pin);
+    if (entry)
+      return entry;
+  }
+
+  // Decompress without holding the lock. Another thread may decompress the
+  // same entry meanwhile, in which case the first result stored wins.
+  base::StringPiece stored = GetEntryData(index);
+  uint32 uncompressed_size = 0;
+  if (!GetUncompressedSize(index, &uncompressed_size)) {
+    LOG(ERROR) << "Compressed data pack entry #" << index << " is corrupt.";
+    return NULL;
+  }
+
+  scoped_refptr<base::RefCountedString> entry(new base::RefCountedString);
+  std::string& data = entry->data();
+  data.resize(uncompressed_size);
+  uLongf data_length = uncompressed_size;
+  if (uncompressed_size > 0 &&
+      (uncompress(reinterpret_cast<Bytef*>(&data[0]), &data_length,
+                  reinterpret_cast<const Bytef*>(stored.data()) +
+                      sizeof(uncompressed_size),
+                  stored.size() - sizeof(uncompressed_size)) != Z_OK ||
+       data_length != uncompressed_size)) {
+    LOG(ERROR) << "Failed to decompress data pack entry #" << index;
+    return NULL;
+  }
+
+  base::AutoLock lock(decompressed_lock_);
+  ++stats_.decompress_count;
+  scoped_refptr<base::RefCountedString> existing =
+      FindDecompressedEntry(index, pin);
+  if (existing)
+    return existing;
+
+  if (pin) {
+    pinned_entries_[index] = entry;
+    stats_.pinned_bytes += data.size();
+  } else {
+    cached_entries_.push_front(std::make_pair(index, entry));
+    cached_entry_index_[index] = cached_entries_.begin();
+    stats_.cached_bytes += data.size();
+    TrimDecompressedCache();
+  }
+  return entry;
+}
+
+scoped_refptr<base::RefCountedString> DataPack::FindDecompressedEntry(
+    size_t index,
+    bool pin) const {
+  decompressed_lock_.AssertAcquired();
+  PinnedEntries::const_iterator pinned = pinned_entries_.find(index);
+  if (pinned != pinned_entries_.end())
+    return pinned->second;
+
+  std::map<size_t, CachedEntries::iterator>::iterator cached =
+      cached_entry_index_.find(index);
+  if (cached == cached_entry_index_.end())
+    return NULL;
+
+  scoped_refptr<base::RefCountedString> entry = cached->second->second;
+  if (pin) {
+    stats_.cached_bytes -= entry->data().size();
+    stats_.pinned_bytes += entry->data().size();
+    pinned_entries_[index] = entry;
+    cached_entries_.erase(cached->second);
+    cached_entry_index_.erase(cached);
+  } else {
+    // Move the entry to the front of the recency list.
+    cached_entries_.splice(cached_entries_.begin(), cached_entries_,
+                           cached->second);
+  }
+  return entry;
+}
+
+void DataPack::TrimDecompressedCache() const {
+  decompressed_lock_.AssertAcquired();
+  // Entries still referenced by callers stay alive until they are released.
+  while (stats_.cached_bytes > decompressed_cache_size_ &&
+         !cached_entries_.empty()) {
+    stats_.cached_bytes -= cached_entries_.back().second->data().size();
+    cached_entry_index_.erase(cached_entries_.back().first);
+    cached_entries_.pop_back();
+  }
+}
+
 ResourceHandle::TextEncodingType DataPack::GetTextEncodingType() const {
   return text_encoding_type_;
 }
@@ -215,11 +484,50 @@ ui::ScaleFactor DataPack::GetScaleFactor() const {
 bool DataPack::WritePack(const FilePath& path,
                          const std::map<uint16, base::StringPiece>& resources,
                          TextEncodingType textEncodingType) {
+  return WritePack(path, resources, textEncodingType, NO_COMPRESSION);
+}
+
+bool DataPack::WritePack(const FilePath& path,
+                         const std::map<uint16, base::StringPiece>& resources,
+                         TextEncodingType textEncodingType,
+                         Compression compression) {
+  // Compress the entries up front as the index needs their stored sizes.
+  std::vector<std::string> compressed(resources.size());
+  std::vector<uint8> flags(resources.size(), 0);
+  if (compression == COMPRESS_ENTRIES) {
+    size_t i = 0;
+    for (std::map<uint16, base::StringPiece>::const_iterator it =
+             resources.begin();
+         it != resources.end(); ++it, ++i) {
+      const base::StringPiece& data = it->second;
+      uint32 uncompressed_size = data.length();
+      uLongf compressed_length = compressBound(uncompressed_size);
+      std::string& stored = compressed[i];
+      stored.resize(sizeof(uncompressed_size) + compressed_length);
+      memcpy(&stored[0], &uncompressed_size, sizeof(uncompressed_size));
+      if (compress2(reinterpret_cast<Bytef*>(&stored[sizeof(uint32)]),
+                    &compressed_length,
+                    reinterpret_cast<const Bytef*>(data.data()),
+                    data.length(), Z_BEST_COMPRESSION) != Z_OK) {
+        LOG(ERROR) << "Failed to compress " << it->first;
+        return false;
+      }
+      stored.resize(sizeof(uncompressed_size) + compressed_length);
+      // Entries that don't shrink are stored as is.
+      if (stored.size() < data.length())
+        flags[i] = kEntryCompressed;
+      else
+        stored.clear();
+    }
+  }
+
   FILE* file = file_util::OpenFile(path, "wb");
   if (!file)
     return false;
 
-  if (fwrite(&kFileFormatVersion, sizeof(kFileFormatVersion), 1, file) != 1) {
+  const uint32 version = compression == COMPRESS_ENTRIES ?
+      kCompressedFileFormatVersion : kFileFormatVersion;
+  if (fwrite(&version, sizeof(version), 1, file) != 1) {
     LOG(ERROR) << "Failed to write file version";
     file_util::CloseFile(file);
     return false;
@@ -250,12 +558,16 @@ bool DataPack::WritePack(const FilePath& path,
   }
 
   // Each entry is a uint16 + a uint32. We have an extra entry after the last
-  // item so we can compute the size of the list item.
+  // item so we can compute the size of the list item. Version 5 packs follow
+  // the index with a byte of flags per entry.
   uint32 index_length = (entry_count + 1) * sizeof(DataPackEntry);
   uint32 data_offset = kHeaderLength + index_length;
+  if (version == kCompressedFileFormatVersion)
+    data_offset += entry_count;
+  size_t i = 0;
   for (std::map<uint16, base::StringPiece>::const_iterator it =
            resources.begin();
-       it != resources.end(); ++it) {
+       it != resources.end(); ++it, ++i) {
     uint16 resource_id = it->first;
     if (fwrite(&resource_id, sizeof(resource_id), 1, file) != 1) {
       LOG(ERROR) << "Failed to write id for " << resource_id;
@@ -269,7 +581,8 @@ bool DataPack::WritePack(const FilePath& path,
       return false;
     }
 
-    data_offset += it->second.length();
+    data_offset += flags[i] & kEntryCompressed ?
+        compressed[i].length() : it->second.length();
   }
 
   // We place an extra entry after the last item that allows us to read the
@@ -287,10 +600,20 @@ bool DataPack::WritePack(const FilePath& path,
     return false;
   }
 
+  if (version == kCompressedFileFormatVersion && entry_count &&
+      fwrite(&flags[0], entry_count, 1, file) != 1) {
+    LOG(ERROR) << "Failed to write entry flags.";
+    file_util::CloseFile(file);
+    return false;
+  }
+
+  i = 0;
   for (std::map<uint16, base::StringPiece>::const_iterator it =
            resources.begin();
-       it != resources.end(); ++it) {
-    if (fwrite(it->second.data(), it->second.length(), 1, file) != 1) {
+       it != resources.end(); ++it, ++i) {
+    base::StringPiece data = flags[i] & kEntryCompressed ?
+        base::StringPiece(compressed[i]) : it->second;
+    if (fwrite(data.data(), data.length(), 1, file) != 1) {
       LOG(ERROR) << "Failed to write data for " << it->first;
       file_util::CloseFile(file);
       return false;
@@ -9,12 +9,16 @@
 #ifndef UI_BASE_RESOURCE_DATA_PACK_H_
 #define UI_BASE_RESOURCE_DATA_PACK_H_
 
+#include <list>
 #include <map>
+#include <vector>
 
 #include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/platform_file.h"
 #include "base/string_piece.h"
+#include "base/synchronization/lock.h"
 #include "ui/base/layout.h"
 #include "ui/base/resource/resource_handle.h"
 #include "ui/base/ui_export.h"
@@ -22,6 +26,7 @@
 namespace base {
 class FilePath;
 class RefCountedStaticMemory;
+class RefCountedString;
 }
 
 namespace file_util {
@@ -32,6 +37,40 @@ namespace ui {
 
 class UI_EXPORT DataPack : public ResourceHandle {
  public:
+  // How WritePack() stores the resources.
+  enum Compression {
+    // Resources are stored as is, in a pack readable by older versions.
+    NO_COMPRESSION,
+    // Resources that shrink are stored zlib compressed. They are
+    // decompressed on first access.
+    COMPRESS_ENTRIES,
+  };
+
+  // Sizes of the compressed resources of a pack, as returned by
+  // GetCompressionStats().
+  struct UI_EXPORT CompressionStats {
+    CompressionStats();
+
+    // Number of compressed resources and their size in the pack and once
+    // decompressed.
+    size_t compressed_count;
+    size_t compressed_bytes;
+    size_t uncompressed_bytes;
+
+    // Decompressed bytes held by the pack: those returned by GetStringPiece()
+    // or GetStaticMemory(), which live as long as the pack, and those in the
+    // bounded cache used by GetMemory(). Each resource is pinned at most once,
+    // so |pinned_bytes| never exceeds |uncompressed_bytes|.
+    size_t pinned_bytes;
+    size_t cached_bytes;
+
+    // Number of times a resource was decompressed.
+    size_t decompress_count;
+  };
+
+  // Default bound of the cache of decompressed resources, in bytes.
+  static const size_t kDefaultDecompressedCacheSize;
+
   DataPack(ui::ScaleFactor scale_factor);
   virtual ~DataPack();
 
@@ -49,12 +88,40 @@ class UI_EXPORT DataPack : public ResourceHandle {
                         const std::map<uint16, base::StringPiece>& resources,
                         TextEncodingType textEncodingType);
 
-  // ResourceHandle implementation:
+  // Same as above, storing the resources as specified by |compression|.
+  static bool WritePack(const base::FilePath& path,
+                        const std::map<uint16, base::StringPiece>& resources,
+                        TextEncodingType textEncodingType,
+                        Compression compression);
+
+  // Sets the number of decompressed bytes GetMemory() keeps around for
+  // resources that are accessed repeatedly.
+  void set_decompressed_cache_size(size_t bytes) {
+    decompressed_cache_size_ = bytes;
+  }
+
+  CompressionStats GetCompressionStats() const;
+
+  // Appends the ids of all the resources in the pack to |resource_ids|, in
+  // increasing order.
+  void GetResourceIds(std::vector<uint16>* resource_ids) const;
+
+  // Drops the lookup table built on load so that lookups binary search the
+  // index of the file. Used to compare the two.
+  void ClearLookupTableForTest() { lookup_table_.clear(); }
+
+  // ResourceHandle implementation. The data GetStringPiece() and
+  // GetStaticMemory() return for a compressed resource is decompressed once
+  // and kept until the pack is destroyed, as the callers don't release it.
+  // Callers that don't need the data to outlive their use of it should call
+  // GetMemory(), whose decompressed data only stays in a bounded cache.
   virtual bool HasResource(uint16 resource_id) const OVERRIDE;
   virtual bool GetStringPiece(uint16 resource_id,
                               base::StringPiece* data) const OVERRIDE;
   virtual base::RefCountedStaticMemory* GetStaticMemory(
       uint16 resource_id) const OVERRIDE;
+  virtual scoped_refptr<base::RefCountedMemory> GetMemory(
+      uint16 resource_id) const OVERRIDE;
   virtual TextEncodingType GetTextEncodingType() const OVERRIDE;
   virtual ui::ScaleFactor GetScaleFactor() const OVERRIDE;
 
@@ -62,12 +129,83 @@ class UI_EXPORT DataPack : public ResourceHandle {
   // Does the actual loading of a pack file. Called by Load and LoadFromFile.
   bool LoadImpl();
 
+  // Builds |lookup_table_| if the resource ids are dense enough.
+  void BuildLookupTable();
+
+  // Sets |index| to the position of |resource_id| in the index of the file.
+  // Returns false if the pack doesn't contain the resource.
+  bool FindEntry(uint16 resource_id, size_t* index) const;
+
+  // Returns the bytes stored in the file for the entry at |index|.
+  base::StringPiece GetEntryData(size_t index) const;
+
+  // Returns true if the entry at |index| is stored compressed.
+  bool IsEntryCompressed(size_t index) const;
+
+  // Sets |size| to the uncompressed size stored at the start of the
+  // compressed entry at |index|. Returns false if the entry is too short to
+  // hold it, or too short to decompress to it.
+  bool GetUncompressedSize(size_t index, uint32* size) const;
+
+  // Returns the decompressed data of the compressed entry at |index|, or NULL
+  // if it is corrupt. If |pin| is true the data is kept until the pack is
+  // destroyed, otherwise it is added to the bounded cache.
+  scoped_refptr<base::RefCountedString> GetDecompressedEntry(size_t index,
+                                                             bool pin) const;
+
+  // Returns the already decompressed data of the entry at |index|, or NULL.
+  // Moves the data from the cache to the pinned entries if |pin| is true.
+  // |decompressed_lock_| must be held.
+  scoped_refptr<base::RefCountedString> FindDecompressedEntry(size_t index,
+                                                              bool pin) const;
+
+  // Drops the least recently used cache entries until the cache fits.
+  // |decompressed_lock_| must be held.
+  void TrimDecompressedCache() const;
+
   // The memory-mapped data.
   scoped_ptr<file_util::MemoryMappedFile> mmap_;
 
   // Number of resources in the data.
   size_t resource_count_;
 
+  // Maps |resource_id - first_resource_id_| to one plus the position of the
+  // resource in the index of the file, or 0 for ids not in the pack. Gives
+  // constant time lookups; empty if the ids are too sparse to be worth it, in
+  // which case the index of the file is binary searched.
+  std::vector<uint16> lookup_table_;
+  uint16 first_resource_id_;
+
+  // One byte of flags per entry for packs with compressed entries, NULL
+  // otherwise. Points into |mmap_|.
+  const uint8* entry_flags_;
+
+  // Offset of the first byte of resource data.
+  size_t data_start_;
+
+  // Protects the members below, which cache decompressed entries, and the
+  // lazily computed |stats_.uncompressed_bytes|.
+  mutable base::Lock decompressed_lock_;
+
+  // False until GetCompressionStats() has summed the uncompressed sizes.
+  mutable bool uncompressed_bytes_known_;
+
+  // Entries returned by GetStringPiece() or GetStaticMemory(), keyed by
+  // position in the index.
+  typedef std::map<size_t, scoped_refptr<base::RefCountedString> >
+      PinnedEntries;
+  mutable PinnedEntries pinned_entries_;
+
+  // Entries returned by GetMemory(), most recently used first, and their
+  // positions in the list.
+  typedef std::list<std::pair<size_t, scoped_refptr<base::RefCountedString> > >
+      CachedEntries;
+  mutable CachedEntries cached_entries_;
+  mutable std::map<size_t, CachedEntries::iterator> cached_entry_index_;
+
+  size_t decompressed_cache_size_;
+  mutable CompressionStats stats_;
+
   // Type of encoding for text resources.
   TextEncodingType text_encoding_type_;
 
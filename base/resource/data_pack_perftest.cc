@@ -0,0 +1,70 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdio.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/string_number_conversions.h"
+#include "base/string_piece.h"
+#include "base/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/base/resource/data_pack.h"
+
+namespace ui {
+
+namespace {
+
+const int kResourceCount = 5000;
+const int kIterations = 200;
+
+// Writes a pack with |count| consecutive resources, each holding its id as a
+// string.
+void WriteNumberedPack(const FilePath& path, int count) {
+  std::vector<std::string> contents(count);
+  std::map<uint16, base::StringPiece> resources;
+  for (int i = 0; i < count; ++i) {
+    contents[i] = base::IntToString(i);
+    resources[static_cast<uint16>(i)] = contents[i];
+  }
+  ASSERT_TRUE(DataPack::WritePack(path, resources, DataPack::BINARY));
+}
+
+}  // namespace
+
+// Compares the lookup table with a binary search of the file's index.
+TEST(DataPackPerfTest, Lookup) {
+  base::ScopedTempDir dir;
+  ASSERT_TRUE(dir.CreateUniqueTempDir());
+  FilePath path = dir.path().Append(FILE_PATH_LITERAL("bench.pak"));
+  WriteNumberedPack(path, kResourceCount);
+
+  DataPack pack(SCALE_FACTOR_100P);
+  ASSERT_TRUE(pack.LoadFromPath(path));
+
+  for (int pass = 0; pass < 2; ++pass) {
+    if (pass == 1)
+      pack.ClearLookupTableForTest();
+    size_t total_length = 0;
+    base::TimeTicks start = base::TimeTicks::HighResNow();
+    for (int i = 0; i < kIterations; ++i) {
+      for (int id = 0; id < kResourceCount; ++id) {
+        base::StringPiece data;
+        if (pack.GetStringPiece(id, &data))
+          total_length += data.length();
+      }
+    }
+    base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+    EXPECT_GT(total_length, 0U);
+    printf("%s: %.1f ns per lookup\n",
+           pass == 0 ? "lookup table" : "binary search",
+           elapsed.InMicroseconds() * 1000.0 / (kIterations * kResourceCount));
+  }
+}
+
+}  // namespace ui
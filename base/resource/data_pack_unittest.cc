@@ -2,10 +2,16 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <string.h>
+
+#include <vector>
+
 #include "base/file_path.h"
 #include "base/file_util.h"
 #include "base/files/scoped_temp_dir.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/path_service.h"
+#include "base/string_number_conversions.h"
 #include "base/string_piece.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "ui/base/resource/data_pack.h"
@@ -147,4 +153,189 @@ TEST_P(DataPackTest, Write) {
   EXPECT_EQ(fifteen, data);
 }
 
+namespace {
+
+// Writes a pack with |count| resources whose ids are |stride| apart, each
+// holding its id as a string.
+void WriteNumberedPack(const FilePath& path, int count, int stride) {
+  std::vector<std::string> contents(count);
+  std::map<uint16, base::StringPiece> resources;
+  for (int i = 0; i < count; ++i) {
+    contents[i] = base::IntToString(i * stride);
+    resources[static_cast<uint16>(i * stride)] = contents[i];
+  }
+  ASSERT_TRUE(DataPack::WritePack(path, resources, DataPack::BINARY));
+}
+
+}  // namespace
+
+// Verifies lookups give the same results with and without the lookup table,
+// and for packs whose ids are too sparse to get one.
+TEST(DataPackTest, LookupTable) {
+  base::ScopedTempDir dir;
+  ASSERT_TRUE(dir.CreateUniqueTempDir());
+  FilePath dense_path = dir.path().Append(FILE_PATH_LITERAL("dense.pak"));
+  FilePath sparse_path = dir.path().Append(FILE_PATH_LITERAL("sparse.pak"));
+  WriteNumberedPack(dense_path, 100, 2);
+  WriteNumberedPack(sparse_path, 100, 500);
+
+  DataPack dense(SCALE_FACTOR_100P);
+  ASSERT_TRUE(dense.LoadFromPath(dense_path));
+  DataPack dense_searched(SCALE_FACTOR_100P);
+  ASSERT_TRUE(dense_searched.LoadFromPath(dense_path));
+  dense_searched.ClearLookupTableForTest();
+  DataPack sparse(SCALE_FACTOR_100P);
+  ASSERT_TRUE(sparse.LoadFromPath(sparse_path));
+
+  for (int id = 0; id < 300; ++id) {
+    base::StringPiece data;
+    base::StringPiece searched_data;
+    bool expected = id % 2 == 0 && id < 200;
+    EXPECT_EQ(expected, dense.GetStringPiece(id, &data)) << id;
+    EXPECT_EQ(expected, dense_searched.GetStringPiece(id, &searched_data));
+    EXPECT_EQ(expected, dense.HasResource(id));
+    if (expected) {
+      EXPECT_EQ(base::IntToString(id), data);
+      EXPECT_EQ(data, searched_data);
+    }
+  }
+
+  base::StringPiece data;
+  EXPECT_TRUE(sparse.GetStringPiece(1500, &data));
+  EXPECT_EQ("1500", data);
+  EXPECT_FALSE(sparse.HasResource(1501));
+
+  std::vector<uint16> ids;
+  sparse.GetResourceIds(&ids);
+  ASSERT_EQ(100U, ids.size());
+  EXPECT_EQ(0, ids[0]);
+  EXPECT_EQ(49500, ids[99]);
+}
+
+// Verifies compressed packs read back the same resources, leaving resources
+// that don't shrink uncompressed, and report their sizes.
+TEST(DataPackTest, WriteCompressed) {
+  base::ScopedTempDir dir;
+  ASSERT_TRUE(dir.CreateUniqueTempDir());
+  FilePath file = dir.path().Append(FILE_PATH_LITERAL("compressed.pak"));
+
+  std::string repetitive(10000, 'x');
+  std::string small("ab");
+  std::string empty;
+  std::map<uint16, base::StringPiece> resources;
+  resources[1] = repetitive;
+  resources[2] = small;
+  resources[3] = empty;
+  ASSERT_TRUE(DataPack::WritePack(file, resources, DataPack::BINARY,
+                                  DataPack::COMPRESS_ENTRIES));
+
+  int64 file_size = 0;
+  ASSERT_TRUE(file_util::GetFileSize(file, &file_size));
+  EXPECT_LT(file_size, 1000);
+
+  DataPack pack(SCALE_FACTOR_100P);
+  ASSERT_TRUE(pack.LoadFromPath(file));
+  DataPack::CompressionStats stats = pack.GetCompressionStats();
+  EXPECT_EQ(1U, stats.compressed_count);
+  EXPECT_EQ(repetitive.size(), stats.uncompressed_bytes);
+  EXPECT_LT(stats.compressed_bytes, repetitive.size());
+  EXPECT_EQ(0U, stats.pinned_bytes + stats.cached_bytes);
+
+  // GetMemory() decompresses into the cache, and a second access is a hit.
+  scoped_refptr<base::RefCountedMemory> memory = pack.GetMemory(1);
+  ASSERT_TRUE(memory);
+  EXPECT_EQ(repetitive, std::string(
+      reinterpret_cast<const char*>(memory->front()), memory->size()));
+  memory = pack.GetMemory(1);
+  stats = pack.GetCompressionStats();
+  EXPECT_EQ(1U, stats.decompress_count);
+  EXPECT_EQ(repetitive.size(), stats.cached_bytes);
+
+  // GetStringPiece() pins the data for the lifetime of the pack.
+  base::StringPiece data;
+  ASSERT_TRUE(pack.GetStringPiece(1, &data));
+  EXPECT_EQ(repetitive, data);
+  stats = pack.GetCompressionStats();
+  EXPECT_EQ(1U, stats.decompress_count);
+  EXPECT_EQ(0U, stats.cached_bytes);
+  EXPECT_EQ(repetitive.size(), stats.pinned_bytes);
+
+  // Pinned data is shared by later accesses rather than pinned again.
+  scoped_refptr<base::RefCountedStaticMemory> static_memory =
+      pack.GetStaticMemory(1);
+  ASSERT_TRUE(static_memory);
+  EXPECT_EQ(data.data(), reinterpret_cast<const char*>(static_memory->front()));
+  stats = pack.GetCompressionStats();
+  EXPECT_EQ(1U, stats.decompress_count);
+  EXPECT_EQ(repetitive.size(), stats.pinned_bytes);
+  EXPECT_LE(stats.pinned_bytes, stats.uncompressed_bytes);
+
+  ASSERT_TRUE(pack.GetStringPiece(2, &data));
+  EXPECT_EQ(small, data);
+  ASSERT_TRUE(pack.GetStringPiece(3, &data));
+  EXPECT_TRUE(data.empty());
+  EXPECT_FALSE(pack.GetStringPiece(4, &data));
+}
+
+// Verifies the cache of GetMemory() stays within its bound.
+TEST(DataPackTest, DecompressedCacheBound) {
+  base::ScopedTempDir dir;
+  ASSERT_TRUE(dir.CreateUniqueTempDir());
+  FilePath file = dir.path().Append(FILE_PATH_LITERAL("compressed.pak"));
+
+  std::string a(1000, 'a');
+  std::string b(1000, 'b');
+  std::map<uint16, base::StringPiece> resources;
+  resources[1] = a;
+  resources[2] = b;
+  ASSERT_TRUE(DataPack::WritePack(file, resources, DataPack::BINARY,
+                                  DataPack::COMPRESS_ENTRIES));
+
+  DataPack pack(SCALE_FACTOR_100P);
+  ASSERT_TRUE(pack.LoadFromPath(file));
+  pack.set_decompressed_cache_size(1500);
+
+  scoped_refptr<base::RefCountedMemory> first = pack.GetMemory(1);
+  scoped_refptr<base::RefCountedMemory> second = pack.GetMemory(2);
+  EXPECT_EQ(1000U, pack.GetCompressionStats().cached_bytes);
+  // The evicted entry stays valid while referenced.
+  EXPECT_EQ(a, std::string(reinterpret_cast<const char*>(first->front()),
+                           first->size()));
+  pack.GetMemory(1);
+  EXPECT_EQ(3U, pack.GetCompressionStats().decompress_count);
+}
+
+// Verifies an entry claiming an impossible uncompressed size is rejected
+// rather than allocated for.
+TEST(DataPackTest, CorruptUncompressedSize) {
+  base::ScopedTempDir dir;
+  ASSERT_TRUE(dir.CreateUniqueTempDir());
+  FilePath file = dir.path().Append(FILE_PATH_LITERAL("corrupt.pak"));
+
+  std::string repetitive(10000, 'x');
+  std::map<uint16, base::StringPiece> resources;
+  resources[1] = repetitive;
+  ASSERT_TRUE(DataPack::WritePack(file, resources, DataPack::BINARY,
+                                  DataPack::COMPRESS_ENTRIES));
+
+  // The offset of the first entry follows the header and the entry's id.
+  std::string contents;
+  ASSERT_TRUE(file_util::ReadFileToString(file, &contents));
+  uint32 offset = 0;
+  ASSERT_GT(contents.size(), 15U);
+  memcpy(&offset, &contents[11], sizeof(offset));
+  ASSERT_LE(offset + sizeof(uint32), contents.size());
+  const uint32 huge_size = 0x7fffffff;
+  memcpy(&contents[offset], &huge_size, sizeof(huge_size));
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            file_util::WriteFile(file, contents.data(), contents.size()));
+
+  DataPack pack(SCALE_FACTOR_100P);
+  ASSERT_TRUE(pack.LoadFromPath(file));
+  base::StringPiece data;
+  EXPECT_FALSE(pack.GetStringPiece(1, &data));
+  EXPECT_FALSE(pack.GetMemory(1));
+  EXPECT_EQ(0U, pack.GetCompressionStats().uncompressed_bytes);
+}
+
 }  // namespace ui
@@ -4,17 +4,24 @@
 
 #include "ui/base/resource/resource_bundle.h"
 
+#include <set>
 #include <vector>
 
+#include "base/bind.h"
 #include "base/command_line.h"
 #include "base/file_util.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted_memory.h"
+#include "base/message_loop_proxy.h"
 #include "base/metrics/histogram.h"
 #include "base/path_service.h"
 #include "base/stl_util.h"
+#include "base/string_number_conversions.h"
 #include "base/string_piece.h"
+#include "base/string_split.h"
+#include "base/synchronization/condition_variable.h"
 #include "base/synchronization/lock.h"
+#include "base/threading/worker_pool.h"
 #include "base/utf_string_conversions.h"
 #include "build/build_config.h"
 #include "net/base/big_endian.h"
@@ -33,6 +40,7 @@
 #include "ui/gfx/screen.h"
 #include "ui/gfx/size_conversions.h"
 #include "ui/gfx/skbitmap_operations.h"
+#include "ui/gfx/text_size_cache.h"
 
 #if defined(OS_CHROMEOS)
 #include "base/chromeos/chromeos_version.h"
@@ -103,15 +111,209 @@ bool DecodePNG(const unsigned char* buf,
   return gfx::PNGCodec::Decode(buf, size, bitmap);
 }
 
+// Returns the key of |resource_id| in ResourceBundle::resource_index_ for the
+// packs of |scale_factor|. NUM_SCALE_FACTORS stands for the packs that are
+// either SCALE_FACTOR_100P or SCALE_FACTOR_NONE. Like the data packs, the key
+// only uses the low 16 bits of |resource_id|.
+uint32 ResourceIndexKey(int resource_id, int scale_factor) {
+  return (static_cast<uint32>(static_cast<uint16>(resource_id)) << 8) |
+      scale_factor;
+}
+
+// Returns the scale factor GetImageNamed() loads first.
+ScaleFactor GetScaleFactorToLoad() {
+  // TODO(oshima): Consider reading the image size from png IHDR chunk and
+  // skip decoding here and remove #ifdef below.
+#if defined(OS_CHROMEOS)
+  return ui::GetMaxScaleFactor();
+#else
+  return ui::SCALE_FACTOR_100P;
+#endif
+}
+
+// The most images ResourceBundle::PrefetchImages() holds on to. Images
+// prefetched but never requested stay until the ResourceBundle goes away, so
+// this bounds the memory a stale image set can waste.
+const size_t kMaxPrefetchedImages = 256;
+
 }  // namespace
 
+// Decodes images for ResourceBundle::PrefetchImages() on the worker pool and
+// holds them until ResourceBundleImageSource asks for them.
+class ResourceBundle::ImagePrefetcher
+    : public base::RefCountedThreadSafe<ImagePrefetcher> {
+ public:
+  explicit ImagePrefetcher(ResourceBundle* rb)
+      : rb_(rb),
+        decoding_done_(&lock_),
+        decoding_count_(0),
+        generation_(0) {
+  }
+
+  // Posts a task per id in |resource_ids| decoding the image for
+  // |scale_factor|. |callback| runs on the calling thread once they are done.
+  void Prefetch(const std::vector<int>& resource_ids,
+                ScaleFactor scale_factor,
+                const base::Closure& callback) {
+    scoped_refptr<Batch> batch(new Batch(callback));
+    for (size_t i = 0; i < resource_ids.size(); ++i) {
+      base::WorkerPool::PostTask(
+          FROM_HERE,
+          base::Bind(&ImagePrefetcher::Decode, this, resource_ids[i],
+                     scale_factor, batch),
+          true);
+    }
+  }
+
+  // Moves the prefetched rep of |resource_id| for |scale_factor| into |rep|.
+  // Returns false if it hasn't been decoded (yet).
+  bool TakeImage(int resource_id,
+                 ScaleFactor scale_factor,
+                 gfx::ImageSkiaRep* rep) {
+    base::AutoLock lock_scope(lock_);
+    DecodedImages::iterator found =
+        decoded_images_.find(std::make_pair(resource_id, scale_factor));
+    if (found == decoded_images_.end())
+      return false;
+    *rep = found->second;
+    decoded_images_.erase(found);
+    return true;
+  }
+
+  // Drops the prefetched reps of |resource_id| for all scale factors, and
+  // those of decodes still in progress. Invoked once the image is cached,
+  // after which it is never loaded again until Clear() is invoked.
+  void DropImage(int resource_id) {
+    base::AutoLock lock_scope(lock_);
+    cached_ids_.insert(resource_id);
+    DecodedImages::iterator i =
+        decoded_images_.lower_bound(std::make_pair(resource_id,
+                                                  SCALE_FACTOR_NONE));
+    while (i != decoded_images_.end() && i->first.first == resource_id)
+      decoded_images_.erase(i++);
+  }
+
+  // Drops all the prefetched reps, and those of decodes still in progress.
+  // Invoked when the cached images are freed or the resources they were
+  // decoded from change.
+  void Clear() {
+    base::AutoLock lock_scope(lock_);
+    ++generation_;
+    cached_ids_.clear();
+    decoded_images_.clear();
+  }
+
+  size_t image_count() {
+    base::AutoLock lock_scope(lock_);
+    return decoded_images_.size();
+  }
+
+  // Waits for the decodes in progress to finish and drops all the prefetched
+  // images. Later decoding tasks do nothing. Invoked before the
+  // ResourceBundle is destroyed.
+  void Shutdown() {
+    base::AutoLock lock_scope(lock_);
+    rb_ = NULL;
+    while (decoding_count_ > 0)
+      decoding_done_.Wait();
+    decoded_images_.clear();
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<ImagePrefetcher>;
+
+  // Runs the callback of a PrefetchImages() call on the thread it was made on
+  // once the last decoding task of the call releases it.
+  class Batch : public base::RefCountedThreadSafe<Batch> {
+   public:
+    explicit Batch(const base::Closure& callback) : callback_(callback) {
+      if (!callback_.is_null())
+        reply_loop_ = base::MessageLoopProxy::current();
+    }
+
+   private:
+    friend class base::RefCountedThreadSafe<Batch>;
+
+    ~Batch() {
+      if (!callback_.is_null())
+        reply_loop_->PostTask(FROM_HERE, callback_);
+    }
+
+    base::Closure callback_;
+    scoped_refptr<base::MessageLoopProxy> reply_loop_;
+
+    DISALLOW_COPY_AND_ASSIGN(Batch);
+  };
+
+  typedef std::map<std::pair<int, ScaleFactor>, gfx::ImageSkiaRep>
+      DecodedImages;
+
+  ~ImagePrefetcher() {}
+
+  // Decodes one image. |batch| is only held until the decode is done.
+  void Decode(int resource_id,
+              ScaleFactor scale_factor,
+              scoped_refptr<Batch> batch) {
+    ResourceBundle* rb = NULL;
+    int generation = 0;
+    {
+      base::AutoLock lock_scope(lock_);
+      if (!rb_ || cached_ids_.count(resource_id) ||
+          decoded_images_.size() >= kMaxPrefetchedImages) {
+        return;
+      }
+      rb = rb_;
+      generation = generation_;
+      ++decoding_count_;
+    }
+
+    // Shutdown() waits for |decoding_count_| to drop, so |rb| stays valid.
+    gfx::ImageSkiaRep rep = rb->LoadImageRep(resource_id, scale_factor);
+
+    base::AutoLock lock_scope(lock_);
+    --decoding_count_;
+    // GetImageNamed() may have loaded the image itself in the meantime, in
+    // which case nothing would ever take the rep, and the rep is stale if the
+    // prefetcher was cleared while decoding it.
+    if (rb_ && !rep.is_null() && generation == generation_ &&
+        !cached_ids_.count(resource_id) &&
+        decoded_images_.size() < kMaxPrefetchedImages) {
+      decoded_images_[std::make_pair(resource_id, scale_factor)] = rep;
+    }
+    decoding_done_.Signal();
+  }
+
+  // Protects all the members below.
+  base::Lock lock_;
+
+  // NULL once Shutdown() has been invoked.
+  ResourceBundle* rb_;
+
+  // Signaled whenever a decode finishes.
+  base::ConditionVariable decoding_done_;
+
+  // Number of decodes in progress.
+  int decoding_count_;
+
+  DecodedImages decoded_images_;
+
+  // Ids of the images GetImageNamed() has cached since the last Clear().
+  std::set<int> cached_ids_;
+
+  // Incremented by Clear(), so that decodes started before it are dropped.
+  int generation_;
+
+  DISALLOW_COPY_AND_ASSIGN(ImagePrefetcher);
+};
+
 // An ImageSkiaSource that loads bitmaps for the requested scale factor from
 // ResourceBundle on demand for a given |resource_id|. If the bitmap for the
 // requested scale factor does not exist, it will return the 1x bitmap scaled
 // by the scale factor. This may lead to broken UI if the correct size of the
 // scaled image is not exactly |scale_factor| * the size of the 1x resource.
 // When --highlight-missing-scaled-resources flag is specified, scaled 1x images
-// are higlighted by blending them with red.
+// are higlighted by blending them with red. Bitmaps decoded ahead of time by
+// ResourceBundle::PrefetchImages() are used when available.
 class ResourceBundle::ResourceBundleImageSource : public gfx::ImageSkiaSource {
  public:
   ResourceBundleImageSource(ResourceBundle* rb, int resource_id)
@@ -121,37 +323,12 @@ class ResourceBundle::ResourceBundleImageSource : public gfx::ImageSkiaSource {
   // gfx::ImageSkiaSource overrides:
   virtual gfx::ImageSkiaRep GetImageForScale(
       ui::ScaleFactor scale_factor) OVERRIDE {
-    SkBitmap image;
-    bool fell_back_to_1x = false;
-    bool found = rb_->LoadBitmap(resource_id_, &scale_factor,
-                                 &image, &fell_back_to_1x);
-    if (!found)
-      return gfx::ImageSkiaRep();
-
-    if (fell_back_to_1x) {
-      // GRIT fell back to the 100% image, so rescale it to the correct size.
-      float scale = GetScaleFactorScale(scale_factor);
-      image = skia::ImageOperations::Resize(
-          image,
-          skia::ImageOperations::RESIZE_LANCZOS3,
-          gfx::ToFlooredInt(image.width() * scale),
-          gfx::ToFlooredInt(image.height() * scale));
-      // If --highlight-missing-scaled-resources is specified, log the resource
-      // id and blend the created resource with red.
-      if (ShouldHighlightMissingScaledResources()) {
-        LOG(ERROR) << "Missing " << scale << "x scaled resource. id="
-                   << resource_id_;
-
-        SkBitmap mask;
-        mask.setConfig(SkBitmap::kARGB_8888_Config,
-                       image.width(), image.height());
-        mask.allocPixels();
-        mask.eraseColor(SK_ColorRED);
-        image = SkBitmapOperations::CreateBlendedBitmap(image, mask, 0.2);
-      }
+    gfx::ImageSkiaRep rep;
+    if (rb_->image_prefetcher_ &&
+        rb_->image_prefetcher_->TakeImage(resource_id_, scale_factor, &rep)) {
+      return rep;
     }
-
-    return gfx::ImageSkiaRep(image, scale_factor);
+    return rb_->LoadImageRep(resource_id_, scale_factor);
   }
 
  private:
@@ -350,6 +527,9 @@ const FilePath& ResourceBundle::GetOverriddenPakPath() {
 std::string ResourceBundle::ReloadLocaleResources(
     const std::string& pref_locale) {
   base::AutoLock lock_scope(*locale_resources_data_lock_);
+  // Images prefetched from the old locale pack must not outlive it.
+  if (image_prefetcher_)
+    image_prefetcher_->Clear();
   UnloadLocaleResources();
   return LoadLocaleResources(pref_locale);
 }
@@ -363,8 +543,9 @@ gfx::Image& ResourceBundle::GetImageNamed(int resource_id) {
   // Check to see if the image is already in the cache.
   {
     base::AutoLock lock_scope(*images_and_fonts_lock_);
-    if (images_.count(resource_id))
-      return images_[resource_id];
+    ImageMap::iterator found = images_.find(resource_id);
+    if (found != images_.end())
+      return found->second;
   }
 
   gfx::Image image;
@@ -375,18 +556,11 @@ gfx::Image& ResourceBundle::GetImageNamed(int resource_id) {
     DCHECK(!delegate_ && !data_packs_.empty()) <<
         "Missing call to SetResourcesDataDLL?";
 
-    // TODO(oshima): Consider reading the image size from png IHDR chunk and
-    // skip decoding here and remove #ifdef below.
     // ResourceBundle::GetSharedInstance() is destroyed after the
     // BrowserMainLoop has finished running. |image_skia| is guaranteed to be
     // destroyed before the resource bundle is destroyed.
-#if defined(OS_CHROMEOS)
-    ui::ScaleFactor scale_factor_to_load = ui::GetMaxScaleFactor();
-#else
-    ui::ScaleFactor scale_factor_to_load = ui::SCALE_FACTOR_100P;
-#endif
     gfx::ImageSkia image_skia(new ResourceBundleImageSource(this, resource_id),
-                              scale_factor_to_load);
+                              GetScaleFactorToLoad());
     if (image_skia.isNull()) {
       LOG(WARNING) << "Unable to load image with id " << resource_id;
       NOTREACHED();  // Want to assert in debug mode.
@@ -398,20 +572,100 @@ gfx::Image& ResourceBundle::GetImageNamed(int resource_id) {
   }
 
   // The load was successful, so cache the image.
-  base::AutoLock lock_scope(*images_and_fonts_lock_);
+  gfx::Image* cached_image = NULL;
+  {
+    base::AutoLock lock_scope(*images_and_fonts_lock_);
 
-  // Another thread raced the load and has already cached the image.
-  if (images_.count(resource_id))
-    return images_[resource_id];
+    // Another thread raced the load and has already cached the image.
+    ImageMap::iterator found = images_.find(resource_id);
+    if (found != images_.end())
+      return found->second;
 
-  images_[resource_id] = image;
-  return images_[resource_id];
+    if (recording_image_loads_)
+      recorded_image_loads_.push_back(resource_id);
+    cached_image = &images_[resource_id];
+    *cached_image = image;
+  }
+
+  // Any reps prefetched for scale factors not loaded yet are no longer
+  // needed; the cached image loads them itself if asked.
+  if (image_prefetcher_)
+    image_prefetcher_->DropImage(resource_id);
+  return *cached_image;
 }
 
 gfx::Image& ResourceBundle::GetNativeImageNamed(int resource_id) {
   return GetNativeImageNamed(resource_id, RTL_DISABLED);
 }
 
+void ResourceBundle::PrefetchImages(const std::vector<int>& resource_ids,
+                                    const base::Closure& callback) {
+  std::vector<int> to_decode;
+  {
+    base::AutoLock lock_scope(*images_and_fonts_lock_);
+    for (size_t i = 0; i < resource_ids.size(); ++i) {
+      if (!images_.count(resource_ids[i]))
+        to_decode.push_back(resource_ids[i]);
+    }
+  }
+
+  if (!image_prefetcher_)
+    image_prefetcher_ = new ImagePrefetcher(this);
+  image_prefetcher_->Prefetch(to_decode, GetScaleFactorToLoad(), callback);
+}
+
+size_t ResourceBundle::GetPrefetchedImageCount() {
+  return image_prefetcher_ ? image_prefetcher_->image_count() : 0;
+}
+
+void ResourceBundle::StartRecordingImageLoads() {
+  base::AutoLock lock_scope(*images_and_fonts_lock_);
+  recording_image_loads_ = true;
+  recorded_image_loads_.clear();
+}
+
+std::vector<int> ResourceBundle::StopRecordingImageLoads() {
+  base::AutoLock lock_scope(*images_and_fonts_lock_);
+  recording_image_loads_ = false;
+  std::vector<int> resource_ids;
+  resource_ids.swap(recorded_image_loads_);
+  return resource_ids;
+}
+
+// static
+bool ResourceBundle::WriteImageSetToFile(const FilePath& path,
+                                         const std::vector<int>& resource_ids) {
+  // One id per line.
+  std::string contents;
+  for (size_t i = 0; i < resource_ids.size(); ++i) {
+    contents += base::IntToString(resource_ids[i]);
+    contents += '\n';
+  }
+  int size = static_cast<int>(contents.size());
+  return file_util::WriteFile(path, contents.data(), size) == size;
+}
+
+// static
+bool ResourceBundle::ReadImageSetFromFile(const FilePath& path,
+                                          std::vector<int>* resource_ids) {
+  std::string contents;
+  if (!file_util::ReadFileToString(path, &contents))
+    return false;
+
+  std::vector<std::string> lines;
+  base::SplitString(contents, '\n', &lines);
+  resource_ids->clear();
+  for (size_t i = 0; i < lines.size(); ++i) {
+    if (lines[i].empty())
+      continue;
+    int resource_id = 0;
+    if (!base::StringToInt(lines[i], &resource_id))
+      return false;
+    resource_ids->push_back(resource_id);
+  }
+  return true;
+}
+
 base::RefCountedStaticMemory* ResourceBundle::LoadDataResourceBytes(
     int resource_id) const {
   return LoadDataResourceBytesForScale(resource_id, ui::SCALE_FACTOR_NONE);
@@ -448,21 +702,42 @@ base::StringPiece ResourceBundle::GetRawDataResourceForScale(
       delegate_->GetRawDataResource(resource_id, scale_factor, &data))
     return data;
 
+  const ResourceHandle* data_pack = FindDataPack(resource_id, scale_factor);
+  if (data_pack && data_pack->GetStringPiece(resource_id, &data))
+    return data;
+
+  return base::StringPiece();
+}
+
+const ResourceHandle* ResourceBundle::FindDataPack(
+    int resource_id,
+    ScaleFactor scale_factor) const {
+  if (indexed_data_pack_count_ == data_packs_.size()) {
+    ResourceIndex::const_iterator found = resource_index_.end();
+    if (scale_factor != ui::SCALE_FACTOR_100P)
+      found = resource_index_.find(ResourceIndexKey(resource_id, scale_factor));
+    if (found == resource_index_.end()) {
+      found = resource_index_.find(
+          ResourceIndexKey(resource_id, ui::NUM_SCALE_FACTORS));
+    }
+    return found == resource_index_.end() ? NULL : data_packs_[found->second];
+  }
+
+  // Some packs were added without being indexed; search them all in order.
   if (scale_factor != ui::SCALE_FACTOR_100P) {
     for (size_t i = 0; i < data_packs_.size(); i++) {
       if (data_packs_[i]->GetScaleFactor() == scale_factor &&
-          data_packs_[i]->GetStringPiece(resource_id, &data))
-        return data;
+          data_packs_[i]->HasResource(resource_id))
+        return data_packs_[i];
     }
   }
   for (size_t i = 0; i < data_packs_.size(); i++) {
     if ((data_packs_[i]->GetScaleFactor() == ui::SCALE_FACTOR_100P ||
          data_packs_[i]->GetScaleFactor() == ui::SCALE_FACTOR_NONE) &&
-        data_packs_[i]->GetStringPiece(resource_id, &data))
-      return data;
+        data_packs_[i]->HasResource(resource_id))
+      return data_packs_[i];
   }
-
-  return base::StringPiece();
+  return NULL;
 }
 
 string16 ResourceBundle::GetLocalizedString(int message_id) {
@@ -538,22 +813,30 @@ void ResourceBundle::ReloadFonts() {
   base::AutoLock lock_scope(*images_and_fonts_lock_);
   base_font_.reset();
   LoadFontsIfNecessary();
+  // Sizes measured with the old fonts are no longer valid.
+  gfx::TextSizeCache::GetInstance()->Clear();
 }
 
 ResourceBundle::ResourceBundle(Delegate* delegate)
     : delegate_(delegate),
       images_and_fonts_lock_(new base::Lock),
       locale_resources_data_lock_(new base::Lock),
-      max_scale_factor_(SCALE_FACTOR_100P) {
+      indexed_data_pack_count_(0),
+      max_scale_factor_(SCALE_FACTOR_100P),
+      recording_image_loads_(false) {
 }
 
 ResourceBundle::~ResourceBundle() {
+  if (image_prefetcher_)
+    image_prefetcher_->Shutdown();
   FreeImages();
   UnloadLocaleResources();
 }
 
 void ResourceBundle::FreeImages() {
   images_.clear();
+  if (image_prefetcher_)
+    image_prefetcher_->Clear();
 }
 
 void ResourceBundle::AddDataPackFromPathInternal(const FilePath& path,
@@ -584,6 +867,27 @@ void ResourceBundle::AddDataPackFromPathInternal(const FilePath& path,
 void ResourceBundle::AddDataPack(DataPack* data_pack) {
   data_packs_.push_back(data_pack);
 
+  // Earlier packs take precedence, so only ids not seen yet are added. Once a
+  // pack has been added without going through here the index is not used.
+  if (indexed_data_pack_count_ + 1 == data_packs_.size()) {
+    const size_t pack_index = data_packs_.size() - 1;
+    const ScaleFactor scale_factor = data_pack->GetScaleFactor();
+    const bool is_default = scale_factor == ui::SCALE_FACTOR_100P ||
+                            scale_factor == ui::SCALE_FACTOR_NONE;
+    std::vector<uint16> resource_ids;
+    data_pack->GetResourceIds(&resource_ids);
+    for (size_t i = 0; i < resource_ids.size(); ++i) {
+      resource_index_.insert(std::make_pair(
+          ResourceIndexKey(resource_ids[i], scale_factor), pack_index));
+      if (is_default) {
+        resource_index_.insert(std::make_pair(
+            ResourceIndexKey(resource_ids[i], ui::NUM_SCALE_FACTORS),
+            pack_index));
+      }
+    }
+    ++indexed_data_pack_count_;
+  }
+
   if (GetScaleFactorScale(data_pack->GetScaleFactor()) >
       GetScaleFactorScale(max_scale_factor_))
     max_scale_factor_ = data_pack->GetScaleFactor();
@@ -654,8 +958,10 @@ bool ResourceBundle::LoadBitmap(const ResourceHandle& data_handle,
                                 SkBitmap* bitmap,
                                 bool* fell_back_to_1x) const {
   DCHECK(fell_back_to_1x);
+  // The encoded bytes are only needed while decoding, so let compressed packs
+  // drop them afterwards.
   scoped_refptr<base::RefCountedMemory> memory(
-      data_handle.GetStaticMemory(resource_id));
+      data_handle.GetMemory(resource_id));
   if (!memory)
     return false;
 
@@ -701,6 +1007,41 @@ bool ResourceBundle::LoadBitmap(int resource_id,
   return false;
 }
 
+gfx::ImageSkiaRep ResourceBundle::LoadImageRep(
+    int resource_id,
+    ScaleFactor scale_factor) const {
+  SkBitmap image;
+  bool fell_back_to_1x = false;
+  bool found = LoadBitmap(resource_id, &scale_factor, &image, &fell_back_to_1x);
+  if (!found)
+    return gfx::ImageSkiaRep();
+
+  if (fell_back_to_1x) {
+    // GRIT fell back to the 100% image, so rescale it to the correct size.
+    float scale = GetScaleFactorScale(scale_factor);
+    image = skia::ImageOperations::Resize(
+        image,
+        skia::ImageOperations::RESIZE_LANCZOS3,
+        gfx::ToFlooredInt(image.width() * scale),
+        gfx::ToFlooredInt(image.height() * scale));
+    // If --highlight-missing-scaled-resources is specified, log the resource
+    // id and blend the created resource with red.
+    if (ShouldHighlightMissingScaledResources()) {
+      LOG(ERROR) << "Missing " << scale << "x scaled resource. id="
+                 << resource_id;
+
+      SkBitmap mask;
+      mask.setConfig(SkBitmap::kARGB_8888_Config,
+                     image.width(), image.height());
+      mask.allocPixels();
+      mask.eraseColor(SK_ColorRED);
+      image = SkBitmapOperations::CreateBlendedBitmap(image, mask, 0.2);
+    }
+  }
+
+  return gfx::ImageSkiaRep(image, scale_factor);
+}
+
 gfx::Image& ResourceBundle::GetEmptyImage() {
   base::AutoLock lock(*images_and_fonts_lock_);
 
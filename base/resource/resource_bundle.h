@@ -9,10 +9,14 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "base/basictypes.h"
+#include "base/callback_forward.h"
 #include "base/file_path.h"
 #include "base/gtest_prod_util.h"
+#include "base/hash_tables.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
 #include "base/platform_file.h"
@@ -31,6 +35,10 @@ class Lock;
 class RefCountedStaticMemory;
 }
 
+namespace gfx {
+class ImageSkiaRep;
+}
+
 namespace ui {
 
 class DataPack;
@@ -203,6 +211,31 @@ class UI_EXPORT ResourceBundle {
   // Same as GetNativeImageNamed() except that RTL is not enabled.
   gfx::Image& GetNativeImageNamed(int resource_id);
 
+  // Decodes the images with the given resource ids on the worker pool so that
+  // a later GetImageNamed() doesn't block on decoding them. |callback|, which
+  // may be null, is run on the calling thread once all the images have been
+  // decoded. Images are decoded at the scale factor GetImageNamed() loads
+  // first, and dropped once the image is cached; a bounded number are held
+  // at a time. Must be called after all the data packs have been added.
+  void PrefetchImages(const std::vector<int>& resource_ids,
+                      const base::Closure& callback);
+
+  // Starts recording the ids of the images GetImageNamed() loads, e.g. to
+  // capture the images needed by the first frame at startup. Replaying the
+  // ids with PrefetchImages() on the next launch moves their decoding off the
+  // UI thread.
+  void StartRecordingImageLoads();
+
+  // Stops recording and returns the ids recorded, in the order loaded.
+  std::vector<int> StopRecordingImageLoads();
+
+  // Saves and restores a set of image resource ids, such as the one returned
+  // by StopRecordingImageLoads(). Return false on failure.
+  static bool WriteImageSetToFile(const FilePath& path,
+                                  const std::vector<int>& resource_ids);
+  static bool ReadImageSetFromFile(const FilePath& path,
+                                   std::vector<int>* resource_ids);
+
   // Loads the raw bytes of a scale independent data resource.
   base::RefCountedStaticMemory* LoadDataResourceBytes(int resource_id) const;
 
@@ -265,6 +298,9 @@ class UI_EXPORT ResourceBundle {
   class ResourceBundleImageSource;
   friend class ResourceBundleImageSource;
 
+  class ImagePrefetcher;
+  friend class ImagePrefetcher;
+
   // Ctor/dtor are private, since we're a singleton.
   explicit ResourceBundle(Delegate* delegate);
   ~ResourceBundle();
@@ -272,6 +308,10 @@ class UI_EXPORT ResourceBundle {
   // Free skia_images_.
   void FreeImages();
 
+  // Returns the number of images PrefetchImages() has decoded that have not
+  // been requested yet.
+  size_t GetPrefetchedImageCount();
+
   // Load the main resources.
   void LoadCommonResources();
 
@@ -281,10 +321,15 @@ class UI_EXPORT ResourceBundle {
                                    ScaleFactor scale_factor,
                                    bool optional);
 
-  // Inserts |data_pack| to |data_pack_| and updates |max_scale_factor_|
-  // accordingly.
+  // Inserts |data_pack| to |data_pack_| and updates |max_scale_factor_| and
+  // |resource_index_| accordingly.
   void AddDataPack(DataPack* data_pack);
 
+  // Returns the data pack GetRawDataResourceForScale() reads |resource_id|
+  // for |scale_factor| from, or NULL if there is none.
+  const ResourceHandle* FindDataPack(int resource_id,
+                                     ScaleFactor scale_factor) const;
+
   // Try to load the locale specific strings from an external data module.
   // Returns the locale that is loaded.
   std::string LoadLocaleResources(const std::string& pref_locale);
@@ -319,6 +364,12 @@ class UI_EXPORT ResourceBundle {
                   SkBitmap* bitmap,
                   bool* fell_back_to_1x) const;
 
+  // Decodes the image rep of |resource_id| for |scale_factor|, rescaling the
+  // 1x bitmap if GRIT fell back to it. Returns a null rep if the resource does
+  // not exist. May be called on any thread.
+  gfx::ImageSkiaRep LoadImageRep(int resource_id,
+                                 ScaleFactor scale_factor) const;
+
   // Returns an empty image for when a resource cannot be loaded. This is a
   // bright red bitmap.
   gfx::Image& GetEmptyImage();
@@ -329,7 +380,7 @@ class UI_EXPORT ResourceBundle {
   // be NULL.
   Delegate* delegate_;
 
-  // Protects |images_| and font-related members.
+  // Protects |images_|, the image load recording and font-related members.
   scoped_ptr<base::Lock> images_and_fonts_lock_;
 
   // Protects |locale_resources_data_|.
@@ -339,14 +390,30 @@ class UI_EXPORT ResourceBundle {
   scoped_ptr<ResourceHandle> locale_resources_data_;
   ScopedVector<ResourceHandle> data_packs_;
 
+  // Maps a resource id and the group of packs it is looked up in (see
+  // ResourceIndexKey() in the .cc file) to the index in |data_packs_| of the
+  // first pack of the group containing the resource. Only valid while every
+  // pack in |data_packs_| went through AddDataPack(), i.e. while
+  // |indexed_data_pack_count_| equals the number of packs.
+  typedef base::hash_map<uint32, size_t> ResourceIndex;
+  ResourceIndex resource_index_;
+  size_t indexed_data_pack_count_;
+
   // The maximum scale factor currently loaded.
   ScaleFactor max_scale_factor_;
 
   // Cached images. The ResourceBundle caches all retrieved images and keeps
   // ownership of the pointers.
-  typedef std::map<int, gfx::Image> ImageMap;
+  typedef base::hash_map<int, gfx::Image> ImageMap;
   ImageMap images_;
 
+  // Images decoded ahead of time by PrefetchImages().
+  scoped_refptr<ImagePrefetcher> image_prefetcher_;
+
+  // See StartRecordingImageLoads().
+  bool recording_image_loads_;
+  std::vector<int> recorded_image_loads_;
+
   gfx::Image empty_image_;
 
   // The various fonts used. Cached to avoid repeated GDI creation/destruction.
@@ -10,7 +10,9 @@
 #include "base/files/scoped_temp_dir.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted_memory.h"
+#include "base/message_loop.h"
 #include "base/path_service.h"
+#include "base/run_loop.h"
 #include "base/utf_string_conversions.h"
 #include "net/base/big_endian.h"
 #include "testing/gmock/include/gmock/gmock.h"
@@ -364,6 +366,14 @@ class ResourceBundleImageTest : public ResourceBundleTest {
   // Returns the path of temporary directory to write test data packs into.
   const FilePath& dir_path() { return dir_.path(); }
 
+  size_t GetPrefetchedImageCount(ResourceBundle* resource_bundle) {
+    return resource_bundle->GetPrefetchedImageCount();
+  }
+
+  void FreeImages(ResourceBundle* resource_bundle) {
+    resource_bundle->FreeImages();
+  }
+
  private:
   scoped_ptr<DataPack> locale_pack_;
   base::ScopedTempDir dir_;
@@ -513,4 +523,120 @@ TEST_F(ResourceBundleImageTest, FallbackToNone) {
             image_skia->image_reps()[0].scale_factor());
 }
 
+// Test that the first pack of a scale factor containing a resource wins, and
+// that 1x and scale independent packs back up other scale factors.
+TEST_F(ResourceBundleImageTest, DataPackPrecedence) {
+  FilePath first_path = dir_path().AppendASCII("first.pak");
+  FilePath second_path = dir_path().AppendASCII("second.pak");
+  FilePath none_path = dir_path().AppendASCII("none.pak");
+
+  std::map<uint16, base::StringPiece> resources;
+  resources[1] = "first 1";
+  ASSERT_TRUE(DataPack::WritePack(first_path, resources, DataPack::BINARY));
+  resources[1] = "second 1";
+  resources[2] = "second 2";
+  ASSERT_TRUE(DataPack::WritePack(second_path, resources, DataPack::BINARY));
+  resources.clear();
+  resources[3] = "none 3";
+  ASSERT_TRUE(DataPack::WritePack(none_path, resources, DataPack::BINARY));
+
+  ResourceBundle* resource_bundle = CreateResourceBundleWithEmptyLocalePak();
+  resource_bundle->AddDataPackFromPath(first_path, SCALE_FACTOR_100P);
+  resource_bundle->AddDataPackFromPath(second_path, SCALE_FACTOR_200P);
+  resource_bundle->AddDataPackFromPath(none_path, SCALE_FACTOR_NONE);
+
+  EXPECT_EQ("first 1",
+            resource_bundle->GetRawDataResourceForScale(1, SCALE_FACTOR_100P));
+  EXPECT_EQ("second 1",
+            resource_bundle->GetRawDataResourceForScale(1, SCALE_FACTOR_200P));
+  EXPECT_EQ("second 2",
+            resource_bundle->GetRawDataResourceForScale(2, SCALE_FACTOR_200P));
+  EXPECT_EQ("", resource_bundle->GetRawDataResourceForScale(
+      2, SCALE_FACTOR_100P));
+  EXPECT_EQ("none 3",
+            resource_bundle->GetRawDataResourceForScale(3, SCALE_FACTOR_200P));
+  EXPECT_EQ("none 3", resource_bundle->GetRawDataResource(3));
+}
+
+// Test that images prefetched on the worker pool are used by GetImageNamed().
+TEST_F(ResourceBundleImageTest, PrefetchImages) {
+  MessageLoopForUI message_loop;
+  FilePath data_path = dir_path().AppendASCII("sample.pak");
+  CreateDataPackWithSingleBitmap(data_path, 10, base::StringPiece());
+
+  ResourceBundle* resource_bundle = CreateResourceBundleWithEmptyLocalePak();
+  resource_bundle->AddDataPackFromPath(data_path, SCALE_FACTOR_100P);
+
+  base::RunLoop run_loop;
+  resource_bundle->PrefetchImages(std::vector<int>(1, 3),
+                                  run_loop.QuitClosure());
+  run_loop.Run();
+  EXPECT_EQ(1u, GetPrefetchedImageCount(resource_bundle));
+
+  resource_bundle->StartRecordingImageLoads();
+  gfx::ImageSkia* image_skia = resource_bundle->GetImageSkiaNamed(3);
+  ASSERT_EQ(1u, image_skia->image_reps().size());
+  EXPECT_EQ(10, image_skia->image_reps()[0].pixel_width());
+  EXPECT_EQ(0u, GetPrefetchedImageCount(resource_bundle));
+  // Cached images are not recorded again.
+  resource_bundle->GetImageSkiaNamed(3);
+  std::vector<int> recorded = resource_bundle->StopRecordingImageLoads();
+  ASSERT_EQ(1u, recorded.size());
+  EXPECT_EQ(3, recorded[0]);
+}
+
+// Test that an image loaded before its prefetch is done isn't kept around.
+TEST_F(ResourceBundleImageTest, PrefetchRacingLoad) {
+  MessageLoopForUI message_loop;
+  FilePath data_path = dir_path().AppendASCII("sample.pak");
+  CreateDataPackWithSingleBitmap(data_path, 10, base::StringPiece());
+
+  ResourceBundle* resource_bundle = CreateResourceBundleWithEmptyLocalePak();
+  resource_bundle->AddDataPackFromPath(data_path, SCALE_FACTOR_100P);
+
+  base::RunLoop run_loop;
+  resource_bundle->PrefetchImages(std::vector<int>(1, 3),
+                                  run_loop.QuitClosure());
+  gfx::ImageSkia* image_skia = resource_bundle->GetImageSkiaNamed(3);
+  ASSERT_EQ(1u, image_skia->image_reps().size());
+  EXPECT_EQ(10, image_skia->image_reps()[0].pixel_width());
+  run_loop.Run();
+  EXPECT_EQ(0u, GetPrefetchedImageCount(resource_bundle));
+}
+
+// Test that freeing the cached images drops the prefetched ones too.
+TEST_F(ResourceBundleImageTest, FreeImagesClearsPrefetch) {
+  MessageLoopForUI message_loop;
+  FilePath data_path = dir_path().AppendASCII("sample.pak");
+  CreateDataPackWithSingleBitmap(data_path, 10, base::StringPiece());
+
+  ResourceBundle* resource_bundle = CreateResourceBundleWithEmptyLocalePak();
+  resource_bundle->AddDataPackFromPath(data_path, SCALE_FACTOR_100P);
+
+  base::RunLoop run_loop;
+  resource_bundle->PrefetchImages(std::vector<int>(1, 3),
+                                  run_loop.QuitClosure());
+  run_loop.Run();
+  EXPECT_EQ(1u, GetPrefetchedImageCount(resource_bundle));
+
+  FreeImages(resource_bundle);
+  EXPECT_EQ(0u, GetPrefetchedImageCount(resource_bundle));
+}
+
+// Test that a recorded image set survives a round trip through a file.
+TEST_F(ResourceBundleImageTest, ImageSetFile) {
+  FilePath path = dir_path().AppendASCII("startup_images");
+  std::vector<int> resource_ids;
+  resource_ids.push_back(3);
+  resource_ids.push_back(12345);
+  ASSERT_TRUE(ResourceBundle::WriteImageSetToFile(path, resource_ids));
+
+  std::vector<int> read_ids;
+  ASSERT_TRUE(ResourceBundle::ReadImageSetFromFile(path, &read_ids));
+  EXPECT_EQ(resource_ids, read_ids);
+
+  EXPECT_FALSE(ResourceBundle::ReadImageSetFromFile(
+      dir_path().AppendASCII("missing"), &read_ids));
+}
+
 }  // namespace ui
@@ -6,14 +6,11 @@
 #define UI_BASE_RESOURCE_RESOURCE_HANDLE_H_
 
 #include "base/basictypes.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/string_piece.h"
 #include "ui/base/layout.h"
 #include "ui/base/ui_export.h"
 
-namespace base {
-class RefCountedStaticMemory;
-}
-
 namespace ui {
 
 class UI_EXPORT ResourceHandle {
@@ -41,6 +38,16 @@ class UI_EXPORT ResourceHandle {
   virtual base::RefCountedStaticMemory* GetStaticMemory(
       uint16 resource_id) const = 0;
 
+  // Like GetStaticMemory(), but the returned memory may be owned by the
+  // returned object rather than by the handle. Handles that store resources
+  // in a different form than they are returned in (e.g. compressed) override
+  // this so that the converted data only lives as long as it is used.
+  // Returns NULL if the resource id isn't found.
+  virtual scoped_refptr<base::RefCountedMemory> GetMemory(
+      uint16 resource_id) const {
+    return GetStaticMemory(resource_id);
+  }
+
   // Get the encoding type of text resources.
   virtual TextEncodingType GetTextEncodingType() const = 0;
 
@@ -28,6 +28,7 @@
 #include "third_party/icu/public/common/unicode/rbbi.h"
 #include "third_party/icu/public/common/unicode/uloc.h"
 #include "ui/gfx/font.h"
+#include "ui/gfx/render_text.h"
 
 namespace ui {
 
@@ -99,6 +100,159 @@ class StringSlicer {
   DISALLOW_COPY_AND_ASSIGN(StringSlicer);
 };
 
+// Strings at least this long are elided by repeated measurement instead of
+// being shaped as a whole; this matches the length beyond which
+// Canvas::SizeStringInt() stops shaping text.
+const size_t kMaxShapedTextLength = 5000;
+
+// The cut priced from grapheme widths is usually off by at most a grapheme or
+// two, from rounding or kerning around the ellipsis. It is nudged by at most
+// this many code units before the remaining range is binary searched by
+// measuring candidates.
+const size_t kMaxElideNudges = 3;
+
+// Shapes a string once and answers width queries for any prefix, suffix, or
+// prefix + suffix pair cut at grapheme boundaries. Widths come from the glyph
+// positions of the fully shaped string, so kerning, ligatures (which are never
+// split) and RTL runs are accounted for without re-measuring each candidate.
+class GraphemeWidthIndex {
+ public:
+  GraphemeWidthIndex(const string16& text, const gfx::Font& font) {
+    scoped_ptr<gfx::RenderText> render_text(gfx::RenderText::CreateInstance());
+    render_text->SetFont(font);
+    render_text->SetText(text);
+    render_text->SetStyle(gfx::BOLD, (font.GetStyle() & gfx::Font::BOLD) != 0);
+    render_text->SetStyle(gfx::ITALIC,
+                          (font.GetStyle() & gfx::Font::ITALIC) != 0);
+    render_text->SetStyle(gfx::UNDERLINE,
+                          (font.GetStyle() & gfx::Font::UNDERLINE) != 0);
+    render_text->GetGraphemePrefixWidths(&prefix_widths_);
+  }
+
+  size_t length() const { return prefix_widths_.size() - 1; }
+
+  // Returns the largest valid cut point at or before |index|.
+  size_t BoundaryBefore(size_t index) const {
+    DCHECK_LE(index, length());
+    while (prefix_widths_[index] < 0)
+      --index;
+    return index;
+  }
+
+  // Returns the smallest valid cut point at or after |index|.
+  size_t BoundaryAfter(size_t index) const {
+    DCHECK_LE(index, length());
+    while (prefix_widths_[index] < 0)
+      ++index;
+    return index;
+  }
+
+  // Computes the valid cut points that keep |kept| code units of the text:
+  // the kept prefix is [0, |prefix_end|) and the kept suffix (non-empty only
+  // when |elide_in_middle|) is [|suffix_start|, length()). As in StringSlicer,
+  // text elided in the middle puts the extra character, if any, before the
+  // cut. Returns the width of the kept text.
+  int GetCut(size_t kept,
+             bool elide_in_middle,
+             size_t* prefix_end,
+             size_t* suffix_start) const {
+    const size_t half = elide_in_middle ? kept / 2 : 0;
+    *prefix_end = BoundaryBefore(kept - half);
+    *suffix_start = BoundaryAfter(length() - half);
+    return prefix_widths_[*prefix_end] +
+        (prefix_widths_.back() - prefix_widths_[*suffix_start]);
+  }
+
+ private:
+  std::vector<int> prefix_widths_;
+
+  DISALLOW_COPY_AND_ASSIGN(GraphemeWidthIndex);
+};
+
+// Returns |text| cut to keep |kept| code units around |ellipsis|.
+string16 CutAtGraphemes(const string16& text,
+                        const GraphemeWidthIndex& widths,
+                        size_t kept,
+                        const string16& ellipsis,
+                        bool elide_in_middle) {
+  size_t prefix_end = 0;
+  size_t suffix_start = 0;
+  widths.GetCut(kept, elide_in_middle, &prefix_end, &suffix_start);
+  return text.substr(0, prefix_end) + ellipsis + text.substr(suffix_start);
+}
+
+// Elides |text|, which is known not to fit, with a single shaping pass. Every
+// candidate cut is priced from the per-grapheme widths of the shaped text; the
+// chosen candidate is then measured as a whole and nudged by a few graphemes
+// if the ellipsis kerns or rounds differently than the sum of its parts. If
+// that doesn't settle it, the cut is binary searched between the candidates
+// measured so far, so at most O(log n) more strings are measured.
+string16 ElideShapedText(const string16& text,
+                         const gfx::Font& font,
+                         int available_pixel_width,
+                         const string16& ellipsis,
+                         bool elide_in_middle) {
+  const GraphemeWidthIndex widths(text, font);
+  const size_t length = widths.length();
+  const int ellipsis_width = ellipsis.empty() ? 0 :
+      font.GetStringWidth(ellipsis);
+
+  // Widths grow monotonically with the number of kept code units, so binary
+  // search for the most that fit. Keeping nothing is the fallback, whether or
+  // not it fits, and keeping everything never fits.
+  size_t lo = 0;
+  size_t hi = length;
+  size_t prefix_end = 0;
+  size_t suffix_start = 0;
+  while (hi - lo > 1) {
+    const size_t guess = lo + (hi - lo) / 2;
+    const int guess_width =
+        widths.GetCut(guess, elide_in_middle, &prefix_end, &suffix_start);
+    if (guess_width + ellipsis_width <= available_pixel_width)
+      lo = guess;
+    else
+      hi = guess;
+  }
+
+  // Check the estimate against the width of the whole elided string, and
+  // narrow [lo, hi) so that keeping |lo| code units fits (or is the fallback)
+  // and keeping |hi| doesn't.
+  const size_t estimate = lo;
+  string16 elided =
+      CutAtGraphemes(text, widths, estimate, ellipsis, elide_in_middle);
+  if (font.GetStringWidth(elided) <= available_pixel_width) {
+    hi = length;
+    for (size_t nudges = 0; nudges < kMaxElideNudges && lo + 1 < hi;
+         ++nudges) {
+      const string16 longer =
+          CutAtGraphemes(text, widths, lo + 1, ellipsis, elide_in_middle);
+      if (font.GetStringWidth(longer) > available_pixel_width)
+        return elided;
+      elided = longer;
+      ++lo;
+    }
+  } else {
+    hi = estimate;
+    lo = 0;
+    for (size_t nudges = 0; nudges < kMaxElideNudges && hi > 0; ++nudges) {
+      elided = CutAtGraphemes(text, widths, --hi, ellipsis, elide_in_middle);
+      if (hi == 0 || font.GetStringWidth(elided) <= available_pixel_width)
+        return elided;
+    }
+  }
+
+  while (hi - lo > 1) {
+    const size_t guess = lo + (hi - lo) / 2;
+    const string16 candidate =
+        CutAtGraphemes(text, widths, guess, ellipsis, elide_in_middle);
+    if (font.GetStringWidth(candidate) <= available_pixel_width)
+      lo = guess;
+    else
+      hi = guess;
+  }
+  return CutAtGraphemes(text, widths, lo, ellipsis, elide_in_middle);
+}
+
 // Build a path from the first |num_components| elements in |path_elements|.
 // Prepends |path_prefix|, appends |filename|, inserts ellipsis if appropriate.
 string16 BuildPathFromComponents(const string16& path_prefix,
@@ -481,7 +635,14 @@ string16 ElideText(const string16& text,
   if (font.GetStringWidth(kEllipsisUTF16) > available_pixel_width)
     return string16();
 
-  // Use binary search to compute the elided text.
+  if (text.length() < kMaxShapedTextLength) {
+    return ElideShapedText(text, font, available_pixel_width,
+                           insert_ellipsis ? kEllipsisUTF16 : string16(),
+                           elide_in_middle);
+  }
+
+  // Very long strings are not shaped as a whole, so binary search for the cut
+  // by measuring candidates.
   size_t lo = 0;
   size_t hi = text.length() - 1;
   size_t guess;
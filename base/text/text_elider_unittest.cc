@@ -334,6 +334,35 @@ TEST(TextEliderTest, ElideTextTruncate) {
   }
 }
 
+// Checks that elided text always fits and keeps the start (and, when eliding in
+// the middle, the end) of the original text, and that eliding at the end keeps
+// as much as fits.
+TEST(TextEliderTest, ElideTextFitsAvailableWidth) {
+  const gfx::Font font;
+  const string16 kEllipsisUTF16 = UTF8ToUTF16(kEllipsis);
+  const string16 text = ASCIIToUTF16("The quick brown fox jumps over the dog");
+  const int full_width = font.GetStringWidth(text);
+  const int ellipsis_width = font.GetStringWidth(kEllipsisUTF16);
+
+  for (int width = ellipsis_width; width < full_width; width += 3) {
+    const string16 at_end = ElideText(text, font, width, ELIDE_AT_END);
+    EXPECT_LE(font.GetStringWidth(at_end), width);
+    ASSERT_GE(at_end.length(), kEllipsisUTF16.length());
+    const size_t kept = at_end.length() - kEllipsisUTF16.length();
+    EXPECT_EQ(text.substr(0, kept) + kEllipsisUTF16, at_end);
+    EXPECT_GT(font.GetStringWidth(text.substr(0, kept + 1) + kEllipsisUTF16),
+              width);
+
+    const string16 in_middle = ElideText(text, font, width, ELIDE_IN_MIDDLE);
+    EXPECT_LE(font.GetStringWidth(in_middle), width);
+    const size_t cut = in_middle.find(kEllipsisUTF16);
+    ASSERT_NE(string16::npos, cut);
+    EXPECT_EQ(text.substr(0, cut), in_middle.substr(0, cut));
+    const string16 suffix = in_middle.substr(cut + kEllipsisUTF16.length());
+    EXPECT_EQ(text.substr(text.length() - suffix.length()), suffix);
+  }
+}
+
 // Checks that all occurrences of |first_char| are followed by |second_char| and
 // all occurrences of |second_char| are preceded by |first_char| in |text|.
 static void CheckSurrogatePairs(const string16& text,
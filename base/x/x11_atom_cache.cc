@@ -13,7 +13,8 @@ namespace ui {
 
 X11AtomCache::X11AtomCache(Display* xdisplay, const char** to_cache)
     : xdisplay_(xdisplay),
-      uncached_atoms_allowed_(false) {
+      uncached_atoms_allowed_(false),
+      uncached_atom_count_(0) {
   int cache_count = 0;
   for (const char** i = to_cache; *i != NULL; i++)
     cache_count++;
@@ -36,6 +37,7 @@ X11AtomCache::~X11AtomCache() {}
 
   if (uncached_atoms_allowed_ && it == cached_atoms_.end()) {
     ::Atom atom = XInternAtom(xdisplay_, name, false);
+    uncached_atom_count_++;
     cached_atoms_.insert(std::make_pair(name, atom));
     return atom;
   }
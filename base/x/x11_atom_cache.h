@@ -35,11 +35,17 @@ class UI_EXPORT X11AtomCache {
   // up, cache it locally, and then return the result.
   void allow_uncached_atoms() { uncached_atoms_allowed_ = true; }
 
+  // Returns the number of atoms that weren't pre-interned and had to be
+  // fetched from the x server one at a time.
+  int uncached_atom_count() const { return uncached_atom_count_; }
+
  private:
   Display* xdisplay_;
 
   bool uncached_atoms_allowed_;
 
+  mutable int uncached_atom_count_;
+
   mutable std::map<std::string, ::Atom> cached_atoms_;
 
   DISALLOW_COPY_AND_ASSIGN(X11AtomCache);
@@ -0,0 +1,93 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/base/x/x11_property_cache.h"
+
+#include "base/logging.h"
+#include "base/memory/singleton.h"
+
+namespace ui {
+
+X11PropertyValue::X11PropertyValue()
+    : type(None),
+      format(0),
+      num_items(0) {
+}
+
+X11PropertyValue::~X11PropertyValue() {
+}
+
+// static
+size_t X11PropertyValue::BytesPerItem(int format) {
+  switch (format) {
+    case 8:
+      return sizeof(char);
+    case 16:
+      return sizeof(short);
+    case 32:
+      return sizeof(long);
+  }
+  return 0;
+}
+
+// static
+X11PropertyCache* X11PropertyCache::GetInstance() {
+  return Singleton<X11PropertyCache>::get();
+}
+
+X11PropertyCache::X11PropertyCache() {
+}
+
+X11PropertyCache::~X11PropertyCache() {
+}
+
+void X11PropertyCache::WatchWindow(XID window) {
+  DCHECK(CalledOnValidThread());
+  windows_[window];
+}
+
+void X11PropertyCache::UnwatchWindow(XID window) {
+  DCHECK(CalledOnValidThread());
+  windows_.erase(window);
+}
+
+bool X11PropertyCache::IsWatched(XID window) const {
+  DCHECK(CalledOnValidThread());
+  return windows_.find(window) != windows_.end();
+}
+
+void X11PropertyCache::OnPropertyNotify(const XPropertyEvent& event) {
+  Invalidate(event.window, event.atom);
+}
+
+void X11PropertyCache::Invalidate(XID window, ::Atom property) {
+  DCHECK(CalledOnValidThread());
+  WindowMap::iterator i = windows_.find(window);
+  if (i != windows_.end())
+    i->second.erase(property);
+}
+
+const X11PropertyValue* X11PropertyCache::Lookup(XID window,
+                                                 ::Atom property) const {
+  DCHECK(CalledOnValidThread());
+  WindowMap::const_iterator i = windows_.find(window);
+  if (i == windows_.end())
+    return NULL;
+  PropertyMap::const_iterator j = i->second.find(property);
+  return j == i->second.end() ? NULL : &j->second;
+}
+
+void X11PropertyCache::Store(XID window,
+                             ::Atom property,
+                             const X11PropertyValue& value) {
+  DCHECK(CalledOnValidThread());
+  WindowMap::iterator i = windows_.find(window);
+  if (i == windows_.end())
+    return;
+  DCHECK_EQ(value.num_items * X11PropertyValue::BytesPerItem(value.format),
+            value.data.size());
+  i->second[property] = value;
+}
+
+}  // namespace ui
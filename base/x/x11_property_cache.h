@@ -0,0 +1,91 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_BASE_X_X11_PROPERTY_CACHE_H_
+#define UI_BASE_X_X11_PROPERTY_CACHE_H_
+
+#include <X11/Xlib.h>
+
+#include <map>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/threading/non_thread_safe.h"
+#include "ui/base/ui_export.h"
+
+// Get rid of a macro from Xlib.h that conflicts with Aura's RootWindow class.
+#undef RootWindow
+
+template <typename T> struct DefaultSingletonTraits;
+
+namespace ui {
+
+// The result of an XGetWindowProperty() call. |data| holds |num_items| items
+// laid out the way Xlib returns them, i.e. format 32 items are longs.
+struct UI_EXPORT X11PropertyValue {
+  X11PropertyValue();
+  ~X11PropertyValue();
+
+  // Size in bytes of a single item of |format| as stored in |data|.
+  static size_t BytesPerItem(int format);
+
+  ::Atom type;
+  int format;
+  unsigned long num_items;
+  std::vector<unsigned char> data;
+};
+
+// Caches the properties of windows we watch so that repeated reads don't have
+// to go to the X server. The owner of a watched window must select
+// PropertyChangeMask on it, forward its PropertyNotify events to
+// OnPropertyNotify() before handling them, and call UnwatchWindow() before
+// destroying it. Properties of other windows are never cached.
+//
+// Cached values reflect the last PropertyNotify event processed, so a change
+// made by another client is only seen once its event has been dispatched.
+// Changes made by this process must call Invalidate() as they are made, as
+// their events arrive later.
+//
+// The cache must only be used on the thread that first uses it, the one
+// processing X events.
+class UI_EXPORT X11PropertyCache : public base::NonThreadSafe {
+ public:
+  static X11PropertyCache* GetInstance();
+
+  void WatchWindow(XID window);
+  void UnwatchWindow(XID window);
+  bool IsWatched(XID window) const;
+
+  // Drops the cached value of the property named in |event|.
+  void OnPropertyNotify(const XPropertyEvent& event);
+
+  // Drops the cached value of |property| on |window|. Invoked when changing
+  // or deleting the property.
+  void Invalidate(XID window, ::Atom property);
+
+  // Returns the cached value of |property| on |window|, or NULL if there is
+  // none. Missing properties are cached too, as values of type None.
+  const X11PropertyValue* Lookup(XID window, ::Atom property) const;
+
+  // Caches |value| as the value of |property| on |window|. Does nothing if
+  // |window| isn't watched.
+  void Store(XID window, ::Atom property, const X11PropertyValue& value);
+
+ private:
+  friend struct DefaultSingletonTraits<X11PropertyCache>;
+
+  typedef std::map< ::Atom, X11PropertyValue> PropertyMap;
+  typedef std::map<XID, PropertyMap> WindowMap;
+
+  X11PropertyCache();
+  ~X11PropertyCache();
+
+  WindowMap windows_;
+
+  DISALLOW_COPY_AND_ASSIGN(X11PropertyCache);
+};
+
+}  // namespace ui
+
+#endif  // UI_BASE_X_X11_PROPERTY_CACHE_H_
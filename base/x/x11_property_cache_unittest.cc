@@ -0,0 +1,103 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/base/x/x11_property_cache.h"
+
+#include <X11/Xatom.h>
+
+// Generically-named #defines from Xlib that conflict with symbols in GTest.
+#undef Bool
+#undef None
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace ui {
+
+namespace {
+
+const XID kWindow = 0x1234;
+const ::Atom kFirstAtom = 100;
+const ::Atom kSecondAtom = 101;
+
+X11PropertyValue MakeCardinal(long cardinal) {
+  X11PropertyValue value;
+  value.type = XA_CARDINAL;
+  value.format = 32;
+  value.num_items = 1;
+  const unsigned char* bytes = reinterpret_cast<unsigned char*>(&cardinal);
+  value.data.assign(bytes, bytes + sizeof(cardinal));
+  return value;
+}
+
+XPropertyEvent MakePropertyNotify(XID window, ::Atom atom) {
+  XPropertyEvent event = {0};
+  event.type = PropertyNotify;
+  event.window = window;
+  event.atom = atom;
+  return event;
+}
+
+}  // namespace
+
+TEST(X11PropertyCacheTest, OnlyWatchedWindowsAreCached) {
+  X11PropertyCache* cache = X11PropertyCache::GetInstance();
+  cache->Store(kWindow, kFirstAtom, MakeCardinal(1));
+  EXPECT_FALSE(cache->Lookup(kWindow, kFirstAtom));
+
+  cache->WatchWindow(kWindow);
+  EXPECT_TRUE(cache->IsWatched(kWindow));
+  cache->Store(kWindow, kFirstAtom, MakeCardinal(1));
+  ASSERT_TRUE(cache->Lookup(kWindow, kFirstAtom));
+  EXPECT_EQ(1u, cache->Lookup(kWindow, kFirstAtom)->num_items);
+
+  cache->UnwatchWindow(kWindow);
+  EXPECT_FALSE(cache->IsWatched(kWindow));
+  EXPECT_FALSE(cache->Lookup(kWindow, kFirstAtom));
+}
+
+TEST(X11PropertyCacheTest, PropertyNotifyInvalidates) {
+  X11PropertyCache* cache = X11PropertyCache::GetInstance();
+  cache->WatchWindow(kWindow);
+
+  X11PropertyValue missing;
+  cache->Store(kWindow, kFirstAtom, MakeCardinal(1));
+  cache->Store(kWindow, kSecondAtom, missing);
+  ASSERT_TRUE(cache->Lookup(kWindow, kSecondAtom));
+  EXPECT_EQ(0UL, cache->Lookup(kWindow, kSecondAtom)->type);  // None
+
+  // Only the property named in the event is dropped.
+  cache->OnPropertyNotify(MakePropertyNotify(kWindow, kSecondAtom));
+  EXPECT_FALSE(cache->Lookup(kWindow, kSecondAtom));
+  EXPECT_TRUE(cache->Lookup(kWindow, kFirstAtom));
+
+  // Events for other windows are ignored.
+  cache->OnPropertyNotify(MakePropertyNotify(kWindow + 1, kFirstAtom));
+  EXPECT_TRUE(cache->Lookup(kWindow, kFirstAtom));
+
+  cache->OnPropertyNotify(MakePropertyNotify(kWindow, kFirstAtom));
+  EXPECT_FALSE(cache->Lookup(kWindow, kFirstAtom));
+  EXPECT_TRUE(cache->IsWatched(kWindow));
+
+  cache->UnwatchWindow(kWindow);
+}
+
+TEST(X11PropertyCacheTest, InvalidateDropsProperty) {
+  X11PropertyCache* cache = X11PropertyCache::GetInstance();
+  cache->WatchWindow(kWindow);
+  cache->Store(kWindow, kFirstAtom, MakeCardinal(1));
+  cache->Store(kWindow, kSecondAtom, MakeCardinal(2));
+
+  // Writing a property drops it without waiting for its PropertyNotify.
+  cache->Invalidate(kWindow, kFirstAtom);
+  EXPECT_FALSE(cache->Lookup(kWindow, kFirstAtom));
+  EXPECT_TRUE(cache->Lookup(kWindow, kSecondAtom));
+
+  // Invalidating an unwatched window does nothing.
+  cache->Invalidate(kWindow + 1, kSecondAtom);
+  EXPECT_TRUE(cache->Lookup(kWindow, kSecondAtom));
+
+  cache->UnwatchWindow(kWindow);
+}
+
+}  // namespace ui
@@ -22,8 +22,14 @@
 #include <X11/extensions/randr.h>
 #include <X11/extensions/shape.h>
 
+#if defined(ARCH_CPU_X86_FAMILY)
+#include <emmintrin.h>
+#endif
+
 #include "base/bind.h"
 #include "base/command_line.h"
+#include "base/cpu.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/singleton.h"
@@ -37,6 +43,8 @@
 #include "ui/base/keycodes/keyboard_code_conversion_x.h"
 #include "ui/base/touch/touch_factory.h"
 #include "ui/base/x/valuators.h"
+#include "ui/base/x/x11_atom_cache.h"
+#include "ui/base/x/x11_property_cache.h"
 #include "ui/base/x/x11_util_internal.h"
 #include "ui/gfx/point_conversions.h"
 #include "ui/gfx/rect.h"
@@ -96,6 +104,124 @@ CachedPictFormats* get_cached_pict_formats() {
 // Maximum number of CachedPictFormats we keep around.
 const size_t kMaxCacheSize = 5;
 
+// A shared memory segment, attached to the X server, that PutARGBImage()
+// writes pixels into so that they don't have to go through the socket. One is
+// kept per display and replaced by a larger one when needed.
+struct SharedImageBuffer {
+  Display* display;
+  XShmSegmentInfo shminfo;
+  size_t size;
+};
+
+typedef std::list<SharedImageBuffer> SharedImageBuffers;
+
+SharedImageBuffers* get_shared_image_buffers() {
+  static SharedImageBuffers* buffers = NULL;
+  if (!buffers)
+    buffers = new SharedImageBuffers();
+  return buffers;
+}
+
+// Segments are allocated in multiples of this, so that a window that grows a
+// little at a time doesn't get a new segment on every frame.
+const size_t kSharedImageBufferGranularity = 256 * 1024;
+
+// Returns a segment of at least |size| bytes shared with the X server, or NULL
+// if |display| can't use shared memory for images.
+XShmSegmentInfo* GetSharedImageBuffer(Display* display, size_t size) {
+  // XShmPutImage() doesn't convert byte order, unlike XPutImage().
+  if (QuerySharedMemorySupport(display) == SHARED_MEMORY_NONE ||
+      ImageByteOrder(display) != LSBFirst) {
+    return NULL;
+  }
+
+  SharedImageBuffers* buffers = get_shared_image_buffers();
+  for (SharedImageBuffers::iterator i = buffers->begin();
+       i != buffers->end(); ++i) {
+    if (i->display != display)
+      continue;
+    if (i->size >= size)
+      return &i->shminfo;
+    XShmDetach(display, &i->shminfo);
+    shmdt(i->shminfo.shmaddr);
+    buffers->erase(i);
+    break;
+  }
+
+  SharedImageBuffer buffer;
+  buffer.display = display;
+  buffer.size = (size + kSharedImageBufferGranularity - 1) /
+      kSharedImageBufferGranularity * kSharedImageBufferGranularity;
+  memset(&buffer.shminfo, 0, sizeof(buffer.shminfo));
+  buffer.shminfo.shmid = shmget(IPC_PRIVATE, buffer.size, IPC_CREAT | 0600);
+  if (buffer.shminfo.shmid == -1) {
+    LOG(WARNING) << "Failed to get shared memory segment.";
+    return NULL;
+  }
+  void* address = shmat(buffer.shminfo.shmid, NULL, 0);
+  // Mark the segment for deletion; it goes away once everyone has detached.
+  shmctl(buffer.shminfo.shmid, IPC_RMID, NULL);
+  if (address == reinterpret_cast<void*>(-1))
+    return NULL;
+  buffer.shminfo.shmaddr = static_cast<char*>(address);
+  buffer.shminfo.readOnly = True;
+  if (!XShmAttach(display, &buffer.shminfo)) {
+    shmdt(address);
+    return NULL;
+  }
+
+  buffers->push_front(buffer);
+  return &buffers->front().shminfo;
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+base::LazyInstance<base::CPU>::Leaky g_cpu = LAZY_INSTANCE_INITIALIZER;
+
+// SSE2 versions of the PutARGBImage() row conversions. Each converts a prefix
+// of the row, a whole number of vectors long, and returns its length.
+int ConvertARGBRowToABGR_SSE2(const uint32* src, uint32* dst, int width) {
+  const __m128i ag_mask = _mm_set1_epi32(0xff00ff00);
+  const __m128i rb_mask = _mm_set1_epi32(0x00ff00ff);
+  int x = 0;
+  for (; x + 4 <= width; x += 4) {
+    __m128i pixels =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+    __m128i rb = _mm_and_si128(pixels, rb_mask);
+    rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+    pixels = _mm_or_si128(_mm_and_si128(pixels, ag_mask), rb);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), pixels);
+  }
+  return x;
+}
+
+// Converts four ARGB pixels to RGB565, one per 32-bit lane, biased by -0x8000
+// so that a signed pack keeps all 16 bits.
+inline __m128i ARGBToBiasedRGB565(__m128i pixels) {
+  __m128i r = _mm_and_si128(_mm_srli_epi32(pixels, 8),
+                            _mm_set1_epi32(0xf800));
+  __m128i g = _mm_and_si128(_mm_srli_epi32(pixels, 5),
+                            _mm_set1_epi32(0x07e0));
+  __m128i b = _mm_and_si128(_mm_srli_epi32(pixels, 3),
+                            _mm_set1_epi32(0x001f));
+  return _mm_sub_epi32(_mm_or_si128(r, _mm_or_si128(g, b)),
+                       _mm_set1_epi32(0x8000));
+}
+
+int ConvertARGBRowToRGB565_SSE2(const uint32* src, uint16* dst, int width) {
+  const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000));
+  int x = 0;
+  for (; x + 8 <= width; x += 8) {
+    __m128i lo = ARGBToBiasedRGB565(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x)));
+    __m128i hi = ARGBToBiasedRGB565(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x + 4)));
+    __m128i pixels = _mm_xor_si128(_mm_packs_epi32(lo, hi), bias);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), pixels);
+  }
+  return x;
+}
+#endif
+
 int DefaultX11ErrorHandler(Display* d, XErrorEvent* e) {
   if (MessageLoop::current()) {
     MessageLoop::current()->PostTask(
@@ -118,24 +244,111 @@ int DefaultX11IOErrorHandler(Display* d) {
   _exit(1);
 }
 
-// Note: The caller should free the resulting value data.
+#if !defined(TOOLKIT_GTK)
+// Atoms used on most window manager code paths. They're interned with a single
+// XInternAtoms() call the first time any atom is needed.
+const char* kCommonAtoms[] = {
+  "UTF8_STRING",
+  "WM_DELETE_WINDOW",
+  "WM_PROTOCOLS",
+  "WM_S0",
+  "_GTK_HIDE_TITLEBAR_WHEN_MAXIMIZED",
+  "_MOTIF_WM_HINTS",
+  "_NET_ACTIVE_WINDOW",
+  "_NET_CLIENT_LIST_STACKING",
+  "_NET_CURRENT_DESKTOP",
+  "_NET_SUPPORTING_WM_CHECK",
+  "_NET_WM_DESKTOP",
+  "_NET_WM_MOVERESIZE",
+  "_NET_WM_NAME",
+  "_NET_WM_PID",
+  "_NET_WM_PING",
+  "_NET_WM_STATE",
+  "_NET_WM_STATE_FULLSCREEN",
+  "_NET_WM_STATE_HIDDEN",
+  "_NET_WM_STATE_MAXIMIZED_HORZ",
+  "_NET_WM_STATE_MAXIMIZED_VERT",
+  "_NET_WORKAREA",
+  NULL
+};
+
+// Returns the process-wide atom table. Like the rest of this file it is not
+// thread-safe, and must only be used on the thread processing X events.
+X11AtomCache* GetAtomTable() {
+  static X11AtomCache* table = NULL;
+  if (!table) {
+    table = new X11AtomCache(GetXDisplay(), kCommonAtoms);
+    table->allow_uncached_atoms();
+  }
+  return table;
+}
+#endif
+
+X11RoundTripCounts g_round_trip_counts;
+
+// The atom table's uncached atom count at the last ResetX11RoundTripCounts().
+int g_uncached_atom_count_at_reset = 0;
+
+// Reads |property| on |window| from the X server. |max_length| is in 32-bit
+// units, as for XGetWindowProperty().
+bool FetchProperty(XID window, Atom property, long max_length,
+                   X11PropertyValue* value) {
+  g_round_trip_counts.property_requests++;
+  unsigned long remaining_bytes = 0;
+  unsigned char* data = NULL;
+  if (XGetWindowProperty(GetXDisplay(),
+                         window,
+                         property,
+                         0,          // offset into property data to read
+                         max_length, // max length to get
+                         False,      // deleted
+                         AnyPropertyType,
+                         &value->type,
+                         &value->format,
+                         &value->num_items,
+                         &remaining_bytes,
+                         &data) != Success) {
+    return false;
+  }
+
+  value->data.clear();
+  if (data) {
+    size_t item_size = X11PropertyValue::BytesPerItem(value->format);
+    value->data.assign(data, data + value->num_items * item_size);
+    XFree(data);
+  }
+  return true;
+}
+
+// Reads up to |max_length| 32-bit units of |property_name| on |window|, or all
+// of it if |max_length| is negative. Properties of windows watched by
+// X11PropertyCache are fetched in full once and then served from the cache.
 bool GetProperty(XID window, const std::string& property_name, long max_length,
-                 Atom* type, int* format, unsigned long* num_items,
-                 unsigned char** property) {
+                 X11PropertyValue* value) {
   Atom property_atom = GetAtom(property_name.c_str());
-  unsigned long remaining_bytes = 0;
-  return XGetWindowProperty(GetXDisplay(),
-                            window,
-                            property_atom,
-                            0,          // offset into property data to read
-                            max_length, // max length to get
-                            False,      // deleted
-                            AnyPropertyType,
-                            type,
-                            format,
-                            num_items,
-                            &remaining_bytes,
-                            property);
+  X11PropertyCache* cache = X11PropertyCache::GetInstance();
+  const X11PropertyValue* cached_value = cache->Lookup(window, property_atom);
+  if (cached_value) {
+    g_round_trip_counts.property_cache_hits++;
+    *value = *cached_value;
+  } else if (cache->IsWatched(window)) {
+    if (!FetchProperty(window, property_atom, ~0L, value))
+      return false;
+    cache->Store(window, property_atom, *value);
+  } else {
+    return FetchProperty(window, property_atom, max_length, value);
+  }
+
+  // Trim the full value to what the server would have returned.
+  size_t item_size = X11PropertyValue::BytesPerItem(value->format);
+  if (max_length >= 0 && item_size) {
+    unsigned long max_items = max_length * 4 / (value->format / 8);
+    if (value->num_items > max_items) {
+      value->num_items = max_items;
+      value->data.resize(max_items * item_size);
+    }
+  }
+  return true;
 }
 
 // Converts ui::EventType to XKeyEvent state.
@@ -684,14 +897,16 @@ void* GetVisualFromGtkWidget(GtkWidget* widget) {
 void SetHideTitlebarWhenMaximizedProperty(XID window,
                                           HideTitlebarWhenMaximized property) {
   uint32 hide = property;
+  Atom name_atom = GetAtom("_GTK_HIDE_TITLEBAR_WHEN_MAXIMIZED");
   XChangeProperty(GetXDisplay(),
       window,
-      GetAtom("_GTK_HIDE_TITLEBAR_WHEN_MAXIMIZED"),
+      name_atom,
       XA_CARDINAL,
       32,  // size in bits
       PropModeReplace,
       reinterpret_cast<unsigned char*>(&hide),
       1);
+  X11PropertyCache::GetInstance()->Invalidate(window, name_atom);
 }
 
 void ClearX11DefaultRootWindow() {
@@ -734,6 +949,7 @@ int BitsPerPixelForPixmapDepth(Display* dpy, int depth) {
 
 bool IsWindowVisible(XID window) {
   XWindowAttributes win_attributes;
+  g_round_trip_counts.window_requests++;
   if (!XGetWindowAttributes(GetXDisplay(), window, &win_attributes))
     return false;
   if (win_attributes.map_state != IsViewable)
@@ -753,10 +969,12 @@ bool GetWindowRect(XID window, gfx::Rect* rect) {
   unsigned int width, height;
   unsigned int border_width, depth;
 
+  g_round_trip_counts.window_requests++;
   if (!XGetGeometry(GetXDisplay(), window, &root, &x, &y,
                     &width, &height, &border_width, &depth))
     return false;
 
+  g_round_trip_counts.window_requests++;
   if (!XTranslateCoordinates(GetXDisplay(), window, root,
                              0, 0, &x, &y, &child))
     return false;
@@ -808,114 +1026,80 @@ bool WindowContainsPoint(XID window, gfx::Point screen_loc) {
 
 
 bool PropertyExists(XID window, const std::string& property_name) {
-  Atom type = None;
-  int format = 0;  // size in bits of each item in 'property'
-  unsigned long num_items = 0;
-  unsigned char* property = NULL;
-
-  int result = GetProperty(window, property_name, 1,
-                           &type, &format, &num_items, &property);
-  if (result != Success)
+  X11PropertyValue property;
+  if (!GetProperty(window, property_name, 1, &property))
     return false;
 
-  XFree(property);
-  return num_items > 0;
+  return property.num_items > 0;
 }
 
 bool GetIntProperty(XID window, const std::string& property_name, int* value) {
-  Atom type = None;
-  int format = 0;  // size in bits of each item in 'property'
-  unsigned long num_items = 0;
-  unsigned char* property = NULL;
-
-  int result = GetProperty(window, property_name, 1,
-                           &type, &format, &num_items, &property);
-  if (result != Success)
+  X11PropertyValue property;
+  if (!GetProperty(window, property_name, 1, &property))
     return false;
 
-  if (format != 32 || num_items != 1) {
-    XFree(property);
+  if (property.format != 32 || property.num_items != 1)
     return false;
-  }
 
-  *value = static_cast<int>(*(reinterpret_cast<long*>(property)));
-  XFree(property);
+  *value = static_cast<int>(*(reinterpret_cast<long*>(&property.data[0])));
   return true;
 }
 
 bool GetIntArrayProperty(XID window,
                          const std::string& property_name,
                          std::vector<int>* value) {
-  Atom type = None;
-  int format = 0;  // size in bits of each item in 'property'
-  unsigned long num_items = 0;
-  unsigned char* properties = NULL;
-
-  int result = GetProperty(window, property_name,
-                           (~0L), // (all of them)
-                           &type, &format, &num_items, &properties);
-  if (result != Success)
+  X11PropertyValue property;
+  if (!GetProperty(window, property_name,
+                   (~0L), // (all of them)
+                   &property)) {
     return false;
+  }
 
-  if (format != 32) {
-    XFree(properties);
+  if (property.format != 32)
     return false;
-  }
 
-  long* int_properties = reinterpret_cast<long*>(properties);
   value->clear();
-  for (unsigned long i = 0; i < num_items; ++i) {
+  if (property.num_items == 0)
+    return true;
+  long* int_properties = reinterpret_cast<long*>(&property.data[0]);
+  for (unsigned long i = 0; i < property.num_items; ++i) {
     value->push_back(static_cast<int>(int_properties[i]));
   }
-  XFree(properties);
   return true;
 }
 
 bool GetAtomArrayProperty(XID window,
                           const std::string& property_name,
                           std::vector<Atom>* value) {
-  Atom type = None;
-  int format = 0;  // size in bits of each item in 'property'
-  unsigned long num_items = 0;
-  unsigned char* properties = NULL;
-
-  int result = GetProperty(window, property_name,
-                           (~0L), // (all of them)
-                           &type, &format, &num_items, &properties);
-  if (result != Success)
+  X11PropertyValue property;
+  if (!GetProperty(window, property_name,
+                   (~0L), // (all of them)
+                   &property)) {
     return false;
+  }
 
-  if (type != XA_ATOM) {
-    XFree(properties);
+  if (property.type != XA_ATOM)
     return false;
-  }
 
-  Atom* atom_properties = reinterpret_cast<Atom*>(properties);
   value->clear();
-  value->insert(value->begin(), atom_properties, atom_properties + num_items);
-  XFree(properties);
+  if (property.num_items == 0)
+    return true;
+  Atom* atom_properties = reinterpret_cast<Atom*>(&property.data[0]);
+  value->insert(value->begin(), atom_properties,
+                atom_properties + property.num_items);
   return true;
 }
 
 bool GetStringProperty(
     XID window, const std::string& property_name, std::string* value) {
-  Atom type = None;
-  int format = 0;  // size in bits of each item in 'property'
-  unsigned long num_items = 0;
-  unsigned char* property = NULL;
-
-  int result = GetProperty(window, property_name, 1024,
-                           &type, &format, &num_items, &property);
-  if (result != Success)
+  X11PropertyValue property;
+  if (!GetProperty(window, property_name, 1024, &property))
     return false;
 
-  if (format != 8) {
-    XFree(property);
+  if (property.format != 8)
     return false;
-  }
 
-  value->assign(reinterpret_cast<char*>(property), num_items);
-  XFree(property);
+  value->assign(property.data.begin(), property.data.end());
   return true;
 }
 
@@ -949,6 +1133,7 @@ bool SetIntArrayProperty(XID window,
                   PropModeReplace,
                   reinterpret_cast<const unsigned char*>(data.get()),
                   value.size());  // num items
+  X11PropertyCache::GetInstance()->Invalidate(window, name_atom);
   XSync(ui::GetXDisplay(), False);
   return gdk_error_trap_pop() == 0;
 }
@@ -958,8 +1143,23 @@ Atom GetAtom(const char* name) {
   return gdk_x11_get_xatom_by_name_for_display(
       gdk_display_get_default(), name);
 #else
-  // TODO(derat): Cache atoms to avoid round-trips to the server.
-  return XInternAtom(GetXDisplay(), name, false);
+  return GetAtomTable()->GetAtom(name);
+#endif
+}
+
+X11RoundTripCounts GetX11RoundTripCounts() {
+  X11RoundTripCounts counts = g_round_trip_counts;
+#if !defined(TOOLKIT_GTK)
+  counts.atom_requests =
+      GetAtomTable()->uncached_atom_count() - g_uncached_atom_count_at_reset;
+#endif
+  return counts;
+}
+
+void ResetX11RoundTripCounts() {
+  memset(&g_round_trip_counts, 0, sizeof(g_round_trip_counts));
+#if !defined(TOOLKIT_GTK)
+  g_uncached_atom_count_at_reset = GetAtomTable()->uncached_atom_count();
 #endif
 }
 
@@ -968,6 +1168,7 @@ XID GetParentWindow(XID window) {
   XID parent = None;
   XID* children = NULL;
   unsigned int num_children = 0;
+  g_round_trip_counts.window_requests++;
   XQueryTree(GetXDisplay(), window, &root, &parent, &children, &num_children);
   if (children)
     XFree(children);
@@ -1072,32 +1273,19 @@ void EnumerateTopLevelWindows(ui::EnumerateWindowsDelegate* delegate) {
 bool GetXWindowStack(Window window, std::vector<XID>* windows) {
   windows->clear();
 
-  Atom type;
-  int format;
-  unsigned long count;
-  unsigned char *data = NULL;
-  if (GetProperty(window,
-                  "_NET_CLIENT_LIST_STACKING",
-                  ~0L,
-                  &type,
-                  &format,
-                  &count,
-                  &data) != Success) {
+  X11PropertyValue property;
+  if (!GetProperty(window, "_NET_CLIENT_LIST_STACKING", ~0L, &property))
     return false;
-  }
 
-  bool result = false;
-  if (type == XA_WINDOW && format == 32 && data && count > 0) {
-    result = true;
-    XID* stack = reinterpret_cast<XID*>(data);
-    for (long i = static_cast<long>(count) - 1; i >= 0; i--)
-      windows->push_back(stack[i]);
+  if (property.type != XA_WINDOW || property.format != 32 ||
+      property.num_items == 0) {
+    return false;
   }
 
-  if (data)
-    XFree(data);
-
-  return result;
+  XID* stack = reinterpret_cast<XID*>(&property.data[0]);
+  for (long i = static_cast<long>(property.num_items) - 1; i >= 0; i--)
+    windows->push_back(stack[i]);
+  return true;
 }
 
 void RestackWindow(XID window, XID sibling, bool above) {
@@ -1168,100 +1356,135 @@ void PutARGBImage(Display* display,
                   int src_x, int src_y,
                   int dst_x, int dst_y,
                   int copy_width, int copy_height) {
+  if (copy_width <= 0 || copy_height <= 0)
+    return;
+
   // TODO(scherkus): potential performance impact... consider passing in as a
   // parameter.
   int pixmap_bpp = BitsPerPixelForPixmapDepth(display, depth);
+  if (pixmap_bpp != 32 && pixmap_bpp != 16) {
+    // Some folks have VNC setups which still use 16-bit visuals and VNC
+    // doesn't include Xrender, but anything else isn't handled.
+    LOG(FATAL) << "Sorry, we don't support your visual depth without "
+                  "Xrender support (depth:" << depth
+               << " bpp:" << pixmap_bpp << ")";
+    return;
+  }
 
   XImage image;
   memset(&image, 0, sizeof(image));
 
-  image.width = data_width;
-  image.height = data_height;
   image.format = ZPixmap;
   image.byte_order = LSBFirst;
   image.bitmap_unit = 8;
   image.bitmap_bit_order = LSBFirst;
   image.depth = depth;
   image.bits_per_pixel = pixmap_bpp;
-  image.bytes_per_line = data_width * pixmap_bpp / 8;
 
+  bool swap_red_blue = false;
   if (pixmap_bpp == 32) {
     image.red_mask = 0xff0000;
     image.green_mask = 0xff00;
     image.blue_mask = 0xff;
 
     // If the X server depth is already 32-bits and the color masks match,
-    // then our job is easy.
+    // then our job is easy. Otherwise assume red and blue need to be swapped.
     Visual* vis = static_cast<Visual*>(visual);
-    if (image.red_mask == vis->red_mask &&
-        image.green_mask == vis->green_mask &&
-        image.blue_mask == vis->blue_mask) {
-      image.data = const_cast<char*>(reinterpret_cast<const char*>(data));
-      XPutImage(display, pixmap, static_cast<GC>(pixmap_gc), &image,
-                src_x, src_y, dst_x, dst_y,
-                copy_width, copy_height);
-    } else {
-      // Otherwise, we need to shuffle the colors around. Assume red and blue
-      // need to be swapped.
-      //
-      // It's possible to use some fancy SSE tricks here, but since this is the
-      // slow path anyway, we do it slowly.
-
-      uint8_t* bitmap32 =
-          static_cast<uint8_t*>(malloc(4 * data_width * data_height));
-      if (!bitmap32)
-        return;
-      uint8_t* const orig_bitmap32 = bitmap32;
-      const uint32_t* bitmap_in = reinterpret_cast<const uint32_t*>(data);
-      for (int y = 0; y < data_height; ++y) {
-        for (int x = 0; x < data_width; ++x) {
-          const uint32_t pixel = *(bitmap_in++);
-          bitmap32[0] = (pixel >> 16) & 0xff;  // Red
-          bitmap32[1] = (pixel >> 8) & 0xff;   // Green
-          bitmap32[2] = pixel & 0xff;          // Blue
-          bitmap32[3] = (pixel >> 24) & 0xff;  // Alpha
-          bitmap32 += 4;
-        }
-      }
-      image.data = reinterpret_cast<char*>(orig_bitmap32);
-      XPutImage(display, pixmap, static_cast<GC>(pixmap_gc), &image,
-                src_x, src_y, dst_x, dst_y,
-                copy_width, copy_height);
-      free(orig_bitmap32);
-    }
-  } else if (pixmap_bpp == 16) {
-    // Some folks have VNC setups which still use 16-bit visuals and VNC
-    // doesn't include Xrender.
-
-    uint16_t* bitmap16 =
-        static_cast<uint16_t*>(malloc(2 * data_width * data_height));
-    if (!bitmap16)
-      return;
-    uint16_t* const orig_bitmap16 = bitmap16;
-    const uint32_t* bitmap_in = reinterpret_cast<const uint32_t*>(data);
-    for (int y = 0; y < data_height; ++y) {
-      for (int x = 0; x < data_width; ++x) {
-        const uint32_t pixel = *(bitmap_in++);
-        uint16_t out_pixel = ((pixel >> 8) & 0xf800) |
-                             ((pixel >> 5) & 0x07e0) |
-                             ((pixel >> 3) & 0x001f);
-        *(bitmap16++) = out_pixel;
-      }
-    }
-
-    image.data = reinterpret_cast<char*>(orig_bitmap16);
+    swap_red_blue = image.red_mask != vis->red_mask ||
+                    image.green_mask != vis->green_mask ||
+                    image.blue_mask != vis->blue_mask;
+  } else {
     image.red_mask = 0xf800;
     image.green_mask = 0x07e0;
     image.blue_mask = 0x001f;
+  }
 
+  int bytes_per_pixel = pixmap_bpp / 8;
+  int scanline_pad = BitmapPad(display) / 8;
+  image.width = copy_width;
+  image.height = copy_height;
+  image.bytes_per_line = (copy_width * bytes_per_pixel + scanline_pad - 1) /
+      scanline_pad * scanline_pad;
+  size_t image_size = static_cast<size_t>(image.bytes_per_line) * copy_height;
+
+  XShmSegmentInfo* shminfo = GetSharedImageBuffer(display, image_size);
+  if (!shminfo && pixmap_bpp == 32 && !swap_red_blue) {
+    // Without shared memory there's nothing to gain from copying pixels that
+    // need no conversion; send them straight from |data|.
+    image.width = data_width;
+    image.height = data_height;
+    image.bytes_per_line = data_width * 4;
+    image.data = const_cast<char*>(reinterpret_cast<const char*>(data));
     XPutImage(display, pixmap, static_cast<GC>(pixmap_gc), &image,
               src_x, src_y, dst_x, dst_y,
               copy_width, copy_height);
-    free(orig_bitmap16);
+    return;
+  }
+
+  // Convert just the region being copied, into the shared segment if there is
+  // one.
+  scoped_ptr<char[]> image_data;
+  if (shminfo) {
+    image.data = shminfo->shmaddr;
+    image.obdata = reinterpret_cast<char*>(shminfo);
   } else {
-    LOG(FATAL) << "Sorry, we don't support your visual depth without "
-                  "Xrender support (depth:" << depth
-               << " bpp:" << pixmap_bpp << ")";
+    image_data.reset(new char[image_size]);
+    image.data = image_data.get();
+  }
+
+  const uint32* src =
+      reinterpret_cast<const uint32*>(data) + src_y * data_width + src_x;
+  for (int y = 0; y < copy_height; ++y) {
+    char* dst = image.data + y * image.bytes_per_line;
+    if (pixmap_bpp == 16)
+      ConvertARGBRowToRGB565(src, reinterpret_cast<uint16*>(dst), copy_width);
+    else if (swap_red_blue)
+      ConvertARGBRowToABGR(src, reinterpret_cast<uint32*>(dst), copy_width);
+    else
+      memcpy(dst, src, copy_width * 4);
+    src += data_width;
+  }
+
+  if (shminfo) {
+    XShmPutImage(display, pixmap, static_cast<GC>(pixmap_gc), &image,
+                 0, 0, dst_x, dst_y,
+                 copy_width, copy_height,
+                 False);  // send_event
+    // The segment is reused by the next call, so wait for the server to be
+    // done reading it.
+    XSync(display, False);
+  } else {
+    XPutImage(display, pixmap, static_cast<GC>(pixmap_gc), &image,
+              0, 0, dst_x, dst_y,
+              copy_width, copy_height);
+  }
+}
+
+void ConvertARGBRowToABGR(const uint32* src, uint32* dst, int width) {
+  int x = 0;
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (g_cpu.Get().has_sse2())
+    x = ConvertARGBRowToABGR_SSE2(src, dst, width);
+#endif
+  for (; x < width; ++x) {
+    const uint32 pixel = src[x];
+    dst[x] = (pixel & 0xff00ff00) |
+             ((pixel >> 16) & 0xff) |
+             ((pixel & 0xff) << 16);
+  }
+}
+
+void ConvertARGBRowToRGB565(const uint32* src, uint16* dst, int width) {
+  int x = 0;
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (g_cpu.Get().has_sse2())
+    x = ConvertARGBRowToRGB565_SSE2(src, dst, width);
+#endif
+  for (; x < width; ++x) {
+    const uint32 pixel = src[x];
+    dst[x] = ((pixel >> 8) & 0xf800) |
+             ((pixel >> 5) & 0x07e0) |
+             ((pixel >> 3) & 0x001f);
   }
 }
 
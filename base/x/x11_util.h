@@ -182,6 +182,23 @@ UI_EXPORT bool SetIntArrayProperty(XID window,
 // Gets the X atom for default display corresponding to atom_name.
 Atom GetAtom(const char* atom_name);
 
+// Counts of the synchronous requests to the X server made by the functions in
+// this file, for profiling.
+struct X11RoundTripCounts {
+  // XInternAtom() calls for atoms that weren't interned up front.
+  int atom_requests;
+  // XGetWindowProperty() calls.
+  int property_requests;
+  // Property reads answered by X11PropertyCache instead.
+  int property_cache_hits;
+  // XGetWindowAttributes(), XGetGeometry(), XTranslateCoordinates() and
+  // XQueryTree() calls.
+  int window_requests;
+};
+
+UI_EXPORT X11RoundTripCounts GetX11RoundTripCounts();
+UI_EXPORT void ResetX11RoundTripCounts();
+
 // Get |window|'s parent window, or None if |window| is the root window.
 XID GetParentWindow(XID window);
 
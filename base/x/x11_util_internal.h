@@ -18,6 +18,7 @@ extern "C" {
 #include <X11/extensions/Xrender.h>
 }
 
+#include "base/basictypes.h"
 #include "ui/base/ui_export.h"
 
 namespace ui {
@@ -49,6 +50,17 @@ UI_EXPORT void SetX11ErrorHandlers(XErrorHandler error_handler,
 UI_EXPORT void LogErrorEventDescription(Display* dpy,
                                         const XErrorEvent& error_event);
 
+// --------------------------------------------------------------------------
+// Pixel conversion used by PutARGBImage(). Exposed for testing.
+// Converts |width| ARGB pixels to ABGR, the layout of 32-bit visuals whose red
+// and blue masks are swapped relative to ours.
+UI_EXPORT void ConvertARGBRowToABGR(const uint32* src, uint32* dst, int width);
+
+// Converts |width| ARGB pixels to RGB565, dropping alpha.
+UI_EXPORT void ConvertARGBRowToRGB565(const uint32* src,
+                                      uint16* dst,
+                                      int width);
+
 }  // namespace ui
 
 #endif  // UI_BASE_X_X11_UTIL_INTERNAL_H_
@@ -6,6 +6,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "ui/base/x/x11_util.h"
+#include "ui/base/x/x11_util_internal.h"
 
 namespace ui {
 
@@ -169,4 +170,36 @@ TEST(X11UtilTest, ParseBrokenOverscanData) {
   EXPECT_FALSE(ParseOutputOverscanFlag(data.get(), 150, &flag));
 }
 
+
+TEST(X11UtilTest, ConvertARGBRows) {
+  // Enough pixels to cover whole vectors as well as a partial one.
+  const int kWidth = 19;
+  uint32 src[kWidth];
+  for (int i = 0; i < kWidth; ++i)
+    src[i] = 0x01020304 * (i + 1) + 0x80706050 * (i % 3);
+
+  for (int width = 0; width <= kWidth; ++width) {
+    uint32 abgr[kWidth + 1];
+    uint16 rgb565[kWidth + 1];
+    abgr[width] = 0xdeadbeef;
+    rgb565[width] = 0xbeef;
+    ConvertARGBRowToABGR(src, abgr, width);
+    ConvertARGBRowToRGB565(src, rgb565, width);
+
+    for (int i = 0; i < width; ++i) {
+      const uint8 a = src[i] >> 24;
+      const uint8 r = src[i] >> 16;
+      const uint8 g = src[i] >> 8;
+      const uint8 b = src[i];
+      EXPECT_EQ(static_cast<uint32>(a << 24 | b << 16 | g << 8 | r), abgr[i])
+          << "width " << width << " pixel " << i;
+      EXPECT_EQ(static_cast<uint16>((r >> 3) << 11 | (g >> 2) << 5 | b >> 3),
+                rgb565[i]) << "width " << width << " pixel " << i;
+    }
+    // Nothing past |width| is written.
+    EXPECT_EQ(0xdeadbeef, abgr[width]);
+    EXPECT_EQ(0xbeef, rgb565[width]);
+  }
+}
+
 }
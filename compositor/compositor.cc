@@ -24,11 +24,13 @@
 #include "ui/compositor/compositor_switches.h"
 #include "ui/compositor/dip_util.h"
 #include "ui/compositor/layer.h"
+#include "ui/compositor/layer_animator.h"
 #include "ui/compositor/test_web_graphics_context_3d.h"
 #include "ui/gl/gl_context.h"
 #include "ui/gl/gl_implementation.h"
 #include "ui/gl/gl_surface.h"
 #include "ui/gl/gl_switches.h"
+#include "ui/gl/vsync_provider.h"
 #include "webkit/gpu/webgraphicscontext3d_in_process_impl.h"
 
 #if defined(OS_CHROMEOS)
@@ -190,6 +192,13 @@ WebKit::WebGraphicsContext3D* DefaultContextFactory::CreateContextCommon(
     gfx::GLContext* gl_context = gfx::GLContext::GetCurrent();
     bool vsync = !command_line->HasSwitch(switches::kDisableGpuVsync);
     gl_context->SetSwapInterval(vsync ? 1 : 0);
+    gfx::GLSurface* surface = gfx::GLSurface::GetCurrent();
+    gfx::VSyncProvider* vsync_provider =
+        surface ? surface->GetVSyncProvider() : NULL;
+    if (vsync && vsync_provider) {
+      vsync_provider->GetVSyncParameters(
+          base::Bind(&ui::LayerAnimator::UpdateVSyncParameters));
+    }
     gl_context->ReleaseCurrent(NULL);
   }
   return context;
@@ -490,6 +499,10 @@ void Compositor::didBeginFrame() {
 }
 
 void Compositor::animate(double frameBeginTime) {
+  // |frameBeginTime| is in seconds on the base::TimeTicks clock.
+  ui::LayerAnimator::OnBeginFrame(
+      base::TimeTicks() + base::TimeDelta::FromMicroseconds(
+          frameBeginTime * base::Time::kMicrosecondsPerSecond));
 }
 
 void Compositor::layout() {
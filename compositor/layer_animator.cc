@@ -325,6 +325,17 @@ bool LayerAnimator::HasAnimation(LayerAnimationSequence* sequence) const {
   return false;
 }
 
+// static
+void LayerAnimator::OnBeginFrame(base::TimeTicks frame_time) {
+  GetAnimationContainer()->OnBeginFrame(frame_time);
+}
+
+// static
+void LayerAnimator::UpdateVSyncParameters(const base::TimeTicks timebase,
+                                          const base::TimeDelta interval) {
+  GetAnimationContainer()->SetVSyncParameters(timebase, interval);
+}
+
 // LayerAnimator private -------------------------------------------------------
 
 void LayerAnimator::Step(base::TimeTicks now) {
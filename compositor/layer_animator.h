@@ -198,6 +198,16 @@ class COMPOSITOR_EXPORT LayerAnimator
     return disable_animations_for_test_;
   }
 
+  // Steps all running animators to |frame_time|, the start of the frame the
+  // compositor is about to produce. Once invoked, animators step once per
+  // frame and fall back to their timer only if frames stop arriving.
+  static void OnBeginFrame(base::TimeTicks frame_time);
+
+  // Aligns the fallback animation timer to the display refresh. Matches
+  // gfx::VSyncProvider::UpdateVSyncCallback.
+  static void UpdateVSyncParameters(const base::TimeTicks timebase,
+                                    const base::TimeDelta interval);
+
  protected:
   virtual ~LayerAnimator();
 
@@ -15,6 +15,7 @@
 #include "ui/gfx/rect.h"
 #include "ui/gfx/render_text.h"
 #include "ui/gfx/shadow_value.h"
+#include "ui/gfx/text_size_cache.h"
 #include "ui/gfx/text_utils.h"
 
 namespace gfx {
@@ -175,6 +176,16 @@ void Canvas::SizeStringInt(const string16& text,
 
   flags = AdjustPlatformSpecificFlags(text, flags);
 
+  // Only multi-line text depends on the width it is given to fit into.
+  const int cache_width = (flags & MULTI_LINE) ? *width : 0;
+  TextSizeCache* size_cache = TextSizeCache::GetInstance();
+  Size cached_size;
+  if (size_cache->Lookup(text, font, flags, cache_width, &cached_size)) {
+    *width = cached_size.width();
+    *height = cached_size.height();
+    return;
+  }
+
   string16 adjusted_text = text;
 #if defined(OS_WIN)
   AdjustStringDirection(flags, &adjusted_text);
@@ -222,6 +233,8 @@ void Canvas::SizeStringInt(const string16& text,
       *height = string_size.height();
     }
   }
+
+  size_cache->Insert(text, font, flags, cache_width, Size(*width, *height));
 }
 
 void Canvas::DrawStringWithShadows(const string16& text,
@@ -683,6 +683,44 @@ size_t RenderText::IndexOfAdjacentGrapheme(size_t index,
   return 0;
 }
 
+void RenderText::GetGraphemePrefixWidths(std::vector<int>* widths) {
+  const size_t length = text().length();
+  widths->assign(length + 1, -1);
+  (*widths)[0] = 0;
+
+  EnsureLayout();
+  std::vector<ui::Range> xspans;
+  GetGraphemeXSpans(&xspans);
+
+  int width = 0;
+  ui::Range previous_xspan = ui::Range::InvalidRange();
+  size_t index = 0;
+  while (index < length) {
+    const size_t next = IndexOfAdjacentGrapheme(index, CURSOR_FORWARD);
+    const ui::Range& xspan = xspans[index];
+    if (index > 0 && xspan == previous_xspan) {
+      // This grapheme shares its glyph with the previous one (e.g. a ligature),
+      // so the text cannot be cut between them.
+      (*widths)[index] = -1;
+    } else {
+      width += static_cast<int>(xspan.length());
+    }
+    (*widths)[next] = width;
+    previous_xspan = xspan;
+    index = next;
+  }
+}
+
+void RenderText::GetGraphemeXSpans(std::vector<ui::Range>* xspans) {
+  const size_t length = text().length();
+  xspans->assign(length, ui::Range());
+  int height = 0;
+  for (size_t index = 0; index < length;
+       index = IndexOfAdjacentGrapheme(index, CURSOR_FORWARD)) {
+    GetGlyphBounds(index, &(*xspans)[index], &height);
+  }
+}
+
 SelectionModel RenderText::GetSelectionModelForSelectionStart() {
   const ui::Range& sel = selection();
   if (sel.is_empty())
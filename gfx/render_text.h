@@ -299,6 +299,14 @@ class UI_EXPORT RenderText {
   size_t IndexOfAdjacentGrapheme(size_t index,
                                  LogicalCursorDirection direction);
 
+  // Fills |widths| with text().length() + 1 entries, where entry |i| is the
+  // width in pixels of the logical substring [0, i) as laid out within the
+  // whole text, or -1 if |i| is not a valid cut point (not a grapheme boundary,
+  // or inside a glyph cluster such as a ligature). Widths are summed per
+  // grapheme, so RTL runs and kerning against following text are accounted
+  // for; entry 0 is always 0 and the last entry is always valid.
+  void GetGraphemePrefixWidths(std::vector<int>* widths);
+
   // Return a SelectionModel with the cursor at the current selection's start.
   // The returned value represents a cursor/caret position without a selection.
   SelectionModel GetSelectionModelForSelectionStart();
@@ -356,6 +364,13 @@ class UI_EXPORT RenderText {
   // a negative width.
   virtual void GetGlyphBounds(size_t index, ui::Range* xspan, int* height) = 0;
 
+  // Fills |xspans| with text().length() entries, where entry |i| is the
+  // horizontal bounds GetGlyphBounds() gives for the grapheme starting at |i|.
+  // Entries for indices that don't start a grapheme are unspecified. The
+  // default calls GetGlyphBounds() for each grapheme; implementations for
+  // which that isn't constant time should compute all the bounds in one pass.
+  virtual void GetGraphemeXSpans(std::vector<ui::Range>* xspans);
+
   // Get the visual bounds containing the logical substring within the |range|.
   // If |range| is empty, the result is empty. These bounds could be visually
   // discontinuous if the substring is split by a LTR/RTL level change.
@@ -429,6 +444,7 @@ class UI_EXPORT RenderText {
   FRIEND_TEST_ALL_PREFIXES(RenderTextTest, ApplyColorAndStyle);
   FRIEND_TEST_ALL_PREFIXES(RenderTextTest, ObscuredText);
   FRIEND_TEST_ALL_PREFIXES(RenderTextTest, GraphemePositions);
+  FRIEND_TEST_ALL_PREFIXES(RenderTextTest, GraphemeXSpans);
   FRIEND_TEST_ALL_PREFIXES(RenderTextTest, EdgeSelectionModels);
   FRIEND_TEST_ALL_PREFIXES(RenderTextTest, OriginForDrawing);
 
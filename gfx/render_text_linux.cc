@@ -223,6 +223,49 @@ void RenderTextLinux::GetGlyphBounds(size_t index,
   *height = PANGO_PIXELS(pos.height);
 }
 
+void RenderTextLinux::GetGraphemeXSpans(std::vector<ui::Range>* xspans) {
+  EnsureLayout();
+  const size_t length = text().length();
+  xspans->assign(length, ui::Range());
+  if (!length)
+    return;
+
+  // pango_layout_index_to_pos() and LayoutIndexToTextIndex() are linear in
+  // the index, so map the layout text to text indices in one pass and take
+  // the bounds of each cluster from a single walk over the layout.
+  std::vector<size_t> text_indices(layout_text_len_ + 1, length);
+  size_t text_index = 0;
+  for (const char* p = layout_text_; p < layout_text_ + layout_text_len_;
+       p = g_utf8_next_char(p)) {
+    text_indices[p - layout_text_] = text_index;
+    text_index = ui::UTF16OffsetToIndex(text(), text_index, 1);
+  }
+
+  std::vector<bool> starts_cluster(length, false);
+  PangoLayoutIter* iter = pango_layout_get_iter(layout_);
+  do {
+    if (!pango_layout_iter_get_run_readonly(iter))
+      continue;  // The end of the line.
+    const size_t index =
+        text_indices[std::min<size_t>(pango_layout_iter_get_index(iter),
+                                      layout_text_len_)];
+    if (index >= length)
+      continue;
+    PangoRectangle extents;
+    pango_layout_iter_get_cluster_extents(iter, NULL, &extents);
+    (*xspans)[index] = ui::Range(PANGO_PIXELS(extents.x),
+                                 PANGO_PIXELS(extents.x + extents.width));
+    starts_cluster[index] = true;
+  } while (pango_layout_iter_next_cluster(iter));
+  pango_layout_iter_free(iter);
+
+  // Graphemes inside a cluster (e.g. a ligature) share its bounds.
+  for (size_t i = 1; i < length; ++i) {
+    if (!starts_cluster[i])
+      (*xspans)[i] = (*xspans)[i - 1];
+  }
+}
+
 std::vector<Rect> RenderTextLinux::GetSubstringBounds(const ui::Range& range) {
   DCHECK_LE(range.GetMax(), text().length());
 
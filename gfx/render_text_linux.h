@@ -36,6 +36,7 @@ class RenderTextLinux : public RenderText {
   virtual void GetGlyphBounds(size_t index,
                               ui::Range* xspan,
                               int* height) OVERRIDE;
+  virtual void GetGraphemeXSpans(std::vector<ui::Range>* xspans) OVERRIDE;
   virtual std::vector<Rect> GetSubstringBounds(const ui::Range& range) OVERRIDE;
   virtual size_t TextIndexToLayoutIndex(size_t index) const OVERRIDE;
   virtual size_t LayoutIndexToTextIndex(size_t index) const OVERRIDE;
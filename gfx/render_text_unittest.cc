@@ -618,6 +618,29 @@ TEST_F(RenderTextTest, GraphemePositions) {
   }
 }
 
+// The bounds computed for all graphemes at once match those of each grapheme.
+TEST_F(RenderTextTest, GraphemeXSpans) {
+  const wchar_t* const texts[] = {
+    kLtr, kLtrRtl, kLtrRtlLtr, kRtl, kRtlLtr, kRtlLtrRtl, L"hop on pop",
+  };
+
+  scoped_ptr<RenderText> render_text(RenderText::CreateInstance());
+  for (size_t i = 0; i < arraysize(texts); ++i) {
+    render_text->SetText(WideToUTF16(texts[i]));
+    std::vector<ui::Range> xspans;
+    render_text->GetGraphemeXSpans(&xspans);
+    ASSERT_EQ(render_text->text().length(), xspans.size());
+    for (size_t index = 0; index < xspans.size();
+         index = render_text->IndexOfAdjacentGrapheme(index, CURSOR_FORWARD)) {
+      ui::Range xspan;
+      int height = 0;
+      render_text->GetGlyphBounds(index, &xspan, &height);
+      EXPECT_EQ(xspan.GetMin(), xspans[index].GetMin()) << i << " " << index;
+      EXPECT_EQ(xspan.GetMax(), xspans[index].GetMax()) << i << " " << index;
+    }
+  }
+}
+
 TEST_F(RenderTextTest, EdgeSelectionModels) {
   // Simple Latin text.
   const string16 kLatin = WideToUTF16(L"abc");
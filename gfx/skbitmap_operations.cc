@@ -7,17 +7,43 @@
 #include <algorithm>
 #include <string.h>
 
+#include "base/cpu.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "skia/ext/refptr.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkCanvas.h"
-#include "third_party/skia/include/core/SkColorFilter.h"
 #include "third_party/skia/include/core/SkColorPriv.h"
 #include "third_party/skia/include/core/SkUnPreMultiply.h"
 #include "third_party/skia/include/effects/SkBlurImageFilter.h"
 #include "ui/gfx/insets.h"
 #include "ui/gfx/point.h"
 #include "ui/gfx/size.h"
+#include "ui/gfx/skbitmap_operations_sse2.h"
+
+namespace {
+
+#if defined(SKBITMAP_OPERATIONS_SSE2)
+base::LazyInstance<base::CPU>::Leaky g_cpu = LAZY_INSTANCE_INITIALIZER;
+#endif
+
+bool g_simd_enabled = true;
+
+// Returns true if the SSE2 row kernels should be used.
+bool UseSSE2() {
+#if defined(SKBITMAP_OPERATIONS_SSE2)
+  return g_simd_enabled && g_cpu.Get().has_sse2();
+#else
+  return false;
+#endif
+}
+
+}  // namespace
+
+// static
+void SkBitmapOperations::SetSIMDEnabledForTesting(bool enabled) {
+  g_simd_enabled = enabled;
+}
 
 // static
 SkBitmap SkBitmapOperations::CreateInvertedBitmap(const SkBitmap& image) {
@@ -35,7 +61,12 @@ SkBitmap SkBitmapOperations::CreateInvertedBitmap(const SkBitmap& image) {
     uint32* image_row = image.getAddr32(0, y);
     uint32* dst_row = inverted.getAddr32(0, y);
 
-    for (int x = 0; x < image.width(); ++x) {
+    int x = 0;
+#if defined(SKBITMAP_OPERATIONS_SSE2)
+    if (UseSSE2())
+      x = gfx::internal::InvertRow_SSE2(image_row, dst_row, image.width());
+#endif
+    for (; x < image.width(); ++x) {
       uint32 image_pixel = image_row[x];
       dst_row[x] = (image_pixel & 0xFF000000) |
                    (0x00FFFFFF - (image_pixel & 0x00FFFFFF));
@@ -110,7 +141,14 @@ SkBitmap SkBitmapOperations::CreateBlendedBitmap(const SkBitmap& first,
     uint32* second_row = second.getAddr32(0, y);
     uint32* dst_row = blended.getAddr32(0, y);
 
-    for (int x = 0; x < first.width(); ++x) {
+    int x = 0;
+#if defined(SKBITMAP_OPERATIONS_SSE2)
+    if (UseSSE2()) {
+      x = gfx::internal::BlendRow_SSE2(first_row, second_row, first_alpha,
+                                       alpha, dst_row, first.width());
+    }
+#endif
+    for (; x < first.width(); ++x) {
       uint32 first_pixel = first_row[x];
       uint32 second_pixel = second_row[x];
 
@@ -153,7 +191,14 @@ SkBitmap SkBitmapOperations::CreateMaskedBitmap(const SkBitmap& rgb,
     uint32* alpha_row = alpha.getAddr32(0, y);
     uint32* dst_row = masked.getAddr32(0, y);
 
-    for (int x = 0; x < masked.width(); ++x) {
+    int x = 0;
+#if defined(SKBITMAP_OPERATIONS_SSE2)
+    if (UseSSE2()) {
+      x = gfx::internal::MaskRow_SSE2(rgb_row, alpha_row, dst_row,
+                                      masked.width());
+    }
+#endif
+    for (; x < masked.width(); ++x) {
       SkColor rgb_pixel = SkUnPreMultiply::PMColorToColor(rgb_row[x]);
       SkColor alpha_pixel = SkUnPreMultiply::PMColorToColor(alpha_row[x]);
       int alpha = SkAlphaMul(SkColorGetA(rgb_pixel),
@@ -310,7 +355,12 @@ void LineProcHnopSnopLdec(const color_utils::HSL& hsl_shift,
   DCHECK(hsl_shift.l <= 0.5 - HSLShift::epsilon && hsl_shift.l >= 0);
 
   uint32_t ldec_num = static_cast<uint32_t>(hsl_shift.l * 2 * den);
-  for (int x = 0; x < width; x++) {
+  int x = 0;
+#if defined(SKBITMAP_OPERATIONS_SSE2)
+  if (UseSSE2())
+    x = gfx::internal::HSLShiftRowHnopSnopLdec_SSE2(in, out, width, ldec_num);
+#endif
+  for (; x < width; x++) {
     uint32_t a = SkGetPackedA32(in[x]);
     uint32_t r = SkGetPackedR32(in[x]);
     uint32_t g = SkGetPackedG32(in[x]);
@@ -334,7 +384,12 @@ void LineProcHnopSnopLinc(const color_utils::HSL& hsl_shift,
   DCHECK(hsl_shift.l >= 0.5 + HSLShift::epsilon && hsl_shift.l <= 1);
 
   uint32_t linc_num = static_cast<uint32_t>((hsl_shift.l - 0.5) * 2 * den);
-  for (int x = 0; x < width; x++) {
+  int x = 0;
+#if defined(SKBITMAP_OPERATIONS_SSE2)
+  if (UseSSE2())
+    x = gfx::internal::HSLShiftRowHnopSnopLinc_SSE2(in, out, width, linc_num);
+#endif
+  for (; x < width; x++) {
     uint32_t a = SkGetPackedA32(in[x]);
     uint32_t r = SkGetPackedR32(in[x]);
     uint32_t g = SkGetPackedG32(in[x]);
@@ -380,7 +435,12 @@ void LineProcHnopSdecLnop(const color_utils::HSL& hsl_shift,
 
   const int32_t denom = 65536;
   int32_t s_numer = static_cast<int32_t>(hsl_shift.s * 2 * denom);
-  for (int x = 0; x < width; x++) {
+  int x = 0;
+#if defined(SKBITMAP_OPERATIONS_SSE2)
+  if (UseSSE2())
+    x = gfx::internal::HSLShiftRowHnopSdecLnop_SSE2(in, out, width, s_numer);
+#endif
+  for (; x < width; x++) {
     int32_t a = static_cast<int32_t>(SkGetPackedA32(in[x]));
     int32_t r = static_cast<int32_t>(SkGetPackedR32(in[x]));
     int32_t g = static_cast<int32_t>(SkGetPackedG32(in[x]));
@@ -419,7 +479,14 @@ void LineProcHnopSdecLdec(const color_utils::HSL& hsl_shift,
   const int32_t denom = 1024;
   int32_t l_numer = static_cast<int32_t>(hsl_shift.l * 2 * denom);
   int32_t s_numer = static_cast<int32_t>(hsl_shift.s * 2 * denom);
-  for (int x = 0; x < width; x++) {
+  int x = 0;
+#if defined(SKBITMAP_OPERATIONS_SSE2)
+  if (UseSSE2()) {
+    x = gfx::internal::HSLShiftRowHnopSdecLdec_SSE2(in, out, width, s_numer,
+                                                    l_numer);
+  }
+#endif
+  for (; x < width; x++) {
     int32_t a = static_cast<int32_t>(SkGetPackedA32(in[x]));
     int32_t r = static_cast<int32_t>(SkGetPackedR32(in[x]));
     int32_t g = static_cast<int32_t>(SkGetPackedG32(in[x]));
@@ -458,7 +525,14 @@ void LineProcHnopSdecLinc(const color_utils::HSL& hsl_shift,
   const int32_t denom = 1024;
   int32_t l_numer = static_cast<int32_t>((hsl_shift.l - 0.5) * 2 * denom);
   int32_t s_numer = static_cast<int32_t>(hsl_shift.s * 2 * denom);
-  for (int x = 0; x < width; x++) {
+  int x = 0;
+#if defined(SKBITMAP_OPERATIONS_SSE2)
+  if (UseSSE2()) {
+    x = gfx::internal::HSLShiftRowHnopSdecLinc_SSE2(in, out, width, s_numer,
+                                                    l_numer);
+  }
+#endif
+  for (; x < width; x++) {
     int32_t a = static_cast<int32_t>(SkGetPackedA32(in[x]));
     int32_t r = static_cast<int32_t>(SkGetPackedR32(in[x]));
     int32_t g = static_cast<int32_t>(SkGetPackedG32(in[x]));
@@ -654,7 +728,17 @@ SkBitmap SkBitmapOperations::DownsampleByTwo(const SkBitmap& bitmap) {
 
     SkPMColor* SK_RESTRICT cur_dst = result.getAddr32(0, dest_y);
 
-    for (int dest_x = 0; dest_x <= resultLastX; ++dest_x) {
+    int dest_x = 0;
+#if defined(SKBITMAP_OPERATIONS_SSE2)
+    if (UseSSE2()) {
+      dest_x = gfx::internal::DownsampleByTwoRow_SSE2(cur_src0, cur_src1,
+                                                      bitmap.width(), cur_dst);
+      cur_src0 += dest_x << 1;
+      cur_src1 += dest_x << 1;
+      cur_dst += dest_x;
+    }
+#endif
+    for (; dest_x <= resultLastX; ++dest_x) {
       // This code is based on downsampleby2_proc32 in SkBitmap.cpp. It is very
       // clever in that it does two channels at once: alpha and green ("ag")
       // and red and blue ("rb"). Each channel gets averaged across 4 pixels
@@ -711,12 +795,17 @@ SkBitmap SkBitmapOperations::UnPreMultiply(const SkBitmap& bitmap) {
     SkAutoLockPixels bitmap_lock(bitmap);
     SkAutoLockPixels opaque_bitmap_lock(opaque_bitmap);
     for (int y = 0; y < opaque_bitmap.height(); y++) {
-      for (int x = 0; x < opaque_bitmap.width(); x++) {
-        uint32 src_pixel = *bitmap.getAddr32(x, y);
-        uint32* dst_pixel = opaque_bitmap.getAddr32(x, y);
-        SkColor unmultiplied = SkUnPreMultiply::PMColorToColor(src_pixel);
-        *dst_pixel = unmultiplied;
+      const SkPMColor* src_row = bitmap.getAddr32(0, y);
+      SkColor* dst_row = opaque_bitmap.getAddr32(0, y);
+      int x = 0;
+#if defined(SKBITMAP_OPERATIONS_SSE2)
+      if (UseSSE2()) {
+        x = gfx::internal::UnPreMultiplyRow_SSE2(src_row, dst_row,
+                                                 opaque_bitmap.width());
       }
+#endif
+      for (; x < opaque_bitmap.width(); x++)
+        dst_row[x] = SkUnPreMultiply::PMColorToColor(src_row[x]);
     }
   }
 
@@ -756,15 +845,29 @@ SkBitmap SkBitmapOperations::CreateColorMask(const SkBitmap& bitmap,
   color_mask.setConfig(SkBitmap::kARGB_8888_Config,
                        bitmap.width(), bitmap.height());
   color_mask.allocPixels();
-  color_mask.eraseARGB(0, 0, 0, 0);
-
-  SkCanvas canvas(color_mask);
 
-  skia::RefPtr<SkColorFilter> color_filter = skia::AdoptRef(
-      SkColorFilter::CreateModeFilter(c, SkXfermode::kSrcIn_Mode));
-  SkPaint paint;
-  paint.setColorFilter(color_filter.get());
-  canvas.drawBitmap(bitmap, SkIntToScalar(0), SkIntToScalar(0), &paint);
+  SkAutoLockPixels lock_bitmap(bitmap);
+  SkAutoLockPixels lock_color_mask(color_mask);
+
+  // This computes what drawing |bitmap| through an SkXfermode::kSrcIn_Mode
+  // color filter of |c| onto a transparent bitmap does: the premultiplied
+  // color scaled by the alpha of each pixel.
+  const SkPMColor color = SkPreMultiplyColor(c);
+  for (int y = 0; y < color_mask.height(); ++y) {
+    const SkPMColor* src_row = bitmap.getAddr32(0, y);
+    SkPMColor* dst_row = color_mask.getAddr32(0, y);
+    int x = 0;
+#if defined(SKBITMAP_OPERATIONS_SSE2)
+    if (UseSSE2()) {
+      x = gfx::internal::ColorMaskRow_SSE2(src_row, color, dst_row,
+                                           color_mask.width());
+    }
+#endif
+    for (; x < color_mask.width(); ++x) {
+      dst_row[x] = SkAlphaMulQ(color,
+                               SkAlpha255To256(SkGetPackedA32(src_row[x])));
+    }
+  }
   return color_mask;
 }
 
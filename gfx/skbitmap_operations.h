@@ -120,6 +120,11 @@ class UI_EXPORT SkBitmapOperations {
   // Rotates the given source bitmap clockwise by the requested amount.
   static SkBitmap Rotate(const SkBitmap& source, RotationAmount rotation);
 
+  // Enables or disables the SSE2 versions of the operations above, which are
+  // used by default when the CPU supports them. Their output is identical to
+  // that of the portable code, which tests and benchmarks compare them with.
+  static void SetSIMDEnabledForTesting(bool enabled);
+
  private:
   SkBitmapOperations();  // Class for scoping only.
 
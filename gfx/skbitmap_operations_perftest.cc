@@ -0,0 +1,46 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gfx/skbitmap_operations.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "base/basictypes.h"
+#include "base/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/gfx/skbitmap_operations_test_util.h"
+
+// Times the operations with and without SSE2 across image sizes.
+TEST(SkBitmapOperationsPerfTest, SIMD) {
+  const int kSizes[] = { 16, 64, 256, 1024 };
+  const int kPixelsPerRun = 1 << 22;
+
+  for (size_t s = 0; s < arraysize(kSizes); ++s) {
+    const int size = kSizes[s];
+    const int iterations = std::max(1, kPixelsPerRun / (size * size));
+    SkBitmap first, second;
+    gfx::test::FillRandomBitmap(size, size, 1, &first);
+    gfx::test::FillRandomBitmap(size, size, 2, &second);
+
+    for (size_t i = 0; i < gfx::test::kSIMDOperationCount; ++i) {
+      double micros[2];
+      for (int pass = 0; pass < 2; ++pass) {
+        SkBitmapOperations::SetSIMDEnabledForTesting(pass == 1);
+        base::TimeTicks start = base::TimeTicks::HighResNow();
+        for (int j = 0; j < iterations; ++j)
+          gfx::test::RunSIMDOperation(i, first, second);
+        base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+        micros[pass] =
+            static_cast<double>(elapsed.InMicroseconds()) / iterations;
+      }
+      printf("%-16s %4dx%-4d scalar %9.1f us  sse2 %9.1f us  (%.2fx)\n",
+             gfx::test::kSIMDOperationNames[i], size, size, micros[0],
+             micros[1], micros[1] > 0 ? micros[0] / micros[1] : 0.0);
+    }
+  }
+  SkBitmapOperations::SetSIMDEnabledForTesting(true);
+}
@@ -0,0 +1,389 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gfx/skbitmap_operations_sse2.h"
+
+#if defined(SKBITMAP_OPERATIONS_SSE2)
+
+#include <emmintrin.h>
+
+#include "third_party/skia/include/core/SkUnPreMultiply.h"
+
+namespace gfx {
+namespace internal {
+
+namespace {
+
+// Most kernels work on four pixels at a time with each channel in its own
+// register ("planar"), one pixel per 32-bit lane. This mirrors the scalar code,
+// which computes each channel in 32-bit integers, so every intermediate value
+// is the same as in the scalar loop.
+
+inline __m128i Load(const SkPMColor* p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+inline void Store(SkPMColor* p, __m128i pixels) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), pixels);
+}
+
+inline __m128i GetA(__m128i pixels) {
+  return _mm_srli_epi32(pixels, 24);
+}
+
+inline __m128i GetR(__m128i pixels) {
+  return _mm_and_si128(_mm_srli_epi32(pixels, 16), _mm_set1_epi32(0xFF));
+}
+
+inline __m128i GetG(__m128i pixels) {
+  return _mm_and_si128(_mm_srli_epi32(pixels, 8), _mm_set1_epi32(0xFF));
+}
+
+inline __m128i GetB(__m128i pixels) {
+  return _mm_and_si128(pixels, _mm_set1_epi32(0xFF));
+}
+
+// Equivalent of SkPackARGB32() and SkColorSetARGB(), including for channel
+// values above 255.
+inline __m128i Pack(__m128i a, __m128i r, __m128i g, __m128i b) {
+  return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(a, 24),
+                                   _mm_slli_epi32(r, 16)),
+                      _mm_or_si128(_mm_slli_epi32(g, 8), b));
+}
+
+// Multiplies the 32-bit lanes of |a| and |b| and keeps the low 32 bits of each
+// product, i.e. what uint32 multiplication does (pmulld needs SSE4.1).
+inline __m128i MulLo32(__m128i a, __m128i b) {
+  __m128i even = _mm_mul_epu32(a, b);
+  __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// Multiplies 32-bit lanes whose product is known to fit in 16 bits.
+inline __m128i MulSmall(__m128i a, __m128i b) {
+  return _mm_mullo_epi16(a, b);
+}
+
+// Returns the SkUnPreMultiply scale of each of the four pixels at |p|.
+inline __m128i GetUnPreMultiplyScales(const SkPMColor* p) {
+  return _mm_set_epi32(SkUnPreMultiply::GetScale(SkGetPackedA32(p[3])),
+                       SkUnPreMultiply::GetScale(SkGetPackedA32(p[2])),
+                       SkUnPreMultiply::GetScale(SkGetPackedA32(p[1])),
+                       SkUnPreMultiply::GetScale(SkGetPackedA32(p[0])));
+}
+
+// SkUnPreMultiply::ApplyScale().
+inline __m128i ApplyScale(__m128i scale, __m128i component) {
+  return _mm_srli_epi32(_mm_add_epi32(MulLo32(scale, component),
+                                      _mm_set1_epi32(1 << 23)), 24);
+}
+
+// static_cast<int>(first * first_alpha + second * alpha) for each lane.
+inline __m128i BlendChannel(__m128i first,
+                            __m128i second,
+                            __m128d first_alpha,
+                            __m128d alpha) {
+  __m128d lo = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(first), first_alpha),
+                          _mm_mul_pd(_mm_cvtepi32_pd(second), alpha));
+  __m128d hi = _mm_add_pd(
+      _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(first, 8)), first_alpha),
+      _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(second, 8)), alpha));
+  return _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+}
+
+inline __m128i Max3(__m128i a, __m128i b, __m128i c) {
+  // The values are at most 255, so 16-bit compares are enough.
+  return _mm_max_epi16(_mm_max_epi16(a, b), c);
+}
+
+inline __m128i Min3(__m128i a, __m128i b, __m128i c) {
+  return _mm_min_epi16(_mm_min_epi16(a, b), c);
+}
+
+// True if any lane of |a| is less than the same lane of |b|.
+inline bool AnyLess(__m128i a, __m128i b) {
+  return _mm_movemask_epi8(_mm_cmplt_epi32(a, b)) != 0;
+}
+
+}  // namespace
+
+int InvertRow_SSE2(const SkPMColor* src, SkPMColor* dst, int width) {
+  // 0x00FFFFFF - rgb == rgb ^ 0x00FFFFFF.
+  const __m128i mask = _mm_set1_epi32(0x00FFFFFF);
+  int x = 0;
+  for (; x + 4 <= width; x += 4)
+    Store(dst + x, _mm_xor_si128(Load(src + x), mask));
+  return x;
+}
+
+int BlendRow_SSE2(const SkPMColor* first,
+                  const SkPMColor* second,
+                  double first_alpha,
+                  double alpha,
+                  SkPMColor* dst,
+                  int width) {
+  const __m128d first_alpha_v = _mm_set1_pd(first_alpha);
+  const __m128d alpha_v = _mm_set1_pd(alpha);
+  int x = 0;
+  for (; x + 4 <= width; x += 4) {
+    __m128i p1 = Load(first + x);
+    __m128i p2 = Load(second + x);
+    Store(dst + x,
+          Pack(BlendChannel(GetA(p1), GetA(p2), first_alpha_v, alpha_v),
+               BlendChannel(GetR(p1), GetR(p2), first_alpha_v, alpha_v),
+               BlendChannel(GetG(p1), GetG(p2), first_alpha_v, alpha_v),
+               BlendChannel(GetB(p1), GetB(p2), first_alpha_v, alpha_v)));
+  }
+  return x;
+}
+
+int MaskRow_SSE2(const SkPMColor* rgb,
+                 const SkPMColor* alpha,
+                 SkPMColor* dst,
+                 int width) {
+  const __m128i one = _mm_set1_epi32(1);
+  int x = 0;
+  for (; x + 4 <= width; x += 4) {
+    __m128i rgb_pixels = Load(rgb + x);
+    __m128i scale = GetUnPreMultiplyScales(rgb + x);
+    __m128i a = GetA(rgb_pixels);
+    __m128i r = ApplyScale(scale, GetR(rgb_pixels));
+    __m128i g = ApplyScale(scale, GetG(rgb_pixels));
+    __m128i b = ApplyScale(scale, GetB(rgb_pixels));
+
+    // SkAlphaMul(a, SkAlpha255To256(mask_a)), then scale each channel by the
+    // result.
+    __m128i mask_a = GetA(Load(alpha + x));
+    a = _mm_srli_epi32(MulSmall(a, _mm_add_epi32(mask_a, one)), 8);
+    __m128i a_256 = _mm_add_epi32(a, one);
+    Store(dst + x, Pack(a,
+                        _mm_srli_epi32(MulSmall(r, a_256), 8),
+                        _mm_srli_epi32(MulSmall(g, a_256), 8),
+                        _mm_srli_epi32(MulSmall(b, a_256), 8)));
+  }
+  return x;
+}
+
+int UnPreMultiplyRow_SSE2(const SkPMColor* src, SkColor* dst, int width) {
+  int x = 0;
+  for (; x + 4 <= width; x += 4) {
+    __m128i pixels = Load(src + x);
+    __m128i scale = GetUnPreMultiplyScales(src + x);
+    Store(dst + x, Pack(GetA(pixels),
+                        ApplyScale(scale, GetR(pixels)),
+                        ApplyScale(scale, GetG(pixels)),
+                        ApplyScale(scale, GetB(pixels))));
+  }
+  return x;
+}
+
+int ColorMaskRow_SSE2(const SkPMColor* src,
+                      SkPMColor color,
+                      SkPMColor* dst,
+                      int width) {
+  // SkAlphaMulQ(color, SkAlpha255To256(src_a)).
+  const __m128i color_a = _mm_set1_epi32(SkGetPackedA32(color));
+  const __m128i color_r = _mm_set1_epi32(SkGetPackedR32(color));
+  const __m128i color_g = _mm_set1_epi32(SkGetPackedG32(color));
+  const __m128i color_b = _mm_set1_epi32(SkGetPackedB32(color));
+  const __m128i one = _mm_set1_epi32(1);
+  int x = 0;
+  for (; x + 4 <= width; x += 4) {
+    __m128i scale = _mm_add_epi32(GetA(Load(src + x)), one);
+    Store(dst + x, Pack(_mm_srli_epi32(MulSmall(color_a, scale), 8),
+                        _mm_srli_epi32(MulSmall(color_r, scale), 8),
+                        _mm_srli_epi32(MulSmall(color_g, scale), 8),
+                        _mm_srli_epi32(MulSmall(color_b, scale), 8)));
+  }
+  return x;
+}
+
+int DownsampleByTwoRow_SSE2(const SkPMColor* src0,
+                            const SkPMColor* src1,
+                            int src_width,
+                            SkPMColor* dst) {
+  // Each channel of the result is the sum of the four source channels divided
+  // by four, rounding down, exactly as the scalar "ag"/"rb" trick computes it.
+  const __m128i zero = _mm_setzero_si128();
+  const int dst_width = src_width / 2;
+  int x = 0;
+  for (; x + 4 <= dst_width; x += 4) {
+    __m128 top0 = _mm_castsi128_ps(Load(src0 + 2 * x));
+    __m128 top1 = _mm_castsi128_ps(Load(src0 + 2 * x + 4));
+    __m128 bottom0 = _mm_castsi128_ps(Load(src1 + 2 * x));
+    __m128 bottom1 = _mm_castsi128_ps(Load(src1 + 2 * x + 4));
+    __m128i top_left = _mm_castps_si128(
+        _mm_shuffle_ps(top0, top1, _MM_SHUFFLE(2, 0, 2, 0)));
+    __m128i top_right = _mm_castps_si128(
+        _mm_shuffle_ps(top0, top1, _MM_SHUFFLE(3, 1, 3, 1)));
+    __m128i bottom_left = _mm_castps_si128(
+        _mm_shuffle_ps(bottom0, bottom1, _MM_SHUFFLE(2, 0, 2, 0)));
+    __m128i bottom_right = _mm_castps_si128(
+        _mm_shuffle_ps(bottom0, bottom1, _MM_SHUFFLE(3, 1, 3, 1)));
+
+    __m128i sum_lo = _mm_add_epi16(
+        _mm_add_epi16(_mm_unpacklo_epi8(top_left, zero),
+                      _mm_unpacklo_epi8(top_right, zero)),
+        _mm_add_epi16(_mm_unpacklo_epi8(bottom_left, zero),
+                      _mm_unpacklo_epi8(bottom_right, zero)));
+    __m128i sum_hi = _mm_add_epi16(
+        _mm_add_epi16(_mm_unpackhi_epi8(top_left, zero),
+                      _mm_unpackhi_epi8(top_right, zero)),
+        _mm_add_epi16(_mm_unpackhi_epi8(bottom_left, zero),
+                      _mm_unpackhi_epi8(bottom_right, zero)));
+    Store(dst + x, _mm_packus_epi16(_mm_srli_epi16(sum_lo, 2),
+                                    _mm_srli_epi16(sum_hi, 2)));
+  }
+  return x;
+}
+
+int HSLShiftRowHnopSnopLdec_SSE2(const SkPMColor* in,
+                                 SkPMColor* out,
+                                 int width,
+                                 uint32_t ldec_num) {
+  // r * ldec_num / 65536 is the high half of a 16-bit multiply.
+  if (ldec_num > 0xFFFF)
+    return 0;
+  const __m128i ldec = _mm_set1_epi32(ldec_num);
+  int x = 0;
+  for (; x + 4 <= width; x += 4) {
+    __m128i pixels = Load(in + x);
+    Store(out + x, Pack(GetA(pixels),
+                        _mm_mulhi_epu16(GetR(pixels), ldec),
+                        _mm_mulhi_epu16(GetG(pixels), ldec),
+                        _mm_mulhi_epu16(GetB(pixels), ldec)));
+  }
+  return x;
+}
+
+int HSLShiftRowHnopSnopLinc_SSE2(const SkPMColor* in,
+                                 SkPMColor* out,
+                                 int width,
+                                 uint32_t linc_num) {
+  if (linc_num > 0xFFFF)
+    return 0;
+  const __m128i linc = _mm_set1_epi32(linc_num);
+  int x = 0;
+  for (; x + 4 <= width; x += 4) {
+    __m128i pixels = Load(in + x);
+    __m128i a = GetA(pixels);
+    __m128i r = GetR(pixels);
+    __m128i g = GetG(pixels);
+    __m128i b = GetB(pixels);
+    // The scalar code relies on unsigned wraparound when a channel exceeds
+    // alpha; leave such pixels to it.
+    if (AnyLess(a, Max3(r, g, b)))
+      break;
+    r = _mm_add_epi32(r, _mm_mulhi_epu16(_mm_sub_epi32(a, r), linc));
+    g = _mm_add_epi32(g, _mm_mulhi_epu16(_mm_sub_epi32(a, g), linc));
+    b = _mm_add_epi32(b, _mm_mulhi_epu16(_mm_sub_epi32(a, b), linc));
+    Store(out + x, Pack(a, r, g, b));
+  }
+  return x;
+}
+
+int HSLShiftRowHnopSdecLnop_SSE2(const SkPMColor* in,
+                                 SkPMColor* out,
+                                 int width,
+                                 int32_t s_numer) {
+  // All intermediate values are non-negative and below 2^26, so the signed
+  // divisions of the scalar code are plain shifts.
+  const __m128i s = _mm_set1_epi32(s_numer);
+  int x = 0;
+  for (; x + 4 <= width; x += 4) {
+    __m128i pixels = Load(in + x);
+    __m128i r = GetR(pixels);
+    __m128i g = GetG(pixels);
+    __m128i b = GetB(pixels);
+    __m128i vsum = _mm_add_epi32(Max3(r, g, b), Min3(r, g, b));
+
+    // denom_l - s_numer_l, with denom == 65536.
+    __m128i base = _mm_sub_epi32(_mm_slli_epi32(vsum, 15),
+                                 _mm_srli_epi32(MulLo32(vsum, s), 1));
+    r = _mm_srli_epi32(_mm_add_epi32(base, MulLo32(r, s)), 16);
+    g = _mm_srli_epi32(_mm_add_epi32(base, MulLo32(g, s)), 16);
+    b = _mm_srli_epi32(_mm_add_epi32(base, MulLo32(b, s)), 16);
+    Store(out + x, Pack(GetA(pixels), r, g, b));
+  }
+  return x;
+}
+
+int HSLShiftRowHnopSdecLdec_SSE2(const SkPMColor* in,
+                                 SkPMColor* out,
+                                 int width,
+                                 int32_t s_numer,
+                                 int32_t l_numer) {
+  const __m128i s = _mm_set1_epi32(s_numer);
+  const __m128i l = _mm_set1_epi32(l_numer);
+  int x = 0;
+  for (; x + 4 <= width; x += 4) {
+    __m128i pixels = Load(in + x);
+    __m128i r = GetR(pixels);
+    __m128i g = GetG(pixels);
+    __m128i b = GetB(pixels);
+    __m128i vsum = _mm_add_epi32(Max3(r, g, b), Min3(r, g, b));
+
+    // denom_l - s_numer_l, with denom == 1024.
+    __m128i base = _mm_sub_epi32(_mm_slli_epi32(vsum, 9),
+                                 _mm_srli_epi32(MulLo32(vsum, s), 1));
+    r = _mm_add_epi32(base, MulLo32(r, s));
+    g = _mm_add_epi32(base, MulLo32(g, s));
+    b = _mm_add_epi32(base, MulLo32(b, s));
+    Store(out + x, Pack(GetA(pixels),
+                        _mm_srli_epi32(MulLo32(r, l), 20),
+                        _mm_srli_epi32(MulLo32(g, l), 20),
+                        _mm_srli_epi32(MulLo32(b, l), 20)));
+  }
+  return x;
+}
+
+int HSLShiftRowHnopSdecLinc_SSE2(const SkPMColor* in,
+                                 SkPMColor* out,
+                                 int width,
+                                 int32_t s_numer,
+                                 int32_t l_numer) {
+  const __m128i s = _mm_set1_epi32(s_numer);
+  const __m128i l = _mm_set1_epi32(l_numer);
+  const __m128i zero = _mm_setzero_si128();
+  int x = 0;
+  for (; x + 4 <= width; x += 4) {
+    __m128i pixels = Load(in + x);
+    __m128i a = GetA(pixels);
+    __m128i r = GetR(pixels);
+    __m128i g = GetG(pixels);
+    __m128i b = GetB(pixels);
+    __m128i vsum = _mm_add_epi32(Max3(r, g, b), Min3(r, g, b));
+
+    __m128i base = _mm_sub_epi32(_mm_slli_epi32(vsum, 9),
+                                 _mm_srli_epi32(MulLo32(vsum, s), 1));
+    r = _mm_add_epi32(base, MulLo32(r, s));
+    g = _mm_add_epi32(base, MulLo32(g, s));
+    b = _mm_add_epi32(base, MulLo32(b, s));
+
+    // a * denom - channel goes negative only for pixels that are not validly
+    // premultiplied, where the scalar division rounds towards zero rather
+    // than down. Leave those to the scalar code.
+    __m128i a_denom = _mm_slli_epi32(a, 10);
+    __m128i r_inc = _mm_sub_epi32(a_denom, r);
+    __m128i g_inc = _mm_sub_epi32(a_denom, g);
+    __m128i b_inc = _mm_sub_epi32(a_denom, b);
+    if (AnyLess(_mm_or_si128(_mm_or_si128(r_inc, g_inc), b_inc), zero))
+      break;
+
+    r = _mm_add_epi32(_mm_slli_epi32(r, 10), MulLo32(r_inc, l));
+    g = _mm_add_epi32(_mm_slli_epi32(g, 10), MulLo32(g_inc, l));
+    b = _mm_add_epi32(_mm_slli_epi32(b, 10), MulLo32(b_inc, l));
+    Store(out + x, Pack(a,
+                        _mm_srli_epi32(r, 20),
+                        _mm_srli_epi32(g, 20),
+                        _mm_srli_epi32(b, 20)));
+  }
+  return x;
+}
+
+}  // namespace internal
+}  // namespace gfx
+
+#endif  // defined(SKBITMAP_OPERATIONS_SSE2)
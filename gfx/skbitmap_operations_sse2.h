@@ -0,0 +1,96 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_GFX_SKBITMAP_OPERATIONS_SSE2_H_
+#define UI_GFX_SKBITMAP_OPERATIONS_SSE2_H_
+
+#include "build/build_config.h"
+#include "third_party/skia/include/core/SkColor.h"
+#include "third_party/skia/include/core/SkColorPriv.h"
+
+// The kernels treat pixels as 32-bit words and rely on SkPMColor and SkColor
+// sharing the ARGB layout Skia uses on x86 (Android uses RGBA instead).
+#if defined(ARCH_CPU_X86_FAMILY) && SK_A32_SHIFT == 24 && \
+    SK_R32_SHIFT == 16 && SK_G32_SHIFT == 8 && SK_B32_SHIFT == 0
+#define SKBITMAP_OPERATIONS_SSE2 1
+#endif
+
+#if defined(SKBITMAP_OPERATIONS_SSE2)
+
+namespace gfx {
+namespace internal {
+
+// SSE2 versions of the per-row loops of SkBitmapOperations. Each kernel
+// processes a prefix of the row, a whole number of vectors long, and returns
+// the number of pixels it wrote; the caller finishes the row with its scalar
+// loop. The output is bit-identical to that of the scalar loop. A kernel may
+// stop early (and return 0) when its input is outside the range it handles
+// exactly, e.g. for pixels that are not validly premultiplied.
+//
+// These must only be called if base::CPU reports SSE2 support.
+
+// CreateInvertedBitmap().
+int InvertRow_SSE2(const SkPMColor* src, SkPMColor* dst, int width);
+
+// CreateBlendedBitmap(), with |first_alpha| == 1 - |alpha|.
+int BlendRow_SSE2(const SkPMColor* first,
+                  const SkPMColor* second,
+                  double first_alpha,
+                  double alpha,
+                  SkPMColor* dst,
+                  int width);
+
+// CreateMaskedBitmap().
+int MaskRow_SSE2(const SkPMColor* rgb,
+                 const SkPMColor* alpha,
+                 SkPMColor* dst,
+                 int width);
+
+// UnPreMultiply().
+int UnPreMultiplyRow_SSE2(const SkPMColor* src, SkColor* dst, int width);
+
+// CreateColorMask(); |color| is the premultiplied mask color.
+int ColorMaskRow_SSE2(const SkPMColor* src,
+                      SkPMColor color,
+                      SkPMColor* dst,
+                      int width);
+
+// DownsampleByTwo(). Only writes destination pixels whose 2x2 source block
+// lies entirely within the |src_width| pixels of |src0| and |src1|.
+int DownsampleByTwoRow_SSE2(const SkPMColor* src0,
+                            const SkPMColor* src1,
+                            int src_width,
+                            SkPMColor* dst);
+
+// The fixed-point CreateHSLShiftedBitmap() line processors. The numerators
+// are those computed by the scalar line processors.
+int HSLShiftRowHnopSnopLdec_SSE2(const SkPMColor* in,
+                                 SkPMColor* out,
+                                 int width,
+                                 uint32_t ldec_num);
+int HSLShiftRowHnopSnopLinc_SSE2(const SkPMColor* in,
+                                 SkPMColor* out,
+                                 int width,
+                                 uint32_t linc_num);
+int HSLShiftRowHnopSdecLnop_SSE2(const SkPMColor* in,
+                                 SkPMColor* out,
+                                 int width,
+                                 int32_t s_numer);
+int HSLShiftRowHnopSdecLdec_SSE2(const SkPMColor* in,
+                                 SkPMColor* out,
+                                 int width,
+                                 int32_t s_numer,
+                                 int32_t l_numer);
+int HSLShiftRowHnopSdecLinc_SSE2(const SkPMColor* in,
+                                 SkPMColor* out,
+                                 int width,
+                                 int32_t s_numer,
+                                 int32_t l_numer);
+
+}  // namespace internal
+}  // namespace gfx
+
+#endif  // defined(SKBITMAP_OPERATIONS_SSE2)
+
+#endif  // UI_GFX_SKBITMAP_OPERATIONS_SSE2_H_
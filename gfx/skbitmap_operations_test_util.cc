@@ -0,0 +1,83 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gfx/skbitmap_operations_test_util.h"
+
+#include "base/logging.h"
+#include "third_party/skia/include/core/SkColorPriv.h"
+#include "ui/gfx/color_utils.h"
+#include "ui/gfx/skbitmap_operations.h"
+
+namespace gfx {
+namespace test {
+
+void FillRandomBitmap(int w, int h, uint32 seed, SkBitmap* bmp) {
+  bmp->setConfig(SkBitmap::kARGB_8888_Config, w, h);
+  bmp->allocPixels();
+
+  SkAutoLockPixels lock(*bmp);
+  for (int y = 0, i = 0; y < h; y++) {
+    for (int x = 0; x < w; x++, i++) {
+      seed = seed * 1103515245 + 12345;
+      uint32 color = seed ^ (seed >> 15);
+      *bmp->getAddr32(x, y) =
+          i % 61 == 0 ? color : SkPreMultiplyColor(color);
+    }
+  }
+}
+
+const char* const kSIMDOperationNames[] = {
+  "Invert",
+  "Blend",
+  "Mask",
+  "HSL (L-)",
+  "HSL (L+)",
+  "HSL (S-)",
+  "HSL (S-, L-)",
+  "HSL (S-, L+)",
+  "DownsampleByTwo",
+  "UnPreMultiply",
+  "ColorMask",
+};
+
+const size_t kSIMDOperationCount = arraysize(kSIMDOperationNames);
+
+SkBitmap RunSIMDOperation(size_t index,
+                          const SkBitmap& first,
+                          const SkBitmap& second) {
+  const color_utils::HSL kShifts[] = {
+    { -1, -1, 0.2 },
+    { -1, -1, 0.8 },
+    { -1, 0.2, -1 },
+    { -1, 0.3, 0.2 },
+    { -1, 0.3, 0.9 },
+  };
+  switch (index) {
+    case 0:
+      return SkBitmapOperations::CreateInvertedBitmap(first);
+    case 1:
+      return SkBitmapOperations::CreateBlendedBitmap(first, second, 0.3);
+    case 2:
+      return SkBitmapOperations::CreateMaskedBitmap(first, second);
+    case 3:
+    case 4:
+    case 5:
+    case 6:
+    case 7:
+      return SkBitmapOperations::CreateHSLShiftedBitmap(first,
+                                                        kShifts[index - 3]);
+    case 8:
+      return SkBitmapOperations::DownsampleByTwo(first);
+    case 9:
+      return SkBitmapOperations::UnPreMultiply(first);
+    case 10:
+      return SkBitmapOperations::CreateColorMask(
+          first, SkColorSetARGB(0xC0, 0x20, 0x80, 0xF0));
+  }
+  NOTREACHED();
+  return SkBitmap();
+}
+
+}  // namespace test
+}  // namespace gfx
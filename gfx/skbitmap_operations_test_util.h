@@ -0,0 +1,35 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Helpers shared by the SkBitmapOperations unit tests and perf tests to run
+// the operations that have SIMD versions.
+
+#ifndef UI_GFX_SKBITMAP_OPERATIONS_TEST_UTIL_H_
+#define UI_GFX_SKBITMAP_OPERATIONS_TEST_UTIL_H_
+
+#include "base/basictypes.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+
+namespace gfx {
+namespace test {
+
+// Fills |bmp| with pseudo-random premultiplied pixels derived from |seed|.
+// Every 61st pixel is not premultiplied, as in a corrupt image.
+void FillRandomBitmap(int w, int h, uint32 seed, SkBitmap* bmp);
+
+// The operations that have SSE2 versions, including one of each kind of
+// fixed-point HSL shift.
+extern const char* const kSIMDOperationNames[];
+extern const size_t kSIMDOperationCount;
+
+// Runs the operation at |index| in kSIMDOperationNames on |first|, and on
+// |second| for the operations taking two bitmaps.
+SkBitmap RunSIMDOperation(size_t index,
+                          const SkBitmap& first,
+                          const SkBitmap& second);
+
+}  // namespace test
+}  // namespace gfx
+
+#endif  // UI_GFX_SKBITMAP_OPERATIONS_TEST_UTIL_H_
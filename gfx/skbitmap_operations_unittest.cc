@@ -4,13 +4,17 @@
 
 #include "ui/gfx/skbitmap_operations.h"
 
+#include <string.h>
+
 #include "testing/gtest/include/gtest/gtest.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkColorFilter.h"
 #include "third_party/skia/include/core/SkColorPriv.h"
 #include "third_party/skia/include/core/SkRect.h"
 #include "third_party/skia/include/core/SkRegion.h"
 #include "third_party/skia/include/core/SkUnPreMultiply.h"
+#include "ui/gfx/skbitmap_operations_test_util.h"
 
 namespace {
 
@@ -57,6 +61,19 @@ void FillDataToBitmap(int w, int h, SkBitmap* bmp) {
   }
 }
 
+bool BitmapsEqual(const SkBitmap& a, const SkBitmap& b) {
+  if (a.width() != b.width() || a.height() != b.height())
+    return false;
+
+  SkAutoLockPixels a_lock(a);
+  SkAutoLockPixels b_lock(b);
+  for (int y = 0; y < a.height(); y++) {
+    if (memcmp(a.getAddr32(0, y), b.getAddr32(0, y), a.width() * 4) != 0)
+      return false;
+  }
+  return true;
+}
+
 // The reference (i.e., old) implementation of |CreateHSLShiftedBitmap()|.
 SkBitmap ReferenceCreateHSLShiftedBitmap(
     const SkBitmap& bitmap,
@@ -581,3 +598,47 @@ TEST(SkBitmapOperationsTest, RotateImage) {
     }
   }
 }
+
+// CreateColorMask() computes directly what drawing the bitmap through a
+// kSrcIn_Mode color filter does.
+TEST(SkBitmapOperationsTest, CreateColorMask) {
+  int src_w = 16, src_h = 16;
+  SkBitmap src;
+  FillDataToBitmap(src_w, src_h, &src);
+  const SkColor color = SkColorSetARGB(0xC0, 0x20, 0x80, 0xF0);
+
+  SkBitmap expected;
+  expected.setConfig(SkBitmap::kARGB_8888_Config, src_w, src_h);
+  expected.allocPixels();
+  expected.eraseARGB(0, 0, 0, 0);
+  SkCanvas canvas(expected);
+  SkColorFilter* filter =
+      SkColorFilter::CreateModeFilter(color, SkXfermode::kSrcIn_Mode);
+  SkPaint paint;
+  paint.setColorFilter(filter);
+  filter->unref();
+  canvas.drawBitmap(src, SkIntToScalar(0), SkIntToScalar(0), &paint);
+
+  SkBitmap mask = SkBitmapOperations::CreateColorMask(src, color);
+  EXPECT_TRUE(BitmapsClose(expected, mask));
+
+  SkAutoLockPixels lock(mask);
+  EXPECT_EQ(0U, *mask.getAddr32(0, 0));
+}
+
+// The SSE2 versions of the operations must produce exactly the same pixels as
+// the portable code. The odd width exercises the scalar tail of each row.
+TEST(SkBitmapOperationsTest, SIMDMatchesScalar) {
+  SkBitmap first, second;
+  gfx::test::FillRandomBitmap(37, 9, 1, &first);
+  gfx::test::FillRandomBitmap(37, 9, 2, &second);
+
+  for (size_t i = 0; i < gfx::test::kSIMDOperationCount; ++i) {
+    SkBitmapOperations::SetSIMDEnabledForTesting(false);
+    SkBitmap scalar = gfx::test::RunSIMDOperation(i, first, second);
+    SkBitmapOperations::SetSIMDEnabledForTesting(true);
+    SkBitmap simd = gfx::test::RunSIMDOperation(i, first, second);
+    EXPECT_TRUE(BitmapsEqual(scalar, simd))
+        << gfx::test::kSIMDOperationNames[i];
+  }
+}
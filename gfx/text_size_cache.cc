@@ -0,0 +1,164 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gfx/text_size_cache.h"
+
+#include "base/logging.h"
+#include "base/memory/singleton.h"
+#include "ui/gfx/font.h"
+
+namespace gfx {
+
+namespace {
+
+// FNV-1a over the UTF-16 code units of |text|.
+size_t HashText(const string16& text) {
+  size_t hash = 2166136261u;
+  for (size_t i = 0; i < text.length(); ++i) {
+    hash ^= static_cast<size_t>(text[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+}  // namespace
+
+// static
+const size_t TextSizeCache::kDefaultMaxEntries = 2048;
+
+TextSizeCache::Key::Key()
+    : text_hash(0),
+      flags(0),
+      width(0),
+      font_size(0),
+      font_style(0) {
+}
+
+TextSizeCache::Key::~Key() {
+}
+
+bool TextSizeCache::Key::operator<(const Key& other) const {
+  // Compare the cheap fields first so that the full text is only compared
+  // when the hashes collide.
+  if (text_hash != other.text_hash)
+    return text_hash < other.text_hash;
+  if (flags != other.flags)
+    return flags < other.flags;
+  if (width != other.width)
+    return width < other.width;
+  if (font_size != other.font_size)
+    return font_size < other.font_size;
+  if (font_style != other.font_style)
+    return font_style < other.font_style;
+  if (font_name != other.font_name)
+    return font_name < other.font_name;
+  return text < other.text;
+}
+
+TextSizeCache::TextSizeCache(size_t max_entries)
+    : max_entries_(max_entries),
+      hit_count_(0),
+      miss_count_(0) {
+  DCHECK_GT(max_entries_, 0U);
+}
+
+TextSizeCache::TextSizeCache()
+    : max_entries_(kDefaultMaxEntries),
+      hit_count_(0),
+      miss_count_(0) {
+}
+
+TextSizeCache::~TextSizeCache() {
+}
+
+// static
+TextSizeCache* TextSizeCache::GetInstance() {
+  return Singleton<TextSizeCache>::get();
+}
+
+bool TextSizeCache::Lookup(const string16& text,
+                           const Font& font,
+                           int flags,
+                           int width,
+                           Size* size) {
+  const Key key = MakeKey(text, font, flags, width);
+  base::AutoLock lock(lock_);
+  EntryMap::iterator found = index_.find(key);
+  if (found == index_.end()) {
+    ++miss_count_;
+    return false;
+  }
+  ++hit_count_;
+  // Move the entry to the front of the recency list.
+  entries_.splice(entries_.begin(), entries_, found->second);
+  *size = found->second->second;
+  return true;
+}
+
+void TextSizeCache::Insert(const string16& text,
+                           const Font& font,
+                           int flags,
+                           int width,
+                           const Size& size) {
+  const Key key = MakeKey(text, font, flags, width);
+  base::AutoLock lock(lock_);
+  EntryMap::iterator found = index_.find(key);
+  if (found != index_.end()) {
+    // Another thread measured the same text concurrently.
+    found->second->second = size;
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return;
+  }
+  if (index_.size() >= max_entries_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.push_front(std::make_pair(key, size));
+  index_[key] = entries_.begin();
+}
+
+void TextSizeCache::Clear() {
+  base::AutoLock lock(lock_);
+  index_.clear();
+  entries_.clear();
+}
+
+void TextSizeCache::ResetCounters() {
+  base::AutoLock lock(lock_);
+  hit_count_ = 0;
+  miss_count_ = 0;
+}
+
+size_t TextSizeCache::hit_count() const {
+  base::AutoLock lock(lock_);
+  return hit_count_;
+}
+
+size_t TextSizeCache::miss_count() const {
+  base::AutoLock lock(lock_);
+  return miss_count_;
+}
+
+size_t TextSizeCache::size() const {
+  base::AutoLock lock(lock_);
+  return index_.size();
+}
+
+// static
+TextSizeCache::Key TextSizeCache::MakeKey(const string16& text,
+                                          const Font& font,
+                                          int flags,
+                                          int width) {
+  Key key;
+  key.text_hash = HashText(text);
+  key.flags = flags;
+  key.width = width;
+  key.font_size = font.GetFontSize();
+  key.font_style = font.GetStyle();
+  key.font_name = font.GetFontName();
+  key.text = text;
+  return key;
+}
+
+}  // namespace gfx
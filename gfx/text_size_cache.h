@@ -0,0 +1,121 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_GFX_TEXT_SIZE_CACHE_H_
+#define UI_GFX_TEXT_SIZE_CACHE_H_
+
+#include <list>
+#include <map>
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/string16.h"
+#include "base/synchronization/lock.h"
+#include "ui/base/ui_export.h"
+#include "ui/gfx/size.h"
+
+template <typename T> struct DefaultSingletonTraits;
+
+namespace gfx {
+
+class Font;
+
+// A bounded, least-recently-used cache of text sizes computed by
+// Canvas::SizeStringInt(). Measuring a string requires building and laying out
+// a RenderText, which is expensive; labels, buttons, elision and table column
+// sizing measure the same (text, font, flags) tuples many times per layout.
+//
+// Entries are keyed by a hash of the text (with the text itself kept to
+// resolve collisions), the font identity (name, size and style), the drawing
+// flags and, for multi-line text, the available width. The cache is safe to
+// use from multiple threads. It must be cleared whenever the fonts backing a
+// gfx::Font may have changed; ResourceBundle::ReloadFonts() does so.
+class UI_EXPORT TextSizeCache {
+ public:
+  // The number of entries kept by the process-wide instance.
+  static const size_t kDefaultMaxEntries;
+
+  // Creates a standalone cache holding at most |max_entries| sizes. Most code
+  // should use the process-wide instance returned by GetInstance().
+  explicit TextSizeCache(size_t max_entries);
+  ~TextSizeCache();
+
+  static TextSizeCache* GetInstance();
+
+  // Looks up the size of |text| drawn with |font| and |flags| inside a box
+  // |width| pixels wide (only meaningful for multi-line text; pass 0
+  // otherwise). Returns true and fills |size| on a hit.
+  bool Lookup(const string16& text,
+              const Font& font,
+              int flags,
+              int width,
+              Size* size);
+
+  // Records |size| as the measurement for the given parameters, evicting the
+  // least recently used entry if the cache is full.
+  void Insert(const string16& text,
+              const Font& font,
+              int flags,
+              int width,
+              const Size& size);
+
+  // Drops all cached sizes. Hit and miss counters are preserved.
+  void Clear();
+
+  // Resets the hit and miss counters to zero.
+  void ResetCounters();
+
+  size_t hit_count() const;
+  size_t miss_count() const;
+  size_t size() const;
+  size_t max_entries() const { return max_entries_; }
+
+ private:
+  friend struct DefaultSingletonTraits<TextSizeCache>;
+
+  struct Key {
+    Key();
+    ~Key();
+
+    bool operator<(const Key& other) const;
+
+    size_t text_hash;
+    int flags;
+    int width;
+    int font_size;
+    int font_style;
+    std::string font_name;
+    string16 text;
+  };
+
+  typedef std::list<std::pair<Key, Size> > EntryList;
+  typedef std::map<Key, EntryList::iterator> EntryMap;
+
+  TextSizeCache();
+
+  static Key MakeKey(const string16& text,
+                     const Font& font,
+                     int flags,
+                     int width);
+
+  const size_t max_entries_;
+
+  // Guards all members below.
+  mutable base::Lock lock_;
+
+  // Entries ordered from most to least recently used.
+  EntryList entries_;
+
+  // Index from key into |entries_|.
+  EntryMap index_;
+
+  size_t hit_count_;
+  size_t miss_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(TextSizeCache);
+};
+
+}  // namespace gfx
+
+#endif  // UI_GFX_TEXT_SIZE_CACHE_H_
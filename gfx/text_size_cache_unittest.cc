@@ -0,0 +1,94 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gfx/text_size_cache.h"
+
+#include "base/utf_string_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/gfx/canvas.h"
+#include "ui/gfx/font.h"
+
+namespace gfx {
+
+TEST(TextSizeCacheTest, HitAndMiss) {
+  TextSizeCache cache(4);
+  const Font font;
+  const string16 text = ASCIIToUTF16("hello");
+  Size size;
+
+  EXPECT_FALSE(cache.Lookup(text, font, 0, 0, &size));
+  EXPECT_EQ(0U, cache.hit_count());
+  EXPECT_EQ(1U, cache.miss_count());
+
+  cache.Insert(text, font, 0, 0, Size(30, 12));
+  EXPECT_TRUE(cache.Lookup(text, font, 0, 0, &size));
+  EXPECT_EQ(Size(30, 12).ToString(), size.ToString());
+  EXPECT_EQ(1U, cache.hit_count());
+
+  // Differing flags, widths or fonts are distinct entries.
+  EXPECT_FALSE(cache.Lookup(text, font, Canvas::MULTI_LINE, 0, &size));
+  EXPECT_FALSE(cache.Lookup(text, font, 0, 100, &size));
+  EXPECT_FALSE(cache.Lookup(text, font.DeriveFont(2), 0, 0, &size));
+  EXPECT_FALSE(cache.Lookup(text, font.DeriveFont(0, Font::BOLD), 0, 0,
+                            &size));
+  EXPECT_EQ(5U, cache.miss_count());
+
+  cache.ResetCounters();
+  EXPECT_EQ(0U, cache.hit_count());
+  EXPECT_EQ(0U, cache.miss_count());
+}
+
+TEST(TextSizeCacheTest, EvictsLeastRecentlyUsed) {
+  TextSizeCache cache(2);
+  const Font font;
+  const string16 a = ASCIIToUTF16("a");
+  const string16 b = ASCIIToUTF16("b");
+  const string16 c = ASCIIToUTF16("c");
+  Size size;
+
+  cache.Insert(a, font, 0, 0, Size(1, 1));
+  cache.Insert(b, font, 0, 0, Size(2, 1));
+  // Touch |a| so that |b| becomes the least recently used entry.
+  EXPECT_TRUE(cache.Lookup(a, font, 0, 0, &size));
+  cache.Insert(c, font, 0, 0, Size(3, 1));
+
+  EXPECT_EQ(2U, cache.size());
+  EXPECT_TRUE(cache.Lookup(a, font, 0, 0, &size));
+  EXPECT_FALSE(cache.Lookup(b, font, 0, 0, &size));
+  EXPECT_TRUE(cache.Lookup(c, font, 0, 0, &size));
+  EXPECT_EQ(3, size.width());
+}
+
+TEST(TextSizeCacheTest, Clear) {
+  TextSizeCache cache(4);
+  const Font font;
+  const string16 text = ASCIIToUTF16("text");
+  Size size;
+
+  cache.Insert(text, font, 0, 0, Size(10, 10));
+  EXPECT_TRUE(cache.Lookup(text, font, 0, 0, &size));
+  cache.Clear();
+  EXPECT_EQ(0U, cache.size());
+  EXPECT_FALSE(cache.Lookup(text, font, 0, 0, &size));
+  // Counters survive clearing.
+  EXPECT_EQ(1U, cache.hit_count());
+  EXPECT_EQ(1U, cache.miss_count());
+}
+
+// Mac measures text natively rather than through canvas_skia.cc.
+#if !defined(OS_MACOSX)
+TEST(TextSizeCacheTest, CanvasUsesCache) {
+  TextSizeCache* cache = TextSizeCache::GetInstance();
+  cache->Clear();
+  const Font font;
+  const string16 text = ASCIIToUTF16("measured twice");
+
+  const size_t hits = cache->hit_count();
+  const int width = Canvas::GetStringWidth(text, font);
+  EXPECT_EQ(width, Canvas::GetStringWidth(text, font));
+  EXPECT_EQ(hits + 1, cache->hit_count());
+}
+#endif
+
+}  // namespace gfx
@@ -30,6 +30,53 @@ double TanDegrees(double degrees) {
   return std::tan(radians);
 }
 
+Transform::Type GetMatrixType(const SkMatrix44& matrix) {
+  SkMatrix44::TypeMask mask = matrix.getType();
+  if (mask & SkMatrix44::kPerspective_Mask)
+    return Transform::TYPE_PERSPECTIVE;
+  if (mask & SkMatrix44::kAffine_Mask)
+    return Transform::TYPE_AFFINE;
+  if (mask & SkMatrix44::kScale_Mask)
+    return Transform::TYPE_SCALE_TRANSLATE;
+  if (mask & SkMatrix44::kTranslate_Mask)
+    return Transform::TYPE_TRANSLATE;
+  return Transform::TYPE_IDENTITY;
+}
+
+// Maps the homogeneous point |p|, whose w component is 1, through |xform|.
+// Matrices without perspective leave w at 1, so only the rows that can change
+// are evaluated. The partial products computed are exactly those mapMScalars()
+// would compute, so the results are identical.
+void MapPoint(const SkMatrix44& xform, Transform::Type type, SkMScalar p[4]) {
+  switch (type) {
+    case Transform::TYPE_IDENTITY:
+      return;
+    case Transform::TYPE_TRANSLATE:
+      p[0] += xform.get(0, 3);
+      p[1] += xform.get(1, 3);
+      p[2] += xform.get(2, 3);
+      return;
+    case Transform::TYPE_SCALE_TRANSLATE:
+      p[0] = p[0] * xform.get(0, 0) + xform.get(0, 3);
+      p[1] = p[1] * xform.get(1, 1) + xform.get(1, 3);
+      p[2] = p[2] * xform.get(2, 2) + xform.get(2, 3);
+      return;
+    case Transform::TYPE_AFFINE: {
+      SkMScalar x = p[0];
+      SkMScalar y = p[1];
+      SkMScalar z = p[2];
+      for (int row = 0; row < 3; ++row) {
+        p[row] = xform.get(row, 0) * x + xform.get(row, 1) * y +
+                 xform.get(row, 2) * z + xform.get(row, 3);
+      }
+      return;
+    }
+    case Transform::TYPE_PERSPECTIVE:
+      xform.mapMScalars(p);
+      return;
+  }
+}
+
 }  // namespace
 
 Transform::Transform(
@@ -196,11 +243,37 @@ void Transform::ApplyPerspectiveDepth(double depth) {
 }
 
 void Transform::PreconcatTransform(const Transform& transform) {
-  matrix_.preConcat(transform.matrix_);
+  // Walking up a view or layer hierarchy concatenates mostly identity and
+  // translation matrices, which don't need a full 4x4 multiply.
+  switch (transform.GetType()) {
+    case TYPE_IDENTITY:
+      return;
+    case TYPE_TRANSLATE:
+      matrix_.preTranslate(transform.matrix_.get(0, 3),
+                           transform.matrix_.get(1, 3),
+                           transform.matrix_.get(2, 3));
+      return;
+    default:
+      matrix_.preConcat(transform.matrix_);
+  }
 }
 
 void Transform::ConcatTransform(const Transform& transform) {
-  matrix_.postConcat(transform.matrix_);
+  switch (transform.GetType()) {
+    case TYPE_IDENTITY:
+      return;
+    case TYPE_TRANSLATE:
+      matrix_.postTranslate(transform.matrix_.get(0, 3),
+                            transform.matrix_.get(1, 3),
+                            transform.matrix_.get(2, 3));
+      return;
+    default:
+      matrix_.postConcat(transform.matrix_);
+  }
+}
+
+Transform::Type Transform::GetType() const {
+  return GetMatrixType(matrix_);
 }
 
 bool Transform::IsIdentityOrIntegerTranslation() const {
@@ -287,6 +360,19 @@ bool Transform::IsBackFaceVisible() const {
 }
 
 bool Transform::GetInverse(Transform* transform) const {
+  switch (GetType()) {
+    case TYPE_IDENTITY:
+      transform->MakeIdentity();
+      return true;
+    case TYPE_TRANSLATE:
+      transform->matrix_.setTranslate(-matrix_.get(0, 3),
+                                      -matrix_.get(1, 3),
+                                      -matrix_.get(2, 3));
+      return true;
+    default:
+      break;
+  }
+
   if (!matrix_.invert(&transform->matrix_)) {
     // Initialize the return value to identity if this matrix turned
     // out to be un-invertible.
@@ -312,36 +398,76 @@ void Transform::FlattenTo2d() {
 }
 
 void Transform::TransformPoint(Point& point) const {
-  TransformPointInternal(matrix_, point);
+  TransformPointInternal(matrix_, GetType(), point);
 }
 
 void Transform::TransformPoint(Point3F& point) const {
-  TransformPointInternal(matrix_, point);
+  TransformPointInternal(matrix_, GetType(), point);
+}
+
+void Transform::TransformPoints(Point3F* points, size_t count) const {
+  Type type = GetType();
+  if (type == TYPE_IDENTITY)
+    return;
+  for (size_t i = 0; i < count; ++i)
+    TransformPointInternal(matrix_, type, points[i]);
+}
+
+void Transform::TransformPoints(Point* points, size_t count) const {
+  Type type = GetType();
+  if (type == TYPE_IDENTITY)
+    return;
+  for (size_t i = 0; i < count; ++i)
+    TransformPointInternal(matrix_, type, points[i]);
 }
 
 bool Transform::TransformPointReverse(Point& point) const {
-  // TODO(sad): Try to avoid trying to invert the matrix.
+  Type type = GetType();
+  if (type == TYPE_IDENTITY)
+    return true;
+  if (type == TYPE_TRANSLATE) {
+    // Undoing a translation doesn't need the matrix inverted.
+    point.SetPoint(ToRoundedInt(point.x() - matrix_.get(0, 3)),
+                   ToRoundedInt(point.y() - matrix_.get(1, 3)));
+    return true;
+  }
+
   SkMatrix44 inverse(SkMatrix44::kUninitialized_Constructor);
   if (!matrix_.invert(&inverse))
     return false;
 
-  TransformPointInternal(inverse, point);
+  TransformPointInternal(inverse, GetMatrixType(inverse), point);
   return true;
 }
 
 bool Transform::TransformPointReverse(Point3F& point) const {
-  // TODO(sad): Try to avoid trying to invert the matrix.
+  Type type = GetType();
+  if (type == TYPE_IDENTITY)
+    return true;
+  if (type == TYPE_TRANSLATE) {
+    point.SetPoint(point.x() - matrix_.get(0, 3),
+                   point.y() - matrix_.get(1, 3),
+                   point.z() - matrix_.get(2, 3));
+    return true;
+  }
+
   SkMatrix44 inverse(SkMatrix44::kUninitialized_Constructor);
   if (!matrix_.invert(&inverse))
     return false;
 
-  TransformPointInternal(inverse, point);
+  TransformPointInternal(inverse, GetMatrixType(inverse), point);
   return true;
 }
 
 void Transform::TransformRect(RectF* rect) const {
-  if (matrix_.isIdentity())
+  Type type = GetType();
+  if (type == TYPE_IDENTITY)
     return;
+  if (type == TYPE_TRANSLATE) {
+    rect->Offset(SkMScalarToFloat(matrix_.get(0, 3)),
+                 SkMScalarToFloat(matrix_.get(1, 3)));
+    return;
+  }
 
   SkRect src = RectFToSkRect(*rect);
   const SkMatrix& matrix = matrix_;
@@ -350,8 +476,14 @@ void Transform::TransformRect(RectF* rect) const {
 }
 
 bool Transform::TransformRectReverse(RectF* rect) const {
-  if (matrix_.isIdentity())
+  Type type = GetType();
+  if (type == TYPE_IDENTITY)
+    return true;
+  if (type == TYPE_TRANSLATE) {
+    rect->Offset(-SkMScalarToFloat(matrix_.get(0, 3)),
+                 -SkMScalarToFloat(matrix_.get(1, 3)));
     return true;
+  }
 
   SkMatrix44 inverse(SkMatrix44::kUninitialized_Constructor);
   if (!matrix_.invert(&inverse))
@@ -387,8 +519,9 @@ bool Transform::Blend(const Transform& from, double progress) {
 }
 
 void Transform::TransformPointInternal(const SkMatrix44& xform,
+                                       Type type,
                                        Point3F& point) const {
-  if (xform.isIdentity())
+  if (type == TYPE_IDENTITY)
     return;
 
   SkMScalar p[4] = {
@@ -398,7 +531,7 @@ void Transform::TransformPointInternal(const SkMatrix44& xform,
     SkDoubleToMScalar(1)
   };
 
-  xform.mapMScalars(p);
+  MapPoint(xform, type, p);
 
   if (p[3] != 1 && abs(p[3]) > 0) {
     point.SetPoint(p[0] / p[3], p[1] / p[3], p[2]/ p[3]);
@@ -408,8 +541,9 @@ void Transform::TransformPointInternal(const SkMatrix44& xform,
 }
 
 void Transform::TransformPointInternal(const SkMatrix44& xform,
+                                       Type type,
                                        Point& point) const {
-  if (xform.isIdentity())
+  if (type == TYPE_IDENTITY)
     return;
 
   SkMScalar p[4] = {
@@ -419,7 +553,7 @@ void Transform::TransformPointInternal(const SkMatrix44& xform,
     SkDoubleToMScalar(1)
   };
 
-  xform.mapMScalars(p);
+  MapPoint(xform, type, p);
 
   point.SetPoint(ToRoundedInt(p[0]), ToRoundedInt(p[1]));
 }
@@ -23,6 +23,16 @@ class Vector3dF;
 class UI_EXPORT Transform {
  public:
 
+  // The kind of mapping the matrix performs, from the cheapest to apply to the
+  // most expensive. Each type is a special case of the ones after it.
+  enum Type {
+    TYPE_IDENTITY,
+    TYPE_TRANSLATE,
+    TYPE_SCALE_TRANSLATE,
+    TYPE_AFFINE,
+    TYPE_PERSPECTIVE
+  };
+
   enum SkipInitialization {
     kSkipInitialization
   };
@@ -98,6 +108,10 @@ class UI_EXPORT Transform {
   // Returns true if this is the identity matrix.
   bool IsIdentity() const { return matrix_.isIdentity(); }
 
+  // Returns the most specific type describing this matrix. The underlying
+  // SkMatrix44 caches its type mask, so this is cheap to call repeatedly.
+  Type GetType() const;
+
   // Returns true if the matrix is either identity or pure translation.
   bool IsIdentityOrTranslation() const {
     return !(matrix_.getType() & ~SkMatrix44::kTranslate_Mask);
@@ -165,6 +179,12 @@ class UI_EXPORT Transform {
   // transformed successfully. Rounds the result to the nearest point.
   void TransformPoint(Point& point) const;
 
+  // Applies the transformation on each of the |count| points in |points|.
+  // Equivalent to calling TransformPoint() on each of them, but only
+  // classifies the matrix once.
+  void TransformPoints(Point3F* points, size_t count) const;
+  void TransformPoints(Point* points, size_t count) const;
+
   // Applies the reverse transformation on the point. Returns true if the
   // transformation can be inverted.
   bool TransformPointReverse(Point3F& point) const;
@@ -214,9 +234,11 @@ class UI_EXPORT Transform {
 
  private:
   void TransformPointInternal(const SkMatrix44& xform,
+                              Type type,
                               Point& point) const;
 
   void TransformPointInternal(const SkMatrix44& xform,
+                              Type type,
                               Point3F& point) const;
 
   SkMatrix44 matrix_;
@@ -0,0 +1,82 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gfx/transform.h"
+
+#include <stdio.h>
+
+#include <cmath>
+
+#include "base/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/gfx/point3_f.h"
+
+namespace gfx {
+
+namespace {
+
+// Maps |point| through the full 4x4 matrix, the way TransformPoint() did
+// before it had per-type fast paths.
+Point3F MapPointGeneric(const SkMatrix44& matrix, const Point3F& point) {
+  SkMScalar p[4] = {
+    SkDoubleToMScalar(point.x()),
+    SkDoubleToMScalar(point.y()),
+    SkDoubleToMScalar(point.z()),
+    SkDoubleToMScalar(1)
+  };
+  matrix.mapMScalars(p);
+  if (p[3] != 1 && std::abs(p[3]) > 0)
+    return Point3F(p[0] / p[3], p[1] / p[3], p[2] / p[3]);
+  return Point3F(p[0], p[1], p[2]);
+}
+
+}  // namespace
+
+// Times converting a point out of a deep hierarchy the way View and Layer do:
+// concatenate each ancestor's transform and offset, then map the point.
+TEST(TransformPerfTest, AncestorWalk) {
+  const int kDepth = 12;
+  const int kIterations = 200000;
+
+  Transform ancestors[kDepth];
+  for (int i = 0; i < kDepth; ++i) {
+    // Every fourth ancestor is scaled; the rest have identity transforms.
+    if (i % 4 == 3)
+      ancestors[i].Scale(1.25, 1.25);
+  }
+
+  double micros[2];
+  float checksum[2] = { 0, 0 };
+  for (int pass = 0; pass < 2; ++pass) {
+    base::TimeTicks start = base::TimeTicks::HighResNow();
+    for (int j = 0; j < kIterations; ++j) {
+      Transform transform;
+      for (int i = 0; i < kDepth; ++i) {
+        Transform translation;
+        translation.Translate(i * 3, i * 5);
+        if (pass == 0) {
+          transform.matrix().postConcat(ancestors[i].matrix());
+          transform.matrix().postConcat(translation.matrix());
+        } else {
+          transform.ConcatTransform(ancestors[i]);
+          transform.ConcatTransform(translation);
+        }
+      }
+      Point3F point(j % 640, j % 480, 0);
+      if (pass == 0)
+        point = MapPointGeneric(transform.matrix(), point);
+      else
+        transform.TransformPoint(point);
+      checksum[pass] += point.x() + point.y();
+    }
+    base::TimeDelta elapsed = base::TimeTicks::HighResNow() - start;
+    micros[pass] = static_cast<double>(elapsed.InMicroseconds()) / kIterations;
+  }
+  EXPECT_FLOAT_EQ(checksum[0], checksum[1]);
+  printf("depth %d  generic %.3f us  typed %.3f us  (%.2fx)\n",
+         kDepth, micros[0], micros[1],
+         micros[1] > 0 ? micros[0] / micros[1] : 0.0);
+}
+
+}  // namespace gfx
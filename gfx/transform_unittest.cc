@@ -15,6 +15,8 @@
 #include "testing/gtest/include/gtest/gtest.h"
 #include "ui/gfx/point.h"
 #include "ui/gfx/point3_f.h"
+#include "ui/gfx/rect_f.h"
+#include "ui/gfx/safe_integer_conversions.h"
 #include "ui/gfx/transform_util.h"
 #include "ui/gfx/vector3d_f.h"
 
@@ -2218,6 +2220,162 @@ TEST(XFormTest, verifyFlattenTo2d) {
   EXPECT_ROW4_EQ(13.0f, 17.0f, 0.0f, 25.0f, A);
 }
 
+// Maps |point| through the full 4x4 matrix, the way TransformPoint() did
+// before it had per-type fast paths.
+Point3F MapPointGeneric(const SkMatrix44& matrix, const Point3F& point) {
+  SkMScalar p[4] = {
+    SkDoubleToMScalar(point.x()),
+    SkDoubleToMScalar(point.y()),
+    SkDoubleToMScalar(point.z()),
+    SkDoubleToMScalar(1)
+  };
+  matrix.mapMScalars(p);
+  if (p[3] != 1 && std::abs(p[3]) > 0)
+    return Point3F(p[0] / p[3], p[1] / p[3], p[2] / p[3]);
+  return Point3F(p[0], p[1], p[2]);
+}
+
+TEST(XFormTest, GetType) {
+  Transform A;
+  EXPECT_EQ(Transform::TYPE_IDENTITY, A.GetType());
+
+  A.Translate(3, -4);
+  EXPECT_EQ(Transform::TYPE_TRANSLATE, A.GetType());
+
+  A.Scale(2, 2);
+  EXPECT_EQ(Transform::TYPE_SCALE_TRANSLATE, A.GetType());
+
+  A.Rotate(30);
+  EXPECT_EQ(Transform::TYPE_AFFINE, A.GetType());
+
+  A.ApplyPerspectiveDepth(100);
+  EXPECT_EQ(Transform::TYPE_PERSPECTIVE, A.GetType());
+
+  // A w scale is a perspective component.
+  A.MakeIdentity();
+  A.matrix().setDouble(3, 3, 2.0);
+  EXPECT_EQ(Transform::TYPE_PERSPECTIVE, A.GetType());
+
+  // The type follows edits made through matrix().
+  A.MakeIdentity();
+  A.matrix().setDouble(2, 3, 1.0);
+  EXPECT_EQ(Transform::TYPE_TRANSLATE, A.GetType());
+  A.matrix().setDouble(0, 1, 1.0);
+  EXPECT_EQ(Transform::TYPE_AFFINE, A.GetType());
+}
+
+// The per-type fast paths must map points exactly as the full matrix does.
+TEST(XFormTest, FastPathsMatchGenericMapping) {
+  Transform transforms[5];
+  transforms[1].Translate3d(10.5, -20.25, 3);
+  transforms[2].Translate(7, 8);
+  transforms[2].Scale3d(1.5, -2, 0.5);
+  transforms[3].Translate(7, 8);
+  transforms[3].Rotate(33);
+  transforms[3].SkewX(10);
+  transforms[4].ApplyPerspectiveDepth(500);
+  transforms[4].RotateAboutYAxis(20);
+  transforms[4].Translate(-3, 5);
+
+  const Point3F kPoints[] = {
+    Point3F(0, 0, 0),
+    Point3F(1, 2, 3),
+    Point3F(-17.5f, 42.25f, 0),
+    Point3F(1000, -0.125f, -8),
+  };
+
+  for (size_t t = 0; t < arraysize(transforms); ++t) {
+    const Transform& xform = transforms[t];
+    EXPECT_EQ(static_cast<Transform::Type>(t), xform.GetType());
+
+    Point3F batch[arraysize(kPoints)];
+    Point batch_2d[arraysize(kPoints)];
+    for (size_t i = 0; i < arraysize(kPoints); ++i) {
+      batch[i] = kPoints[i];
+      batch_2d[i] = Point(static_cast<int>(kPoints[i].x()),
+                          static_cast<int>(kPoints[i].y()));
+    }
+    xform.TransformPoints(batch, arraysize(batch));
+    xform.TransformPoints(batch_2d, arraysize(batch_2d));
+
+    for (size_t i = 0; i < arraysize(kPoints); ++i) {
+      Point3F expected = MapPointGeneric(xform.matrix(), kPoints[i]);
+
+      Point3F point = kPoints[i];
+      xform.TransformPoint(point);
+      EXPECT_EQ(expected.ToString(), point.ToString());
+      EXPECT_EQ(expected.ToString(), batch[i].ToString());
+
+      Point point_2d(static_cast<int>(kPoints[i].x()),
+                     static_cast<int>(kPoints[i].y()));
+      Point3F expected_2d = MapPointGeneric(
+          xform.matrix(), Point3F(point_2d.x(), point_2d.y(), 0));
+      Point single_2d = point_2d;
+      xform.TransformPoint(single_2d);
+      if (xform.GetType() != Transform::TYPE_PERSPECTIVE) {
+        EXPECT_EQ(ToRoundedInt(expected_2d.x()), single_2d.x());
+        EXPECT_EQ(ToRoundedInt(expected_2d.y()), single_2d.y());
+      }
+      EXPECT_EQ(single_2d.ToString(), batch_2d[i].ToString());
+
+      Point3F reversed = point;
+      EXPECT_TRUE(xform.TransformPointReverse(reversed));
+      EXPECT_TRUE(PointsAreNearlyEqual(kPoints[i], reversed))
+          << t << ": " << reversed.ToString();
+    }
+
+    Transform inverse;
+    EXPECT_TRUE(xform.GetInverse(&inverse));
+    SkMatrix44 expected_inverse(SkMatrix44::kUninitialized_Constructor);
+    EXPECT_TRUE(xform.matrix().invert(&expected_inverse));
+    Transform generic_inverse;
+    generic_inverse.matrix() = expected_inverse;
+    EXPECT_TRUE(MatricesAreNearlyEqual(generic_inverse, inverse)) << t;
+  }
+}
+
+TEST(XFormTest, TransformRectTranslation) {
+  Transform translation;
+  translation.Translate(10, -5);
+
+  RectF rect(1, 2, 30, 40);
+  translation.TransformRect(&rect);
+  EXPECT_EQ(RectF(11, -3, 30, 40).ToString(), rect.ToString());
+
+  EXPECT_TRUE(translation.TransformRectReverse(&rect));
+  EXPECT_EQ(RectF(1, 2, 30, 40).ToString(), rect.ToString());
+
+  Transform scale;
+  scale.Scale(2, 3);
+  scale.TransformRect(&rect);
+  EXPECT_EQ(RectF(2, 6, 60, 120).ToString(), rect.ToString());
+}
+
+TEST(XFormTest, ConcatIdentityAndTranslation) {
+  Transform transform;
+  transform.Rotate(45);
+  Transform expected = transform;
+
+  transform.ConcatTransform(Transform());
+  transform.PreconcatTransform(Transform());
+  EXPECT_EQ(expected, transform);
+
+  Transform translation;
+  translation.Translate3d(4, 5, 6);
+  Transform generic_post = expected;
+  generic_post.matrix().postConcat(translation.matrix());
+  Transform generic_pre = expected;
+  generic_pre.matrix().preConcat(translation.matrix());
+
+  Transform post = expected;
+  post.ConcatTransform(translation);
+  EXPECT_TRUE(MatricesAreNearlyEqual(generic_post, post));
+
+  Transform pre = expected;
+  pre.PreconcatTransform(translation);
+  EXPECT_TRUE(MatricesAreNearlyEqual(generic_pre, pre));
+}
+
 }  // namespace
 
 }  // namespace gfx
@@ -60,9 +60,10 @@ class GL_EXPORT AsyncPixelTransferState :
   // Returns true if there is a transfer in progress.
   virtual bool TransferIsInProgress() = 0;
 
-  // Perform any custom binding of the transfer (currently only
-  // needed for AsyncTexImage2D). The params used to define the texture
-  // are returned in level_params.
+  // Perform any custom binding of the transfer (needed after
+  // AsyncTexImage2D, and after AsyncTexSubImage2D where the upload runs in
+  // another context). The params used to define the texture are returned in
+  // level_params.
   //
   // The transfer must be complete to call this (!TransferIsInProgress).
   virtual void BindTransfer(AsyncTexImage2DParams* level_params) = 0;
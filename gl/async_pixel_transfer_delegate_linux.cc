@@ -0,0 +1,537 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gl/async_pixel_transfer_delegate.h"
+
+#include <queue>
+
+#include "base/bind.h"
+#include "base/debug/trace_event.h"
+#include "base/logging.h"
+#include "base/memory/ref_counted.h"
+#include "base/message_loop_proxy.h"
+#include "base/process_util.h"
+#include "base/shared_memory.h"
+#include "base/threading/thread.h"
+#include "ui/gl/async_pixel_transfer_delegate_stub.h"
+#include "ui/gl/gl_bindings.h"
+#include "ui/gl/gl_context.h"
+#include "ui/gl/gl_fence.h"
+#include "ui/gl/gl_implementation.h"
+#include "ui/gl/gl_surface.h"
+
+using base::SharedMemory;
+using base::SharedMemoryHandle;
+
+namespace gfx {
+
+namespace {
+
+const char kAsyncTransferThreadName[] = "AsyncTransferThread";
+
+// How often the upload thread checks the fence of its oldest pending upload.
+// Checking at an interval, rather than spinning on the fence or calling
+// glFinish(), leaves the upload thread free to issue the next uploads.
+const int kFencePollIntervalMs = 1;
+
+// We duplicate shared memory to avoid use-after-free issues, as the client
+// may free it as soon as the transfer has been issued.
+SharedMemory* DuplicateSharedMemory(SharedMemory* shared_memory, uint32 size) {
+  // Duplicate the handle.
+  SharedMemoryHandle duped_shared_memory_handle;
+  if (!shared_memory->ShareToProcess(
+      base::GetCurrentProcessHandle(),
+      &duped_shared_memory_handle)) {
+    CHECK(false); // Diagnosing a crash.
+    return NULL;
+  }
+  scoped_ptr<SharedMemory> duped_shared_memory(
+      new SharedMemory(duped_shared_memory_handle, false));
+  // Map the shared memory into this process. This validates the size.
+  if (!duped_shared_memory->Map(size)) {
+    CHECK(false); // Diagnosing a crash.
+    return NULL;
+  }
+  return duped_shared_memory.release();
+}
+
+// Gets the address of the data from shared memory.
+void* GetAddress(SharedMemory* shared_memory, uint32 shm_data_offset) {
+  // Memory bounds have already been validated, so there
+  // is just DCHECKS here.
+  CHECK(shared_memory);
+  CHECK(shared_memory->memory());
+  return static_cast<int8*>(shared_memory->memory()) + shm_data_offset;
+}
+
+// Runs the uploads with its own GL context current, and replies to each one
+// once a GLFence placed after it has passed. The context and surface are
+// owned by the delegate, on the main thread.
+class TransferThread : public base::Thread {
+ public:
+  TransferThread(GLContext* context, GLSurface* surface)
+      : base::Thread(kAsyncTransferThreadName),
+        context_(context),
+        surface_(surface),
+        poll_scheduled_(false) {
+    Start();
+  }
+  virtual ~TransferThread() {
+    Stop();
+  }
+
+  virtual void Init() OVERRIDE {
+    bool is_current = context_->MakeCurrent(surface_);
+    DCHECK(is_current);
+  }
+
+  virtual void CleanUp() OVERRIDE {
+    // The replies to uploads still in flight are dropped.
+    while (!pending_fences_.empty()) {
+      delete pending_fences_.front().fence;
+      pending_fences_.pop();
+    }
+    context_->ReleaseCurrent(surface_);
+  }
+
+  // Called on the upload thread after the GL commands of an upload have been
+  // issued. Places a fence after them and, once it has passed, stores the
+  // time since |begin_time| in |transfer_time| (if not NULL) and posts
+  // |reply| to |reply_loop|. Replies are posted in the order the uploads
+  // were issued in.
+  void WaitForCompletion(base::TimeTicks begin_time,
+                         base::TimeDelta* transfer_time,
+                         scoped_refptr<base::MessageLoopProxy> reply_loop,
+                         const base::Closure& reply) {
+    PendingFence pending;
+    pending.fence = GLFence::Create();
+    if (!pending.fence) {
+      // Neither NV_fence nor ARB_sync is available.
+      glFinish();
+    }
+    pending.begin_time = begin_time;
+    pending.transfer_time = transfer_time;
+    pending.reply_loop = reply_loop;
+    pending.reply = reply;
+    pending_fences_.push(pending);
+    if (!poll_scheduled_)
+      PollFences();
+  }
+
+ private:
+  struct PendingFence {
+    // NULL if the commands had already completed when the fence was placed.
+    GLFence* fence;
+    base::TimeTicks begin_time;
+    base::TimeDelta* transfer_time;
+    scoped_refptr<base::MessageLoopProxy> reply_loop;
+    base::Closure reply;
+  };
+
+  // Replies to the uploads whose fences have passed, oldest first, and checks
+  // again later if any are left.
+  void PollFences() {
+    TRACE_EVENT0("gpu", "PollFences");
+    poll_scheduled_ = false;
+    while (!pending_fences_.empty()) {
+      PendingFence& pending = pending_fences_.front();
+      if (pending.fence && !pending.fence->HasCompleted())
+        break;
+      if (pending.transfer_time) {
+        *pending.transfer_time =
+            base::TimeTicks::HighResNow() - pending.begin_time;
+      }
+      pending.reply_loop->PostTask(FROM_HERE, pending.reply);
+      delete pending.fence;
+      pending_fences_.pop();
+    }
+    if (pending_fences_.empty())
+      return;
+    poll_scheduled_ = true;
+    message_loop()->PostDelayedTask(
+        FROM_HERE,
+        base::Bind(&TransferThread::PollFences, base::Unretained(this)),
+        base::TimeDelta::FromMilliseconds(kFencePollIntervalMs));
+  }
+
+  GLContext* context_;
+  GLSurface* surface_;
+
+  // The uploads waiting for their fences to pass, oldest first. Only used on
+  // the upload thread.
+  std::queue<PendingFence> pending_fences_;
+  bool poll_scheduled_;
+
+  DISALLOW_COPY_AND_ASSIGN(TransferThread);
+};
+
+}  // namespace
+
+// Class which holds the state of async pixel transfers to one texture. The
+// transfer times are written on the upload thread and read in the reply on
+// the main thread; everything else is only accessed on the main thread.
+class TransferStateInternal
+    : public base::RefCountedThreadSafe<TransferStateInternal> {
+ public:
+  explicit TransferStateInternal(GLuint texture_id)
+      : texture_id_(texture_id),
+        needs_late_bind_(false),
+        transfer_in_progress_(false) {
+    static const AsyncTexImage2DParams zero_params = {0, 0, 0, 0, 0, 0, 0, 0};
+    late_bind_define_params_ = zero_params;
+  }
+
+  // Implement AsyncPixelTransferState:
+  bool TransferIsInProgress() {
+    return transfer_in_progress_;
+  }
+
+  void BindTransfer(AsyncTexImage2DParams* bound_params) {
+    DCHECK(bound_params);
+    DCHECK(texture_id_);
+    *bound_params = late_bind_define_params_;
+    if (!needs_late_bind_)
+      return;
+
+    // Changes made to a texture in another context of the share group only
+    // become visible once it is bound again. We can only change the active
+    // texture and unit 0, as that is all that will be restored.
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture_id_);
+    needs_late_bind_ = false;
+  }
+
+ protected:
+  friend class base::RefCountedThreadSafe<TransferStateInternal>;
+  friend class AsyncPixelTransferDelegateLinux;
+
+  virtual ~TransferStateInternal() {}
+
+  // The texture, which the upload context shares with the main one.
+  GLuint texture_id_;
+
+  // Indicates the texture has been modified on the upload thread and needs
+  // to be bound again before its contents are guaranteed to be visible.
+  bool needs_late_bind_;
+
+  // Definition params for texture that needs binding.
+  AsyncTexImage2DParams late_bind_define_params_;
+
+  // Indicates that an async transfer is in progress.
+  bool transfer_in_progress_;
+
+  // Time spent performing last transfer.
+  base::TimeDelta last_transfer_time_;
+};
+
+// The upload thread needs thread-safe ref-counting, so this just wraps
+// an internal thread-safe ref-counted state object.
+class AsyncTransferStateLinux : public AsyncPixelTransferState {
+ public:
+  explicit AsyncTransferStateLinux(GLuint texture_id)
+      : internal_(new TransferStateInternal(texture_id)) {
+  }
+  virtual ~AsyncTransferStateLinux() {}
+  virtual bool TransferIsInProgress() OVERRIDE {
+      return internal_->TransferIsInProgress();
+  }
+  virtual void BindTransfer(AsyncTexImage2DParams* bound_params) OVERRIDE {
+      internal_->BindTransfer(bound_params);
+  }
+  scoped_refptr<TransferStateInternal> internal_;
+};
+
+// Class which handles async pixel transfers on Linux, by uploading on a
+// thread of its own with a GL context in the same share group as the
+// decoder's.
+class AsyncPixelTransferDelegateLinux
+    : public AsyncPixelTransferDelegate,
+      public base::SupportsWeakPtr<AsyncPixelTransferDelegateLinux> {
+ public:
+  // Returns NULL if an upload context can't be created next to |context|.
+  static AsyncPixelTransferDelegate* Create(GLContext* context);
+
+  virtual ~AsyncPixelTransferDelegateLinux();
+
+  // implement AsyncPixelTransferDelegate:
+  virtual void AsyncNotifyCompletion(
+      const base::Closure& task) OVERRIDE;
+  virtual void AsyncTexImage2D(
+      AsyncPixelTransferState* state,
+      const AsyncTexImage2DParams& tex_params,
+      const AsyncMemoryParams& mem_params) OVERRIDE;
+  virtual void AsyncTexSubImage2D(
+      AsyncPixelTransferState* state,
+      const AsyncTexSubImage2DParams& tex_params,
+      const AsyncMemoryParams& mem_params) OVERRIDE;
+  virtual uint32 GetTextureUploadCount() OVERRIDE;
+  virtual base::TimeDelta GetTotalTextureUploadTime() OVERRIDE;
+
+ private:
+  AsyncPixelTransferDelegateLinux(GLContext* upload_context,
+                                  GLSurface* upload_surface);
+
+  // implement AsyncPixelTransferDelegate:
+  virtual AsyncPixelTransferState*
+      CreateRawPixelTransferState(GLuint texture_id) OVERRIDE;
+
+  void AsyncTexImage2DCompleted(scoped_refptr<TransferStateInternal> state);
+  void AsyncTexSubImage2DCompleted(scoped_refptr<TransferStateInternal> state);
+
+  // These run on the upload thread, and post |reply| to |reply_loop| once
+  // the upload has completed.
+  static void PerformAsyncTexImage2D(
+      TransferThread* transfer_thread,
+      TransferStateInternal* state,
+      AsyncTexImage2DParams tex_params,
+      base::SharedMemory* shared_memory,
+      uint32 shared_memory_data_offset,
+      scoped_refptr<base::MessageLoopProxy> reply_loop,
+      const base::Closure& reply);
+  static void PerformAsyncTexSubImage2D(
+      TransferThread* transfer_thread,
+      TransferStateInternal* state,
+      AsyncTexSubImage2DParams tex_params,
+      base::SharedMemory* shared_memory,
+      uint32 shared_memory_data_offset,
+      scoped_refptr<base::MessageLoopProxy> reply_loop,
+      const base::Closure& reply);
+
+  base::MessageLoopProxy* transfer_message_loop_proxy() {
+    return transfer_thread_->message_loop_proxy();
+  }
+
+  // These are released on the main thread, after |transfer_thread_| has been
+  // stopped.
+  scoped_refptr<GLContext> upload_context_;
+  scoped_refptr<GLSurface> upload_surface_;
+  scoped_ptr<TransferThread> transfer_thread_;
+
+  int texture_upload_count_;
+  base::TimeDelta total_texture_upload_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(AsyncPixelTransferDelegateLinux);
+};
+
+// We use threaded uploads whenever a second context can share textures with
+// the decoder's; that excludes only the mock implementation used by tests.
+scoped_ptr<AsyncPixelTransferDelegate>
+    AsyncPixelTransferDelegate::Create(gfx::GLContext* context) {
+  DCHECK(context);
+  AsyncPixelTransferDelegate* delegate = NULL;
+  if (GetGLImplementation() != kGLImplementationMockGL)
+    delegate = AsyncPixelTransferDelegateLinux::Create(context);
+  if (!delegate) {
+    LOG(INFO) << "Async pixel transfers not supported";
+    return AsyncPixelTransferDelegateStub::Create(context);
+  }
+  return make_scoped_ptr(delegate);
+}
+
+// static
+AsyncPixelTransferDelegate* AsyncPixelTransferDelegateLinux::Create(
+    GLContext* context) {
+  scoped_refptr<GLSurface> surface =
+      GLSurface::CreateOffscreenGLSurface(false, gfx::Size(1, 1));
+  if (!surface)
+    return NULL;
+  scoped_refptr<GLContext> upload_context = GLContext::CreateGLContext(
+      context->share_group(), surface, PreferIntegratedGpu);
+  if (!upload_context)
+    return NULL;
+  return new AsyncPixelTransferDelegateLinux(upload_context, surface);
+}
+
+AsyncPixelTransferDelegateLinux::AsyncPixelTransferDelegateLinux(
+    GLContext* upload_context,
+    GLSurface* upload_surface)
+    : upload_context_(upload_context),
+      upload_surface_(upload_surface),
+      transfer_thread_(new TransferThread(upload_context, upload_surface)),
+      texture_upload_count_(0) {
+}
+
+AsyncPixelTransferDelegateLinux::~AsyncPixelTransferDelegateLinux() {
+  // Stop the upload thread, dropping the replies to uploads still in flight,
+  // and release the upload context before it is destroyed.
+  transfer_thread_.reset();
+}
+
+AsyncPixelTransferState*
+    AsyncPixelTransferDelegateLinux::CreateRawPixelTransferState(
+        GLuint texture_id) {
+  return static_cast<AsyncPixelTransferState*>(
+      new AsyncTransferStateLinux(texture_id));
+}
+
+void AsyncPixelTransferDelegateLinux::AsyncNotifyCompletion(
+      const base::Closure& task) {
+  // A fence placed after the uploads issued so far passes once all of them
+  // have completed, and replies are posted in order, so |task| runs after
+  // their replies.
+  transfer_message_loop_proxy()->PostTask(FROM_HERE,
+      base::Bind(
+          &TransferThread::WaitForCompletion,
+          base::Unretained(transfer_thread_.get()),
+          base::TimeTicks(),
+          static_cast<base::TimeDelta*>(NULL),
+          base::MessageLoopProxy::current(),
+          task));
+}
+
+void AsyncPixelTransferDelegateLinux::AsyncTexImage2D(
+    AsyncPixelTransferState* transfer_state,
+    const AsyncTexImage2DParams& tex_params,
+    const AsyncMemoryParams& mem_params) {
+  scoped_refptr<TransferStateInternal> state =
+      static_cast<AsyncTransferStateLinux*>(transfer_state)->internal_.get();
+  DCHECK(mem_params.shared_memory);
+  DCHECK_LE(mem_params.shm_data_offset + mem_params.shm_data_size,
+            mem_params.shm_size);
+  DCHECK(state);
+  DCHECK(state->texture_id_);
+  DCHECK(!state->transfer_in_progress_);
+  DCHECK_EQ(static_cast<GLenum>(GL_TEXTURE_2D), tex_params.target);
+
+  // Mark the transfer in progress and save define params for lazy binding.
+  state->transfer_in_progress_ = true;
+  state->late_bind_define_params_ = tex_params;
+
+  transfer_message_loop_proxy()->PostTask(FROM_HERE,
+      base::Bind(
+          &AsyncPixelTransferDelegateLinux::PerformAsyncTexImage2D,
+          base::Unretained(transfer_thread_.get()),
+          base::Unretained(state.get()),  // This is referenced in reply below.
+          tex_params,
+          base::Owned(DuplicateSharedMemory(mem_params.shared_memory,
+                                            mem_params.shm_size)),
+          mem_params.shm_data_offset,
+          base::MessageLoopProxy::current(),
+          base::Bind(
+              &AsyncPixelTransferDelegateLinux::AsyncTexImage2DCompleted,
+              AsWeakPtr(),
+              state)));
+}
+
+void AsyncPixelTransferDelegateLinux::AsyncTexSubImage2D(
+    AsyncPixelTransferState* transfer_state,
+    const AsyncTexSubImage2DParams& tex_params,
+    const AsyncMemoryParams& mem_params) {
+  TRACE_EVENT2("gpu", "AsyncTexSubImage2D",
+               "width", tex_params.width,
+               "height", tex_params.height);
+  scoped_refptr<TransferStateInternal> state =
+      static_cast<AsyncTransferStateLinux*>(transfer_state)->internal_.get();
+  DCHECK(state->texture_id_);
+  DCHECK(!state->transfer_in_progress_);
+  DCHECK(mem_params.shared_memory);
+  DCHECK_LE(mem_params.shm_data_offset + mem_params.shm_data_size,
+            mem_params.shm_size);
+  DCHECK_EQ(static_cast<GLenum>(GL_TEXTURE_2D), tex_params.target);
+
+  // Mark the transfer in progress.
+  state->transfer_in_progress_ = true;
+
+  transfer_message_loop_proxy()->PostTask(FROM_HERE,
+      base::Bind(
+          &AsyncPixelTransferDelegateLinux::PerformAsyncTexSubImage2D,
+          base::Unretained(transfer_thread_.get()),
+          base::Unretained(state.get()),  // This is referenced in reply below.
+          tex_params,
+          base::Owned(DuplicateSharedMemory(mem_params.shared_memory,
+                                            mem_params.shm_size)),
+          mem_params.shm_data_offset,
+          base::MessageLoopProxy::current(),
+          base::Bind(
+              &AsyncPixelTransferDelegateLinux::AsyncTexSubImage2DCompleted,
+              AsWeakPtr(),
+              state)));
+}
+
+uint32 AsyncPixelTransferDelegateLinux::GetTextureUploadCount() {
+  return texture_upload_count_;
+}
+
+base::TimeDelta AsyncPixelTransferDelegateLinux::GetTotalTextureUploadTime() {
+  return total_texture_upload_time_;
+}
+
+void AsyncPixelTransferDelegateLinux::AsyncTexImage2DCompleted(
+    scoped_refptr<TransferStateInternal> state) {
+  state->needs_late_bind_ = true;
+  state->transfer_in_progress_ = false;
+}
+
+void AsyncPixelTransferDelegateLinux::AsyncTexSubImage2DCompleted(
+    scoped_refptr<TransferStateInternal> state) {
+  state->needs_late_bind_ = true;
+  state->transfer_in_progress_ = false;
+  texture_upload_count_++;
+  total_texture_upload_time_ += state->last_transfer_time_;
+}
+
+void AsyncPixelTransferDelegateLinux::PerformAsyncTexImage2D(
+    TransferThread* transfer_thread,
+    TransferStateInternal* state,
+    AsyncTexImage2DParams tex_params,
+    base::SharedMemory* shared_memory,
+    uint32 shared_memory_data_offset,
+    scoped_refptr<base::MessageLoopProxy> reply_loop,
+    const base::Closure& reply) {
+  TRACE_EVENT2("gpu", "PerformAsyncTexImage",
+               "width", tex_params.width,
+               "height", tex_params.height);
+  DCHECK(state);
+
+  void* data = GetAddress(shared_memory, shared_memory_data_offset);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, state->texture_id_);
+  glTexImage2D(
+      GL_TEXTURE_2D,
+      tex_params.level,
+      tex_params.internal_format,
+      tex_params.width,
+      tex_params.height,
+      tex_params.border,
+      tex_params.format,
+      tex_params.type,
+      data);
+  transfer_thread->WaitForCompletion(base::TimeTicks(), NULL, reply_loop,
+                                     reply);
+}
+
+void AsyncPixelTransferDelegateLinux::PerformAsyncTexSubImage2D(
+    TransferThread* transfer_thread,
+    TransferStateInternal* state,
+    AsyncTexSubImage2DParams tex_params,
+    base::SharedMemory* shared_memory,
+    uint32 shared_memory_data_offset,
+    scoped_refptr<base::MessageLoopProxy> reply_loop,
+    const base::Closure& reply) {
+  TRACE_EVENT2("gpu", "PerformAsyncTexSubImage2D",
+               "width", tex_params.width,
+               "height", tex_params.height);
+  DCHECK(state);
+
+  void* data = GetAddress(shared_memory, shared_memory_data_offset);
+
+  base::TimeTicks begin_time(base::TimeTicks::HighResNow());
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, state->texture_id_);
+  glTexSubImage2D(
+      GL_TEXTURE_2D,
+      tex_params.level,
+      tex_params.xoffset,
+      tex_params.yoffset,
+      tex_params.width,
+      tex_params.height,
+      tex_params.format,
+      tex_params.type,
+      data);
+  // |state| is kept alive by |reply| until the transfer time is stored.
+  transfer_thread->WaitForCompletion(begin_time, &state->last_transfer_time_,
+                                     reply_loop, reply);
+}
+
+}  // namespace gfx
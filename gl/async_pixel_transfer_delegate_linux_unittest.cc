@@ -0,0 +1,175 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gl/async_pixel_transfer_delegate.h"
+
+#include <string.h>
+
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/run_loop.h"
+#include "base/shared_memory.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/gfx/size.h"
+#include "ui/gl/gl_bindings.h"
+#include "ui/gl/gl_context.h"
+#include "ui/gl/gl_implementation.h"
+#include "ui/gl/gl_surface.h"
+
+namespace gfx {
+
+namespace {
+
+// Large enough for an upload to take measurable time.
+const int kTextureSize = 256;
+const uint32 kTextureBytes = kTextureSize * kTextureSize * 4;
+
+}  // namespace
+
+// Uploads through the threaded delegate, with OSMesa as the GL
+// implementation.
+class AsyncPixelTransferDelegateLinuxTest : public testing::Test {
+ public:
+  AsyncPixelTransferDelegateLinuxTest() : texture_id_(0), framebuffer_id_(0) {}
+
+ protected:
+  virtual void SetUp() OVERRIDE {
+    if (GetGLImplementation() == kGLImplementationNone)
+      ASSERT_TRUE(InitializeGLBindings(kGLImplementationOSMesaGL));
+    ASSERT_EQ(kGLImplementationOSMesaGL, GetGLImplementation());
+
+    surface_ = GLSurface::CreateOffscreenGLSurface(false, Size(1, 1));
+    ASSERT_TRUE(surface_);
+    context_ = GLContext::CreateGLContext(NULL, surface_, PreferIntegratedGpu);
+    ASSERT_TRUE(context_);
+    ASSERT_TRUE(context_->MakeCurrent(surface_));
+
+    delegate_ = AsyncPixelTransferDelegate::Create(context_);
+    ASSERT_TRUE(delegate_.get());
+
+    glGenTextures(1, &texture_id_);
+    glBindTexture(GL_TEXTURE_2D, texture_id_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    state_ = delegate_->CreatePixelTransferState(texture_id_);
+
+    ASSERT_TRUE(shared_memory_.CreateAndMapAnonymous(kTextureBytes));
+    mem_params_.shared_memory = &shared_memory_;
+    mem_params_.shm_size = kTextureBytes;
+    mem_params_.shm_data_offset = 0;
+    mem_params_.shm_data_size = kTextureBytes;
+  }
+
+  virtual void TearDown() OVERRIDE {
+    state_.reset();
+    delegate_.reset();
+    if (framebuffer_id_)
+      glDeleteFramebuffersEXT(1, &framebuffer_id_);
+    if (texture_id_)
+      glDeleteTextures(1, &texture_id_);
+    if (context_)
+      context_->ReleaseCurrent(surface_);
+    context_ = NULL;
+    surface_ = NULL;
+  }
+
+  // Fills the shared memory with |byte|.
+  void FillPixels(uint8 byte) {
+    memset(shared_memory_.memory(), byte, kTextureBytes);
+  }
+
+  // Runs the message loop until the uploads issued so far have completed.
+  void WaitForUploads() {
+    base::RunLoop run_loop;
+    delegate_->AsyncNotifyCompletion(run_loop.QuitClosure());
+    run_loop.Run();
+  }
+
+  // Returns the first pixel of the texture as seen by the main context.
+  uint32 ReadFirstPixel() {
+    if (!framebuffer_id_)
+      glGenFramebuffersEXT(1, &framebuffer_id_);
+    glBindFramebufferEXT(GL_FRAMEBUFFER, framebuffer_id_);
+    glFramebufferTexture2DEXT(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                              GL_TEXTURE_2D, texture_id_, 0);
+    EXPECT_EQ(static_cast<GLenum>(GL_FRAMEBUFFER_COMPLETE),
+              glCheckFramebufferStatusEXT(GL_FRAMEBUFFER));
+    uint32 pixel = 0;
+    glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, &pixel);
+    glBindFramebufferEXT(GL_FRAMEBUFFER, 0);
+    return pixel;
+  }
+
+  AsyncTexImage2DParams GetTexImageParams() {
+    AsyncTexImage2DParams params = {
+      GL_TEXTURE_2D, 0, GL_RGBA, kTextureSize, kTextureSize, 0, GL_RGBA,
+      GL_UNSIGNED_BYTE
+    };
+    return params;
+  }
+
+  AsyncTexSubImage2DParams GetTexSubImageParams() {
+    AsyncTexSubImage2DParams params = {
+      GL_TEXTURE_2D, 0, 0, 0, kTextureSize, kTextureSize, GL_RGBA,
+      GL_UNSIGNED_BYTE
+    };
+    return params;
+  }
+
+  MessageLoop message_loop_;
+  scoped_refptr<GLSurface> surface_;
+  scoped_refptr<GLContext> context_;
+  scoped_ptr<AsyncPixelTransferDelegate> delegate_;
+  scoped_ptr<AsyncPixelTransferState> state_;
+  base::SharedMemory shared_memory_;
+  AsyncMemoryParams mem_params_;
+  GLuint texture_id_;
+  GLuint framebuffer_id_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(AsyncPixelTransferDelegateLinuxTest);
+};
+
+// A texture defined asynchronously is visible to the main context once the
+// transfer is bound.
+TEST_F(AsyncPixelTransferDelegateLinuxTest, TexImage2D) {
+  FillPixels(0x11);
+  delegate_->AsyncTexImage2D(state_.get(), GetTexImageParams(), mem_params_);
+  WaitForUploads();
+  EXPECT_FALSE(state_->TransferIsInProgress());
+
+  AsyncTexImage2DParams bound_params;
+  state_->BindTransfer(&bound_params);
+  EXPECT_EQ(kTextureSize, bound_params.width);
+  EXPECT_EQ(kTextureSize, bound_params.height);
+  EXPECT_EQ(0x11111111U, ReadFirstPixel());
+}
+
+// Sub-image uploads are counted and timed, and their contents are visible to
+// the main context once the transfer is bound.
+TEST_F(AsyncPixelTransferDelegateLinuxTest, TexSubImage2D) {
+  FillPixels(0x11);
+  delegate_->AsyncTexImage2D(state_.get(), GetTexImageParams(), mem_params_);
+  WaitForUploads();
+  AsyncTexImage2DParams bound_params;
+  state_->BindTransfer(&bound_params);
+  EXPECT_EQ(0U, delegate_->GetTextureUploadCount());
+
+  const int kUploads = 3;
+  for (int i = 0; i < kUploads; ++i) {
+    FillPixels(0x22 * (i + 1));
+    delegate_->AsyncTexSubImage2D(state_.get(), GetTexSubImageParams(),
+                                  mem_params_);
+    WaitForUploads();
+    EXPECT_FALSE(state_->TransferIsInProgress());
+    state_->BindTransfer(&bound_params);
+    EXPECT_EQ(0x22222222U * (i + 1), ReadFirstPixel());
+  }
+
+  EXPECT_EQ(static_cast<uint32>(kUploads), delegate_->GetTextureUploadCount());
+  EXPECT_LT(base::TimeDelta(), delegate_->GetTotalTextureUploadTime());
+}
+
+}  // namespace gfx
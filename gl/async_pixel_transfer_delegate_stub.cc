@@ -28,7 +28,7 @@ void* GetAddress(SharedMemory* shared_memory,
 
 namespace gfx {
 
-#if !defined(OS_ANDROID)
+#if !defined(OS_ANDROID) && !defined(OS_LINUX)
 scoped_ptr<AsyncPixelTransferDelegate>
     AsyncPixelTransferDelegate::Create(gfx::GLContext* context) {
   return AsyncPixelTransferDelegateStub::Create(context);
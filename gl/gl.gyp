@@ -41,6 +41,7 @@
       ],
      'sources': [
         'async_pixel_transfer_delegate.h',
+        'async_pixel_transfer_delegate_linux.cc',
         'async_pixel_transfer_delegate_stub.cc',
         'async_pixel_transfer_delegate_stub.h',
         'gl_bindings.h',
@@ -293,4 +294,27 @@
       ],
     },
   ],
+  'conditions': [
+    ['OS=="linux"', {
+      'targets': [
+        {
+          'target_name': 'gl_unittests',
+          'type': 'executable',
+          'dependencies': [
+            '<(DEPTH)/base/base.gyp:base',
+            '<(DEPTH)/base/base.gyp:run_all_unittests',
+            '<(DEPTH)/testing/gtest.gyp:gtest',
+            '<(DEPTH)/third_party/mesa/mesa.gyp:osmesa',
+            'gl',
+          ],
+          'include_dirs': [
+            '../..',
+          ],
+          'sources': [
+            'async_pixel_transfer_delegate_linux_unittest.cc',
+          ],
+        },
+      ],
+    }],
+  ],
 }
@@ -4,15 +4,22 @@
 
 #include "ui/message_center/message_center.h"
 
+#include "base/bind.h"
+#include "base/compiler_specific.h"
 #include "base/logging.h"
 #include "base/memory/singleton.h"
+#include "base/message_loop.h"
 #include "base/observer_list.h"
 
 namespace message_center {
 
 //------------------------------------------------------------------------------
 MessageCenter::MessageCenter()
-    : delegate_(NULL) {
+    : delegate_(NULL),
+      batch_observer_notifications_(false),
+      notification_pending_(false),
+      pending_new_notification_(false),
+      ALLOW_THIS_IN_INITIALIZER_LIST(flush_factory_(this)) {
   notification_list_.reset(new NotificationList(this));
 }
 
@@ -32,6 +39,24 @@ void MessageCenter::SetDelegate(Delegate* delegate) {
   delegate_ = delegate;
 }
 
+void MessageCenter::SetBatchObserverNotifications(bool batch) {
+  batch_observer_notifications_ = batch;
+  if (!batch)
+    FlushObserverNotifications();
+}
+
+void MessageCenter::FlushObserverNotifications() {
+  if (!notification_pending_)
+    return;
+  flush_factory_.InvalidateWeakPtrs();
+  const bool new_notification = pending_new_notification_;
+  notification_pending_ = false;
+  pending_new_notification_ = false;
+  FOR_EACH_OBSERVER(Observer,
+                    observer_list_,
+                    OnMessageCenterChanged(new_notification));
+}
+
 void MessageCenter::SetMessageCenterVisible(bool visible) {
   notification_list_->SetMessageCenterVisible(visible);
 }
@@ -183,6 +208,17 @@ void MessageCenter::Delegate::OnButtonClicked(const std::string& id,
 // Private.
 
 void MessageCenter::NotifyMessageCenterChanged(bool new_notification) {
+  if (batch_observer_notifications_) {
+    pending_new_notification_ |= new_notification;
+    if (!notification_pending_) {
+      notification_pending_ = true;
+      MessageLoop::current()->PostTask(
+          FROM_HERE,
+          base::Bind(&MessageCenter::FlushObserverNotifications,
+                     flush_factory_.GetWeakPtr()));
+    }
+    return;
+  }
   FOR_EACH_OBSERVER(Observer,
                     observer_list_,
                     OnMessageCenterChanged(new_notification));
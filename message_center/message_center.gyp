@@ -71,6 +71,7 @@
       ],
       'sources': [
         'message_center_tray_unittest.cc',
+        'message_center_unittest.cc',
         'notification_list_unittest.cc',
       ],
     },
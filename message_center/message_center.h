@@ -8,6 +8,7 @@
 #include <string>
 
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
 #include "base/observer_list.h"
 #include "ui/gfx/native_widget_types.h"
 #include "ui/message_center/message_center_export.h"
@@ -89,6 +90,17 @@ class MESSAGE_CENTER_EXPORT MessageCenter : public NotificationList::Delegate {
   void AddObserver(Observer* observer);
   void RemoveObserver(Observer* observer);
 
+  // Sets whether changes are reported to observers in batches. When batched,
+  // the changes made by the current task and any that run before the
+  // notification task posted by the first change are reported with a single
+  // OnMessageCenterChanged(), so that a burst of notifications updates the UI
+  // once. Disabling batching reports pending changes immediately. The default
+  // is false.
+  void SetBatchObserverNotifications(bool batch);
+
+  // Reports pending batched changes to observers now, if there are any.
+  void FlushObserverNotifications();
+
   // Informs the notification list whether the message center is visible.
   // This affects whether or not a message has been "read".
   void SetMessageCenterVisible(bool visible);
@@ -151,13 +163,25 @@ class MESSAGE_CENTER_EXPORT MessageCenter : public NotificationList::Delegate {
   virtual NotificationList* GetNotificationList() OVERRIDE;
 
  private:
-  // Calls OnMessageCenterChanged on each observer.
+  // Calls OnMessageCenterChanged on each observer, or records the change to
+  // be reported later if batching.
   void NotifyMessageCenterChanged(bool new_notification);
 
   scoped_ptr<NotificationList> notification_list_;
   ObserverList<Observer> observer_list_;
   Delegate* delegate_;
 
+  // See SetBatchObserverNotifications().
+  bool batch_observer_notifications_;
+
+  // True if a change has been recorded but not reported yet, and whether any
+  // such change added or updated a notification.
+  bool notification_pending_;
+  bool pending_new_notification_;
+
+  // Used to post FlushObserverNotifications().
+  base::WeakPtrFactory<MessageCenter> flush_factory_;
+
   DISALLOW_COPY_AND_ASSIGN(MessageCenter);
 };
 
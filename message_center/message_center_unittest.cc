@@ -0,0 +1,109 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/message_center/message_center.h"
+
+#include "base/message_loop.h"
+#include "base/run_loop.h"
+#include "base/utf_string_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/notifications/notification_types.h"
+
+namespace message_center {
+namespace {
+
+class CountingObserver : public MessageCenter::Observer {
+ public:
+  CountingObserver() : change_count_(0), new_notification_(false) {}
+  virtual ~CountingObserver() {}
+
+  int change_count() const { return change_count_; }
+  bool new_notification() const { return new_notification_; }
+
+  // MessageCenter::Observer overrides:
+  virtual void OnMessageCenterChanged(bool new_notification) OVERRIDE {
+    ++change_count_;
+    new_notification_ = new_notification;
+  }
+
+ private:
+  int change_count_;
+  bool new_notification_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingObserver);
+};
+
+class MessageCenterTest : public testing::Test {
+ public:
+  MessageCenterTest() {}
+  virtual ~MessageCenterTest() {}
+
+  virtual void SetUp() OVERRIDE {
+    message_center_.reset(new MessageCenter());
+    message_center_->AddObserver(&observer_);
+  }
+
+  virtual void TearDown() OVERRIDE {
+    message_center_->RemoveObserver(&observer_);
+    message_center_.reset();
+  }
+
+ protected:
+  void AddNotification(const std::string& id) {
+    message_center_->AddNotification(
+        ui::notifications::NOTIFICATION_TYPE_SIMPLE, id,
+        UTF8ToUTF16("title"), UTF8ToUTF16("message"),
+        UTF8ToUTF16("source"), "ext", NULL);
+  }
+
+  MessageLoopForUI message_loop_;
+  CountingObserver observer_;
+  scoped_ptr<MessageCenter> message_center_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(MessageCenterTest);
+};
+
+}  // namespace
+
+TEST_F(MessageCenterTest, UnbatchedNotifications) {
+  AddNotification("a");
+  AddNotification("b");
+  EXPECT_EQ(2, observer_.change_count());
+  message_center_->RemoveNotification("a");
+  EXPECT_EQ(3, observer_.change_count());
+  EXPECT_FALSE(observer_.new_notification());
+}
+
+TEST_F(MessageCenterTest, BatchedNotifications) {
+  message_center_->SetBatchObserverNotifications(true);
+  for (int i = 0; i < 100; ++i)
+    AddNotification("a");
+  message_center_->RemoveNotification("a");
+  AddNotification("b");
+  EXPECT_EQ(0, observer_.change_count());
+
+  // The burst is reported once, as having added a notification.
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(1, observer_.change_count());
+  EXPECT_TRUE(observer_.new_notification());
+  EXPECT_EQ(1u, message_center_->NotificationCount());
+
+  // Flushing reports pending changes immediately, and only once.
+  message_center_->RemoveNotification("b");
+  message_center_->FlushObserverNotifications();
+  EXPECT_EQ(2, observer_.change_count());
+  EXPECT_FALSE(observer_.new_notification());
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(2, observer_.change_count());
+
+  // Turning batching off reports pending changes.
+  AddNotification("c");
+  message_center_->SetBatchObserverNotifications(false);
+  EXPECT_EQ(3, observer_.change_count());
+  AddNotification("d");
+  EXPECT_EQ(4, observer_.change_count());
+}
+
+}  // namespace message_center
@@ -23,6 +23,7 @@ NotificationList::Notification::~Notification() {
 
 NotificationList::NotificationList(Delegate* delegate)
     : delegate_(delegate),
+      notification_count_(0),
       message_center_visible_(false),
       unread_count_(0),
       quiet_mode_(false) {
@@ -153,6 +154,8 @@ bool NotificationList::RemoveNotification(const std::string& id) {
 
 void NotificationList::RemoveAllNotifications() {
   notifications_.clear();
+  index_.clear();
+  notification_count_ = 0;
   unread_count_ = 0;
 }
 
@@ -227,9 +230,11 @@ bool NotificationList::HasNotification(const std::string& id) {
 bool NotificationList::HasPopupNotifications() {
   for (int i = ui::notifications::DEFAULT_PRIORITY;
        i <= ui::notifications::MAX_PRIORITY; ++i) {
-    Notifications notifications = notifications_[i];
-    if (!notifications.empty() && !notifications.front().shown_as_popup)
+    NotificationMap::const_iterator mapiter = notifications_.find(i);
+    if (mapiter != notifications_.end() && !mapiter->second.empty() &&
+        !mapiter->second.front().shown_as_popup) {
       return true;
+    }
   }
   return false;
 }
@@ -287,19 +292,15 @@ void NotificationList::MarkSinglePopupAsShown(
     notification.is_read = true;
   }
 
-  notifications_[notification.priority].erase(iter);
-  for (Notifications::iterator iter2 =
-           notifications_[notification.priority].begin();
-       iter2 != notifications_[notification.priority].end(); iter2++) {
-    if (iter2->shown_as_popup) {
-      notifications_[notification.priority].insert(iter2, notification);
-      return;
-    }
-  }
+  Notifications& notifications = notifications_[notification.priority];
+  notifications.erase(iter);
+  Notifications::iterator position = notifications.begin();
+  while (position != notifications.end() && !position->shown_as_popup)
+    ++position;
 
-  // No notifications are already shown as popup, so just re-adding at the end
-  // of the list.
-  notifications_[notification.priority].push_back(notification);
+  // If no notifications are already shown as popup, |position| is the end of
+  // the list and the notification is re-added there.
+  index_[notification.id] = notifications.insert(position, notification);
 }
 
 void NotificationList::SetQuietMode(bool quiet_mode) {
@@ -336,12 +337,7 @@ void NotificationList::GetNotifications(
 }
 
 size_t NotificationList::NotificationCount() const {
-  size_t result = 0;
-  for (NotificationMap::const_iterator mapiter = notifications_.begin();
-       mapiter != notifications_.end(); ++mapiter) {
-    result += mapiter->second.size();
-  }
-  return result;
+  return notification_count_;
 }
 
 void NotificationList::SetQuietModeInternal(bool quiet_mode) {
@@ -362,17 +358,11 @@ void NotificationList::SetQuietModeInternal(bool quiet_mode) {
 
 bool NotificationList::GetNotification(
     const std::string& id, Notifications::iterator* iter) {
-  for (NotificationMap::iterator mapiter = notifications_.begin();
-       mapiter != notifications_.end(); ++mapiter) {
-    for (Notifications::iterator curiter = mapiter->second.begin();
-         curiter != mapiter->second.end(); ++curiter) {
-      if (curiter->id == id) {
-        *iter = curiter;
-        return true;
-      }
-    }
-  }
-  return false;
+  NotificationIndex::const_iterator index_iter = index_.find(id);
+  if (index_iter == index_.end())
+    return false;
+  *iter = index_iter->second;
+  return true;
 }
 
 void NotificationList::EraseNotification(Notifications::iterator iter) {
@@ -380,6 +370,8 @@ void NotificationList::EraseNotification(Notifications::iterator iter) {
       iter->priority > ui::notifications::MIN_PRIORITY) {
     --unread_count_;
   }
+  index_.erase(iter->id);
+  --notification_count_;
   notifications_[iter->priority].erase(iter);
 }
 
@@ -404,7 +396,10 @@ void NotificationList::PushNotification(Notification& notification) {
       notification.shown_as_popup = false;
     }
   }
-  notifications_[notification.priority].push_front(notification);
+  Notifications& notifications = notifications_[notification.priority];
+  notifications.push_front(notification);
+  index_[notification.id] = notifications.begin();
+  ++notification_count_;
 }
 
 void NotificationList::GetPopupIterators(int priority,
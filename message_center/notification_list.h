@@ -9,6 +9,7 @@
 #include <map>
 #include <string>
 
+#include "base/hash_tables.h"
 #include "base/string16.h"
 #include "base/time.h"
 #include "base/timer.h"
@@ -179,8 +180,12 @@ class MESSAGE_CENTER_EXPORT NotificationList {
  private:
   typedef std::map<int, Notifications> NotificationMap;
 
-  // Iterates through the list and stores the first notification matching |id|
-  // (should always be unique) to |iter|. Returns true if it's found.
+  // Maps the id of each notification to its position in |notifications_|.
+  typedef base::hash_map<std::string, Notifications::iterator>
+      NotificationIndex;
+
+  // Stores the notification matching |id| (should always be unique) to |iter|.
+  // Returns true if it's found.
   bool GetNotification(const std::string& id, Notifications::iterator* iter);
 
   void EraseNotification(Notifications::iterator iter);
@@ -206,6 +211,8 @@ class MESSAGE_CENTER_EXPORT NotificationList {
 
   Delegate* delegate_;
   NotificationMap notifications_;
+  NotificationIndex index_;
+  size_t notification_count_;
   bool message_center_visible_;
   size_t unread_count_;
   bool quiet_mode_;
@@ -4,6 +4,8 @@
 
 #include "ui/message_center/notification_list.h"
 
+#include <vector>
+
 #include "base/basictypes.h"
 #include "base/i18n/time_formatting.h"
 #include "base/stringprintf.h"
@@ -196,6 +198,42 @@ TEST_F(NotificationListTest, UpdateNotification) {
   EXPECT_EQ(UTF8ToUTF16("newbody"), notifications.begin()->message);
 }
 
+// Verifies notifications are found by id as they are updated, reordered and
+// removed.
+TEST_F(NotificationListTest, LookupById) {
+  std::vector<std::string> ids;
+  for (int i = 0; i < 100; ++i) {
+    ids.push_back(AddPriorityNotification(
+        i % 2 ? ui::notifications::HIGH_PRIORITY :
+                ui::notifications::DEFAULT_PRIORITY));
+  }
+  EXPECT_EQ(100u, notification_list()->NotificationCount());
+  for (size_t i = 0; i < ids.size(); ++i)
+    EXPECT_TRUE(notification_list()->HasNotification(ids[i]));
+  EXPECT_FALSE(notification_list()->HasNotification("unknown"));
+
+  // Changing the id moves the notification to the new one.
+  notification_list()->UpdateNotificationMessage(
+      ids[10], "renamed", UTF8ToUTF16("title"), UTF8ToUTF16("body"), NULL);
+  EXPECT_FALSE(notification_list()->HasNotification(ids[10]));
+  EXPECT_TRUE(notification_list()->HasNotification("renamed"));
+  EXPECT_EQ(100u, notification_list()->NotificationCount());
+
+  // Reordered notifications can still be updated.
+  notification_list()->MarkSinglePopupAsShown(ids[20], false);
+  EXPECT_TRUE(notification_list()->SetNotificationIcon(ids[20],
+                                                       gfx::ImageSkia()));
+
+  EXPECT_TRUE(notification_list()->RemoveNotification(ids[30]));
+  EXPECT_FALSE(notification_list()->RemoveNotification(ids[30]));
+  EXPECT_FALSE(notification_list()->HasNotification(ids[30]));
+  EXPECT_EQ(99u, notification_list()->NotificationCount());
+
+  notification_list()->RemoveAllNotifications();
+  EXPECT_EQ(0u, notification_list()->NotificationCount());
+  EXPECT_FALSE(notification_list()->HasNotification(ids[0]));
+}
+
 TEST_F(NotificationListTest, SendRemoveNotifications) {
   notification_list()->AddNotification(
       ui::notifications::NOTIFICATION_TYPE_SIMPLE, "id0", UTF8ToUTF16("title0"),
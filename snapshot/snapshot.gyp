@@ -58,8 +58,37 @@
         'snapshot'
       ],
       'sources': [
+        'snapshot_aura_unittest.cc',
         'snapshot_mac_unittest.mm',
-      ]
+      ],
+      'include_dirs': [
+        '..',
+      ],
+      'conditions': [
+        ['use_aura==1', {
+          'dependencies': [
+            '../../base/base.gyp:test_support_base',
+            '../aura/aura.gyp:aura',
+            '../aura/aura.gyp:aura_test_support',
+            '../compositor/compositor.gyp:compositor',
+            '../compositor/compositor.gyp:compositor_test_support',
+            '../gl/gl.gyp:gl',
+            '../ui.gyp:ui_resources',
+            '../ui.gyp:ui_test_support',
+          ],
+          'sources': [
+            '../aura/test/run_all_unittests.cc',
+            '../aura/test/test_suite.cc',
+            '../aura/test/test_suite.h',
+          ],
+        }],
+        # osmesa GL implementation is used on linux.
+        ['use_aura==1 and OS=="linux"', {
+          'dependencies': [
+            '<(DEPTH)/third_party/mesa/mesa.gyp:osmesa',
+          ],
+        }],
+      ],
     },
   ],
 }
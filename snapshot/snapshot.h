@@ -7,9 +7,18 @@
 
 #include <vector>
 
+#include "base/callback_forward.h"
+#include "base/memory/ref_counted.h"
+#include "base/time.h"
 #include "ui/gfx/native_widget_types.h"
 #include "ui/snapshot/snapshot_export.h"
 
+class SkBitmap;
+
+namespace base {
+class RefCountedBytes;
+}
+
 namespace gfx {
 class Rect;
 }
@@ -29,6 +38,46 @@ SNAPSHOT_EXPORT bool GrabViewSnapshot(
     std::vector<unsigned char>* png_representation,
     const gfx::Rect& snapshot_bounds);
 
+#if defined(USE_AURA)
+// How long the stages of an asynchronous snapshot took.
+struct SnapshotTimings {
+  // Reading the pixels back from the compositor, on the UI thread.
+  base::TimeDelta readback_time;
+  // Encoding the pixels as PNG, on a worker thread.
+  base::TimeDelta encode_time;
+};
+
+// Receives the snapshot taken by GrabWindowBitmapAsync(). |bitmap| is empty if
+// the snapshot couldn't be taken.
+typedef base::Callback<void(const SkBitmap& bitmap,
+                            const SnapshotTimings& timings)>
+    GrabWindowBitmapCallback;
+
+// Receives the PNG encoded snapshot taken by GrabWindowSnapshotAsync().
+// |png_data| is NULL if the snapshot couldn't be taken or encoded.
+typedef base::Callback<void(scoped_refptr<base::RefCountedBytes> png_data,
+                            const SnapshotTimings& timings)>
+    GrabWindowSnapshotCallback;
+
+// Like GrabWindowSnapshot(), but reads |window| back once the compositor has
+// finished its next frame instead of right away, and calls |callback| with
+// the pixels. |callback| is always run, asynchronously, on the calling
+// thread.
+SNAPSHOT_EXPORT void GrabWindowBitmapAsync(
+    gfx::NativeWindow window,
+    const gfx::Rect& snapshot_bounds,
+    const GrabWindowBitmapCallback& callback);
+
+// Like GrabWindowBitmapAsync(), but also encodes the snapshot as PNG on a
+// worker thread, using zlib's |compression_level| (0-9, or -1 for the
+// default).
+SNAPSHOT_EXPORT void GrabWindowSnapshotAsync(
+    gfx::NativeWindow window,
+    const gfx::Rect& snapshot_bounds,
+    int compression_level,
+    const GrabWindowSnapshotCallback& callback);
+#endif
+
 }  // namespace ui
 
 #endif  // UI_SNAPSHOT_SNAPSHOT_H_
@@ -4,10 +4,18 @@
 
 #include "ui/snapshot/snapshot.h"
 
+#include "base/bind.h"
+#include "base/callback.h"
 #include "base/logging.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/memory/weak_ptr.h"
+#include "base/message_loop.h"
+#include "base/threading/worker_pool.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "ui/aura/window.h"
+#include "ui/aura/window_observer.h"
 #include "ui/compositor/compositor.h"
+#include "ui/compositor/compositor_observer.h"
 #include "ui/compositor/dip_util.h"
 #include "ui/compositor/layer.h"
 #include "ui/gfx/codec/png_codec.h"
@@ -15,17 +23,13 @@
 
 namespace ui {
 
-bool GrabViewSnapshot(gfx::NativeView view,
-                      std::vector<unsigned char>* png_representation,
-                      const gfx::Rect& snapshot_bounds) {
-  return GrabWindowSnapshot(view, png_representation, snapshot_bounds);
-}
-
-bool GrabWindowSnapshot(gfx::NativeWindow window,
-                        std::vector<unsigned char>* png_representation,
-                        const gfx::Rect& snapshot_bounds) {
-  ui::Compositor* compositor = window->layer()->GetCompositor();
+namespace {
 
+// Returns the part of |compositor|'s output that shows |snapshot_bounds| of
+// |window|.
+gfx::Rect GetReadPixelsBoundsInPixel(aura::Window* window,
+                                     ui::Compositor* compositor,
+                                     const gfx::Rect& snapshot_bounds) {
   gfx::Rect read_pixels_bounds = snapshot_bounds;
 
   // When not in compact mode we must take into account the window's position on
@@ -40,6 +44,162 @@ bool GrabWindowSnapshot(gfx::NativeWindow window,
 
   DCHECK_LE(0, read_pixels_bounds.x());
   DCHECK_LE(0, read_pixels_bounds.y());
+  return read_pixels_bounds_in_pixel;
+}
+
+// Waits for the compositor showing a window to finish a frame, then reads the
+// window back and hands the pixels to a callback. Deletes itself once the
+// callback has been run.
+//
+// The compositor is always looked up through the window's layer rather than
+// kept: ~RootWindow destroys its compositor before its windows are destroyed,
+// and the destroyed compositor detaches itself from the layer tree.
+class WindowBitmapGrabber : public CompositorObserver,
+                            public aura::WindowObserver {
+ public:
+  WindowBitmapGrabber(aura::Window* window,
+                      const gfx::Rect& snapshot_bounds,
+                      const GrabWindowBitmapCallback& callback)
+      : window_(window),
+        snapshot_bounds_(snapshot_bounds),
+        callback_(callback),
+        ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
+    window_->AddObserver(this);
+    Compositor* compositor = GetCompositor();
+    compositor->AddObserver(this);
+    // Make sure there is a next frame, without forcing it to happen now.
+    compositor->ScheduleDraw();
+  }
+
+  // CompositorObserver overrides:
+  virtual void OnCompositingDidCommit(Compositor* compositor) OVERRIDE {}
+  virtual void OnCompositingStarted(Compositor* compositor) OVERRIDE {}
+  virtual void OnCompositingEnded(Compositor* compositor) OVERRIDE {
+    // Observers are notified from within the compositor's drawing code, which
+    // ReadPixels() would reenter.
+    if (!weak_factory_.HasWeakPtrs()) {
+      MessageLoop::current()->PostTask(
+          FROM_HERE,
+          base::Bind(&WindowBitmapGrabber::ReadPixels,
+                     weak_factory_.GetWeakPtr()));
+    }
+  }
+  virtual void OnCompositingAborted(Compositor* compositor) OVERRIDE {
+    Finish(SkBitmap(), SnapshotTimings());
+  }
+  virtual void OnCompositingLockStateChanged(Compositor* compositor) OVERRIDE {}
+
+  // aura::WindowObserver overrides:
+  virtual void OnWindowRemovingFromRootWindow(aura::Window* window) OVERRIDE {
+    Finish(SkBitmap(), SnapshotTimings());
+  }
+  virtual void OnWindowDestroying(aura::Window* window) OVERRIDE {
+    Finish(SkBitmap(), SnapshotTimings());
+  }
+
+ private:
+  virtual ~WindowBitmapGrabber() {
+    window_->RemoveObserver(this);
+    // NULL if the compositor is being torn down with the root window.
+    Compositor* compositor = GetCompositor();
+    if (compositor)
+      compositor->RemoveObserver(this);
+  }
+
+  Compositor* GetCompositor() {
+    return window_->layer()->GetCompositor();
+  }
+
+  void ReadPixels() {
+    SnapshotTimings timings;
+    base::TimeTicks start = base::TimeTicks::Now();
+    SkBitmap bitmap;
+    Compositor* compositor = GetCompositor();
+    if (!compositor ||
+        !compositor->ReadPixels(&bitmap, GetReadPixelsBoundsInPixel(
+            window_, compositor, snapshot_bounds_))) {
+      bitmap.reset();
+    }
+    timings.readback_time = base::TimeTicks::Now() - start;
+    Finish(bitmap, timings);
+  }
+
+  void Finish(const SkBitmap& bitmap, const SnapshotTimings& timings) {
+    MessageLoop::current()->PostTask(FROM_HERE,
+                                     base::Bind(callback_, bitmap, timings));
+    delete this;
+  }
+
+  aura::Window* window_;
+  gfx::Rect snapshot_bounds_;
+  GrabWindowBitmapCallback callback_;
+  base::WeakPtrFactory<WindowBitmapGrabber> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(WindowBitmapGrabber);
+};
+
+// Runs on a worker thread.
+void EncodeBitmap(const SkBitmap& bitmap,
+                  int compression_level,
+                  scoped_refptr<base::RefCountedBytes> png_data,
+                  SnapshotTimings* timings) {
+  base::TimeTicks start = base::TimeTicks::Now();
+  SkAutoLockPixels lock_image(bitmap);
+  if (!gfx::PNGCodec::EncodeWithCompressionLevel(
+          reinterpret_cast<unsigned char*>(bitmap.getPixels()),
+          gfx::PNGCodec::FORMAT_BGRA,
+          gfx::Size(bitmap.width(), bitmap.height()),
+          bitmap.rowBytes(), true,
+          std::vector<gfx::PNGCodec::Comment>(),
+          compression_level,
+          &png_data->data())) {
+    png_data->data().clear();
+  }
+  timings->encode_time = base::TimeTicks::Now() - start;
+}
+
+void OnBitmapEncoded(scoped_refptr<base::RefCountedBytes> png_data,
+                     SnapshotTimings* timings,
+                     const GrabWindowSnapshotCallback& callback) {
+  if (png_data->data().empty())
+    png_data = NULL;
+  callback.Run(png_data, *timings);
+}
+
+void OnBitmapGrabbed(int compression_level,
+                     const GrabWindowSnapshotCallback& callback,
+                     const SkBitmap& bitmap,
+                     const SnapshotTimings& timings) {
+  if (bitmap.isNull()) {
+    callback.Run(NULL, timings);
+    return;
+  }
+
+  scoped_refptr<base::RefCountedBytes> png_data(new base::RefCountedBytes());
+  SnapshotTimings* encode_timings = new SnapshotTimings(timings);
+  base::WorkerPool::PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(&EncodeBitmap, bitmap, compression_level, png_data,
+                 encode_timings),
+      base::Bind(&OnBitmapEncoded, png_data, base::Owned(encode_timings),
+                 callback),
+      true);  // task_is_slow
+}
+
+}  // namespace
+
+bool GrabViewSnapshot(gfx::NativeView view,
+                      std::vector<unsigned char>* png_representation,
+                      const gfx::Rect& snapshot_bounds) {
+  return GrabWindowSnapshot(view, png_representation, snapshot_bounds);
+}
+
+bool GrabWindowSnapshot(gfx::NativeWindow window,
+                        std::vector<unsigned char>* png_representation,
+                        const gfx::Rect& snapshot_bounds) {
+  ui::Compositor* compositor = window->layer()->GetCompositor();
+  gfx::Rect read_pixels_bounds_in_pixel =
+      GetReadPixelsBoundsInPixel(window, compositor, snapshot_bounds);
 
   SkBitmap bitmap;
   if (!compositor->ReadPixels(&bitmap, read_pixels_bounds_in_pixel))
@@ -55,4 +215,24 @@ bool GrabWindowSnapshot(gfx::NativeWindow window,
   return true;
 }
 
+void GrabWindowBitmapAsync(gfx::NativeWindow window,
+                           const gfx::Rect& snapshot_bounds,
+                           const GrabWindowBitmapCallback& callback) {
+  if (!window->layer()->GetCompositor()) {
+    MessageLoop::current()->PostTask(
+        FROM_HERE, base::Bind(callback, SkBitmap(), SnapshotTimings()));
+    return;
+  }
+  new WindowBitmapGrabber(window, snapshot_bounds, callback);
+}
+
+void GrabWindowSnapshotAsync(gfx::NativeWindow window,
+                             const gfx::Rect& snapshot_bounds,
+                             int compression_level,
+                             const GrabWindowSnapshotCallback& callback) {
+  GrabWindowBitmapAsync(window, snapshot_bounds,
+                        base::Bind(&OnBitmapGrabbed, compression_level,
+                                   callback));
+}
+
 }  // namespace ui
@@ -0,0 +1,137 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/snapshot/snapshot.h"
+
+#include "base/bind.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/run_loop.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/aura/root_window.h"
+#include "ui/aura/test/aura_test_base.h"
+#include "ui/aura/test/test_windows.h"
+#include "ui/aura/window.h"
+#include "ui/gfx/codec/png_codec.h"
+#include "ui/gfx/rect.h"
+
+namespace ui {
+
+namespace {
+
+// Records the result of a GrabWindowBitmapAsync() or GrabWindowSnapshotAsync()
+// call and stops Wait() from waiting.
+class SnapshotReceiver {
+ public:
+  SnapshotReceiver() : called_(false) {}
+
+  GrabWindowBitmapCallback GetBitmapCallback() {
+    return base::Bind(&SnapshotReceiver::OnBitmap, base::Unretained(this));
+  }
+  GrabWindowSnapshotCallback GetSnapshotCallback() {
+    return base::Bind(&SnapshotReceiver::OnSnapshot, base::Unretained(this));
+  }
+
+  // Runs the message loop until the callback has been run.
+  void Wait() {
+    if (!called_)
+      run_loop_.Run();
+  }
+
+  bool called() const { return called_; }
+  const SkBitmap& bitmap() const { return bitmap_; }
+  const scoped_refptr<base::RefCountedBytes>& png_data() const {
+    return png_data_;
+  }
+
+ private:
+  void OnBitmap(const SkBitmap& bitmap, const SnapshotTimings& timings) {
+    EXPECT_FALSE(called_);
+    called_ = true;
+    bitmap_ = bitmap;
+    run_loop_.Quit();
+  }
+
+  void OnSnapshot(scoped_refptr<base::RefCountedBytes> png_data,
+                  const SnapshotTimings& timings) {
+    EXPECT_FALSE(called_);
+    called_ = true;
+    png_data_ = png_data;
+    run_loop_.Quit();
+  }
+
+  base::RunLoop run_loop_;
+  bool called_;
+  SkBitmap bitmap_;
+  scoped_refptr<base::RefCountedBytes> png_data_;
+
+  DISALLOW_COPY_AND_ASSIGN(SnapshotReceiver);
+};
+
+}  // namespace
+
+typedef aura::test::AuraTestBase SnapshotAuraTest;
+
+// The bitmap of the requested part of the window is passed to the callback
+// after the next frame.
+TEST_F(SnapshotAuraTest, GrabWindowBitmapAsync) {
+  scoped_ptr<aura::Window> window(aura::test::CreateTestWindow(
+      SK_ColorRED, 1, gfx::Rect(10, 10, 40, 30), root_window()));
+  SnapshotReceiver receiver;
+  GrabWindowBitmapAsync(window.get(), gfx::Rect(0, 0, 20, 10),
+                        receiver.GetBitmapCallback());
+  EXPECT_FALSE(receiver.called());
+  receiver.Wait();
+  EXPECT_EQ(20, receiver.bitmap().width());
+  EXPECT_EQ(10, receiver.bitmap().height());
+}
+
+// Destroying the window before the frame runs the callback with an empty
+// bitmap.
+TEST_F(SnapshotAuraTest, WindowDestroyed) {
+  scoped_ptr<aura::Window> window(aura::test::CreateTestWindow(
+      SK_ColorRED, 1, gfx::Rect(10, 10, 40, 30), root_window()));
+  SnapshotReceiver receiver;
+  GrabWindowBitmapAsync(window.get(), gfx::Rect(0, 0, 20, 10),
+                        receiver.GetBitmapCallback());
+  window.reset();
+  receiver.Wait();
+  EXPECT_TRUE(receiver.bitmap().isNull());
+}
+
+// Tearing down the root window, which destroys its compositor before the
+// windows, runs the callback with an empty bitmap.
+TEST_F(SnapshotAuraTest, RootWindowDestroyed) {
+  scoped_ptr<aura::RootWindow> other_root_window(new aura::RootWindow(
+      aura::RootWindow::CreateParams(gfx::Rect(0, 0, 100, 100))));
+  other_root_window->Init();
+  aura::Window* window = aura::test::CreateTestWindow(
+      SK_ColorRED, 1, gfx::Rect(10, 10, 40, 30), other_root_window.get());
+  SnapshotReceiver receiver;
+  GrabWindowBitmapAsync(window, gfx::Rect(0, 0, 20, 10),
+                        receiver.GetBitmapCallback());
+  other_root_window.reset();
+  receiver.Wait();
+  EXPECT_TRUE(receiver.bitmap().isNull());
+}
+
+// The snapshot is encoded as a PNG of the requested size.
+TEST_F(SnapshotAuraTest, GrabWindowSnapshotAsync) {
+  scoped_ptr<aura::Window> window(aura::test::CreateTestWindow(
+      SK_ColorRED, 1, gfx::Rect(10, 10, 40, 30), root_window()));
+  SnapshotReceiver receiver;
+  GrabWindowSnapshotAsync(window.get(), gfx::Rect(0, 0, 20, 10), 1,
+                          receiver.GetSnapshotCallback());
+  receiver.Wait();
+  ASSERT_TRUE(receiver.png_data());
+
+  SkBitmap decoded;
+  ASSERT_TRUE(gfx::PNGCodec::Decode(receiver.png_data()->front(),
+                                    receiver.png_data()->size(), &decoded));
+  EXPECT_EQ(20, decoded.width());
+  EXPECT_EQ(10, decoded.height());
+}
+
+}  // namespace ui
@@ -162,6 +162,8 @@
         'base/gestures/gesture_types.h',
         'base/gestures/gesture_util.cc',
         'base/gestures/gesture_util.h',
+        'base/gestures/touch_resampler.cc',
+        'base/gestures/touch_resampler.h',
         'base/gestures/velocity_calculator.cc',
         'base/gestures/velocity_calculator.h',
         'base/gtk/event_synthesis_gtk.cc',
@@ -321,6 +323,8 @@
         'base/x/work_area_watcher_x.h',
         'base/x/x11_atom_cache.cc',
         'base/x/x11_atom_cache.h',
+        'base/x/x11_property_cache.cc',
+        'base/x/x11_property_cache.h',
         'base/x/x11_util.cc',
         'base/x/x11_util.h',
         'base/x/x11_util_internal.h',
@@ -485,6 +489,8 @@
         'gfx/size_f.h',
         'gfx/skbitmap_operations.cc',
         'gfx/skbitmap_operations.h',
+        'gfx/skbitmap_operations_sse2.cc',
+        'gfx/skbitmap_operations_sse2.h',
         'gfx/skia_util.cc',
         'gfx/skia_util.h',
         'gfx/skia_utils_gtk.cc',
@@ -494,6 +500,8 @@
         'gfx/sys_color_change_listener.cc',
         'gfx/sys_color_change_listener.h',
         'gfx/text_constants.h',
+        'gfx/text_size_cache.cc',
+        'gfx/text_size_cache.h',
         'gfx/text_utils.cc',
         'gfx/text_utils.h',
         'gfx/transform.cc',
@@ -10,6 +10,7 @@
 #include "ui/views/border.h"
 #include "ui/views/controls/scrollbar/native_scroll_bar.h"
 #include "ui/views/widget/root_view.h"
+#include "ui/views/widget/widget.h"
 
 namespace views {
 
@@ -100,8 +101,10 @@ class ScrollView::Viewport : public View {
   }
 
   void ChildPreferredSizeChanged(View* child) OVERRIDE {
+    // Coalesce the layouts caused by bursts of model changes in the contents,
+    // e.g. rows added to a table one at a time.
     if (parent())
-      parent()->Layout();
+      parent()->ScheduleLayout();
   }
 
  private:
@@ -380,6 +383,14 @@ void ScrollView::SetHeaderOrContents(View* parent,
 }
 
 void ScrollView::ScrollContentsRegionToBeVisible(const gfx::Rect& rect) {
+  // The viewport lays this view out lazily when the preferred size of the
+  // contents changes, which callers often do right before scrolling, e.g. by
+  // expanding a tree node. Apply the pending layouts so that the bounds of
+  // the contents and the scrollbars used below are up to date.
+  Widget* widget = GetWidget();
+  if (widget)
+    widget->LayoutPendingViews();
+
   if (!contents_ || (!horiz_sb_->visible() && !vert_sb_->visible()))
     return;
 
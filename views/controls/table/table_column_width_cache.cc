@@ -0,0 +1,160 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/views/controls/table/table_column_width_cache.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "ui/base/models/table_model.h"
+#include "ui/gfx/font.h"
+
+namespace views {
+
+namespace {
+
+// Width recorded for rows that have not been measured.
+const int kUnmeasured = -1;
+
+}  // namespace
+
+TableColumnWidthCache::ColumnWidths::ColumnWidths()
+    : needs_initial_pass(true),
+      max_width(0),
+      max_width_valid(false) {
+}
+
+TableColumnWidthCache::ColumnWidths::~ColumnWidths() {
+}
+
+TableColumnWidthCache::TableColumnWidthCache()
+    : max_rows_to_measure_(0),
+      measure_count_(0) {
+}
+
+TableColumnWidthCache::~TableColumnWidthCache() {
+}
+
+int TableColumnWidthCache::GetContentWidth(ui::TableModel* model,
+                                           const gfx::Font& font,
+                                           int column_id) {
+  const int row_count = model->RowCount();
+  ColumnWidths& column = columns_[column_id];
+  if (!column.needs_initial_pass &&
+      static_cast<int>(column.widths.size()) != row_count) {
+    // The model changed without the cache being told; start over.
+    NOTREACHED();
+    column = ColumnWidths();
+  }
+
+  if (column.needs_initial_pass) {
+    column.widths.assign(row_count, kUnmeasured);
+    column.pending_rows.clear();
+    column.max_width_valid = false;
+    int step = 1;
+    if (max_rows_to_measure_ > 0 && row_count > max_rows_to_measure_)
+      step = (row_count + max_rows_to_measure_ - 1) / max_rows_to_measure_;
+    for (int row = 0; row < row_count; row += step)
+      MeasureRow(model, font, column_id, row, &column);
+    column.needs_initial_pass = false;
+  }
+
+  for (size_t i = 0; i < column.pending_rows.size(); ++i)
+    MeasureRow(model, font, column_id, column.pending_rows[i], &column);
+  column.pending_rows.clear();
+
+  if (!column.max_width_valid) {
+    column.max_width = 0;
+    for (size_t i = 0; i < column.widths.size(); ++i)
+      column.max_width = std::max(column.max_width, column.widths[i]);
+    column.max_width_valid = true;
+  }
+  return column.max_width;
+}
+
+void TableColumnWidthCache::Reset() {
+  columns_.clear();
+}
+
+void TableColumnWidthCache::OnItemsChanged(int start, int length) {
+  for (ColumnIdToWidths::iterator i = columns_.begin(); i != columns_.end();
+       ++i) {
+    ColumnWidths& column = i->second;
+    if (column.needs_initial_pass)
+      continue;
+    if (max_rows_to_measure_ > 0 && length > max_rows_to_measure_) {
+      column.needs_initial_pass = true;
+      continue;
+    }
+    // The stale widths are kept until the rows are re-measured so that
+    // MeasureRow() can tell whether the widest cell shrank.
+    for (int row = start; row < start + length; ++row)
+      column.pending_rows.push_back(row);
+  }
+}
+
+void TableColumnWidthCache::OnItemsAdded(int start, int length) {
+  for (ColumnIdToWidths::iterator i = columns_.begin(); i != columns_.end();
+       ++i) {
+    ColumnWidths& column = i->second;
+    if (column.needs_initial_pass)
+      continue;
+    if (max_rows_to_measure_ > 0 && length > max_rows_to_measure_) {
+      column.needs_initial_pass = true;
+      continue;
+    }
+    DCHECK_LE(start, static_cast<int>(column.widths.size()));
+    column.widths.insert(column.widths.begin() + start, length, kUnmeasured);
+    for (size_t j = 0; j < column.pending_rows.size(); ++j) {
+      if (column.pending_rows[j] >= start)
+        column.pending_rows[j] += length;
+    }
+    for (int row = start; row < start + length; ++row)
+      column.pending_rows.push_back(row);
+  }
+}
+
+void TableColumnWidthCache::OnItemsRemoved(int start, int length) {
+  for (ColumnIdToWidths::iterator i = columns_.begin(); i != columns_.end();
+       ++i) {
+    ColumnWidths& column = i->second;
+    if (column.needs_initial_pass)
+      continue;
+    DCHECK_LE(start + length, static_cast<int>(column.widths.size()));
+    for (int row = start; row < start + length; ++row) {
+      if (column.widths[row] == column.max_width)
+        column.max_width_valid = false;
+    }
+    column.widths.erase(column.widths.begin() + start,
+                        column.widths.begin() + start + length);
+    std::vector<int> pending_rows;
+    for (size_t j = 0; j < column.pending_rows.size(); ++j) {
+      const int row = column.pending_rows[j];
+      if (row < start)
+        pending_rows.push_back(row);
+      else if (row >= start + length)
+        pending_rows.push_back(row - length);
+    }
+    column.pending_rows.swap(pending_rows);
+  }
+}
+
+void TableColumnWidthCache::MeasureRow(ui::TableModel* model,
+                                       const gfx::Font& font,
+                                       int column_id,
+                                       int row,
+                                       ColumnWidths* column) {
+  const int old_width = column->widths[row];
+  const int width = font.GetStringWidth(model->GetText(row, column_id));
+  ++measure_count_;
+  column->widths[row] = width;
+  if (!column->max_width_valid)
+    return;
+  if (width >= column->max_width)
+    column->max_width = width;
+  else if (old_width == column->max_width)
+    column->max_width_valid = false;
+}
+
+}  // namespace views
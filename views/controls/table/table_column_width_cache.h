@@ -0,0 +1,107 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_VIEWS_CONTROLS_TABLE_TABLE_COLUMN_WIDTH_CACHE_H_
+#define UI_VIEWS_CONTROLS_TABLE_TABLE_COLUMN_WIDTH_CACHE_H_
+
+#include <map>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "ui/views/views_export.h"
+
+namespace gfx {
+class Font;
+}
+
+namespace ui {
+class TableModel;
+}
+
+namespace views {
+
+// TableColumnWidthCache remembers the measured width of every cell of the
+// auto-sized columns of a table so that sizing the columns does not measure
+// every row on every layout. Only rows reported through the On* methods (which
+// mirror ui::TableModelObserver) are re-measured, and the widest cell of each
+// column is tracked as rows are measured.
+//
+// For very large models the number of rows measured for a column can be
+// limited with set_max_rows_to_measure(), in which case evenly spaced rows are
+// sampled and the column width is an estimate.
+//
+// The cache assumes the same font is passed to GetContentWidth() until the
+// next call to Reset().
+class VIEWS_EXPORT TableColumnWidthCache {
+ public:
+  TableColumnWidthCache();
+  ~TableColumnWidthCache();
+
+  // Sets the maximum number of rows measured per column. 0 (the default)
+  // measures every row.
+  void set_max_rows_to_measure(int max_rows) {
+    max_rows_to_measure_ = max_rows;
+  }
+  int max_rows_to_measure() const { return max_rows_to_measure_; }
+
+  // Returns the width of the widest cell of the column identified by
+  // |column_id|, measuring only cells that are not already cached.
+  int GetContentWidth(ui::TableModel* model,
+                      const gfx::Font& font,
+                      int column_id);
+
+  // Forgets all cached widths. Invoke when the model or font changes wholesale.
+  void Reset();
+
+  // Keep the cache in sync with the model. Arguments match those of
+  // ui::TableModelObserver.
+  void OnItemsChanged(int start, int length);
+  void OnItemsAdded(int start, int length);
+  void OnItemsRemoved(int start, int length);
+
+  // Number of cells measured since construction. Exposed for tests and
+  // profiling.
+  int measure_count() const { return measure_count_; }
+
+ private:
+  struct ColumnWidths {
+    ColumnWidths();
+    ~ColumnWidths();
+
+    // Width of each row, or kUnmeasured.
+    std::vector<int> widths;
+
+    // Rows whose cached width is stale and that must be measured before the
+    // width of the column is next computed.
+    std::vector<int> pending_rows;
+
+    // True until the initial pass over the rows has been done.
+    bool needs_initial_pass;
+
+    // Widest entry of |widths|, valid only if |max_width_valid| is true.
+    int max_width;
+    bool max_width_valid;
+  };
+
+  typedef std::map<int, ColumnWidths> ColumnIdToWidths;
+
+  // Measures |row| of |column_id| and updates |column| accordingly.
+  void MeasureRow(ui::TableModel* model,
+                  const gfx::Font& font,
+                  int column_id,
+                  int row,
+                  ColumnWidths* column);
+
+  ColumnIdToWidths columns_;
+
+  int max_rows_to_measure_;
+
+  int measure_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(TableColumnWidthCache);
+};
+
+}  // namespace views
+
+#endif  // UI_VIEWS_CONTROLS_TABLE_TABLE_COLUMN_WIDTH_CACHE_H_
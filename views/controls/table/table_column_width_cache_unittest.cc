@@ -0,0 +1,136 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/views/controls/table/table_column_width_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "base/compiler_specific.h"
+#include "base/utf_string_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/base/models/table_model.h"
+#include "ui/gfx/font.h"
+#include "ui/gfx/image/image_skia.h"
+
+namespace views {
+
+namespace {
+
+// A single column model whose rows contain strings of 'x' of a given length.
+class WidthTableModel : public ui::TableModel {
+ public:
+  WidthTableModel() {}
+  virtual ~WidthTableModel() {}
+
+  void SetRowLength(int row, int length) { lengths_[row] = length; }
+  void AddRow(int row, int length) {
+    lengths_.insert(lengths_.begin() + row, length);
+  }
+  void RemoveRow(int row) { lengths_.erase(lengths_.begin() + row); }
+
+  // ui::TableModel overrides:
+  virtual int RowCount() OVERRIDE { return static_cast<int>(lengths_.size()); }
+  virtual string16 GetText(int row, int column_id) OVERRIDE {
+    return ASCIIToUTF16(std::string(lengths_[row], 'x'));
+  }
+  virtual gfx::ImageSkia GetIcon(int row) OVERRIDE { return gfx::ImageSkia(); }
+  virtual void SetObserver(ui::TableModelObserver* observer) OVERRIDE {}
+
+ private:
+  std::vector<int> lengths_;
+
+  DISALLOW_COPY_AND_ASSIGN(WidthTableModel);
+};
+
+int WidthOfLength(const gfx::Font& font, int length) {
+  return font.GetStringWidth(ASCIIToUTF16(std::string(length, 'x')));
+}
+
+}  // namespace
+
+// Verifies only rows reported as changed are measured again and the widest
+// cell is tracked as rows grow, shrink, appear and disappear.
+TEST(TableColumnWidthCacheTest, IncrementalUpdates) {
+  const gfx::Font font;
+  WidthTableModel model;
+  for (int i = 0; i < 10; ++i)
+    model.AddRow(i, i + 1);
+
+  TableColumnWidthCache cache;
+  EXPECT_EQ(WidthOfLength(font, 10), cache.GetContentWidth(&model, font, 0));
+  EXPECT_EQ(10, cache.measure_count());
+
+  // Nothing changed, nothing is measured.
+  EXPECT_EQ(WidthOfLength(font, 10), cache.GetContentWidth(&model, font, 0));
+  EXPECT_EQ(10, cache.measure_count());
+
+  // Grow a row past the widest one.
+  model.SetRowLength(2, 20);
+  cache.OnItemsChanged(2, 1);
+  EXPECT_EQ(WidthOfLength(font, 20), cache.GetContentWidth(&model, font, 0));
+  EXPECT_EQ(11, cache.measure_count());
+
+  // Shrink the widest row; the next widest comes from the cached widths.
+  model.SetRowLength(2, 1);
+  cache.OnItemsChanged(2, 1);
+  EXPECT_EQ(WidthOfLength(font, 10), cache.GetContentWidth(&model, font, 0));
+  EXPECT_EQ(12, cache.measure_count());
+
+  // Add a row.
+  model.AddRow(0, 15);
+  cache.OnItemsAdded(0, 1);
+  EXPECT_EQ(WidthOfLength(font, 15), cache.GetContentWidth(&model, font, 0));
+  EXPECT_EQ(13, cache.measure_count());
+
+  // Remove it again without measuring anything.
+  model.RemoveRow(0);
+  cache.OnItemsRemoved(0, 1);
+  EXPECT_EQ(WidthOfLength(font, 10), cache.GetContentWidth(&model, font, 0));
+  EXPECT_EQ(13, cache.measure_count());
+
+  // Reset forgets everything.
+  cache.Reset();
+  EXPECT_EQ(WidthOfLength(font, 10), cache.GetContentWidth(&model, font, 0));
+  EXPECT_EQ(23, cache.measure_count());
+}
+
+// Verifies a change reported before a pending row is measured shifts the
+// pending row.
+TEST(TableColumnWidthCacheTest, PendingRowsFollowModel) {
+  const gfx::Font font;
+  WidthTableModel model;
+  for (int i = 0; i < 4; ++i)
+    model.AddRow(i, 1);
+
+  TableColumnWidthCache cache;
+  cache.GetContentWidth(&model, font, 0);
+
+  model.SetRowLength(3, 8);
+  cache.OnItemsChanged(3, 1);
+  model.RemoveRow(0);
+  cache.OnItemsRemoved(0, 1);
+  EXPECT_EQ(WidthOfLength(font, 8), cache.GetContentWidth(&model, font, 0));
+}
+
+// Verifies sampling limits the number of rows measured.
+TEST(TableColumnWidthCacheTest, Sampling) {
+  const gfx::Font font;
+  WidthTableModel model;
+  for (int i = 0; i < 1000; ++i)
+    model.AddRow(i, 5);
+
+  TableColumnWidthCache cache;
+  cache.set_max_rows_to_measure(100);
+  EXPECT_EQ(WidthOfLength(font, 5), cache.GetContentWidth(&model, font, 0));
+  EXPECT_EQ(100, cache.measure_count());
+
+  // Changed rows are always measured, even if they were not sampled.
+  model.SetRowLength(1, 9);
+  cache.OnItemsChanged(1, 1);
+  EXPECT_EQ(WidthOfLength(font, 9), cache.GetContentWidth(&model, font, 0));
+  EXPECT_EQ(101, cache.measure_count());
+}
+
+}  // namespace views
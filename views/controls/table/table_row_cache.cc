@@ -0,0 +1,120 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/views/controls/table/table_row_cache.h"
+
+#include <utility>
+
+#include "base/logging.h"
+#include "ui/base/models/table_model.h"
+
+namespace views {
+
+namespace {
+
+// Default number of rows cached.
+const size_t kDefaultCapacity = 256;
+
+}  // namespace
+
+TableRowCache::Row::Row() : has_icon(false) {
+}
+
+TableRowCache::Row::~Row() {
+}
+
+TableRowCache::TableRowCache()
+    : capacity_(kDefaultCapacity),
+      last_row_(0),
+      fetch_count_(0) {
+}
+
+TableRowCache::~TableRowCache() {
+}
+
+void TableRowCache::SetCapacity(size_t capacity) {
+  DCHECK_GT(capacity, 0u);
+  capacity_ = capacity;
+  EvictRows();
+}
+
+const string16& TableRowCache::GetText(ui::TableModel* model,
+                                       int row,
+                                       int column_id) {
+  Row* entry = GetRow(row);
+  std::map<int, string16>::iterator i = entry->texts.find(column_id);
+  if (i == entry->texts.end()) {
+    ++fetch_count_;
+    i = entry->texts.insert(
+        std::make_pair(column_id, model->GetText(row, column_id))).first;
+  }
+  return i->second;
+}
+
+const gfx::ImageSkia& TableRowCache::GetIcon(ui::TableModel* model, int row) {
+  Row* entry = GetRow(row);
+  if (!entry->has_icon) {
+    ++fetch_count_;
+    entry->icon = model->GetIcon(row);
+    entry->has_icon = true;
+  }
+  return entry->icon;
+}
+
+void TableRowCache::Reset() {
+  rows_.clear();
+}
+
+void TableRowCache::OnItemsChanged(int start, int length) {
+  rows_.erase(rows_.lower_bound(start), rows_.lower_bound(start + length));
+}
+
+void TableRowCache::OnItemsAdded(int start, int length) {
+  ShiftRows(start, length);
+  if (last_row_ >= start)
+    last_row_ += length;
+}
+
+void TableRowCache::OnItemsRemoved(int start, int length) {
+  rows_.erase(rows_.lower_bound(start), rows_.lower_bound(start + length));
+  ShiftRows(start + length, -length);
+  if (last_row_ >= start + length)
+    last_row_ -= length;
+  else if (last_row_ >= start)
+    last_row_ = start;
+}
+
+TableRowCache::Row* TableRowCache::GetRow(int row) {
+  last_row_ = row;
+  Rows::iterator i = rows_.find(row);
+  if (i != rows_.end())
+    return &i->second;
+  Row* entry = &rows_[row];
+  EvictRows();
+  return entry;
+}
+
+void TableRowCache::ShiftRows(int start, int delta) {
+  // The cache is small, so rebuilding the tail is cheap.
+  Rows shifted;
+  for (Rows::iterator i = rows_.lower_bound(start); i != rows_.end(); ++i)
+    shifted[i->first + delta] = i->second;
+  rows_.erase(rows_.lower_bound(start), rows_.end());
+  rows_.insert(shifted.begin(), shifted.end());
+}
+
+void TableRowCache::EvictRows() {
+  // The row at |last_row_|, if cached, is only the furthest when it is the
+  // last one left, so it is never evicted.
+  while (rows_.size() > capacity_) {
+    Rows::iterator first = rows_.begin();
+    Rows::iterator last = --rows_.end();
+    if (last_row_ - first->first >= last->first - last_row_)
+      rows_.erase(first);
+    else
+      rows_.erase(last);
+  }
+}
+
+}  // namespace views
@@ -0,0 +1,100 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_VIEWS_CONTROLS_TABLE_TABLE_ROW_CACHE_H_
+#define UI_VIEWS_CONTROLS_TABLE_TABLE_ROW_CACHE_H_
+
+#include <map>
+
+#include "base/basictypes.h"
+#include "base/string16.h"
+#include "ui/gfx/image/image_skia.h"
+#include "ui/views/views_export.h"
+
+namespace ui {
+class TableModel;
+}
+
+namespace views {
+
+// TableRowCache holds the text and icon of a bounded number of rows of a
+// ui::TableModel, so that repainting rows that are on screen does not go back
+// to the model. When the cache is full the row furthest from the last one
+// requested is evicted, which keeps the rows around the area being scrolled
+// through.
+//
+// Rows are identified by their model index. The On* methods, which mirror
+// ui::TableModelObserver, must be invoked to keep the cache in sync with the
+// model.
+class VIEWS_EXPORT TableRowCache {
+ public:
+  TableRowCache();
+  ~TableRowCache();
+
+  // Sets the maximum number of rows cached. Must be at least 1.
+  void SetCapacity(size_t capacity);
+  size_t capacity() const { return capacity_; }
+
+  // Returns the text of the cell at |row| and |column_id|.
+  const string16& GetText(ui::TableModel* model, int row, int column_id);
+
+  // Returns the icon of |row|.
+  const gfx::ImageSkia& GetIcon(ui::TableModel* model, int row);
+
+  // Forgets all cached rows.
+  void Reset();
+
+  // Keep the cache in sync with the model. Arguments match those of
+  // ui::TableModelObserver.
+  void OnItemsChanged(int start, int length);
+  void OnItemsAdded(int start, int length);
+  void OnItemsRemoved(int start, int length);
+
+  // Number of rows cached.
+  size_t size() const { return rows_.size(); }
+
+  // Number of values fetched from the model since construction. Exposed for
+  // tests and profiling.
+  int fetch_count() const { return fetch_count_; }
+
+ private:
+  struct Row {
+    Row();
+    ~Row();
+
+    // Text of the cells fetched so far, keyed by column id.
+    std::map<int, string16> texts;
+
+    gfx::ImageSkia icon;
+    bool has_icon;
+  };
+
+  typedef std::map<int, Row> Rows;
+
+  // Returns the entry for |row|, creating it (and evicting another row if the
+  // cache is full) if necessary.
+  Row* GetRow(int row);
+
+  // Adds |delta| to the index of the rows at or after |start|.
+  void ShiftRows(int start, int delta);
+
+  // Evicts rows until there are at most |capacity_|, starting with the ones
+  // furthest from |last_row_|.
+  void EvictRows();
+
+  Rows rows_;
+
+  size_t capacity_;
+
+  // The row most recently requested.
+  int last_row_;
+
+  int fetch_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(TableRowCache);
+};
+
+}  // namespace views
+
+#endif  // UI_VIEWS_CONTROLS_TABLE_TABLE_ROW_CACHE_H_
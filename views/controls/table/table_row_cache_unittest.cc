@@ -0,0 +1,139 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/views/controls/table/table_row_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "base/compiler_specific.h"
+#include "base/string_number_conversions.h"
+#include "base/utf_string_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/base/models/table_model.h"
+#include "ui/gfx/image/image_skia.h"
+
+namespace views {
+
+namespace {
+
+// A model whose cells contain the value of their row, and can be changed.
+class ValueTableModel : public ui::TableModel {
+ public:
+  explicit ValueTableModel(int row_count) {
+    for (int i = 0; i < row_count; ++i)
+      values_.push_back(i);
+  }
+  virtual ~ValueTableModel() {}
+
+  void SetValue(int row, int value) { values_[row] = value; }
+  void AddRow(int row, int value) {
+    values_.insert(values_.begin() + row, value);
+  }
+  void RemoveRow(int row) { values_.erase(values_.begin() + row); }
+
+  // ui::TableModel overrides:
+  virtual int RowCount() OVERRIDE { return static_cast<int>(values_.size()); }
+  virtual string16 GetText(int row, int column_id) OVERRIDE {
+    return base::IntToString16(values_[row] * 10 + column_id);
+  }
+  virtual gfx::ImageSkia GetIcon(int row) OVERRIDE { return gfx::ImageSkia(); }
+  virtual void SetObserver(ui::TableModelObserver* observer) OVERRIDE {}
+
+ private:
+  std::vector<int> values_;
+
+  DISALLOW_COPY_AND_ASSIGN(ValueTableModel);
+};
+
+std::string GetText(TableRowCache* cache,
+                    ValueTableModel* model,
+                    int row,
+                    int column_id) {
+  return UTF16ToASCII(cache->GetText(model, row, column_id));
+}
+
+}  // namespace
+
+// Verifies cached values are not fetched again.
+TEST(TableRowCacheTest, Fetch) {
+  ValueTableModel model(10);
+  TableRowCache cache;
+  EXPECT_EQ("20", GetText(&cache, &model, 2, 0));
+  EXPECT_EQ("21", GetText(&cache, &model, 2, 1));
+  cache.GetIcon(&model, 2);
+  EXPECT_EQ(3, cache.fetch_count());
+
+  EXPECT_EQ("20", GetText(&cache, &model, 2, 0));
+  EXPECT_EQ("21", GetText(&cache, &model, 2, 1));
+  cache.GetIcon(&model, 2);
+  EXPECT_EQ(3, cache.fetch_count());
+  EXPECT_EQ(1u, cache.size());
+
+  cache.Reset();
+  EXPECT_EQ("20", GetText(&cache, &model, 2, 0));
+  EXPECT_EQ(4, cache.fetch_count());
+}
+
+// Verifies the cache is bounded and keeps the rows closest to the last one
+// requested.
+TEST(TableRowCacheTest, Eviction) {
+  ValueTableModel model(1000);
+  TableRowCache cache;
+  cache.SetCapacity(10);
+  for (int i = 0; i < 1000; ++i)
+    GetText(&cache, &model, i, 0);
+  EXPECT_EQ(10u, cache.size());
+  EXPECT_EQ(1000, cache.fetch_count());
+
+  // The last ten rows are cached.
+  for (int i = 990; i < 1000; ++i)
+    GetText(&cache, &model, i, 0);
+  EXPECT_EQ(1000, cache.fetch_count());
+
+  // Scrolling back up evicts the rows furthest down.
+  GetText(&cache, &model, 989, 0);
+  EXPECT_EQ(1001, cache.fetch_count());
+  GetText(&cache, &model, 990, 0);
+  EXPECT_EQ(1001, cache.fetch_count());
+  GetText(&cache, &model, 999, 0);
+  EXPECT_EQ(1002, cache.fetch_count());
+
+  cache.SetCapacity(1);
+  EXPECT_EQ(1u, cache.size());
+  GetText(&cache, &model, 999, 0);
+  EXPECT_EQ(1002, cache.fetch_count());
+}
+
+// Verifies the cache follows rows as they change, move and go away.
+TEST(TableRowCacheTest, FollowsModel) {
+  ValueTableModel model(5);
+  TableRowCache cache;
+  for (int i = 0; i < 5; ++i)
+    GetText(&cache, &model, i, 0);
+  EXPECT_EQ(5, cache.fetch_count());
+
+  model.SetValue(1, 7);
+  cache.OnItemsChanged(1, 1);
+  EXPECT_EQ("70", GetText(&cache, &model, 1, 0));
+  EXPECT_EQ(6, cache.fetch_count());
+
+  model.AddRow(2, 8);
+  cache.OnItemsAdded(2, 1);
+  EXPECT_EQ("80", GetText(&cache, &model, 2, 0));
+  EXPECT_EQ(7, cache.fetch_count());
+  EXPECT_EQ("40", GetText(&cache, &model, 5, 0));
+  EXPECT_EQ("70", GetText(&cache, &model, 1, 0));
+  EXPECT_EQ(7, cache.fetch_count());
+
+  model.RemoveRow(0);
+  model.RemoveRow(0);
+  cache.OnItemsRemoved(0, 2);
+  EXPECT_EQ("80", GetText(&cache, &model, 0, 0));
+  EXPECT_EQ("40", GetText(&cache, &model, 3, 0));
+  EXPECT_EQ(7, cache.fetch_count());
+  EXPECT_EQ(4u, cache.size());
+}
+
+}  // namespace views
@@ -0,0 +1,74 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/views/controls/table/table_sort_keys.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "ui/base/models/table_model.h"
+
+namespace views {
+
+TableSortKeys::TableSortKeys()
+    : column_id_(-1),
+      used_size_(0) {
+}
+
+TableSortKeys::~TableSortKeys() {
+}
+
+void TableSortKeys::Build(ui::TableModel* model, int column_id) {
+  column_id_ = column_id;
+  const int row_count = model->RowCount();
+  buffer_.clear();
+  offsets_.resize(row_count);
+  lengths_.resize(row_count);
+  for (int row = 0; row < row_count; ++row) {
+    offsets_[row] = buffer_.size();
+    lengths_[row] = model->AppendSortKey(row, column_id, &buffer_);
+  }
+  used_size_ = buffer_.size();
+}
+
+void TableSortKeys::Update(ui::TableModel* model, int row) {
+  DCHECK(row >= 0 && row < row_count());
+  used_size_ -= lengths_[row];
+  offsets_[row] = buffer_.size();
+  lengths_[row] = model->AppendSortKey(row, column_id_, &buffer_);
+  used_size_ += lengths_[row];
+  if (buffer_.size() > 2 * used_size_ + 1024)
+    Compact();
+}
+
+int TableSortKeys::Compare(int row1, int row2) const {
+  const size_t length1 = lengths_[row1];
+  const size_t length2 = lengths_[row2];
+  const size_t common_length = std::min(length1, length2);
+  if (common_length > 0) {
+    const int result = memcmp(&buffer_[offsets_[row1]],
+                              &buffer_[offsets_[row2]], common_length);
+    if (result != 0)
+      return result;
+  }
+  if (length1 == length2)
+    return 0;
+  return length1 < length2 ? -1 : 1;
+}
+
+void TableSortKeys::Compact() {
+  std::vector<uint8> buffer;
+  buffer.reserve(used_size_);
+  for (size_t row = 0; row < offsets_.size(); ++row) {
+    const size_t offset = buffer.size();
+    buffer.insert(buffer.end(), buffer_.begin() + offsets_[row],
+                  buffer_.begin() + offsets_[row] + lengths_[row]);
+    offsets_[row] = offset;
+  }
+  buffer_.swap(buffer);
+}
+
+}  // namespace views
@@ -0,0 +1,63 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_VIEWS_CONTROLS_TABLE_TABLE_SORT_KEYS_H_
+#define UI_VIEWS_CONTROLS_TABLE_TABLE_SORT_KEYS_H_
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "ui/views/views_export.h"
+
+namespace ui {
+class TableModel;
+}
+
+namespace views {
+
+// TableSortKeys holds the collation sort keys (see
+// ui::TableModel::AppendSortKey()) of every row of one column of a model,
+// stored back to back in a single buffer. Comparing two rows is then a memcmp
+// instead of fetching both strings and collating them.
+class VIEWS_EXPORT TableSortKeys {
+ public:
+  TableSortKeys();
+  ~TableSortKeys();
+
+  int column_id() const { return column_id_; }
+  int row_count() const { return static_cast<int>(offsets_.size()); }
+
+  // Builds the keys of every row of the column with id |column_id|.
+  void Build(ui::TableModel* model, int column_id);
+
+  // Rebuilds the key of |row| after its value changed.
+  void Update(ui::TableModel* model, int row);
+
+  // Returns a value < 0, == 0 or > 0 as to whether the value of |row1| sorts
+  // before, with or after that of |row2|.
+  int Compare(int row1, int row2) const;
+
+ private:
+  // Rewrites |buffer_| so that it only contains the current keys.
+  void Compact();
+
+  int column_id_;
+
+  // The keys, indexed by |offsets_| and |lengths_|.
+  std::vector<uint8> buffer_;
+
+  // Offset into |buffer_| and length of the key of each row.
+  std::vector<size_t> offsets_;
+  std::vector<size_t> lengths_;
+
+  // Number of bytes of |buffer_| used by current keys; Update() leaves the old
+  // key of a row behind.
+  size_t used_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(TableSortKeys);
+};
+
+}  // namespace views
+
+#endif  // UI_VIEWS_CONTROLS_TABLE_TABLE_SORT_KEYS_H_
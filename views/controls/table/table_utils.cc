@@ -7,6 +7,7 @@
 #include "base/logging.h"
 #include "ui/gfx/canvas.h"
 #include "ui/gfx/font.h"
+#include "ui/views/controls/table/table_column_width_cache.h"
 #include "ui/views/controls/table/table_view.h"
 
 namespace views {
@@ -19,14 +20,30 @@ int WidthForContent(const gfx::Font& header_font,
                     int header_padding,
                     const ui::TableColumn& column,
                     ui::TableModel* model) {
+  return WidthForContent(header_font, content_font, padding, header_padding,
+                         column, model, NULL);
+}
+
+int WidthForContent(const gfx::Font& header_font,
+                    const gfx::Font& content_font,
+                    int padding,
+                    int header_padding,
+                    const ui::TableColumn& column,
+                    ui::TableModel* model,
+                    TableColumnWidthCache* width_cache) {
   int width = header_padding;
   if (!column.title.empty())
     width = header_font.GetStringWidth(column.title) + header_padding;
 
-  for (int i = 0, row_count = model->RowCount(); i < row_count; ++i) {
-    const int cell_width =
-        content_font.GetStringWidth(model->GetText(i, column.id));
-    width = std::max(width, cell_width);
+  if (width_cache) {
+    width = std::max(width, width_cache->GetContentWidth(model, content_font,
+                                                         column.id));
+  } else {
+    for (int i = 0, row_count = model->RowCount(); i < row_count; ++i) {
+      const int cell_width =
+          content_font.GetStringWidth(model->GetText(i, column.id));
+      width = std::max(width, cell_width);
+    }
   }
   return width + padding;
 }
@@ -40,6 +57,21 @@ std::vector<int> CalculateTableColumnSizes(
     int header_padding,
     const std::vector<ui::TableColumn>& columns,
     ui::TableModel* model) {
+  return CalculateTableColumnSizes(width, first_column_padding, header_font,
+                                   content_font, padding, header_padding,
+                                   columns, model, NULL);
+}
+
+std::vector<int> CalculateTableColumnSizes(
+    int width,
+    int first_column_padding,
+    const gfx::Font& header_font,
+    const gfx::Font& content_font,
+    int padding,
+    int header_padding,
+    const std::vector<ui::TableColumn>& columns,
+    ui::TableModel* model,
+    TableColumnWidthCache* width_cache) {
   float total_percent = 0;
   int non_percent_width = 0;
   std::vector<int> content_widths(columns.size(), 0);
@@ -53,7 +85,8 @@ std::vector<int> CalculateTableColumnSizes(
             header_padding;
       } else {
         content_widths[i] = WidthForContent(header_font, content_font, padding,
-                                            header_padding, column, model);
+                                            header_padding, column, model,
+                                            width_cache);
         if (i == 0)
           content_widths[i] += first_column_padding;
       }
@@ -16,6 +16,7 @@ class Font;
 
 namespace views {
 
+class TableColumnWidthCache;
 class TableView;
 
 VIEWS_EXPORT extern const int kUnspecifiedColumnWidth;
@@ -30,6 +31,16 @@ VIEWS_EXPORT int WidthForContent(const gfx::Font& header_font,
                                  const ui::TableColumn& column,
                                  ui::TableModel* model);
 
+// Same as above, but the widths of the cells are obtained from |width_cache|,
+// which measures only rows it has not seen before. |width_cache| may be NULL.
+VIEWS_EXPORT int WidthForContent(const gfx::Font& header_font,
+                                 const gfx::Font& content_font,
+                                 int padding,
+                                 int header_padding,
+                                 const ui::TableColumn& column,
+                                 ui::TableModel* model,
+                                 TableColumnWidthCache* width_cache);
+
 // Determines the width for each of the specified columns. |width| is the width
 // to fit the columns into. |header_font| the font used to draw the header and
 // |content_font| the header used to draw the content. |padding| is extra
@@ -45,6 +56,19 @@ VIEWS_EXPORT std::vector<int> CalculateTableColumnSizes(
     const std::vector<ui::TableColumn>& columns,
     ui::TableModel* model);
 
+// Same as above, using |width_cache| (which may be NULL) to size columns that
+// are sized to fit their content.
+VIEWS_EXPORT std::vector<int> CalculateTableColumnSizes(
+    int width,
+    int first_column_padding,
+    const gfx::Font& header_font,
+    const gfx::Font& content_font,
+    int padding,
+    int header_padding,
+    const std::vector<ui::TableColumn>& columns,
+    ui::TableModel* model,
+    TableColumnWidthCache* width_cache);
+
 // Converts a TableColumn::Alignment to the alignment for drawing the string.
 int TableColumnAlignmentToCanvasAlignment(ui::TableColumn::Alignment alignment);
 
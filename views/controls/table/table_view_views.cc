@@ -4,6 +4,7 @@
 
 #include "ui/views/controls/table/table_view_views.h"
 
+#include <algorithm>
 #include <map>
 
 #include "base/auto_reset.h"
@@ -18,6 +19,7 @@
 #include "ui/views/controls/table/group_table_model.h"
 #include "ui/views/controls/table/table_grouper.h"
 #include "ui/views/controls/table/table_header.h"
+#include "ui/views/controls/table/table_sort_keys.h"
 #include "ui/views/controls/table/table_utils.h"
 #include "ui/views/controls/table/table_view_observer.h"
 #include "ui/views/controls/table/table_view_row_background_painter.h"
@@ -31,8 +33,17 @@ static const int kImageSize = 16;
 
 static const int kGroupingIndicatorSize = 6;
 
+// Number of screens of rows kept in the row cache of virtualized tables: the
+// one shown and one on either side.
+static const int kScreensOfCachedRows = 3;
+
+// Minimum number of rows kept in the row cache of virtualized tables.
+static const int kMinCachedRows = 64;
+
 namespace views {
 
+const int TableView::kVirtualizedMaxRowsToMeasure = 1000;
+
 namespace {
 
 // Returns result, unless ascending is false in which case -result is returned.
@@ -131,6 +142,8 @@ TableView::TableView(ui::TableModel* model,
       row_height_(font_.GetHeight() + kTextVerticalPadding * 2),
       last_parent_width_(0),
       layout_width_(0),
+      max_rows_to_measure_(0),
+      virtualized_(false),
       grouper_(NULL),
       in_set_visible_column_width_(false) {
   for (size_t i = 0; i < columns.size(); ++i) {
@@ -157,6 +170,8 @@ void TableView::SetModel(ui::TableModel* model) {
     model_->SetObserver(NULL);
   model_ = model;
   selection_model_.Clear();
+  column_width_cache_.Reset();
+  row_cache_.Reset();
   if (model_)
     model_->SetObserver(this);
 }
@@ -276,6 +291,23 @@ void TableView::SetVisibleColumnWidth(int index, int width) {
   SchedulePaint();
 }
 
+void TableView::SetMaxRowsToMeasureForColumnSizing(int max_rows) {
+  max_rows_to_measure_ = max_rows;
+  UpdateMaxRowsToMeasure();
+}
+
+void TableView::SetVirtualized(bool virtualized) {
+  if (virtualized == virtualized_)
+    return;
+  virtualized_ = virtualized;
+  row_cache_.Reset();
+  UpdateRowCacheCapacity();
+  UpdateMaxRowsToMeasure();
+  UpdateVisibleColumnSizes();
+  PreferredSizeChanged();
+  SchedulePaint();
+}
+
 int TableView::ModelToView(int model_index) const {
   if (!is_sorted())
     return model_index;
@@ -319,6 +351,7 @@ void TableView::Layout() {
     height = std::max(parent()->height(), height);
   }
   SetBounds(x(), y(), width, height);
+  UpdateRowCacheCapacity();
 }
 
 gfx::Size TableView::GetPreferredSize() {
@@ -393,14 +426,30 @@ bool TableView::GetTooltipTextOrigin(const gfx::Point& p,
 
 void TableView::OnModelChanged() {
   selection_model_.Clear();
+  column_width_cache_.Reset();
+  row_cache_.Reset();
   NumRowsChanged();
 }
 
 void TableView::OnItemsChanged(int start, int length) {
-  SortItemsAndUpdateMapping();
+  column_width_cache_.OnItemsChanged(start, length);
+  row_cache_.OnItemsChanged(start, length);
+  // Groups are sorted by their first row, so a change to one row may move a
+  // whole group; re-sort everything in that case. A change may also alter the
+  // groups themselves, so repaint everything when grouped.
+  if (!is_sorted() && !grouper_) {
+    SchedulePaintForRows(start, start + length - 1);
+  } else if (length == 1 && is_sorted() && !grouper_ &&
+             static_cast<int>(view_to_model_.size()) == RowCount()) {
+    RepositionSortedRow(start);
+  } else {
+    SortItemsAndUpdateMapping();
+  }
 }
 
 void TableView::OnItemsAdded(int start, int length) {
+  column_width_cache_.OnItemsAdded(start, length);
+  row_cache_.OnItemsAdded(start, length);
   for (int i = 0; i < length; ++i)
     selection_model_.IncrementFrom(start);
   NumRowsChanged();
@@ -415,6 +464,8 @@ void TableView::OnItemsRemoved(int start, int length) {
   if (previously_selected_model_index != -1 && is_sorted())
     previously_selected_view_index =
         model_to_view_[previously_selected_model_index];
+  column_width_cache_.OnItemsRemoved(start, length);
+  row_cache_.OnItemsRemoved(start, length);
   for (int i = 0; i < length; ++i)
     selection_model_.DecrementFrom(start);
   NumRowsChanged();
@@ -489,7 +540,7 @@ void TableView::OnPaint(gfx::Canvas* canvas) {
 
       // Always paint the icon in the first visible column.
       if (j == 0 && table_type_ == ICON_AND_TEXT) {
-        gfx::ImageSkia image = model_->GetIcon(model_index);
+        gfx::ImageSkia image = GetRowIcon(model_index);
         if (!image.isNull()) {
           int image_x = GetMirroredXWithWidthInView(text_x, kImageSize);
           canvas->DrawImageInt(
@@ -502,7 +553,7 @@ void TableView::OnPaint(gfx::Canvas* canvas) {
       }
       if (text_x < cell_bounds.right() - kTextHorizontalPadding) {
         canvas->DrawStringInt(
-            model_->GetText(model_index, visible_columns_[j].column.id), font_,
+            GetCellText(model_index, visible_columns_[j].column.id), font_,
             is_selected ? selected_fg_color : fg_color,
             GetMirroredXWithWidthInView(text_x, cell_bounds.right() - text_x -
                                         kTextHorizontalPadding),
@@ -580,7 +631,9 @@ void TableView::SortItemsAndUpdateMapping() {
   if (!is_sorted()) {
     view_to_model_.clear();
     model_to_view_.clear();
+    sort_keys_.clear();
   } else {
+    UpdateSortKeys();
     const int row_count = RowCount();
     view_to_model_.resize(row_count);
     model_to_view_.resize(row_count);
@@ -601,23 +654,104 @@ void TableView::SortItemsAndUpdateMapping() {
   SchedulePaint();
 }
 
+void TableView::UpdateSortKeys() {
+  sort_keys_.clear();
+  for (size_t i = 0; i < sort_descriptors_.size(); ++i) {
+    if (!model_->CanSortBySortKey(sort_descriptors_[i].column_id))
+      return;
+  }
+  for (size_t i = 0; i < sort_descriptors_.size(); ++i) {
+    TableSortKeys* keys = new TableSortKeys;
+    keys->Build(model_, sort_descriptors_[i].column_id);
+    sort_keys_.push_back(keys);
+  }
+}
+
+void TableView::RepositionSortedRow(int model_index) {
+  for (size_t i = 0; i < sort_keys_.size(); ++i)
+    sort_keys_[i]->Update(model_, model_index);
+
+  const int old_view_index = model_to_view_[model_index];
+  view_to_model_.erase(view_to_model_.begin() + old_view_index);
+  std::vector<int>::iterator position =
+      std::upper_bound(view_to_model_.begin(), view_to_model_.end(),
+                       model_index, SortHelper(this));
+  const int new_view_index =
+      static_cast<int>(position - view_to_model_.begin());
+  view_to_model_.insert(position, model_index);
+  for (int i = std::min(old_view_index, new_view_index),
+           end = std::max(old_view_index, new_view_index); i <= end; ++i) {
+    model_to_view_[view_to_model_[i]] = i;
+  }
+  model_->ClearCollator();
+  SchedulePaintForRows(std::min(old_view_index, new_view_index),
+                       std::max(old_view_index, new_view_index));
+}
+
 int TableView::CompareRows(int model_row1, int model_row2) {
-  const int sort_result = model_->CompareValues(
-      model_row1, model_row2, sort_descriptors_[0].column_id);
+  const int sort_result = CompareRowsForDescriptor(0, model_row1, model_row2);
   if (sort_result == 0 && sort_descriptors_.size() > 1) {
     // Try the secondary sort.
     return SwapCompareResult(
-        model_->CompareValues(model_row1, model_row2,
-                              sort_descriptors_[1].column_id),
+        CompareRowsForDescriptor(1, model_row1, model_row2),
         sort_descriptors_[1].ascending);
   }
   return SwapCompareResult(sort_result, sort_descriptors_[0].ascending);
 }
 
+int TableView::CompareRowsForDescriptor(size_t index,
+                                        int model_row1,
+                                        int model_row2) {
+  if (!sort_keys_.empty())
+    return sort_keys_[index]->Compare(model_row1, model_row2);
+  return model_->CompareValues(model_row1, model_row2,
+                               sort_descriptors_[index].column_id);
+}
+
 gfx::Rect TableView::GetRowBounds(int row) const {
   return gfx::Rect(0, row * row_height_, width(), row_height_);
 }
 
+void TableView::SchedulePaintForRows(int start, int end) {
+  gfx::Rect bounds(GetRowBounds(start));
+  bounds.Union(GetRowBounds(end));
+  bounds.Intersect(GetVisibleBounds());
+  if (!bounds.IsEmpty())
+    SchedulePaintInRect(bounds);
+}
+
+string16 TableView::GetCellText(int model_index, int column_id) const {
+  if (virtualized_)
+    return row_cache_.GetText(model_, model_index, column_id);
+  return model_->GetText(model_index, column_id);
+}
+
+gfx::ImageSkia TableView::GetRowIcon(int model_index) const {
+  if (virtualized_)
+    return row_cache_.GetIcon(model_, model_index);
+  return model_->GetIcon(model_index);
+}
+
+void TableView::UpdateRowCacheCapacity() {
+  if (!virtualized_)
+    return;
+  // The parent is the Viewport of the ScrollView, if any.
+  const int visible_height = parent() ? parent()->height() : height();
+  const int rows_per_screen = visible_height / row_height_ + 1;
+  row_cache_.SetCapacity(static_cast<size_t>(
+      std::max(kMinCachedRows, rows_per_screen * kScreensOfCachedRows)));
+}
+
+void TableView::UpdateMaxRowsToMeasure() {
+  int max_rows = max_rows_to_measure_;
+  if (virtualized_ &&
+      (max_rows == 0 || max_rows > kVirtualizedMaxRowsToMeasure)) {
+    max_rows = kVirtualizedMaxRowsToMeasure;
+  }
+  column_width_cache_.set_max_rows_to_measure(max_rows);
+  column_width_cache_.Reset();
+}
+
 gfx::Rect TableView::GetCellBounds(int row, int visible_column_index) const {
   if (!header_)
     return GetRowBounds(row);
@@ -665,7 +799,8 @@ void TableView::UpdateVisibleColumnSizes() {
   std::vector<int> sizes = views::CalculateTableColumnSizes(
       layout_width_, first_column_padding, header_->font(), font_,
       std::max(kTextHorizontalPadding, TableHeader::kHorizontalPadding) * 2,
-      TableHeader::kSortIndicatorWidth, columns, model_);
+      TableHeader::kSortIndicatorWidth, columns, model_,
+      &column_width_cache_);
   DCHECK_EQ(visible_columns_.size(), sizes.size());
   int x = 0;
   for (size_t i = 0; i < visible_columns_.size(); ++i) {
@@ -864,8 +999,8 @@ bool TableView::GetTooltipImpl(const gfx::Point& location,
       x > (visible_columns_[column].x + visible_columns_[column].width))
     return false;
 
-  const string16 text(model_->GetText(ViewToModel(row),
-                                      visible_columns_[column].column.id));
+  const string16 text(GetCellText(ViewToModel(row),
+                                  visible_columns_[column].column.id));
   if (text.empty())
     return false;
 
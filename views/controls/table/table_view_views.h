@@ -8,10 +8,13 @@
 #include <vector>
 
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
 #include "ui/base/models/list_selection_model.h"
 #include "ui/base/models/table_model.h"
 #include "ui/base/models/table_model_observer.h"
 #include "ui/gfx/font.h"
+#include "ui/views/controls/table/table_column_width_cache.h"
+#include "ui/views/controls/table/table_row_cache.h"
 #include "ui/views/view.h"
 #include "ui/views/views_export.h"
 
@@ -29,12 +32,18 @@
 // convert to view coordinates use ModelToView().
 //
 // Sorting is done by a locale sensitive string sort. You can customize the
-// sort by way of overriding TableModel::CompareValues().
+// sort by way of overriding TableModel::CompareValues(). Models that keep the
+// default sort can return true from TableModel::CanSortBySortKey() to have the
+// table sort by precomputed collation keys, which is much faster.
+//
+// Tables showing very large models should be made virtualized with
+// SetVirtualized(). See it for details.
 namespace views {
 
 struct GroupRange;
 class TableGrouper;
 class TableHeader;
+class TableSortKeys;
 class TableViewObserver;
 class TableViewRowBackgroundPainter;
 class TableViewTestHelper;
@@ -163,6 +172,21 @@ class VIEWS_EXPORT TableView
   // Sets the width of the column. |index| is in terms of |visible_columns_|.
   void SetVisibleColumnWidth(int index, int width);
 
+  // Limits the number of rows measured when sizing columns to their content.
+  // With very large models the content width is then estimated from a sample
+  // of the rows. 0 (the default) measures every row.
+  void SetMaxRowsToMeasureForColumnSizing(int max_rows);
+
+  // Sets whether the table is virtualized, for models with a very large number
+  // of rows. A virtualized table only asks the model for the rows it paints
+  // and keeps their text and icons in a cache sized to a few screens of rows.
+  // Columns sized to their content measure at most
+  // kVirtualizedMaxRowsToMeasure rows, unless
+  // SetMaxRowsToMeasureForColumnSizing() set a lower limit. The default is
+  // false.
+  void SetVirtualized(bool virtualized);
+  bool virtualized() const { return virtualized_; }
+
   // Toggles the sort order of the specified visible column index.
   void ToggleSortOrder(int visible_column_index);
 
@@ -177,6 +201,9 @@ class VIEWS_EXPORT TableView
 
   int row_height() const { return row_height_; }
 
+  // See SetVirtualized().
+  static const int kVirtualizedMaxRowsToMeasure;
+
   // View overrides:
   virtual void Layout() OVERRIDE;
   virtual gfx::Size GetPreferredSize() OVERRIDE;
@@ -236,14 +263,43 @@ class VIEWS_EXPORT TableView
   // |model_to_view_|) appropriately.
   void SortItemsAndUpdateMapping();
 
+  // Builds |sort_keys_| for the current sort if the model allows sorting all
+  // the sorted columns by sort key, otherwise clears it.
+  void UpdateSortKeys();
+
+  // Moves |model_index|, whose value changed, to its sorted position without
+  // sorting the remaining rows.
+  void RepositionSortedRow(int model_index);
+
   // Used to sort the two rows. Returns a value < 0, == 0 or > 0 indicating
   // whether the row2 comes before row1, row2 is the same as row1 or row1 comes
-  // after row2. This invokes CompareValues on the model with the sorted column.
+  // after row2. This compares the sort keys of the rows if available and
+  // otherwise invokes CompareValues on the model with the sorted column.
   int CompareRows(int model_row1, int model_row2);
 
+  // Compares the two rows on the column of |sort_descriptors_[index]|,
+  // ignoring the sort direction.
+  int CompareRowsForDescriptor(size_t index, int model_row1, int model_row2);
+
   // Returns the bounds of the specified row.
   gfx::Rect GetRowBounds(int row) const;
 
+  // Schedules a paint for the visible part of the rows from |start| to |end|,
+  // inclusive, in terms of the view.
+  void SchedulePaintForRows(int start, int end);
+
+  // Returns the text of the cell at |model_index| and |column_id|, or the icon
+  // of |model_index|. These go through |row_cache_| when virtualized.
+  string16 GetCellText(int model_index, int column_id) const;
+  gfx::ImageSkia GetRowIcon(int model_index) const;
+
+  // Sizes |row_cache_| to hold a few screens of rows.
+  void UpdateRowCacheCapacity();
+
+  // Applies the limit on the rows measured for column sizing, which depends on
+  // whether the table is virtualized.
+  void UpdateMaxRowsToMeasure();
+
   // Returns the bounds of the specified cell. |visible_column_index| indexes
   // into |visible_columns_|.
   gfx::Rect GetCellBounds(int row, int visible_column_index) const;
@@ -339,6 +395,19 @@ class VIEWS_EXPORT TableView
   // The width we layout to. This may differ from |last_parent_width_|.
   int layout_width_;
 
+  // Caches the measured width of cells for sizing columns to their content.
+  TableColumnWidthCache column_width_cache_;
+
+  // Limit set by SetMaxRowsToMeasureForColumnSizing().
+  int max_rows_to_measure_;
+
+  // See SetVirtualized().
+  bool virtualized_;
+
+  // Text and icons of the rows painted most recently. Only used when
+  // virtualized. Mutable as it's filled in by const methods.
+  mutable TableRowCache row_cache_;
+
   // Current sort.
   SortDescriptors sort_descriptors_;
 
@@ -346,6 +415,10 @@ class VIEWS_EXPORT TableView
   std::vector<int> view_to_model_;
   std::vector<int> model_to_view_;
 
+  // Sort keys of the sorted columns, parallel to |sort_descriptors_|. Empty if
+  // the table is not sorted or the model does not support sort keys.
+  ScopedVector<TableSortKeys> sort_keys_;
+
   scoped_ptr<TableViewRowBackgroundPainter> row_background_painter_;
 
   TableGrouper* grouper_;
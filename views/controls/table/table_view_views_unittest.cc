@@ -7,10 +7,13 @@
 #include "base/string_number_conversions.h"
 #include "base/utf_string_conversions.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "ui/gfx/canvas.h"
 #include "ui/views/controls/table/group_table_model.h"
 #include "ui/views/controls/table/table_grouper.h"
 #include "ui/views/controls/table/table_header.h"
 #include "ui/views/controls/table/table_view_observer.h"
+#include "ui/views/test/views_test_base.h"
+#include "ui/views/widget/widget.h"
 
 // Put the tests in the views namespace to make it easier to declare them as
 // friend classes.
@@ -34,6 +37,14 @@ class TableViewTestHelper {
 
   TableHeader* header() { return table_->header_; }
 
+  // Paints the part of the table in |bounds|, as the table would be asked to
+  // when that part is on screen.
+  void Paint(const gfx::Rect& bounds) {
+    gfx::Canvas canvas(bounds.size(), ui::SCALE_FACTOR_100P, false);
+    canvas.Translate(gfx::Vector2d(-bounds.x(), -bounds.y()));
+    table_->OnPaint(&canvas);
+  }
+
  private:
   TableView* table_;
 
@@ -738,4 +749,287 @@ TEST_F(TableViewTest, MultiselectionWithSort) {
   table_->SetObserver(NULL);
 }
 
+namespace {
+
+// StringTableModel ------------------------------------------------------------
+
+// Single column TableModel backed by a vector of strings. It keeps the default
+// CompareValues() and so allows sorting by sort key. Counts calls to GetText().
+class StringTableModel : public ui::TableModel {
+ public:
+  StringTableModel() : observer_(NULL), get_text_count_(0) {}
+  virtual ~StringTableModel() {}
+
+  void AddRow(const std::string& value) {
+    rows_.push_back(ASCIIToUTF16(value));
+    if (observer_)
+      observer_->OnItemsAdded(static_cast<int>(rows_.size()) - 1, 1);
+  }
+
+  void ChangeRow(int row, const std::string& value) {
+    rows_[row] = ASCIIToUTF16(value);
+    if (observer_)
+      observer_->OnItemsChanged(row, 1);
+  }
+
+  int GetTextCountAndClear() {
+    const int count = get_text_count_;
+    get_text_count_ = 0;
+    return count;
+  }
+
+  // ui::TableModel overrides:
+  virtual int RowCount() OVERRIDE { return static_cast<int>(rows_.size()); }
+  virtual string16 GetText(int row, int column_id) OVERRIDE {
+    ++get_text_count_;
+    return rows_[row];
+  }
+  virtual void SetObserver(ui::TableModelObserver* observer) OVERRIDE {
+    observer_ = observer;
+  }
+  virtual bool CanSortBySortKey(int column_id) OVERRIDE { return true; }
+
+ private:
+  ui::TableModelObserver* observer_;
+  std::vector<string16> rows_;
+  int get_text_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(StringTableModel);
+};
+
+}  // namespace
+
+// Verifies sorting by sort key fetches each value once and a change to a single
+// row only fetches that row again.
+TEST(TableViewSortKeyTest, Sort) {
+  StringTableModel model;
+  model.AddRow("pear");
+  model.AddRow("apple");
+  model.AddRow("Banana");
+  model.AddRow("cherry");
+  std::vector<ui::TableColumn> columns(1);
+  columns[0].title = ASCIIToUTF16("Fruit");
+  columns[0].sortable = true;
+  TableView* table = new TestTableView(&model, columns);
+  scoped_ptr<View> parent(table->CreateParentIfNecessary());
+  parent->SetBounds(0, 0, 10000, 10000);
+  parent->Layout();
+
+  model.GetTextCountAndClear();
+  table->ToggleSortOrder(0);
+  EXPECT_EQ(4, model.GetTextCountAndClear());
+  EXPECT_EQ("1 2 3 0", GetViewToModelAsString(table));
+  EXPECT_EQ("3 0 1 2", GetModelToViewAsString(table));
+
+  // Move "pear" to between "apple" and "Banana".
+  model.ChangeRow(0, "avocado");
+  EXPECT_EQ(1, model.GetTextCountAndClear());
+  EXPECT_EQ("1 0 2 3", GetViewToModelAsString(table));
+  EXPECT_EQ("1 0 2 3", GetModelToViewAsString(table));
+
+  // Descending.
+  table->ToggleSortOrder(0);
+  EXPECT_EQ("3 2 0 1", GetViewToModelAsString(table));
+  model.GetTextCountAndClear();
+
+  // Move "Banana" to the front.
+  model.ChangeRow(2, "zucchini");
+  EXPECT_EQ(1, model.GetTextCountAndClear());
+  EXPECT_EQ("2 3 0 1", GetViewToModelAsString(table));
+  EXPECT_EQ("2 3 0 1", GetModelToViewAsString(table));
+}
+
+namespace {
+
+// LargeTableModel -------------------------------------------------------------
+
+// Two column TableModel with |row_count| rows whose text is their index.
+// Counts calls to GetText() and GetIcon().
+class LargeTableModel : public ui::TableModel {
+ public:
+  explicit LargeTableModel(int row_count)
+      : observer_(NULL),
+        row_count_(row_count),
+        get_text_count_(0),
+        get_icon_count_(0) {
+  }
+  virtual ~LargeTableModel() {}
+
+  // Notifies the observer that |row| changed.
+  void ChangeRow(int row) {
+    if (observer_)
+      observer_->OnItemsChanged(row, 1);
+  }
+
+  int GetTextCountAndClear() {
+    const int count = get_text_count_;
+    get_text_count_ = 0;
+    return count;
+  }
+
+  int GetIconCountAndClear() {
+    const int count = get_icon_count_;
+    get_icon_count_ = 0;
+    return count;
+  }
+
+  // ui::TableModel overrides:
+  virtual int RowCount() OVERRIDE { return row_count_; }
+  virtual string16 GetText(int row, int column_id) OVERRIDE {
+    ++get_text_count_;
+    return base::IntToString16(row);
+  }
+  virtual gfx::ImageSkia GetIcon(int row) OVERRIDE {
+    ++get_icon_count_;
+    return gfx::ImageSkia();
+  }
+  virtual void SetObserver(ui::TableModelObserver* observer) OVERRIDE {
+    observer_ = observer;
+  }
+
+ private:
+  ui::TableModelObserver* observer_;
+  const int row_count_;
+  int get_text_count_;
+  int get_icon_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(LargeTableModel);
+};
+
+// A TableView with icons that records the area it schedules paints for.
+class PaintRecordingTableView : public TableView {
+ public:
+  PaintRecordingTableView(ui::TableModel* model,
+                          const std::vector<ui::TableColumn>& columns)
+      : TableView(model, columns, ICON_AND_TEXT, false, true, true) {
+  }
+
+  const gfx::Rect& scheduled_paint() const { return scheduled_paint_; }
+  void ClearScheduledPaint() { scheduled_paint_ = gfx::Rect(); }
+
+  // View overrides:
+  virtual void SchedulePaintInRect(const gfx::Rect& r) OVERRIDE {
+    scheduled_paint_.Union(r);
+    TableView::SchedulePaintInRect(r);
+  }
+
+ private:
+  gfx::Rect scheduled_paint_;
+
+  DISALLOW_COPY_AND_ASSIGN(PaintRecordingTableView);
+};
+
+const int kLargeRowCount = 100000;
+
+}  // namespace
+
+class TableViewVirtualizedTest : public ViewsTestBase {
+ public:
+  TableViewVirtualizedTest() : table_(NULL), widget_(NULL) {}
+
+  virtual void SetUp() OVERRIDE {
+    ViewsTestBase::SetUp();
+    model_.reset(new LargeTableModel(kLargeRowCount));
+    std::vector<ui::TableColumn> columns(2);
+    columns[0].title = ASCIIToUTF16("Title Column 0");
+    columns[1].title = ASCIIToUTF16("Title Column 1");
+    columns[1].id = 1;
+    table_ = new PaintRecordingTableView(model_.get(), columns);
+
+    // The widget makes the table visible, which SchedulePaintForRows() needs.
+    widget_ = new Widget;
+    Widget::InitParams params = CreateParams(Widget::InitParams::TYPE_POPUP);
+    params.bounds = gfx::Rect(0, 0, 200, 200);
+    widget_->Init(params);
+    widget_->SetContentsView(table_->CreateParentIfNecessary());
+    table_->SetVirtualized(true);
+    helper_.reset(new TableViewTestHelper(table_));
+
+    model_->GetTextCountAndClear();
+    model_->GetIconCountAndClear();
+  }
+
+  virtual void TearDown() OVERRIDE {
+    widget_->Close();
+    ViewsTestBase::TearDown();
+  }
+
+ protected:
+  // Returns the bounds of the part of the table scrolled to |first_row| that
+  // fits in the widget.
+  gfx::Rect GetScreenBounds(int first_row) const {
+    return gfx::Rect(0, first_row * table_->row_height(),
+                     table_->parent()->width(), table_->parent()->height());
+  }
+
+  // Number of rows painted for GetScreenBounds().
+  int GetRowsPerScreen() const {
+    const int row_height = table_->row_height();
+    return (table_->parent()->height() + row_height - 1) / row_height;
+  }
+
+  scoped_ptr<LargeTableModel> model_;
+
+  // Owned by |widget_|.
+  PaintRecordingTableView* table_;
+
+  scoped_ptr<TableViewTestHelper> helper_;
+
+ private:
+  Widget* widget_;
+
+  DISALLOW_COPY_AND_ASSIGN(TableViewVirtualizedTest);
+};
+
+// Verifies a virtualized table only fetches the rows it paints, and fetches
+// them once while they stay cached.
+TEST_F(TableViewVirtualizedTest, PaintFetchesVisibleRows) {
+  EXPECT_TRUE(table_->virtualized());
+  EXPECT_EQ(kLargeRowCount, table_->RowCount());
+  const int rows_per_screen = GetRowsPerScreen();
+  ASSERT_GT(rows_per_screen, 1);
+
+  helper_->Paint(GetScreenBounds(0));
+  int text_count = model_->GetTextCountAndClear();
+  EXPECT_GT(text_count, 0);
+  EXPECT_LE(text_count, rows_per_screen * 2);
+  EXPECT_EQ(rows_per_screen, model_->GetIconCountAndClear());
+
+  // Repainting the same rows is answered from the cache.
+  helper_->Paint(GetScreenBounds(0));
+  EXPECT_EQ(0, model_->GetTextCountAndClear());
+  EXPECT_EQ(0, model_->GetIconCountAndClear());
+
+  // Scrolling far down only fetches the newly painted rows.
+  helper_->Paint(GetScreenBounds(kLargeRowCount / 2));
+  text_count = model_->GetTextCountAndClear();
+  EXPECT_GT(text_count, 0);
+  EXPECT_LE(text_count, rows_per_screen * 2);
+  EXPECT_EQ(rows_per_screen, model_->GetIconCountAndClear());
+}
+
+// Verifies a change to a row only repaints it if it is on screen, and makes
+// the next paint fetch it again.
+TEST_F(TableViewVirtualizedTest, ChangeRowRepaintsRow) {
+  helper_->Paint(GetScreenBounds(0));
+  model_->GetTextCountAndClear();
+  model_->GetIconCountAndClear();
+
+  table_->ClearScheduledPaint();
+  model_->ChangeRow(2);
+  const gfx::Rect& scheduled = table_->scheduled_paint();
+  EXPECT_FALSE(scheduled.IsEmpty());
+  EXPECT_EQ(2 * table_->row_height(), scheduled.y());
+  EXPECT_EQ(table_->row_height(), scheduled.height());
+
+  helper_->Paint(GetScreenBounds(0));
+  EXPECT_GT(model_->GetTextCountAndClear(), 0);
+  EXPECT_EQ(1, model_->GetIconCountAndClear());
+
+  // Rows that aren't on screen aren't repainted.
+  table_->ClearScheduledPaint();
+  model_->ChangeRow(kLargeRowCount - 1);
+  EXPECT_TRUE(table_->scheduled_paint().IsEmpty());
+}
+
 }  // namespace views
@@ -532,8 +532,7 @@ void TreeView::OnPaint(gfx::Canvas* canvas) {
   int max_row = (max_y - kVerticalInset) / row_height_;
   if ((max_y - kVerticalInset) % row_height_ != 0)
     max_row++;
-  int current_row = root_row();
-  PaintRows(canvas, min_row, max_row, &root_, root_depth(), &current_row);
+  PaintRows(canvas, min_row, max_row);
 }
 
 void TreeView::OnFocus() {
@@ -613,6 +612,7 @@ void TreeView::UpdatePreferredSize() {
   if (!model_)
     return;
 
+  UpdateCachedRows();
   preferred_size_.SetSize(
       root_.GetMaxWidth(text_offset_, root_shown_ ? 1 : 0) +
       kTextHorizontalPadding * 2,
@@ -645,23 +645,13 @@ void TreeView::SchedulePaintForNode(InternalNode* node) {
   SchedulePaintInRect(GetBoundsForNode(node));
 }
 
-void TreeView::PaintRows(gfx::Canvas* canvas,
-                         int min_row,
-                         int max_row,
-                         InternalNode* node,
-                         int depth,
-                         int* row) {
-  if (*row >= max_row)
-    return;
-
-  if (*row >= min_row && *row < max_row)
-    PaintRow(canvas, node, *row, depth);
-  (*row)++;
-  if (!node->is_expanded())
-    return;
-  depth++;
-  for (int i = 0; i < node->child_count() && *row < max_row; ++i)
-    PaintRows(canvas, min_row, max_row, node->GetChild(i), depth, row);
+void TreeView::PaintRows(gfx::Canvas* canvas, int min_row, int max_row) {
+  int depth;
+  InternalNode* node = GetNodeByRow(min_row, &depth);
+  for (int row = min_row; node && row < max_row; ++row) {
+    PaintRow(canvas, node, row, depth);
+    node = GetNextNodeInRowOrder(node, &depth);
+  }
 }
 
 void TreeView::PaintRow(gfx::Canvas* canvas,
@@ -782,6 +772,7 @@ gfx::Rect TreeView::GetBoundsForNodeImpl(InternalNode* node,
 }
 
 int TreeView::GetRowCount() {
+  UpdateCachedRows();
   int row_count = root_.NumExpandedNodes();
   if (!root_shown_)
     row_count--;
@@ -790,53 +781,50 @@ int TreeView::GetRowCount() {
 
 int TreeView::GetRowForNode(InternalNode* node, int* depth) {
   DCHECK(!node->parent() || IsExpanded(node->parent()->model_node()));
-  *depth = -1;
-  int row = -1;
-  InternalNode* tmp_node = node;
-  while (tmp_node->parent()) {
-    int index_in_parent = tmp_node->parent()->GetIndexOf(tmp_node);
+  UpdateCachedRows();
+  *depth = root_depth();
+  int row = root_row();
+  for (InternalNode* tmp_node = node; tmp_node->parent();
+       tmp_node = tmp_node->parent()) {
     (*depth)++;
-    row++;  // For node.
-    for (int i = 0; i < index_in_parent; ++i)
-      row += tmp_node->parent()->GetChild(i)->NumExpandedNodes();
-    tmp_node = tmp_node->parent();
-  }
-  if (root_shown_) {
-    (*depth)++;
-    row++;
+    row += tmp_node->row_offset_in_parent();
   }
   return row;
 }
 
 TreeView::InternalNode* TreeView::GetNodeByRow(int row, int* depth) {
-  int current_row = root_row();
   *depth = 0;
-  return GetNodeByRowImpl(&root_, row, root_depth(), &current_row, depth);
+  if (row < 0 || row >= GetRowCount())
+    return NULL;
+  // GetRowCount() updated the cached rows.
+  InternalNode* node = &root_;
+  *depth = root_depth();
+  // Descend towards |row|, which is kept relative to the row of |node|.
+  for (row -= root_row(); row > 0; (*depth)++) {
+    node = node->GetChild(node->GetChildIndexForRow(row));
+    row -= node->row_offset_in_parent();
+  }
+  return node;
 }
 
-TreeView::InternalNode* TreeView::GetNodeByRowImpl(InternalNode* node,
-                                                   int target_row,
-                                                   int current_depth,
-                                                   int* current_row,
-                                                   int* node_depth) {
-  if (*current_row == target_row) {
-    *node_depth = current_depth;
-    return node;
+TreeView::InternalNode* TreeView::GetNextNodeInRowOrder(InternalNode* node,
+                                                        int* depth) {
+  if (node->is_expanded() && node->child_count()) {
+    (*depth)++;
+    return node->GetChild(0);
   }
-  (*current_row)++;
-  if (node->is_expanded()) {
-    current_depth++;
-    for (int i = 0; i < node->child_count(); ++i) {
-      InternalNode* result = GetNodeByRowImpl(
-          node->GetChild(i), target_row, current_depth, current_row,
-          node_depth);
-      if (result)
-        return result;
-    }
+  for (; node->parent(); node = node->parent(), (*depth)--) {
+    int next_index = node->index_in_parent() + 1;
+    if (next_index < node->parent()->child_count())
+      return node->parent()->GetChild(next_index);
   }
   return NULL;
 }
 
+void TreeView::UpdateCachedRows() {
+  root_.UpdateCachedValues(text_offset_);
+}
+
 void TreeView::IncrementSelection(IncrementType type) {
   if (!model_)
     return;
@@ -916,7 +904,12 @@ TreeView::InternalNode::InternalNode()
     : model_node_(NULL),
       loaded_children_(false),
       is_expanded_(false),
-      text_width_(0) {
+      text_width_(0),
+      cached_values_stale_(true),
+      expanded_node_count_(1),
+      max_width_(0),
+      index_in_parent_(0),
+      row_offset_in_parent_(1) {
 }
 
 TreeView::InternalNode::~InternalNode() {
@@ -927,26 +920,97 @@ void TreeView::InternalNode::Reset(ui::TreeModelNode* node) {
   loaded_children_ = false;
   is_expanded_ = false;
   text_width_ = 0;
+  InvalidateCachedValues();
+}
+
+void TreeView::InternalNode::Add(InternalNode* node, int index) {
+  ui::TreeNode<InternalNode>::Add(node, index);
+  InvalidateCachedValues();
+}
+
+TreeView::InternalNode* TreeView::InternalNode::Remove(InternalNode* node) {
+  InvalidateCachedValues();
+  return ui::TreeNode<InternalNode>::Remove(node);
+}
+
+void TreeView::InternalNode::set_is_expanded(bool expanded) {
+  if (expanded == is_expanded_)
+    return;
+  is_expanded_ = expanded;
+  InvalidateCachedValues();
 }
 
-int TreeView::InternalNode::NumExpandedNodes() {
-  int result = 1;  // For this.
-  if (!is_expanded_)
-    return result;
-  for (int i = 0; i < child_count(); ++i)
-    result += GetChild(i)->NumExpandedNodes();
-  return result;
+void TreeView::InternalNode::set_text_width(int width) {
+  if (width == text_width_)
+    return;
+  text_width_ = width;
+  InvalidateCachedValues();
 }
 
-int TreeView::InternalNode::GetMaxWidth(int indent, int depth) {
-  int max_width = text_width_ + indent * depth;
-  if (!is_expanded_)
-    return max_width;
+void TreeView::InternalNode::UpdateCachedValues(int indent) {
+  if (!cached_values_stale_)
+    return;
+  cached_values_stale_ = false;
+  expanded_node_count_ = 1;  // For this.
+  max_width_ = text_width_;
   for (int i = 0; i < child_count(); ++i) {
-    max_width = std::max(max_width,
-                         GetChild(i)->GetMaxWidth(indent, depth + 1));
+    InternalNode* child = GetChild(i);
+    // Collapsed children are updated as well so that stale nodes always have
+    // stale parents.
+    child->UpdateCachedValues(indent);
+    child->index_in_parent_ = i;
+    child->row_offset_in_parent_ = expanded_node_count_;
+    if (is_expanded_) {
+      expanded_node_count_ += child->expanded_node_count_;
+      max_width_ = std::max(max_width_, child->max_width_ + indent);
+    }
+  }
+}
+
+int TreeView::InternalNode::NumExpandedNodes() const {
+  DCHECK(!cached_values_stale_);
+  return expanded_node_count_;
+}
+
+int TreeView::InternalNode::GetMaxWidth(int indent, int depth) const {
+  DCHECK(!cached_values_stale_);
+  return max_width_ + indent * depth;
+}
+
+int TreeView::InternalNode::index_in_parent() const {
+  DCHECK(parent() && !parent()->cached_values_stale_);
+  return index_in_parent_;
+}
+
+int TreeView::InternalNode::row_offset_in_parent() const {
+  DCHECK(parent() && !parent()->cached_values_stale_);
+  return row_offset_in_parent_;
+}
+
+int TreeView::InternalNode::GetChildIndexForRow(int row) const {
+  DCHECK(!cached_values_stale_);
+  DCHECK(is_expanded_);
+  DCHECK_GT(row, 0);
+  DCHECK_LT(row, expanded_node_count_);
+  // Binary search for the last child that starts at or before |row|.
+  int low = 0;
+  int high = child_count() - 1;
+  while (low < high) {
+    int mid = low + (high - low + 1) / 2;
+    if (GetChild(mid)->row_offset_in_parent_ <= row)
+      low = mid;
+    else
+      high = mid - 1;
+  }
+  return low;
+}
+
+void TreeView::InternalNode::InvalidateCachedValues() {
+  for (InternalNode* node = this; node; node = node->parent()) {
+    if (node->cached_values_stale_ && node != this)
+      break;
+    node->cached_values_stale_ = true;
   }
-  return max_width;
 }
 
 }  // namespace views
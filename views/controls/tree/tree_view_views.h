@@ -25,9 +25,11 @@ class TreeViewController;
 // can expand, collapse and edit the items. A Controller may be attached to
 // receive notification of selection changes and restrict editing.
 //
-// Note on implementation. This implementation doesn't scale well. In particular
-// it does not store any row information, but instead calculates it as
-// necessary. But it's more than adequate for current uses.
+// Note on implementation. Each InternalNode caches the number of rows its
+// subtree occupies and the row offset of each of its children. The caches are
+// invalidated along the path to the root when the tree changes and rebuilt
+// lazily, so that mapping between rows and nodes costs O(depth * log(children))
+// and painting only visits the rows being painted.
 class VIEWS_EXPORT TreeView : public View,
                               public ui::TreeModelObserver,
                               public TextfieldController,
@@ -162,11 +164,15 @@ class VIEWS_EXPORT TreeView : public View,
     // Resets the state from |node|.
     void Reset(ui::TreeModelNode* node);
 
+    // ui::TreeNode overrides:
+    virtual void Add(InternalNode* node, int index) OVERRIDE;
+    virtual InternalNode* Remove(InternalNode* node) OVERRIDE;
+
     // The model node this InternalNode represents.
     ui::TreeModelNode* model_node() { return model_node_; }
 
     // Whether the node is expanded.
-    void set_is_expanded(bool expanded) { is_expanded_ = expanded; }
+    void set_is_expanded(bool expanded);
     bool is_expanded() const { return is_expanded_; }
 
     // Whether children have been loaded.
@@ -174,18 +180,36 @@ class VIEWS_EXPORT TreeView : public View,
     bool loaded_children() const { return loaded_children_; }
 
     // Width needed to display the string.
-    void set_text_width(int width) { text_width_ = width; }
+    void set_text_width(int width);
     int text_width() const { return text_width_; }
 
-    // Returns the total number of descendants (including this node).
-    int NumExpandedNodes();
+    // Recomputes the cached values below for any part of this subtree that
+    // changed since the last call. |indent| is how many pixels each child is
+    // indented and must be the same for every call.
+    void UpdateCachedValues(int indent);
+
+    // Returns the total number of expanded descendants (including this node).
+    int NumExpandedNodes() const;
+
+    // Returns the max width of all expanded descendants (including this node).
+    // |indent| is the value passed to UpdateCachedValues() and |depth| is the
+    // depth of this node from its parent.
+    int GetMaxWidth(int indent, int depth) const;
 
-    // Returns the max width of all descendants (including this node). |indent|
-    // is how many pixels each child is indented and |depth| is the depth of
-    // this node from its parent.
-    int GetMaxWidth(int indent, int depth);
+    // Index of this node in its parent.
+    int index_in_parent() const;
+
+    // Number of rows between the row of the parent and the row of this node.
+    int row_offset_in_parent() const;
+
+    // Returns the index of the child whose subtree contains |row|, which is
+    // relative to the row of this node and must be in [1, NumExpandedNodes()).
+    int GetChildIndexForRow(int row) const;
 
    private:
+    // Marks the cached values of this node and its ancestors as stale.
+    void InvalidateCachedValues();
+
     // The node from the model.
     ui::TreeModelNode* model_node_;
 
@@ -196,6 +220,21 @@ class VIEWS_EXPORT TreeView : public View,
 
     int text_width_;
 
+    // Whether the values below need to be recomputed. If a node is stale so
+    // are all its ancestors.
+    bool cached_values_stale_;
+
+    // See NumExpandedNodes().
+    int expanded_node_count_;
+
+    // GetMaxWidth() for a depth of 0.
+    int max_width_;
+
+    // See index_in_parent() and row_offset_in_parent(). These are set by the
+    // parent.
+    int index_in_parent_;
+    int row_offset_in_parent_;
+
     DISALLOW_COPY_AND_ASSIGN(InternalNode);
   };
 
@@ -246,15 +285,8 @@ class VIEWS_EXPORT TreeView : public View,
   // Schedules a paint for |node|.
   void SchedulePaintForNode(InternalNode* node);
 
-  // Recursively paints rows from |min_row| to |max_row|. |node| is the node for
-  // the row |*row|. |row| is updated as this walks the tree. Depth is the depth
-  // of |*row|.
-  void PaintRows(gfx::Canvas* canvas,
-                 int min_row,
-                 int max_row,
-                 InternalNode* node,
-                 int depth,
-                 int* row);
+  // Paints the rows from |min_row| up to, but not including, |max_row|.
+  void PaintRows(gfx::Canvas* canvas, int min_row, int max_row);
 
   // Invoked to paint a single node.
   void PaintRow(gfx::Canvas* canvas,
@@ -286,15 +318,16 @@ class VIEWS_EXPORT TreeView : public View,
   // Returns the row and depth of a node.
   int GetRowForNode(InternalNode* node, int* depth);
 
-  // Returns the row and depth of the specified node.
+  // Returns the node at |row| and its depth, or NULL if there is no such row.
   InternalNode* GetNodeByRow(int row, int* depth);
 
-  // Implementation of GetNodeByRow. |curent_row| is updated as we iterate.
-  InternalNode* GetNodeByRowImpl(InternalNode* node,
-                                 int target_row,
-                                 int current_depth,
-                                 int* current_row,
-                                 int* node_depth);
+  // Returns the node displayed in the row after |node|, or NULL if |node| is
+  // in the last row. |depth| is the depth of |node| and is updated to that of
+  // the returned node.
+  InternalNode* GetNextNodeInRowOrder(InternalNode* node, int* depth);
+
+  // Brings the row information cached by the InternalNodes up to date.
+  void UpdateCachedRows();
 
   // Increments the selection. Invoked in response to up/down arrow.
   void IncrementSelection(IncrementType type);
@@ -6,10 +6,13 @@
 
 #include <string>
 
+#include "base/memory/scoped_ptr.h"
+#include "base/string_number_conversions.h"
 #include "base/string_util.h"
 #include "base/utf_string_conversions.h"
 #include "ui/base/models/tree_node_model.h"
 #include "ui/views/test/views_test_base.h"
+#include "ui/views/widget/widget.h"
 
 using ui::TreeModel;
 using ui::TreeModelNode;
@@ -59,6 +62,14 @@ class TreeViewViewsTest : public ViewsTestBase {
   void ExpandOrSelectChild();
   int GetRowCount();
 
+  // Returns the titles of the nodes in row order, as determined by
+  // TreeView::GetNodeByRow(). Also verifies TreeView::GetRowForNode() agrees
+  // with it.
+  std::string RowsAsString();
+
+  // Returns the bounds of the selected node's row.
+  gfx::Rect GetSelectedNodeBounds();
+
   ui::TreeNodeModel<TestNode > model_;
   TreeView tree_;
 
@@ -114,6 +125,31 @@ int TreeViewViewsTest::GetRowCount() {
   return tree_.GetRowCount();
 }
 
+gfx::Rect TreeViewViewsTest::GetSelectedNodeBounds() {
+  return tree_.GetBoundsForNode(tree_.selected_node_);
+}
+
+std::string TreeViewViewsTest::RowsAsString() {
+  std::string result;
+  for (int row = 0; row < GetRowCount(); ++row) {
+    int depth;
+    TreeView::InternalNode* node = tree_.GetNodeByRow(row, &depth);
+    if (!node) {
+      ADD_FAILURE() << "no node for row " << row;
+      break;
+    }
+    int node_depth;
+    EXPECT_EQ(row, tree_.GetRowForNode(node, &node_depth));
+    EXPECT_EQ(depth, node_depth);
+    if (row > 0)
+      result += " ";
+    result += UTF16ToASCII(node->model_node()->GetTitle());
+  }
+  int depth;
+  EXPECT_TRUE(tree_.GetNodeByRow(GetRowCount(), &depth) == NULL);
+  return result;
+}
+
 TestNode* TreeViewViewsTest::GetNodeByTitleImpl(TestNode* node,
                                                 const string16& title) {
   if (node->GetTitle() == title)
@@ -381,4 +417,68 @@ TEST_F(TreeViewViewsTest, ExpandOrSelectChild) {
   EXPECT_EQ("b1", GetSelectedNodeTitle());
 }
 
+// Verifies rows map to nodes, and back, as the tree changes.
+TEST_F(TreeViewViewsTest, RowMapping) {
+  Add(GetNodeByTitle("b1"), 0, "b11");
+  Add(GetNodeByTitle("c"), 0, "c1");
+  tree_.SetModel(&model_);
+  EXPECT_EQ("root a b c", RowsAsString());
+
+  tree_.Expand(GetNodeByTitle("b11"));
+  EXPECT_EQ("root a b b1 b11 c", RowsAsString());
+
+  tree_.Expand(GetNodeByTitle("c"));
+  EXPECT_EQ("root a b b1 b11 c c1", RowsAsString());
+
+  tree_.Collapse(GetNodeByTitle("b1"));
+  EXPECT_EQ("root a b b1 c c1", RowsAsString());
+
+  Add(GetNodeByTitle("b"), 0, "b0");
+  Add(GetNodeByTitle("b1"), 1, "b12");
+  EXPECT_EQ("root a b b0 b1 c c1", RowsAsString());
+
+  tree_.Expand(GetNodeByTitle("b1"));
+  EXPECT_EQ("root a b b0 b1 b11 b12 c c1", RowsAsString());
+
+  delete model_.Remove(GetNodeByTitle("b"), GetNodeByTitle("b0"));
+  EXPECT_EQ("root a b b1 b11 b12 c c1", RowsAsString());
+
+  tree_.SetRootShown(false);
+  EXPECT_EQ("a b b1 b11 b12 c c1", RowsAsString());
+
+  tree_.Collapse(GetNodeByTitle("b"));
+  EXPECT_EQ("a b c c1", RowsAsString());
+}
+
+// Verifies selecting a node in a collapsed parent scrolls it into view, even
+// though the ScrollView lays itself out lazily after the expansion.
+TEST_F(TreeViewViewsTest, SelectionScrolledIntoView) {
+  TestNode* b = GetNodeByTitle("b");
+  for (int i = 2; i <= 20; ++i)
+    Add(b, i - 1, "b" + base::IntToString(i));
+  tree_.SetModel(&model_);
+  tree_.set_owned_by_client();
+
+  scoped_ptr<Widget> widget(new Widget);
+  Widget::InitParams params = CreateParams(Widget::InitParams::TYPE_POPUP);
+  params.ownership = Widget::InitParams::WIDGET_OWNS_NATIVE_WIDGET;
+  params.bounds = gfx::Rect(0, 0, 200, 100);
+  widget->Init(params);
+  View* scroll_view = tree_.CreateParentIfNecessary();
+  widget->SetContentsView(scroll_view);
+  scroll_view->SetBounds(0, 0, 200, 100);
+  scroll_view->Layout();
+  ASSERT_TRUE(widget->deferred_layout_enabled());
+
+  tree_.SetSelectedNode(GetNodeByTitle("b20"));
+  EXPECT_EQ("b20", GetSelectedNodeTitle());
+  const View* viewport = tree_.parent();
+  gfx::Rect visible_bounds(-tree_.x(), -tree_.y(), viewport->width(),
+                           viewport->height());
+  gfx::Rect selected_bounds = GetSelectedNodeBounds();
+  EXPECT_TRUE(visible_bounds.Contains(selected_bounds))
+      << visible_bounds.ToString() << " " << selected_bounds.ToString();
+  EXPECT_GT(visible_bounds.y(), 0);
+}
+
 }  // namespace views
@@ -682,10 +682,12 @@ GridLayout* GridLayout::CreatePanel(View* host) {
 
 void GridLayout::SetInsets(int top, int left, int bottom, int right) {
   insets_.Set(top, left, bottom, right);
+  host_->InvalidateLayout();
 }
 
 void GridLayout::SetInsets(const gfx::Insets& insets) {
   insets_ = insets;
+  host_->InvalidateLayout();
 }
 
 ColumnSet* GridLayout::AddColumnSet(int id) {
@@ -849,6 +851,11 @@ int GridLayout::GetPreferredHeightForWidth(View* host, int width) {
   return pref.height();
 }
 
+void GridLayout::SetMinimumSize(const gfx::Size& size) {
+  minimum_size_ = size;
+  host_->InvalidateLayout();
+}
+
 void GridLayout::SizeRowsAndColumns(bool layout, int width, int height,
                                     gfx::Size* pref) {
   // Make sure the master columns have been calculated.
@@ -994,6 +1001,7 @@ void GridLayout::AddRow(Row* row) {
   next_column_ = 0;
   rows_.push_back(row);
   current_row_col_set_ = row->column_set();
+  host_->InvalidateLayout();
   SkipPaddingColumns();
 }
 
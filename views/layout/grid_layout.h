@@ -106,6 +106,8 @@ class VIEWS_EXPORT GridLayout : public LayoutManager {
   static GridLayout* CreatePanel(View* host);
 
   // Sets the insets. All views are placed relative to these offsets.
+  // Changing the insets, the minimum size or the rows invalidates the layout
+  // of the host, as it caches the preferred size.
   void SetInsets(int top, int left, int bottom, int right);
   void SetInsets(const gfx::Insets& insets);
 
@@ -182,7 +184,8 @@ class VIEWS_EXPORT GridLayout : public LayoutManager {
 
   virtual int GetPreferredHeightForWidth(View* host, int width) OVERRIDE;
 
-  void set_minimum_size(const gfx::Size& size) { minimum_size_ = size; }
+  // Sets the size the preferred size is at least.
+  void SetMinimumSize(const gfx::Size& size);
 
  private:
   // As both Layout and GetPreferredSize need to do nearly the same thing,
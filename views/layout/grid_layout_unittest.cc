@@ -602,11 +602,34 @@ TEST_F(GridLayoutTest, MinimumPreferredSize) {
   GetPreferredSize();
   EXPECT_EQ(gfx::Size(10, 20), pref);
 
-  layout.set_minimum_size(gfx::Size(40, 40));
+  layout.SetMinimumSize(gfx::Size(40, 40));
   GetPreferredSize();
   EXPECT_EQ(gfx::Size(40, 40), pref);
 
   RemoveAll();
 }
 
+// Makes sure changes to the layout aren't hidden by the preferred size the
+// host caches.
+TEST(GridLayoutHostTest, ChangesInvalidateHost) {
+  View host;
+  GridLayout* layout = new GridLayout(&host);
+  host.SetLayoutManager(layout);
+  ColumnSet* set = layout->AddColumnSet(0);
+  set->AddColumn(GridLayout::FILL, GridLayout::FILL,
+                 0, GridLayout::USE_PREF, 0, 0);
+  layout->StartRow(0, 0);
+  layout->AddView(new SettableSizeView(gfx::Size(10, 20)));
+  EXPECT_EQ(gfx::Size(10, 20), host.GetPreferredSize());
+
+  layout->SetInsets(1, 2, 3, 4);
+  EXPECT_EQ(gfx::Size(16, 24), host.GetPreferredSize());
+
+  layout->SetMinimumSize(gfx::Size(40, 40));
+  EXPECT_EQ(gfx::Size(40, 40), host.GetPreferredSize());
+
+  layout->AddPaddingRow(0, 30);
+  EXPECT_EQ(gfx::Size(40, 54), host.GetPreferredSize());
+}
+
 }  // namespace views
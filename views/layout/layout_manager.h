@@ -41,7 +41,9 @@ class VIEWS_EXPORT LayoutManager {
   virtual void Layout(View* host) = 0;
 
   // Return the preferred size which is the size required to give each
-  // children their respective preferred size.
+  // children their respective preferred size. The host caches the result, so
+  // implementations must call InvalidateLayout() on the host when a change to
+  // their own state changes it.
   virtual gfx::Size GetPreferredSize(View* host) = 0;
 
   // Returns the preferred height for the specified width. The default
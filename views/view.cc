@@ -99,6 +99,14 @@ ViewsDelegate* ViewsDelegate::views_delegate = NULL;
 // static
 const char View::kViewClassName[] = "views/View";
 
+namespace {
+
+// Layout manager calls made in the current and the previous frame.
+View::LayoutStats g_layout_stats;
+View::LayoutStats g_last_frame_layout_stats;
+
+}  // namespace
+
 ////////////////////////////////////////////////////////////////////////////////
 // View, public:
 
@@ -115,6 +123,7 @@ View::View()
       registered_for_visible_bounds_notification_(false),
       clip_insets_(0, 0, 0, 0),
       needs_layout_(true),
+      preferred_size_valid_(false),
       focus_border_(FocusBorder::CreateDashedFocusBorder()),
       flip_canvas_on_paint_for_rtl_ui_(false),
       paint_to_layer_(false),
@@ -127,6 +136,7 @@ View::View()
       accessibility_focusable_(false),
       context_menu_controller_(NULL),
       drag_controller_(NULL) {
+  ClearPreferredSizeCache();
 }
 
 View::~View() {
@@ -200,6 +210,7 @@ void View::AddChildViewAt(View* view, int index) {
 
   if (layout_manager_.get())
     layout_manager_->ViewAdded(this, view);
+  InvalidatePreferredSizeCaches();
 
   if (use_acceleration_when_possible)
     ReorderLayers();
@@ -369,9 +380,16 @@ gfx::Rect View::GetBoundsInScreen() const {
 }
 
 gfx::Size View::GetPreferredSize() {
-  if (layout_manager_.get())
-    return layout_manager_->GetPreferredSize(this);
-  return gfx::Size();
+  if (!layout_manager_.get())
+    return gfx::Size();
+  if (preferred_size_valid_) {
+    ++g_layout_stats.cache_hit_count;
+    return preferred_size_;
+  }
+  ++g_layout_stats.preferred_size_count;
+  preferred_size_ = layout_manager_->GetPreferredSize(this);
+  preferred_size_valid_ = true;
+  return preferred_size_;
 }
 
 int View::GetBaseline() const {
@@ -393,9 +411,26 @@ gfx::Size View::GetMaximumSize() {
 }
 
 int View::GetHeightForWidth(int w) {
-  if (layout_manager_.get())
-    return layout_manager_->GetPreferredHeightForWidth(this, w);
-  return GetPreferredSize().height();
+  if (!layout_manager_.get())
+    return GetPreferredSize().height();
+
+  HeightForWidth* cache = height_for_width_cache_;
+  for (int i = 0; i < kHeightForWidthCacheSize; ++i) {
+    if (cache[i].width == w) {
+      ++g_layout_stats.cache_hit_count;
+      HeightForWidth hit = cache[i];
+      std::copy_backward(cache, cache + i, cache + i + 1);
+      cache[0] = hit;
+      return hit.height;
+    }
+  }
+  ++g_layout_stats.height_for_width_count;
+  const int height = layout_manager_->GetPreferredHeightForWidth(this, w);
+  std::copy_backward(cache, cache + kHeightForWidthCacheSize - 1,
+                     cache + kHeightForWidthCacheSize);
+  cache[0].width = w;
+  cache[0].height = height;
+  return height;
 }
 
 void View::SetVisible(bool visible) {
@@ -407,9 +442,12 @@ void View::SetVisible(bool visible) {
 
     visible_ = visible;
 
-    // Notify the parent.
-    if (parent_)
+    // Notify the parent. Layout managers skip hidden views, so its preferred
+    // size may have changed.
+    if (parent_) {
+      parent_->InvalidatePreferredSizeCaches();
       parent_->ChildVisibilityChanged(this);
+    }
 
     // This notifies all sub-views recursively.
     PropagateVisibilityNotifications(this, visible_);
@@ -514,8 +552,10 @@ void View::Layout() {
   needs_layout_ = false;
 
   // If we have a layout manager, let it handle the layout for us.
-  if (layout_manager_.get())
+  if (layout_manager_.get()) {
+    ++g_layout_stats.layout_count;
     layout_manager_->Layout(this);
+  }
 
   // Make sure to propagate the Layout() call to any children that haven't
   // received it yet through the layout manager and need to be laid out. This
@@ -536,10 +576,18 @@ void View::InvalidateLayout() {
   // Always invalidate up. This is needed to handle the case of us already being
   // valid, but not our parent.
   needs_layout_ = true;
+  ClearPreferredSizeCache();
   if (parent_)
     parent_->InvalidateLayout();
 }
 
+void View::ScheduleLayout() {
+  needs_layout_ = true;
+  Widget* widget = GetWidget();
+  if (!widget || !widget->ScheduleLayout(this))
+    Layout();
+}
+
 LayoutManager* View::GetLayoutManager() const {
   return layout_manager_.get();
 }
@@ -551,6 +599,23 @@ void View::SetLayoutManager(LayoutManager* layout_manager) {
   layout_manager_.reset(layout_manager);
   if (layout_manager_.get())
     layout_manager_->Installed(this);
+  InvalidatePreferredSizeCaches();
+}
+
+// static
+const View::LayoutStats& View::GetLayoutStats() {
+  return g_layout_stats;
+}
+
+// static
+const View::LayoutStats& View::GetLayoutStatsForLastFrame() {
+  return g_last_frame_layout_stats;
+}
+
+// static
+void View::StartLayoutStatsFrame() {
+  g_last_frame_layout_stats = g_layout_stats;
+  g_layout_stats = LayoutStats();
 }
 
 // Attributes ------------------------------------------------------------------
@@ -697,6 +762,11 @@ gfx::Rect View::ConvertRectToWidget(const gfx::Rect& rect) const {
 
 // Painting --------------------------------------------------------------------
 
+void View::set_border(Border* b) {
+  border_.reset(b);
+  InvalidatePreferredSizeCaches();
+}
+
 void View::SchedulePaint() {
   SchedulePaintInRect(GetLocalBounds());
 }
@@ -1572,8 +1642,11 @@ void View::DoRemoveChildView(View* view,
         next_focusable->previous_focusable_view_ = prev_focusable;
     }
 
-    if (GetWidget())
+    Widget* widget = GetWidget();
+    if (widget) {
       UnregisterChildrenForVisibleBoundsNotification(view);
+      widget->CancelScheduledLayout(view);
+    }
     view->PropagateRemoveNotifications(this);
     view->parent_ = NULL;
     view->UpdateLayerVisibility();
@@ -1589,6 +1662,7 @@ void View::DoRemoveChildView(View* view,
 
   if (layout_manager_.get())
     layout_manager_->ViewRemoved(this, view);
+  InvalidatePreferredSizeCaches();
 }
 
 void View::PropagateRemoveNotifications(View* parent) {
@@ -1674,6 +1748,17 @@ void View::VisibilityChangedImpl(View* starting_from, bool is_visible) {
   VisibilityChanged(starting_from, is_visible);
 }
 
+void View::InvalidatePreferredSizeCaches() {
+  for (View* view = this; view; view = view->parent_)
+    view->ClearPreferredSizeCache();
+}
+
+void View::ClearPreferredSizeCache() {
+  preferred_size_valid_ = false;
+  for (int i = 0; i < kHeightForWidthCacheSize; ++i)
+    height_for_width_cache_[i].width = -1;
+}
+
 void View::BoundsChanged(const gfx::Rect& previous_bounds) {
   if (visible_) {
     // Paint the new bounds.
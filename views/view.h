@@ -218,6 +218,8 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   virtual int GetBaseline() const;
 
   // Get the size the View would like to be, if enough space were available.
+  // View's implementation asks the LayoutManager, and caches the result until
+  // the layout of this view or one of its descendants is invalidated.
   virtual gfx::Size GetPreferredSize();
 
   // Convenience method that sizes this view to its preferred size.
@@ -234,7 +236,8 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // Return the height necessary to display this view with the provided width.
   // View's implementation returns the value from getPreferredSize.cy.
   // Override if your View's preferred height depends upon the width (such
-  // as with Labels).
+  // as with Labels). If there is a LayoutManager, the heights for the last few
+  // widths asked for are cached like the preferred size.
   virtual int GetHeightForWidth(int w);
 
   // Set whether this view is visible. Painting is scheduled as needed.
@@ -346,6 +349,18 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // parent views do not change.
   void InvalidateLayout();
 
+  // Has the Widget lay this view out before it next paints, so that many
+  // changes in a row cause a single layout. Unlike InvalidateLayout(), this
+  // does not mark the ancestors as needing layout. Lays the view out
+  // immediately if it is not in a Widget or the Widget has deferred layout
+  // disabled. Code that needs the resulting bounds right away should call
+  // Layout() instead.
+  void ScheduleLayout();
+
+  // Returns true if the layout of this view has been invalidated since it was
+  // last laid out.
+  bool needs_layout() const { return needs_layout_; }
+
   // Gets/Sets the Layout Manager used by this view to size and place its
   // children.
   // The LayoutManager is owned by the View and is deleted when the view is
@@ -353,6 +368,32 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   LayoutManager* GetLayoutManager() const;
   void SetLayoutManager(LayoutManager* layout);
 
+  // Counts of the calls made to layout managers by all views, used to measure
+  // how much re-measuring layouts cost. RootView starts a new frame of counts
+  // each time it paints.
+  struct LayoutStats {
+    // Calls to LayoutManager::Layout().
+    int layout_count;
+
+    // Calls to LayoutManager::GetPreferredSize() and
+    // LayoutManager::GetPreferredHeightForWidth().
+    int preferred_size_count;
+    int height_for_width_count;
+
+    // GetPreferredSize() and GetHeightForWidth() calls answered from the
+    // caches instead.
+    int cache_hit_count;
+  };
+
+  // Returns the counts since the current frame started.
+  static const LayoutStats& GetLayoutStats();
+
+  // Returns the counts of the previous frame.
+  static const LayoutStats& GetLayoutStatsForLastFrame();
+
+  // Ends the current frame of counts and starts a new one.
+  static void StartLayoutStatsFrame();
+
   // Attributes ----------------------------------------------------------------
 
   // The view class name.
@@ -461,7 +502,9 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   Background* background() { return background_.get(); }
 
   // The border object is owned by this object and may be NULL.
-  void set_border(Border* b) { border_.reset(b); }
+  // The preferred size depends on the insets of the border, so setting it
+  // invalidates the cached preferred size.
+  void set_border(Border* b);
   const Border* border() const { return border_.get(); }
   Border* border() { return border_.get(); }
 
@@ -1216,6 +1259,13 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // views.
   void BoundsChanged(const gfx::Rect& previous_bounds);
 
+  // Discards the cached preferred sizes of this view and its ancestors,
+  // without marking them as needing layout.
+  void InvalidatePreferredSizeCaches();
+
+  // Discards the cached preferred sizes of this view only.
+  void ClearPreferredSizeCache();
+
   // Visible bounds notification registration.
   // When a view is added to a hierarchy, it and all its children are asked if
   // they need to be registered for "visible bounds within root" notifications
@@ -1420,6 +1470,20 @@ class VIEWS_EXPORT View : public ui::LayerDelegate,
   // Whether the view needs to be laid out.
   bool needs_layout_;
 
+  // Size returned by the layout manager's GetPreferredSize(), valid if
+  // |preferred_size_valid_| is true.
+  gfx::Size preferred_size_;
+  bool preferred_size_valid_;
+
+  // Results of the layout manager's GetPreferredHeightForWidth(), most
+  // recently computed first. Unused entries have a width of -1.
+  struct HeightForWidth {
+    int width;
+    int height;
+  };
+  static const int kHeightForWidthCacheSize = 2;
+  HeightForWidth height_for_width_cache_[kHeightForWidthCacheSize];
+
   // The View's LayoutManager defines the sizing heuristics applied to child
   // Views. The default is absolute positioning according to bounds_.
   scoped_ptr<LayoutManager> layout_manager_;
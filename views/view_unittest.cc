@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <map>
 
 #include "base/memory/scoped_ptr.h"
@@ -29,6 +30,7 @@
 #include "ui/views/controls/textfield/textfield.h"
 #include "ui/views/focus/accelerator_handler.h"
 #include "ui/views/focus/view_storage.h"
+#include "ui/views/layout/layout_manager.h"
 #include "ui/views/test/views_test_base.h"
 #include "ui/views/view.h"
 #include "ui/views/views_delegate.h"
@@ -351,6 +353,136 @@ TEST_F(ViewTest, OnBoundsChanged) {
   EXPECT_EQ(v.bounds(), new_rect);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Preferred size caching
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// A layout manager that stacks children vertically and counts how often it is
+// asked for sizes.
+class CountingLayout : public LayoutManager {
+ public:
+  CountingLayout() : preferred_size_count_(0), height_for_width_count_(0) {}
+  virtual ~CountingLayout() {}
+
+  int preferred_size_count() const { return preferred_size_count_; }
+  int height_for_width_count() const { return height_for_width_count_; }
+
+  // LayoutManager overrides:
+  virtual void Layout(View* host) OVERRIDE {}
+  virtual gfx::Size GetPreferredSize(View* host) OVERRIDE {
+    ++preferred_size_count_;
+    gfx::Size size;
+    for (int i = 0; i < host->child_count(); ++i) {
+      if (!host->child_at(i)->visible())
+        continue;
+      gfx::Size child_size = host->child_at(i)->GetPreferredSize();
+      size.SetSize(std::max(size.width(), child_size.width()),
+                   size.height() + child_size.height());
+    }
+    return size;
+  }
+  virtual int GetPreferredHeightForWidth(View* host, int width) OVERRIDE {
+    ++height_for_width_count_;
+    return width / 2;
+  }
+
+ private:
+  int preferred_size_count_;
+  int height_for_width_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingLayout);
+};
+
+// A view with a settable preferred size.
+class SizedView : public View {
+ public:
+  SizedView() {}
+  virtual ~SizedView() {}
+
+  void SetSize(const gfx::Size& size) {
+    size_ = size;
+    PreferredSizeChanged();
+  }
+
+  // View overrides:
+  virtual gfx::Size GetPreferredSize() OVERRIDE { return size_; }
+
+ private:
+  gfx::Size size_;
+
+  DISALLOW_COPY_AND_ASSIGN(SizedView);
+};
+
+}  // namespace
+
+TEST_F(ViewTest, PreferredSizeCache) {
+  View outer;
+  CountingLayout* outer_layout = new CountingLayout;
+  outer.SetLayoutManager(outer_layout);
+  View* inner = new View;
+  CountingLayout* inner_layout = new CountingLayout;
+  inner->SetLayoutManager(inner_layout);
+  outer.AddChildView(inner);
+  SizedView* leaf = new SizedView;
+  leaf->SetSize(gfx::Size(10, 20));
+  inner->AddChildView(leaf);
+
+  EXPECT_EQ(gfx::Size(10, 20), outer.GetPreferredSize());
+  EXPECT_EQ(gfx::Size(10, 20), outer.GetPreferredSize());
+  EXPECT_EQ(1, outer_layout->preferred_size_count());
+  EXPECT_EQ(1, inner_layout->preferred_size_count());
+
+  // A change to the leaf invalidates all its ancestors.
+  leaf->SetSize(gfx::Size(30, 5));
+  EXPECT_EQ(gfx::Size(30, 5), outer.GetPreferredSize());
+  EXPECT_EQ(2, outer_layout->preferred_size_count());
+  EXPECT_EQ(2, inner_layout->preferred_size_count());
+
+  // Adding, hiding and removing children do too.
+  SizedView* second_leaf = new SizedView;
+  second_leaf->SetSize(gfx::Size(1, 1));
+  inner->AddChildView(second_leaf);
+  EXPECT_EQ(gfx::Size(30, 6), outer.GetPreferredSize());
+  second_leaf->SetVisible(false);
+  EXPECT_EQ(gfx::Size(30, 5), outer.GetPreferredSize());
+  inner->RemoveChildView(second_leaf);
+  delete second_leaf;
+  EXPECT_EQ(gfx::Size(30, 5), outer.GetPreferredSize());
+  EXPECT_EQ(5, outer_layout->preferred_size_count());
+
+  // The last two widths asked for are cached.
+  EXPECT_EQ(50, outer.GetHeightForWidth(100));
+  EXPECT_EQ(100, outer.GetHeightForWidth(200));
+  EXPECT_EQ(50, outer.GetHeightForWidth(100));
+  EXPECT_EQ(100, outer.GetHeightForWidth(200));
+  EXPECT_EQ(2, outer_layout->height_for_width_count());
+  EXPECT_EQ(150, outer.GetHeightForWidth(300));
+  EXPECT_EQ(50, outer.GetHeightForWidth(100));
+  EXPECT_EQ(4, outer_layout->height_for_width_count());
+
+  outer.InvalidateLayout();
+  EXPECT_EQ(50, outer.GetHeightForWidth(100));
+  EXPECT_EQ(5, outer_layout->height_for_width_count());
+}
+
+TEST_F(ViewTest, LayoutStats) {
+  View::StartLayoutStatsFrame();
+  View host;
+  host.SetLayoutManager(new CountingLayout);
+  host.GetPreferredSize();
+  host.GetPreferredSize();
+  host.Layout();
+  EXPECT_EQ(1, View::GetLayoutStats().preferred_size_count);
+  EXPECT_EQ(1, View::GetLayoutStats().cache_hit_count);
+  EXPECT_EQ(1, View::GetLayoutStats().layout_count);
+
+  View::StartLayoutStatsFrame();
+  EXPECT_EQ(1, View::GetLayoutStatsForLastFrame().preferred_size_count);
+  EXPECT_EQ(0, View::GetLayoutStats().preferred_size_count);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // MouseEvent
 ////////////////////////////////////////////////////////////////////////////////
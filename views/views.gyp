@@ -207,8 +207,14 @@
         'controls/table/group_table_view.h',
         'controls/table/group_table_view_views.cc',
         'controls/table/group_table_view_views.h',
+        'controls/table/table_column_width_cache.cc',
+        'controls/table/table_column_width_cache.h',
         'controls/table/table_header.cc',
         'controls/table/table_header.h',
+        'controls/table/table_row_cache.cc',
+        'controls/table/table_row_cache.h',
+        'controls/table/table_sort_keys.cc',
+        'controls/table/table_sort_keys.h',
         'controls/table/table_utils.cc',
         'controls/table/table_utils.h',
         'controls/table/table_view.h',
@@ -659,6 +665,8 @@
         'controls/single_split_view_unittest.cc',
         'controls/slider_unittest.cc',
         'controls/tabbed_pane/tabbed_pane_unittest.cc',
+        'controls/table/table_column_width_cache_unittest.cc',
+        'controls/table/table_row_cache_unittest.cc',
         'controls/table/table_utils_unittest.cc',
         'controls/table/table_view_views_unittest.cc',
         'controls/table/test_table_model.cc',
@@ -20,6 +20,7 @@
 #include "ui/aura/window_property.h"
 #include "ui/base/events/event_utils.h"
 #include "ui/base/touch/touch_factory.h"
+#include "ui/base/x/x11_property_cache.h"
 #include "ui/base/x/x11_util.h"
 #include "ui/native_theme/native_theme.h"
 #include "ui/views/corewm/compound_event_filter.h"
@@ -142,6 +143,7 @@ void DesktopRootWindowHostLinux::InitX11Window(
                     PointerMotionMask;
   XSelectInput(xdisplay_, xwindow_, event_mask);
   XFlush(xdisplay_);
+  ui::X11PropertyCache::GetInstance()->WatchWindow(xwindow_);
 
   if (base::MessagePumpForUI::HasXInput2())
     ui::TouchFactory::GetInstance()->SetupXI2ForXWindow(xwindow_);
@@ -163,13 +165,15 @@ void DesktopRootWindowHostLinux::InitX11Window(
   // Likewise, the X server needs to know this window's pid so it knows which
   // program to kill if the window hangs.
   pid_t pid = getpid();
+  ::Atom pid_atom = atom_cache_.GetAtom("_NET_WM_PID");
   XChangeProperty(xdisplay_,
                   xwindow_,
-                  atom_cache_.GetAtom("_NET_WM_PID"),
+                  pid_atom,
                   XA_CARDINAL,
                   32,
                   PropModeReplace,
                   reinterpret_cast<unsigned char*>(&pid), 1);
+  ui::X11PropertyCache::GetInstance()->Invalidate(xwindow_, pid_atom);
 }
 
 // static
@@ -344,6 +348,7 @@ void DesktopRootWindowHostLinux::CloseNow() {
 
   // Actually free our native resources.
   base::MessagePumpAuraX11::Current()->RemoveDispatcherForWindow(xwindow_);
+  ui::X11PropertyCache::GetInstance()->UnwatchWindow(xwindow_);
   XDestroyWindow(xdisplay_, xwindow_);
   xwindow_ = None;
 
@@ -1066,6 +1071,8 @@ bool DesktopRootWindowHostLinux::Dispatch(const base::NativeEvent& event) {
       break;
     }
     case PropertyNotify: {
+      ui::X11PropertyCache::GetInstance()->OnPropertyNotify(xev->xproperty);
+
       // Get our new window property state if the WM has told us its changed.
       ::Atom state = atom_cache_.GetAtom("_NET_WM_STATE");
 
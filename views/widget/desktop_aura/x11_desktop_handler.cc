@@ -8,6 +8,7 @@
 #include "ui/aura/env.h"
 #include "ui/aura/focus_manager.h"
 #include "ui/aura/root_window.h"
+#include "ui/base/x/x11_property_cache.h"
 #include "ui/base/x/x11_util.h"
 #include "ui/views/widget/desktop_aura/desktop_activation_client.h"
 
@@ -51,9 +52,11 @@ X11DesktopHandler::X11DesktopHandler()
   XSelectInput(xdisplay_, x_root_window_,
                attr.your_event_mask | PropertyChangeMask |
                StructureNotifyMask | SubstructureNotifyMask);
+  ui::X11PropertyCache::GetInstance()->WatchWindow(x_root_window_);
 }
 
 X11DesktopHandler::~X11DesktopHandler() {
+  ui::X11PropertyCache::GetInstance()->UnwatchWindow(x_root_window_);
   aura::Env::GetInstance()->RemoveObserver(this);
   base::MessagePumpAuraX11::Current()->RemoveDispatcherForRootWindow(this);
 }
@@ -84,6 +87,7 @@ bool X11DesktopHandler::Dispatch(const base::NativeEvent& event) {
   // Check for a change to the active window.
   switch (event->type) {
     case PropertyNotify: {
+      ui::X11PropertyCache::GetInstance()->OnPropertyNotify(event->xproperty);
       ::Atom active_window = atom_cache_.GetAtom("_NET_ACTIVE_WINDOW");
 
       if (event->xproperty.window == x_root_window_ &&
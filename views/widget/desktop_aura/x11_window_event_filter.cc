@@ -14,6 +14,7 @@
 #include "ui/aura/window_delegate.h"
 #include "ui/base/events/event.h"
 #include "ui/base/hit_test.h"
+#include "ui/base/x/x11_property_cache.h"
 #include "ui/views/widget/desktop_aura/desktop_activation_client.h"
 #include "ui/views/widget/native_widget_aura.h"
 
@@ -86,6 +87,7 @@ void X11WindowEventFilter::SetUseHostWindowBorders(bool use_os_border) {
                   PropModeReplace,
                   reinterpret_cast<unsigned char*>(&motif_hints),
                   sizeof(MotifWmHints)/sizeof(long));
+  ui::X11PropertyCache::GetInstance()->Invalidate(xwindow_, hint_atom);
 }
 
 void X11WindowEventFilter::OnMouseEvent(ui::MouseEvent* event) {
@@ -636,6 +636,9 @@ void RootView::ViewHierarchyChanged(bool is_add, View* parent, View* child) {
 }
 
 void RootView::OnPaint(gfx::Canvas* canvas) {
+  // Layout for this frame is done by the time it is painted.
+  View::StartLayoutStatsFrame();
+
   if (!layer() || !layer()->fills_bounds_opaquely())
     canvas->DrawColor(SK_ColorBLACK, SkXfermode::kClear_Mode);
 
@@ -4,6 +4,11 @@
 
 #include "ui/views/widget/widget.h"
 
+#include <algorithm>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/compiler_specific.h"
 #include "base/logging.h"
 #include "base/message_loop.h"
 #include "base/utf_string_conversions.h"
@@ -60,6 +65,14 @@ NativeWidget* CreateNativeWidget(NativeWidget* native_widget,
   return native_widget;
 }
 
+// Returns the number of ancestors of |view|.
+int GetViewDepth(const View* view) {
+  int depth = 0;
+  for (const View* v = view->parent(); v; v = v->parent())
+    ++depth;
+  return depth;
+}
+
 }  // namespace
 
 // This class is used to keep track of the event a Widget is processing, and
@@ -200,7 +213,9 @@ Widget::Widget()
       is_mouse_button_pressed_(false),
       is_touch_down_(false),
       last_mouse_event_was_move_(false),
-      root_layers_dirty_(false) {
+      root_layers_dirty_(false),
+      deferred_layout_enabled_(true),
+      ALLOW_THIS_IN_INITIALIZER_LIST(layout_factory_(this)) {
 }
 
 Widget::~Widget() {
@@ -754,6 +769,51 @@ void Widget::SchedulePaintInRect(const gfx::Rect& rect) {
   native_widget_->SchedulePaintInRect(rect);
 }
 
+bool Widget::ScheduleLayout(View* view) {
+  DCHECK_EQ(this, view->GetWidget());
+  if (!deferred_layout_enabled_)
+    return false;
+  views_needing_layout_.insert(view);
+  if (!layout_factory_.HasWeakPtrs()) {
+    MessageLoop::current()->PostTask(
+        FROM_HERE,
+        base::Bind(&Widget::LayoutPendingViews, layout_factory_.GetWeakPtr()));
+  }
+  return true;
+}
+
+void Widget::LayoutPendingViews() {
+  layout_factory_.InvalidateWeakPtrs();
+  // Laying a view out may schedule more layouts, or remove views that are
+  // still pending, so work from a snapshot and check each view is still
+  // pending before laying it out.
+  while (!views_needing_layout_.empty()) {
+    std::vector<std::pair<int, View*> > views;
+    for (std::set<View*>::const_iterator i = views_needing_layout_.begin();
+         i != views_needing_layout_.end(); ++i) {
+      views.push_back(std::make_pair(GetViewDepth(*i), *i));
+    }
+    // Ancestors first: laying them out often lays out their descendants too,
+    // which then need nothing more.
+    std::sort(views.begin(), views.end());
+    for (size_t i = 0; i < views.size(); ++i) {
+      View* view = views[i].second;
+      if (views_needing_layout_.erase(view) && view->needs_layout())
+        view->Layout();
+    }
+  }
+}
+
+void Widget::CancelScheduledLayout(View* view) {
+  std::set<View*>::iterator i = views_needing_layout_.begin();
+  while (i != views_needing_layout_.end()) {
+    if (view->Contains(*i))
+      views_needing_layout_.erase(i++);
+    else
+      ++i;
+  }
+}
+
 void Widget::SetCursor(gfx::NativeCursor cursor) {
   native_widget_->SetCursor(cursor);
 }
@@ -1081,6 +1141,8 @@ bool Widget::OnNativeWidgetPaintAccelerated(const gfx::Rect& dirty_region) {
   if (!compositor)
     return false;
 
+  LayoutPendingViews();
+
 #if defined(OS_WIN) && defined(USE_AURA)
   compositor->ScheduleDraw();
 #else
@@ -1117,8 +1179,10 @@ bool Widget::OnNativeWidgetPaintAccelerated(const gfx::Rect& dirty_region) {
 void Widget::OnNativeWidgetPaint(gfx::Canvas* canvas) {
   // On Linux Aura, we can get here during Init() because of the
   // SetInitialBounds call.
-  if (native_widget_initialized_)
-  GetRootView()->Paint(canvas);
+  if (native_widget_initialized_) {
+    LayoutPendingViews();
+    GetRootView()->Paint(canvas);
+  }
 }
 
 int Widget::GetNonClientComponent(const gfx::Point& point) {
@@ -1292,6 +1356,8 @@ internal::RootView* Widget::CreateRootView() {
 }
 
 void Widget::DestroyRootView() {
+  views_needing_layout_.clear();
+  layout_factory_.InvalidateWeakPtrs();
   non_client_view_ = NULL;
   root_view_.reset();
   // Input method has to be destroyed before focus manager.
@@ -11,6 +11,7 @@
 
 #include "base/gtest_prod_util.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
 #include "base/observer_list.h"
 #include "ui/base/accessibility/accessibility_types.h"
 #include "ui/base/ui_base_types.h"
@@ -495,6 +496,28 @@ class VIEWS_EXPORT Widget : public internal::NativeWidgetDelegate,
   // redrawn.
   void SchedulePaintInRect(const gfx::Rect& rect);
 
+  // Arranges for |view| to be laid out right before the widget next paints,
+  // or once the current task completes if no paint comes first. Views
+  // scheduled several times are laid out once, and ancestors are laid out
+  // before their descendants. Returns false without scheduling anything if
+  // deferred layout is disabled. Use View::ScheduleLayout() rather than
+  // calling this directly.
+  bool ScheduleLayout(View* view);
+
+  // Lays out the views passed to ScheduleLayout() now.
+  void LayoutPendingViews();
+
+  // Forgets any pending layout of |view| and its descendants. Invoked when
+  // |view| is removed from the widget.
+  void CancelScheduledLayout(View* view);
+
+  // Deferred layout is enabled by default. Widgets whose contents rely on
+  // View::ScheduleLayout() updating bounds synchronously can disable it.
+  void set_deferred_layout_enabled(bool enabled) {
+    deferred_layout_enabled_ = enabled;
+  }
+  bool deferred_layout_enabled() const { return deferred_layout_enabled_; }
+
   // Sets the currently visible cursor. If |cursor| is NULL, the cursor used
   // before the current is restored.
   void SetCursor(gfx::NativeCursor cursor);
@@ -836,6 +859,16 @@ class VIEWS_EXPORT Widget : public internal::NativeWidgetDelegate,
   // Is |root_layers_| out of date?
   bool root_layers_dirty_;
 
+  // Views passed to ScheduleLayout() that have not been laid out yet.
+  std::set<View*> views_needing_layout_;
+
+  // See set_deferred_layout_enabled().
+  bool deferred_layout_enabled_;
+
+  // Used to post the task that lays out |views_needing_layout_| if no paint
+  // does it first.
+  base::WeakPtrFactory<Widget> layout_factory_;
+
   DISALLOW_COPY_AND_ASSIGN(Widget);
 };
 
@@ -519,6 +519,64 @@ TEST_F(WidgetTest, Visibility) {
   // |child| should be automatically destroyed with |toplevel|.
 }
 
+// A view that counts how often it is laid out.
+class LayoutCountingView : public View {
+ public:
+  LayoutCountingView() : layout_count_(0) {}
+  virtual ~LayoutCountingView() {}
+
+  int layout_count() const { return layout_count_; }
+
+  // View overrides:
+  virtual void Layout() OVERRIDE {
+    ++layout_count_;
+    View::Layout();
+  }
+
+ private:
+  int layout_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(LayoutCountingView);
+};
+
+// Layouts scheduled in a burst are coalesced and run once.
+TEST_F(WidgetTest, DeferredLayout) {
+  Widget* toplevel = CreateTopLevelPlatformWidget();
+  LayoutCountingView* outer = new LayoutCountingView;
+  LayoutCountingView* inner = new LayoutCountingView;
+  outer->AddChildView(inner);
+  toplevel->GetRootView()->AddChildView(outer);
+  RunPendingMessages();
+  const int outer_count = outer->layout_count();
+  const int inner_count = inner->layout_count();
+
+  for (int i = 0; i < 100; ++i) {
+    inner->ScheduleLayout();
+    outer->ScheduleLayout();
+  }
+  EXPECT_EQ(outer_count, outer->layout_count());
+  EXPECT_EQ(inner_count, inner->layout_count());
+
+  // Laying |outer| out lays out |inner| too, which then needs nothing more.
+  RunPendingMessages();
+  EXPECT_EQ(outer_count + 1, outer->layout_count());
+  EXPECT_EQ(inner_count + 1, inner->layout_count());
+
+  // Removing a view cancels its pending layout.
+  inner->ScheduleLayout();
+  outer->RemoveChildView(inner);
+  toplevel->LayoutPendingViews();
+  EXPECT_EQ(inner_count + 1, inner->layout_count());
+  delete inner;
+
+  // With deferred layout disabled, views are laid out immediately.
+  toplevel->set_deferred_layout_enabled(false);
+  outer->ScheduleLayout();
+  EXPECT_EQ(outer_count + 2, outer->layout_count());
+
+  toplevel->CloseNow();
+}
+
 #if defined(OS_WIN) && !defined(USE_AURA)
 // On Windows, it is possible to have child window that are TYPE_POPUP.  Unlike
 // regular child windows, these should be created as hidden and must be shown